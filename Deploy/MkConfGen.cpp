@@ -24,7 +24,759 @@ SOFTWARE.
 
 #include "MkConfGen.h"
 
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#include <stdio.h>
+#endif
+#include <charconv>
+#include <errno.h>
+#include <limits.h>
+#include <math.h>
+#include <new>
+#include <string.h>
+#include <thread>
+
 #define _MKCONFGEN_ERRORS_GROW_COUNT 8
+#define _MKCONFGEN_CHUNKS_PER_THREAD 4
+#define _MKCONFGEN_MIN_CHUNK_LENGTH 65536
+
+bool _MkConfGenParseBool(const wchar_t * rawValue, size_t rawValueLength, bool * value) {
+    _MKCONFGEN_ASSERT(rawValue);
+    _MKCONFGEN_ASSERT(value);
+
+    switch (rawValueLength) {
+        case 1:
+            if (rawValue[0] == L'1') {
+                *value = true;
+                return true;
+            } else if (rawValue[0] == L'0') {
+                *value = false;
+                return true;
+            }
+            return false;
+
+        case 2:
+            *value = true;
+            return wcsncmp(rawValue, L"on", 2) == 0;
+
+        case 3:
+            *value = false;
+            return wcsncmp(rawValue, L"off", 3) == 0;
+
+        case 4:
+            *value = true;
+            return wcsncmp(rawValue, L"true", 4) == 0;
+
+        case 5:
+            *value = false;
+            return wcsncmp(rawValue, L"false", 5) == 0;
+
+        default:
+            return false;
+    }
+}
+
+typedef struct _MkConfGenUnit {
+    const wchar_t * wcs;
+    size_t length;
+    uint64_t factor;
+} _MkConfGenUnit;
+
+static const _MkConfGenUnit _mkConfGenDurationUnits[] = {
+    { L"ms", 2, 1 },
+    { L"s", 1, 1000 },
+    { L"min", 3, 60000 },
+    { L"h", 1, 3600000 },
+    { L"d", 1, 86400000 },
+};
+
+static const _MkConfGenUnit _mkConfGenSizeUnits[] = {
+    { L"B", 1, 1 },
+    { L"KB", 2, 1000 },
+    { L"kB", 2, 1000 },
+    { L"MB", 2, 1000000 },
+    { L"GB", 2, 1000000000 },
+    { L"TB", 2, 1000000000000 },
+    { L"KiB", 3, (uint64_t)1 << 10 },
+    { L"MiB", 3, (uint64_t)1 << 20 },
+    { L"GiB", 3, (uint64_t)1 << 30 },
+    { L"TiB", 3, (uint64_t)1 << 40 },
+};
+
+// Decimal digits directly followed by a unit. A unit is required except for 0.
+static bool _MkConfGenParseUnitValue(
+    const wchar_t * rawValue,
+    size_t rawValueLength,
+    const _MkConfGenUnit * units,
+    size_t unitCount,
+    uint64_t * value,
+    MkConfGenLoadErrorType * errorType)
+{
+    _MKCONFGEN_ASSERT(rawValue);
+    _MKCONFGEN_ASSERT(value);
+
+    size_t i = 0;
+    uint64_t number = 0;
+    bool isOverflow = false;
+    while (i != rawValueLength && rawValue[i] >= L'0' && rawValue[i] <= L'9') {
+        uint64_t digit = rawValue[i++] - L'0';
+        if (number > (UINT64_MAX - digit) / 10) {
+            isOverflow = true;
+        }
+        number = number * 10 + digit;
+    }
+    if (i == 0) {
+        *errorType = MKCONFGEN_LOAD_ERROR_VALUE_TYPE;
+        return false;
+    }
+    if (i == rawValueLength) {
+        if (number != 0) {
+            *errorType = MKCONFGEN_LOAD_ERROR_VALUE_TYPE;
+            return false;
+        }
+        *value = 0;
+        return true;
+    }
+
+    for (size_t k = 0; k != unitCount; k++) {
+        if (rawValueLength - i == units[k].length && wmemcmp(rawValue + i, units[k].wcs, units[k].length) == 0) {
+            if (isOverflow || number > UINT64_MAX / units[k].factor) {
+                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_OVERFLOW;
+                return false;
+            }
+            *value = number * units[k].factor;
+            return true;
+        }
+    }
+    *errorType = MKCONFGEN_LOAD_ERROR_VALUE_TYPE;
+    return false;
+}
+
+bool _MkConfGenParseDuration(const wchar_t * rawValue, size_t rawValueLength, uint64_t * value, MkConfGenLoadErrorType * errorType) {
+    return _MkConfGenParseUnitValue(
+        rawValue, rawValueLength,
+        _mkConfGenDurationUnits, sizeof _mkConfGenDurationUnits / sizeof(_MkConfGenUnit),
+        value, errorType);
+}
+
+bool _MkConfGenParseSize(const wchar_t * rawValue, size_t rawValueLength, uint64_t * value, MkConfGenLoadErrorType * errorType) {
+    return _MkConfGenParseUnitValue(
+        rawValue, rawValueLength,
+        _mkConfGenSizeUnits, sizeof _mkConfGenSizeUnits / sizeof(_MkConfGenUnit),
+        value, errorType);
+}
+
+// Inside quoted values only \\ and \" are escapes, any other backslash is taken literally so that paths read as written.
+static bool _MkConfGenIsStrEscape(const wchar_t * pos, const wchar_t * end) {
+    return *pos == L'\\' && pos + 1 != end && (pos[1] == L'\\' || pos[1] == L'\"');
+}
+
+// Walks the comma-separated elements of a bracketed list. parseElement parses the element at the given position and
+// advances the position past it.
+template <typename ParseElementFunc>
+static bool _MkConfGenParseList(
+    const wchar_t * rawValue,
+    size_t rawValueLength,
+    size_t maxCount,
+    size_t * count,
+    MkConfGenLoadErrorType * errorType,
+    ParseElementFunc parseElement)
+{
+    _MKCONFGEN_ASSERT(rawValue);
+    _MKCONFGEN_ASSERT(count);
+    _MKCONFGEN_ASSERT(errorType);
+
+    if (rawValueLength < 2 || rawValue[0] != L'[' || rawValue[rawValueLength - 1] != L']') {
+        *errorType = MKCONFGEN_LOAD_ERROR_VALUE_TYPE;
+        return false;
+    }
+
+    const wchar_t * pos = rawValue + 1;
+    const wchar_t * end = rawValue + rawValueLength - 1;
+
+    auto SkipWhitespace = [&pos, &end]() {
+        while (pos != end && (*pos == L' ' || *pos == L'\t')) pos++;
+    };
+
+    size_t elementCount = 0;
+    SkipWhitespace();
+    while (pos != end) {
+        if (elementCount == maxCount) {
+            *errorType = MKCONFGEN_LOAD_ERROR_VALUE_OVERFLOW;
+            return false;
+        }
+        if (!parseElement(elementCount, &pos, end, errorType)) {
+            return false;
+        }
+        elementCount++;
+
+        SkipWhitespace();
+        if (pos == end) {
+            break;
+        }
+        if (*pos != L',') {
+            *errorType = MKCONFGEN_LOAD_ERROR_VALUE_FORMAT;
+            return false;
+        }
+        pos++;
+        SkipWhitespace();
+        if (pos == end) {
+            *errorType = MKCONFGEN_LOAD_ERROR_VALUE_FORMAT;
+            return false;
+        }
+    }
+
+    *count = elementCount;
+    return true;
+}
+
+bool _MkConfGenParseIntArray(
+    const wchar_t * rawValue,
+    size_t rawValueLength,
+    long * values,
+    size_t maxCount,
+    size_t * count,
+    MkConfGenLoadErrorType * errorType)
+{
+    _MKCONFGEN_ASSERT(values || maxCount == 0);
+
+    auto ParseElement = [&values](size_t index, const wchar_t ** posPtr, const wchar_t * end, MkConfGenLoadErrorType * errorType) {
+        wchar_t * elementEnd;
+        errno = 0;
+        long value = wcstol(*posPtr, &elementEnd, 0);
+        if (elementEnd == *posPtr || elementEnd > end) {
+            *errorType = MKCONFGEN_LOAD_ERROR_VALUE_TYPE;
+            return false;
+        }
+        if (errno == ERANGE) {
+            *errorType = MKCONFGEN_LOAD_ERROR_VALUE_OVERFLOW;
+            return false;
+        }
+        values[index] = value;
+        *posPtr = elementEnd;
+        return true;
+    };
+
+    return _MkConfGenParseList(rawValue, rawValueLength, maxCount, count, errorType, ParseElement);
+}
+
+bool _MkConfGenParseFloatArray(
+    const wchar_t * rawValue,
+    size_t rawValueLength,
+    double * values,
+    size_t maxCount,
+    size_t * count,
+    MkConfGenLoadErrorType * errorType)
+{
+    _MKCONFGEN_ASSERT(values || maxCount == 0);
+
+    auto ParseElement = [&values](size_t index, const wchar_t ** posPtr, const wchar_t * end, MkConfGenLoadErrorType * errorType) {
+        wchar_t * elementEnd;
+        errno = 0;
+        double value = wcstod(*posPtr, &elementEnd);
+        if (elementEnd == *posPtr || elementEnd > end) {
+            *errorType = MKCONFGEN_LOAD_ERROR_VALUE_TYPE;
+            return false;
+        }
+        if (errno == ERANGE && (value == HUGE_VAL || value == -HUGE_VAL)) {
+            *errorType = MKCONFGEN_LOAD_ERROR_VALUE_OVERFLOW;
+            return false;
+        }
+        values[index] = value;
+        *posPtr = elementEnd;
+        return true;
+    };
+
+    return _MkConfGenParseList(rawValue, rawValueLength, maxCount, count, errorType, ParseElement);
+}
+
+bool _MkConfGenParseWstrArray(
+    const wchar_t * rawValue,
+    size_t rawValueLength,
+    wchar_t * values,
+    size_t maxCount,
+    size_t strCount,
+    size_t * count,
+    MkConfGenLoadErrorType * errorType)
+{
+    _MKCONFGEN_ASSERT(values || maxCount == 0);
+    _MKCONFGEN_ASSERT(strCount != 0);
+
+    auto ParseElement = [&values, &strCount](size_t index, const wchar_t ** posPtr, const wchar_t * end, MkConfGenLoadErrorType * errorType) {
+        const wchar_t * pos = *posPtr;
+        if (*pos != L'\"') {
+            *errorType = MKCONFGEN_LOAD_ERROR_VALUE_TYPE;
+            return false;
+        }
+        pos++;
+
+        wchar_t * str = values + index * strCount;
+        size_t strLength = 0;
+        while (true) {
+            if (pos == end) {
+                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_FORMAT;
+                return false;
+            }
+            if (*pos == L'\"') {
+                break;
+            }
+            if (strLength == strCount - 1) {
+                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_OVERFLOW;
+                return false;
+            }
+            if (_MkConfGenIsStrEscape(pos, end)) {
+                pos++;
+            }
+            str[strLength++] = *pos++;
+        }
+        str[strLength] = L'\0';
+
+        *posPtr = pos + 1;
+        return true;
+    };
+
+    return _MkConfGenParseList(rawValue, rawValueLength, maxCount, count, errorType, ParseElement);
+}
+
+bool _MkConfGenMatchPattern(const _MkConfGenPattern * pattern, const wchar_t * value, size_t valueLength) {
+    size_t state = 0;
+    for (size_t i = 0; i != valueLength; i++) {
+        uint32_t ch = (uint32_t)value[i];
+        size_t characterClass;
+        if (ch < 128) {
+            characterClass = pattern->asciiClasses[ch];
+        } else {
+            size_t low = 0;
+            size_t high = pattern->rangeCount - 1;
+            while (low != high) {
+                size_t middle = (low + high) / 2;
+                if (pattern->rangeLasts[middle] < ch) {
+                    low = middle + 1;
+                } else {
+                    high = middle;
+                }
+            }
+            characterClass = pattern->rangeClasses[low];
+        }
+
+        state = pattern->transitions[state * pattern->classCount + characterClass];
+        if (state == pattern->deadState) {
+            return false;
+        }
+    }
+    return pattern->isAccepting[state];
+}
+
+//-----
+// Maps
+
+#define _MKCONFGEN_MAP_MIN_SLOT_COUNT 8
+#define _MKCONFGEN_ALIGN(n) (((n) + 7) & ~(size_t)7)
+
+// FNV-1a
+static uint32_t _MkConfGenHash(const wchar_t * key, size_t keyLength) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i != keyLength; i++) {
+        hash ^= (uint32_t)key[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static MkConfGenMapSlot * _MkConfGenMapProbe(const MkConfGenMap * map, const wchar_t * key, size_t keyLength, uint32_t hash) {
+    size_t slotIndex = hash & map->slotMask;
+    while (true) {
+        MkConfGenMapSlot * slot = &map->slots[slotIndex];
+        if (slot->entry == 0) {
+            return slot;
+        }
+        if (slot->hash == hash) {
+            size_t entry = slot->entry - 1;
+            size_t entryKeyOffset = map->keyOffsets[entry];
+            if (map->keyOffsets[entry + 1] - entryKeyOffset == keyLength
+                && wmemcmp(map->keyArena + entryKeyOffset, key, keyLength) == 0)
+            {
+                return slot;
+            }
+        }
+        slotIndex = (slotIndex + 1) & map->slotMask;
+    }
+}
+
+const void * MkConfGenMapFind(const MkConfGenMap * map, const wchar_t * key, size_t keyLength) {
+    _MKCONFGEN_ASSERT(map);
+    _MKCONFGEN_ASSERT(key || keyLength == 0);
+
+    if (map->count == 0) {
+        return NULL;
+    }
+
+    MkConfGenMapSlot * slot = _MkConfGenMapProbe(map, key, keyLength, _MkConfGenHash(key, keyLength));
+    if (slot->entry == 0) {
+        return NULL;
+    }
+    return map->values + (slot->entry - 1) * map->valueSize;
+}
+
+const wchar_t * MkConfGenMapKey(const MkConfGenMap * map, size_t index, size_t * keyLength) {
+    _MKCONFGEN_ASSERT(map);
+    _MKCONFGEN_ASSERT(index < map->count);
+    _MKCONFGEN_ASSERT(keyLength);
+
+    *keyLength = map->keyOffsets[index + 1] - map->keyOffsets[index];
+    return map->keyArena + map->keyOffsets[index];
+}
+
+const void * MkConfGenMapValue(const MkConfGenMap * map, size_t index) {
+    _MKCONFGEN_ASSERT(map);
+    _MKCONFGEN_ASSERT(index < map->count);
+
+    return map->values + index * map->valueSize;
+}
+
+bool _MkConfGenMapReserve(MkConfGenMap * map, size_t additionalCount, size_t additionalKeyLength, size_t valueSize) {
+    _MKCONFGEN_ASSERT(map);
+    _MKCONFGEN_ASSERT(valueSize != 0);
+    _MKCONFGEN_ASSERT(map->count == 0 || map->valueSize == valueSize);
+
+    size_t capacity = map->count + additionalCount;
+    size_t keyArenaCapacity = map->keyArenaLength + additionalKeyLength;
+    if (capacity <= map->capacity && keyArenaCapacity <= map->keyArenaCapacity) {
+        return true;
+    }
+    if (capacity > UINT32_MAX - 1) {
+        return false;
+    }
+
+    // At most half of the slots are used.
+    size_t slotCount = _MKCONFGEN_MAP_MIN_SLOT_COUNT;
+    while (slotCount < capacity * 2) {
+        slotCount *= 2;
+    }
+
+    size_t valuesOffset = _MKCONFGEN_ALIGN(slotCount * sizeof(MkConfGenMapSlot));
+    size_t keyOffsetsOffset = valuesOffset + _MKCONFGEN_ALIGN(capacity * valueSize);
+    size_t keyArenaOffset = keyOffsetsOffset + (capacity + 1) * sizeof(size_t);
+    unsigned char * memory = (unsigned char *)malloc(keyArenaOffset + keyArenaCapacity * sizeof(wchar_t));
+    if (!memory) {
+        return false;
+    }
+
+    MkConfGenMap newMap;
+    newMap.count = map->count;
+    newMap.capacity = capacity;
+    newMap.slotMask = slotCount - 1;
+    newMap.keyArenaLength = map->keyArenaLength;
+    newMap.keyArenaCapacity = keyArenaCapacity;
+    newMap.valueSize = valueSize;
+    newMap.slots = (MkConfGenMapSlot *)memory;
+    newMap.values = memory + valuesOffset;
+    newMap.keyOffsets = (size_t *)(memory + keyOffsetsOffset);
+    newMap.keyArena = (wchar_t *)(memory + keyArenaOffset);
+
+    memset(newMap.slots, 0, slotCount * sizeof(MkConfGenMapSlot));
+    newMap.keyOffsets[0] = 0;
+    if (map->count != 0) {
+        memcpy(newMap.values, map->values, map->count * valueSize);
+        memcpy(newMap.keyOffsets, map->keyOffsets, (map->count + 1) * sizeof(size_t));
+        wmemcpy(newMap.keyArena, map->keyArena, map->keyArenaLength);
+
+        for (size_t i = 0; i != map->count; i++) {
+            const wchar_t * key = newMap.keyArena + newMap.keyOffsets[i];
+            size_t keyLength = newMap.keyOffsets[i + 1] - newMap.keyOffsets[i];
+            uint32_t hash = _MkConfGenHash(key, keyLength);
+            MkConfGenMapSlot * slot = _MkConfGenMapProbe(&newMap, key, keyLength, hash);
+            slot->hash = hash;
+            slot->entry = (uint32_t)(i + 1);
+        }
+    }
+
+    _MkConfGenMapFree(map);
+    *map = newMap;
+    return true;
+}
+
+void * _MkConfGenMapInsert(MkConfGenMap * map, const wchar_t * key, size_t keyLength) {
+    _MKCONFGEN_ASSERT(map);
+    _MKCONFGEN_ASSERT(key || keyLength == 0);
+
+    if (map->capacity == 0) {
+        return NULL;
+    }
+
+    uint32_t hash = _MkConfGenHash(key, keyLength);
+    MkConfGenMapSlot * slot = _MkConfGenMapProbe(map, key, keyLength, hash);
+    if (slot->entry != 0) {
+        return map->values + (slot->entry - 1) * map->valueSize;
+    }
+
+    if (map->count == map->capacity || map->keyArenaCapacity - map->keyArenaLength < keyLength) {
+        return NULL;
+    }
+
+    size_t entry = map->count++;
+    wmemcpy(map->keyArena + map->keyArenaLength, key, keyLength);
+    map->keyArenaLength += keyLength;
+    map->keyOffsets[entry + 1] = map->keyArenaLength;
+
+    slot->hash = hash;
+    slot->entry = (uint32_t)(entry + 1);
+    return map->values + entry * map->valueSize;
+}
+
+void _MkConfGenMapFree(MkConfGenMap * map) {
+    _MKCONFGEN_ASSERT(map);
+
+    free(map->slots);
+    memset(map, 0, sizeof(MkConfGenMap));
+}
+
+// Size of a copy of the map that is exactly as large as its entries, laid out like by _MkConfGenMapReserve.
+static size_t _MkConfGenMapCopySize(const MkConfGenMap * source) {
+    if (source->count == 0) {
+        return 0;
+    }
+    return _MKCONFGEN_ALIGN((source->slotMask + 1) * sizeof(MkConfGenMapSlot))
+        + _MKCONFGEN_ALIGN(source->count * source->valueSize)
+        + (source->count + 1) * sizeof(size_t)
+        + _MKCONFGEN_ALIGN(source->keyArenaLength * sizeof(wchar_t));
+}
+
+// Copies the entries into memory of _MkConfGenMapCopySize bytes, which the map then points to.
+static void _MkConfGenMapCopyTo(MkConfGenMap * map, const MkConfGenMap * source, unsigned char * memory) {
+    if (source->count == 0) {
+        memset(map, 0, sizeof(MkConfGenMap));
+        return;
+    }
+
+    size_t slotCount = source->slotMask + 1;
+    size_t valuesOffset = _MKCONFGEN_ALIGN(slotCount * sizeof(MkConfGenMapSlot));
+    size_t keyOffsetsOffset = valuesOffset + _MKCONFGEN_ALIGN(source->count * source->valueSize);
+    size_t keyArenaOffset = keyOffsetsOffset + (source->count + 1) * sizeof(size_t);
+
+    MkConfGenMap newMap = *source;
+    newMap.capacity = source->count;
+    newMap.keyArenaCapacity = source->keyArenaLength;
+    newMap.slots = (MkConfGenMapSlot *)memory;
+    newMap.values = memory + valuesOffset;
+    newMap.keyOffsets = (size_t *)(memory + keyOffsetsOffset);
+    newMap.keyArena = (wchar_t *)(memory + keyArenaOffset);
+    memcpy(newMap.slots, source->slots, slotCount * sizeof(MkConfGenMapSlot));
+    memcpy(newMap.values, source->values, source->count * source->valueSize);
+    memcpy(newMap.keyOffsets, source->keyOffsets, (source->count + 1) * sizeof(size_t));
+    wmemcpy(newMap.keyArena, source->keyArena, source->keyArenaLength);
+    *map = newMap;
+}
+
+bool _MkConfGenMapCopy(MkConfGenMap * map, const MkConfGenMap * source) {
+    _MKCONFGEN_ASSERT(map);
+    _MKCONFGEN_ASSERT(source);
+
+    unsigned char * memory = NULL;
+    if (source->count != 0) {
+        memory = (unsigned char *)malloc(_MkConfGenMapCopySize(source));
+        if (!memory) {
+            memset(map, 0, sizeof(MkConfGenMap));
+            return false;
+        }
+    }
+    _MkConfGenMapCopyTo(map, source, memory);
+    return true;
+}
+
+static size_t _MkConfGenPopCount(uint64_t bits) {
+    bits = bits - ((bits >> 1) & 0x5555555555555555ull);
+    bits = (bits & 0x3333333333333333ull) + ((bits >> 2) & 0x3333333333333333ull);
+    bits = (bits + (bits >> 4)) & 0x0f0f0f0f0f0f0f0full;
+    return (size_t)((bits * 0x0101010101010101ull) >> 56);
+}
+
+const void * MkConfGenOverlayFind(const MkConfGenOverlay * overlay, size_t index) {
+    _MKCONFGEN_ASSERT(overlay);
+
+    if (overlay->count == 0) {
+        return NULL;
+    }
+    _MKCONFGEN_ASSERT(index < overlay->itemCount);
+
+    uint64_t word = overlay->presence[index / 64];
+    uint64_t bit = (uint64_t)1 << (index % 64);
+    if (!(word & bit)) {
+        return NULL;
+    }
+
+    size_t slot = overlay->ranks[index / 64] + _MkConfGenPopCount(word & (bit - 1));
+    return overlay->values + overlay->offsets[slot];
+}
+
+bool _MkConfGenOverlayAlloc(MkConfGenOverlay * overlay, size_t itemCount, const uint64_t * presence, const size_t * valueSizes) {
+    _MKCONFGEN_ASSERT(overlay);
+    _MKCONFGEN_ASSERT(presence || itemCount == 0);
+    _MKCONFGEN_ASSERT(valueSizes || itemCount == 0);
+
+    memset(overlay, 0, sizeof(MkConfGenOverlay));
+    overlay->itemCount = itemCount;
+
+    size_t wordCount = (itemCount + 63) / 64;
+    size_t count = 0;
+    size_t valuesLength = 0;
+    for (size_t i = 0; i != itemCount; i++) {
+        if (presence[i / 64] & ((uint64_t)1 << (i % 64))) {
+            count++;
+            valuesLength += (valueSizes[i] + 7) & ~(size_t)7;
+        }
+    }
+
+    // An overlay without overrides holds no memory.
+    if (count == 0) {
+        return true;
+    }
+
+    size_t headerLength = wordCount * sizeof(uint64_t) + (wordCount + count) * sizeof(uint32_t);
+    headerLength = (headerLength + 7) & ~(size_t)7;
+    unsigned char * block = (unsigned char *)malloc(headerLength + valuesLength);
+    if (!block) {
+        return false;
+    }
+
+    overlay->count = count;
+    overlay->presence = (uint64_t *)block;
+    overlay->ranks = (uint32_t *)(overlay->presence + wordCount);
+    overlay->offsets = overlay->ranks + wordCount;
+    overlay->values = block + headerLength;
+    memcpy(overlay->presence, presence, wordCount * sizeof(uint64_t));
+
+    uint32_t rank = 0;
+    uint32_t offset = 0;
+    for (size_t w = 0; w != wordCount; w++) {
+        overlay->ranks[w] = rank;
+        for (size_t i = w * 64; i != itemCount && i != (w + 1) * 64; i++) {
+            if (presence[w] & ((uint64_t)1 << (i % 64))) {
+                overlay->offsets[rank++] = offset;
+                offset += (uint32_t)((valueSizes[i] + 7) & ~(size_t)7);
+            }
+        }
+    }
+
+    return true;
+}
+
+void _MkConfGenOverlayFree(MkConfGenOverlay * overlay) {
+    _MKCONFGEN_ASSERT(overlay);
+
+    free(overlay->presence);
+    memset(overlay, 0, sizeof(MkConfGenOverlay));
+}
+
+wchar_t * _MkConfGenRawValue(wchar_t * value, size_t valueLength, bool isStr, wchar_t * buffer, size_t * rawValueLength) {
+    _MKCONFGEN_ASSERT(value);
+    _MKCONFGEN_ASSERT(buffer);
+    _MKCONFGEN_ASSERT(rawValueLength);
+
+    // Lists are parsed in place, like in the loader.
+    if (!isStr && valueLength != 0 && value[0] == L'[') {
+        *rawValueLength = valueLength;
+        return value;
+    }
+
+    size_t length = 0;
+    if (isStr) {
+        _MKCONFGEN_ASSERT(valueLength >= 2);
+        for (size_t i = 1; i != valueLength - 1; i++) {
+            if (_MkConfGenIsStrEscape(value + i, value + valueLength - 1)) {
+                i++;
+            }
+            buffer[length++] = value[i];
+        }
+    } else {
+        wmemcpy(buffer, value, valueLength);
+        length = valueLength;
+    }
+    buffer[length] = L'\0';
+    *rawValueLength = length;
+    return buffer;
+}
+
+void _MkConfGenLazyParse(
+    _MkConfGenLazyItem * item,
+    const wchar_t * source,
+    size_t index,
+    _MkConfGenParseValueCallback parseValueCallback,
+    void * config)
+{
+    _MKCONFGEN_ASSERT(item);
+    _MKCONFGEN_ASSERT(parseValueCallback);
+    _MKCONFGEN_ASSERT(config);
+
+    // The acquire load pairs with the release store below, so the parsed value is visible once the state says so.
+    if (item->state.load(std::memory_order_acquire) == 2) {
+        return;
+    }
+
+    long expected = 0;
+    if (!item->state.compare_exchange_strong(expected, 1, std::memory_order_acquire)) {
+        while (item->state.load(std::memory_order_acquire) != 2) {
+            std::this_thread::yield();
+        }
+        return;
+    }
+
+    if (item->offset != SIZE_MAX) {
+        wchar_t buffer[MK_CONF_MAX_VALUE_COUNT];
+        size_t rawValueLength;
+        wchar_t * rawValue = _MkConfGenRawValue(const_cast<wchar_t *>(source + item->offset), item->length, item->isStr, buffer, &rawValueLength);
+
+        // Invalid values keep their default, there is nobody to report the error to.
+        MkConfGenLoadErrorType errorType;
+        parseValueCallback(config, index, SIZE_MAX, NULL, 0, rawValue, rawValueLength, item->isStr, &errorType);
+    }
+    item->state.store(2, std::memory_order_release);
+}
+
+void _MkConfGenCountMapKeys(
+    const wchar_t * configWcs,
+    size_t configLength,
+    size_t mapCount,
+    const wchar_t * const * mapNames,
+    size_t * keyCounts,
+    size_t * keyLengths)
+{
+    _MKCONFGEN_ASSERT(configWcs || configLength == 0);
+    _MKCONFGEN_ASSERT(mapNames || mapCount == 0);
+    _MKCONFGEN_ASSERT(keyCounts || mapCount == 0);
+    _MKCONFGEN_ASSERT(keyLengths || mapCount == 0);
+
+    for (size_t k = 0; k != mapCount; k++) {
+        keyCounts[k] = 0;
+        keyLengths[k] = 0;
+    }
+
+    const wchar_t * pos = configWcs;
+    const wchar_t * end = configWcs + configLength;
+    while (pos != end) {
+        while (pos != end && (*pos == L' ' || *pos == L'\t')) pos++;
+
+        for (size_t k = 0; k != mapCount; k++) {
+            size_t nameLength = wcslen(mapNames[k]);
+            if ((size_t)(end - pos) > nameLength && pos[nameLength] == L'.' && wmemcmp(pos, mapNames[k], nameLength) == 0) {
+                const wchar_t * keyEnd = pos + nameLength + 1;
+                while (keyEnd != end && !(*keyEnd == L' ' || *keyEnd == L'\t' || *keyEnd == L'=' || *keyEnd == L'#' || *keyEnd == L'\n')) {
+                    keyEnd++;
+                }
+                keyCounts[k]++;
+                keyLengths[k] += keyEnd - (pos + nameLength + 1);
+                pos = keyEnd;
+                break;
+            }
+        }
+
+        const wchar_t * lineEnd = wmemchr(pos, L'\n', end - pos);
+        pos = lineEnd ? lineEnd + 1 : end;
+    }
+}
 
 bool _MkConfGenLoad(
     const wchar_t * configWcs,
@@ -32,22 +784,216 @@ bool _MkConfGenLoad(
     size_t keyCount,
     const size_t * keyIndices,
     const wchar_t * keys,
+    size_t headingCount,
+    const wchar_t * const * headings,
+    uint64_t headingMask,
     _MkConfGenParseValueCallback parseValueCallback,
     void * config,
     MkConfGenLoadError ** errors,
     size_t * errorCount)
+{
+    _MkConfGenSection section = { NULL, keyCount, keyIndices, keys, headingCount, headings, headingMask, parseValueCallback, config, false, NULL };
+    return _MkConfGenLoadSections(configWcs, configLength, 1, &section, errors, errorCount);
+}
+
+static bool _MkConfGenAddError(MkConfGenLoadError ** errors, size_t * errorCount, MkConfGenLoadErrorType type, size_t line, const wchar_t * file) {
+    if ((*errorCount) % _MKCONFGEN_ERRORS_GROW_COUNT == 0) {
+        size_t allocCount = *errorCount + _MKCONFGEN_ERRORS_GROW_COUNT;
+        MkConfGenLoadError * newErrors = (MkConfGenLoadError *)realloc(*errors, allocCount * sizeof(MkConfGenLoadError));
+        if (!newErrors) {
+            return false;
+        }
+        *errors = newErrors;
+        _MKCONFGEN_ASSERT(*errors);
+    }
+
+    MkConfGenLoadError * errorPtr = &(*errors)[(*errorCount)++];
+    errorPtr->type = type;
+    errorPtr->line = line;
+    errorPtr->file = file;
+    return true;
+}
+
+// A value found by a worker thread of the parallel loader, the value is a span of the source.
+typedef struct _MkConfGenRecord {
+    size_t line;
+    size_t index;
+    size_t row;
+    const wchar_t * mapKey;
+    size_t mapKeyLength;
+    wchar_t * value; // the path of includes
+    size_t valueLength;
+    bool isStr;
+    bool isBeforeHeader; // only applies if the section is valid at the start of the chunk
+    bool isInclude;
+    bool isSectionValid; // of includes after a header
+    bool isParsed; // by a worker thread, the callback result is kept for the merge
+    bool isRejected;
+    MkConfGenLoadErrorType errorType; // of rejected values
+} _MkConfGenRecord;
+
+// Part of the source starting at a line boundary. Lines of records and errors are relative to the chunk.
+typedef struct _MkConfGenChunk {
+    const wchar_t * wcs;
+    size_t length;
+    size_t lineCount;
+    _MkConfGenRecord * records;
+    size_t recordCount;
+    size_t recordCapacity;
+    MkConfGenLoadError * errors;
+    size_t errorCount;
+    bool hasHeader;
+    bool isLastHeaderValid;
+    bool hasInclude;
+    bool isScanned; // false on memory errors
+} _MkConfGenChunk;
+
+typedef enum _MkConfGenTokenType {
+    _MKCONFGEN_TOKEN_VALUE,
+    _MKCONFGEN_TOKEN_HEADER,
+    _MKCONFGEN_TOKEN_INCLUDE,
+    _MKCONFGEN_TOKEN_ERROR,
+} _MkConfGenTokenType;
+
+// A line of an included file, independent of the sections it is loaded into.
+typedef struct _MkConfGenToken {
+    _MkConfGenTokenType type;
+    size_t line;
+    size_t textOffset; // of the key of values or the full path of includes in the text of the fragment
+    size_t textLength;
+    size_t row;
+    const wchar_t * mapKey;
+    size_t mapKeyLength;
+    const wchar_t * value; // as written, the name between the brackets of headers, NULL for malformed headers
+    size_t valueLength;
+    bool isStr;
+    MkConfGenLoadErrorType errorType;
+} _MkConfGenToken;
+
+// An included file in the fragment cache. Fragments are read once and never change afterwards. A file that changed
+// gets a new fragment that replaces the old one in the cache, the old one is freed when its last load releases it. The
+// path is handed on to the new fragment, so paths in load errors stay valid until the cache is cleared.
+typedef struct _MkConfGenFragment {
+    struct _MkConfGenFragment * next;
+    volatile long refCount; // one for the cache and one per user
+    wchar_t * path;
+    bool exists;
+    uint64_t size;
+#ifdef _WIN32
+    FILETIME writeTime;
+    INIT_ONCE once;
+#endif
+    wchar_t * source;
+    size_t sourceLength;
+    wchar_t * text;
+    size_t textLength;
+    size_t textCapacity;
+    _MkConfGenToken * tokens;
+    size_t tokenCount;
+    size_t tokenCapacity;
+    bool isRead;
+    bool isTokenized; // false on memory errors
+} _MkConfGenFragment;
+
+static bool _MkConfGenReadInclude(const wchar_t * wcs, size_t length, size_t * pathBegin, size_t * pathEnd);
+static bool _MkConfGenAddFragmentToken(
+    _MkConfGenFragment * fragment,
+    _MkConfGenTokenType type,
+    size_t line,
+    const wchar_t * text,
+    size_t textLength,
+    _MkConfGenToken ** token);
+static wchar_t * _MkConfGenResolvePath(const wchar_t * basePath, const wchar_t * path, size_t pathLength);
+static void _MkConfGenPrefetchSource(const wchar_t * basePath, const wchar_t * wcs, size_t length);
+static bool _MkConfGenInclude(
+    const wchar_t * basePath,
+    const wchar_t * path,
+    size_t pathLength,
+    size_t line,
+    size_t sectionCount,
+    const _MkConfGenSection * sections,
+    const _MkConfGenSection * section,
+    MkConfGenLoadError ** errors,
+    size_t * errorCount);
+
+// Resolves the name between the brackets of a section header, NULL for unknown configs and headings. isSkipped is set
+// for headings whose bit is cleared in the heading mask.
+static const _MkConfGenSection * _MkConfGenFindSection(
+    const wchar_t * name,
+    size_t nameLength,
+    size_t sectionCount,
+    const _MkConfGenSection * sections,
+    bool * isSkipped)
+{
+    const _MkConfGenSection * section = sections;
+    const wchar_t * heading = name;
+    size_t headingLength = nameLength;
+    *isSkipped = false;
+
+    if (sections[0].name) {
+        const wchar_t * dot = wmemchr(name, L'.', nameLength);
+        size_t configNameLength = dot ? dot - name : nameLength;
+        size_t k;
+        for (k = 0; k != sectionCount; k++) {
+            if (wcslen(sections[k].name) == configNameLength && wmemcmp(sections[k].name, name, configNameLength) == 0) {
+                break;
+            }
+        }
+        if (k == sectionCount) {
+            return NULL;
+        }
+        section = &sections[k];
+        heading = dot ? dot + 1 : name + nameLength;
+        headingLength = name + nameLength - heading;
+    }
+
+    if (headingLength != 0) {
+        size_t k;
+        for (k = 0; k != section->headingCount; k++) {
+            if (wcslen(section->headings[k]) == headingLength && wmemcmp(section->headings[k], heading, headingLength) == 0) {
+                break;
+            }
+        }
+        if (k == section->headingCount) {
+            return NULL;
+        }
+        *isSkipped = !(section->headingMask & ((uint64_t)1 << k));
+    }
+    return section;
+}
+
+// Without a chunk or fragment the values are handed to the section callbacks, otherwise they are recorded in the chunk
+// or, independent of any section, as tokens of the fragment. Includes are resolved relative to path.
+static bool _MkConfGenScan(
+    const wchar_t * configWcs,
+    size_t configLength,
+    size_t sectionCount,
+    const _MkConfGenSection * sections,
+    const wchar_t * path,
+    _MkConfGenChunk * chunk,
+    _MkConfGenFragment * fragment,
+    MkConfGenLoadError ** errors,
+    size_t * errorCount)
 {
     _MKCONFGEN_ASSERT(configWcs || configLength == 0);
-    _MKCONFGEN_ASSERT(keyIndices);
-    _MKCONFGEN_ASSERT(parseValueCallback);
-    _MKCONFGEN_ASSERT(keys);
-    _MKCONFGEN_ASSERT(config);
+    _MKCONFGEN_ASSERT(fragment || (sections && sectionCount != 0));
     _MKCONFGEN_ASSERT(errors);
     _MKCONFGEN_ASSERT(errorCount);
+    for (size_t k = 0; k != sectionCount; k++) {
+        _MKCONFGEN_ASSERT(sections[k].keyIndices);
+        _MKCONFGEN_ASSERT(sections[k].keys);
+        _MKCONFGEN_ASSERT(sections[k].headings || sections[k].headingCount == 0);
+        _MKCONFGEN_ASSERT(sections[k].parseValueCallback);
+        _MKCONFGEN_ASSERT(sections[k].config);
+    }
+
+    bool isSectioned = !fragment && sections[0].name != NULL;
+    const _MkConfGenSection * section = isSectioned ? NULL : sections;
 
     *errorCount = 0;
     *errors = NULL;
     bool memoryError = false;
+    bool isPrefetched = false;
 
     size_t currentLine = 0;
     bool skipLine;
@@ -71,76 +1017,258 @@ bool _MkConfGenLoad(
         return (configWcs[i] >= L'A' && configWcs[i] <= L'Z') || (configWcs[i] >= L'a' && configWcs[i] <= L'z');
     };
 
-    auto AddError = [&errors, &errorCount, &currentLine, &memoryError](MkConfGenLoadErrorType type) {
-        if ((*errorCount) % _MKCONFGEN_ERRORS_GROW_COUNT == 0) {
-            size_t allocCount = *errorCount + _MKCONFGEN_ERRORS_GROW_COUNT;
-            MkConfGenLoadError * newErrors = (MkConfGenLoadError *)realloc(*errors, allocCount * sizeof(MkConfGenLoadError));
-            if (!newErrors) {
+    auto AddError = [&errors, &errorCount, &fragment, &currentLine, &memoryError](MkConfGenLoadErrorType type) {
+        if (fragment) {
+            _MkConfGenToken * token;
+            if (_MkConfGenAddFragmentToken(fragment, _MKCONFGEN_TOKEN_ERROR, currentLine, NULL, 0, &token)) {
+                token->errorType = type;
+            } else {
                 memoryError = true;
-                return;
             }
-            *errors = newErrors;
-            _MKCONFGEN_ASSERT(*errors);
+        } else if (!_MkConfGenAddError(errors, errorCount, type, currentLine, NULL)) {
+            memoryError = true;
         }
-
-        MkConfGenLoadError * errorPtr = &(*errors)[(*errorCount)++];
-        errorPtr->type = type;
-        errorPtr->line = currentLine;
     };
 
     while (i != configLength) {
         skipLine = false;
         currentKeyLength = 0;
         currentRawValueLength = 0;
+        wchar_t * rawValue = currentRawValue;
+        size_t rawValueLength;
 
         // Skip Whitespace and Newlines
 
         while (configWcs[i] == L' ' || configWcs[i] == L'\t' || configWcs[i] == L'\n') {
-            if (++i == configLength) return memoryError;
             if (configWcs[i] == L'\n') {
-                if (++i == configLength) return memoryError;
                 currentLine++;
             }
+            if (++i == configLength) return !memoryError;
         }
 
-        // Check First Key Char
+        // Read Section Header
+        // Headers are [ConfigName], [ConfigName.Heading] or just [Heading] when there is only one unnamed section.
 
-        if (!(IsAsciiLetter() || configWcs[i] == L'_')) {
-            if (configWcs[i] != L'#') {
-                AddError(MKCONFGEN_LOAD_ERROR_KEY_FORMAT);
+        if (configWcs[i] == L'[') {
+            size_t nameBegin = ++i;
+            while (i != configLength && configWcs[i] != L']' && configWcs[i] != L'\n') {
+                i++;
+            }
+
+            bool isValid = i != configLength && configWcs[i] == L']';
+            bool isSkipped = false;
+            if (fragment) {
+                // Headers of fragments are resolved when they are replayed.
+                _MkConfGenToken * token;
+                if (_MkConfGenAddFragmentToken(fragment, _MKCONFGEN_TOKEN_HEADER, currentLine, NULL, 0, &token)) {
+                    token->value = isValid ? configWcs + nameBegin : NULL;
+                    token->valueLength = i - nameBegin;
+                } else {
+                    memoryError = true;
+                }
+            } else {
+                section = isValid ? _MkConfGenFindSection(configWcs + nameBegin, i - nameBegin, sectionCount, sections, &isSkipped) : NULL;
+                if (!section) {
+                    AddError(MKCONFGEN_LOAD_ERROR_SECTION);
+                }
             }
-            if (!SkipLine()) return memoryError;
+            if (chunk) {
+                chunk->hasHeader = true;
+                chunk->isLastHeaderValid = section != NULL;
+            }
+
+            if (i == configLength || !SkipLine()) return !memoryError;
             currentLine++;
-            continue;
-        }
 
-        // Read Key Chars
+            // Unrequested sections are skipped by only looking at line starts until the next header.
+            while (isSkipped) {
+                size_t k = i;
+                while (k != configLength && (configWcs[k] == L' ' || configWcs[k] == L'\t')) {
+                    k++;
+                }
+                if (k != configLength && configWcs[k] == L'[') {
+                    break;
+                }
 
-        do {
-            if (currentKeyLength == MK_CONF_MAX_KEY_COUNT - 1) {
-                AddError(MKCONFGEN_LOAD_ERROR_KEY_LENGTH);
-                if (!SkipLine()) return memoryError;
+                const wchar_t * lineEnd = wmemchr(configWcs + k, L'\n', configLength - k);
+                if (!lineEnd || lineEnd + 1 == configWcs + configLength) return !memoryError;
+                i = lineEnd + 1 - configWcs;
                 currentLine++;
-                skipLine = false;
-                break;
+            }
+            continue;
+        }
+
+        // Read Include Directive
+
+        if (configWcs[i] == L'@') {
+            size_t directiveBegin = i;
+            size_t pathBegin;
+            size_t pathEnd;
+            bool isValid = _MkConfGenReadInclude(configWcs + i, configLength - i, &pathBegin, &pathEnd);
+            const wchar_t * includePath = configWcs + i + pathBegin;
+            size_t includePathLength = pathEnd - pathBegin;
+            i += pathEnd;
+
+            if (!isValid) {
+                AddError(MKCONFGEN_LOAD_ERROR_FORMAT);
+            } else if (fragment) {
+                wchar_t * fullPath = _MkConfGenResolvePath(path, includePath, includePathLength);
+                _MkConfGenToken * token;
+                if (!fullPath || !_MkConfGenAddFragmentToken(fragment, _MKCONFGEN_TOKEN_INCLUDE, currentLine, fullPath, wcslen(fullPath), &token)) {
+                    memoryError = true;
+                }
+                free(fullPath);
+            } else if (chunk) {
+                if (chunk->recordCount == chunk->recordCapacity) {
+                    size_t newCapacity = chunk->recordCapacity ? chunk->recordCapacity * 2 : 256;
+                    _MkConfGenRecord * newRecords = (_MkConfGenRecord *)realloc(chunk->records, newCapacity * sizeof(_MkConfGenRecord));
+                    if (!newRecords) {
+                        return false;
+                    }
+                    chunk->records = newRecords;
+                    chunk->recordCapacity = newCapacity;
+                }
+
+                _MkConfGenRecord * recordPtr = &chunk->records[chunk->recordCount++];
+                memset(recordPtr, 0, sizeof(_MkConfGenRecord));
+                recordPtr->line = currentLine;
+                recordPtr->value = const_cast<wchar_t *>(includePath);
+                recordPtr->valueLength = includePathLength;
+                recordPtr->isBeforeHeader = !chunk->hasHeader;
+                recordPtr->isInclude = true;
+                recordPtr->isSectionValid = section != NULL;
+                chunk->hasInclude = true;
+            } else if (sections[0].isLazy) {
+                // Lazy values are offsets into this source.
+                AddError(MKCONFGEN_LOAD_ERROR_INCLUDE);
+            } else {
+                // The first include reads all files included further down in parallel.
+                if (!isPrefetched) {
+                    _MkConfGenPrefetchSource(path, configWcs + directiveBegin, configLength - directiveBegin);
+                    isPrefetched = true;
+                }
+                if (!_MkConfGenInclude(path, includePath, includePathLength, currentLine, sectionCount, sections, section, errors, errorCount)) {
+                    memoryError = true;
+                }
+            }
+
+            if (i == configLength || !SkipLine()) return !memoryError;
+            currentLine++;
+            continue;
+        }
+
+        // Check First Key Char
+
+        if (!(IsAsciiLetter() || configWcs[i] == L'_')) {
+            if (configWcs[i] != L'#') {
+                AddError(MKCONFGEN_LOAD_ERROR_KEY_FORMAT);
+            }
+            if (!SkipLine()) return !memoryError;
+            currentLine++;
+            continue;
+        }
+
+        // Read Key Chars
+
+        do {
+            if (currentKeyLength == MK_CONF_MAX_KEY_COUNT - 1) {
+                AddError(MKCONFGEN_LOAD_ERROR_KEY_LENGTH);
+                if (!SkipLine()) return !memoryError;
+                currentLine++;
+                skipLine = true;
+                break;
             }
             currentKey[currentKeyLength++] = configWcs[i];
 
             if (++i == configLength) {
                 AddError(MKCONFGEN_LOAD_ERROR_NO_VALUE);
-                return memoryError;
+                return !memoryError;
             }
         } while (IsAsciiLetter() || iswdigit(configWcs[i]) || configWcs[i] == L'_');
         if (skipLine) {
             continue;
         }
 
+        // Read Table Row and Column
+
+        size_t row = SIZE_MAX;
+        if (configWcs[i] == L'[') {
+            row = 0;
+            size_t rowBegin = ++i;
+            while (i != configLength && iswdigit(configWcs[i])) {
+                // Rows this large are out of bounds anyway.
+                if (row < SIZE_MAX / 10 - 1) {
+                    row = row * 10 + (configWcs[i] - L'0');
+                }
+                i++;
+            }
+
+            if (i == rowBegin || configLength - i < 3 || configWcs[i] != L']' || configWcs[i + 1] != L'.') {
+                AddError(MKCONFGEN_LOAD_ERROR_KEY_FORMAT);
+                if (i == configLength || !SkipLine()) return !memoryError;
+                currentLine++;
+                continue;
+            }
+            i += 2;
+            if (!(IsAsciiLetter() || configWcs[i] == L'_')) {
+                AddError(MKCONFGEN_LOAD_ERROR_KEY_FORMAT);
+                if (!SkipLine()) return !memoryError;
+                currentLine++;
+                continue;
+            }
+
+            do {
+                if (currentKeyLength == MK_CONF_MAX_KEY_COUNT - 2) {
+                    AddError(MKCONFGEN_LOAD_ERROR_KEY_LENGTH);
+                    if (!SkipLine()) return !memoryError;
+                    currentLine++;
+                    skipLine = true;
+                    break;
+                }
+                if (configWcs[i - 1] == L'.') {
+                    currentKey[currentKeyLength++] = L'.';
+                }
+                currentKey[currentKeyLength++] = configWcs[i];
+
+                if (++i == configLength) {
+                    AddError(MKCONFGEN_LOAD_ERROR_NO_VALUE);
+                    return !memoryError;
+                }
+            } while (IsAsciiLetter() || iswdigit(configWcs[i]) || configWcs[i] == L'_');
+            if (skipLine) {
+                continue;
+            }
+        }
+
+        // Read Map Key
+
+        const wchar_t * mapKey = NULL;
+        size_t mapKeyLength = 0;
+        if (row == SIZE_MAX && configWcs[i] == L'.') {
+            size_t mapKeyBegin = ++i;
+            while (!(i == configLength || configWcs[i] == L' ' || configWcs[i] == L'\t' || configWcs[i] == L'=' || configWcs[i] == L'#' || configWcs[i] == L'\n')) {
+                i++;
+            }
+            if (i == configLength) {
+                AddError(MKCONFGEN_LOAD_ERROR_NO_VALUE);
+                return !memoryError;
+            }
+            if (i == mapKeyBegin) {
+                AddError(MKCONFGEN_LOAD_ERROR_KEY_FORMAT);
+                if (!SkipLine()) return !memoryError;
+                currentLine++;
+                continue;
+            }
+            mapKey = configWcs + mapKeyBegin;
+            mapKeyLength = i - mapKeyBegin;
+        }
+
         // Skip Whitespace
 
         while (configWcs[i] == L' ' || configWcs[i] == L'\t') {
             if (++i == configLength) {
                 AddError(MKCONFGEN_LOAD_ERROR_NO_VALUE);
-                return memoryError;
+                return !memoryError;
             }
         }
 
@@ -150,16 +1278,16 @@ bool _MkConfGenLoad(
             if (configWcs[i] == L'#' || configWcs[i] == L'\n') {
                 AddError(MKCONFGEN_LOAD_ERROR_NO_VALUE);
                 if (configWcs[i] == L'#') {
-                    if (!SkipLine()) return memoryError;
+                    if (!SkipLine()) return !memoryError;
                 } else {
-                    if (++i == configLength) return memoryError;
+                    if (++i == configLength) return !memoryError;
                 }
             } else {
                 AddError(MKCONFGEN_LOAD_ERROR_KEY_FORMAT);
-                if (!SkipLine()) return memoryError;
+                if (!SkipLine()) return !memoryError;
             }
             currentLine++;
-            break;
+            continue;
         }
 
         // Skip Whitespace
@@ -167,57 +1295,87 @@ bool _MkConfGenLoad(
         do {
             if (++i == configLength) {
                 AddError(MKCONFGEN_LOAD_ERROR_NO_VALUE);
-                return memoryError;
+                return !memoryError;
             }
         } while (configWcs[i] == L' ' || configWcs[i] == L'\t');
+        size_t valueBegin = i;
 
         // Check First Value Char
 
         if (configWcs[i] == L'#' || configWcs[i] == L'\n') {
             AddError(MKCONFGEN_LOAD_ERROR_NO_VALUE);
             if (configWcs[i] == L'#') {
-                if (!SkipLine()) return memoryError;
+                if (!SkipLine()) return !memoryError;
             } else {
-                if (++i == configLength) return memoryError;
+                if (++i == configLength) return !memoryError;
             }
             currentLine++;
-            break;
+            continue;
         }
 
-        if (configWcs[i] == L'\"') {
+        if (configWcs[i] == L'[') {
+            // Read Raw List Value
+            // Lists are handed to the callback in place since they may well exceed the value buffer.
+
+            size_t listBegin = i;
+            bool isInStr = false;
+            while (true) {
+                if (++i == configLength || configWcs[i] == L'\n') {
+                    AddError(MKCONFGEN_LOAD_ERROR_VALUE_FORMAT);
+                    skipLine = true;
+                    break;
+                }
+                if (isInStr && _MkConfGenIsStrEscape(configWcs + i, configWcs + configLength)) {
+                    i++;
+                } else if (configWcs[i] == L'\"') {
+                    isInStr = !isInStr;
+                } else if (configWcs[i] == L']' && !isInStr) {
+                    break;
+                }
+            }
+            if (skipLine) {
+                if (i == configLength) return !memoryError;
+                i++;
+                currentLine++;
+                continue;
+            }
+
+            i++;
+            rawValue = const_cast<wchar_t *>(configWcs + listBegin);
+            rawValueLength = i - listBegin;
+            valueIsStr = false;
+        } else if (configWcs[i] == L'\"') {
             // Read Raw String Value
 
             while (true) {
                 if (++i == configLength) {
                     AddError(MKCONFGEN_LOAD_ERROR_VALUE_FORMAT);
-                    return memoryError;
+                    return !memoryError;
                 }
 
                 if (configWcs[i] == L'\n') {
                     AddError(MKCONFGEN_LOAD_ERROR_VALUE_FORMAT);
-                    if (++i == configLength) return memoryError;
+                    if (++i == configLength) return !memoryError;
                     currentLine++;
-                    skipLine = false;
+                    skipLine = true;
                     break;
                 }
 
                 if (configWcs[i] == L'\"') {
-                    if (currentRawValueLength != 0 && currentRawValue[currentRawValueLength - 1] == L'\\') {
-                        currentRawValue[currentRawValueLength - 1] = L'\"';
-                        continue;
-                    } else {
-                        break;
-                    }
+                    break;
                 }
 
                 if (currentRawValueLength == MK_CONF_MAX_VALUE_COUNT - 1) {
                     AddError(MKCONFGEN_LOAD_ERROR_VALUE_LENGTH);
-                    if (!SkipLine()) return memoryError;
+                    if (!SkipLine()) return !memoryError;
                     currentLine++;
-                    skipLine = false;
+                    skipLine = true;
                     break;
                 }
 
+                if (_MkConfGenIsStrEscape(configWcs + i, configWcs + configLength)) {
+                    i++;
+                }
                 currentRawValue[currentRawValueLength++] = configWcs[i];
             }
             if (skipLine) {
@@ -232,9 +1390,9 @@ bool _MkConfGenLoad(
             while (!(i == configLength || configWcs[i] == L' ' || configWcs[i] == L'\t' || configWcs[i] == L'\n')) {
                 if (currentRawValueLength == MK_CONF_MAX_VALUE_COUNT - 1) {
                     AddError(MKCONFGEN_LOAD_ERROR_VALUE_LENGTH);
-                    if (!SkipLine()) return memoryError;
+                    if (!SkipLine()) return !memoryError;
                     currentLine++;
-                    skipLine = false;
+                    skipLine = true;
                     break;
                 }
                 currentRawValue[currentRawValueLength++] = configWcs[i];
@@ -248,6 +1406,8 @@ bool _MkConfGenLoad(
             valueIsStr = false;
         }
 
+        size_t valueEnd = i;
+
         // Discard Remainder
 
         if (i != configLength) {
@@ -257,22 +1417,80 @@ bool _MkConfGenLoad(
         // Parse
 
         currentKey[currentKeyLength] = L'\0';
-        currentRawValue[currentRawValueLength] = L'\0';
+        if (rawValue == currentRawValue) {
+            currentRawValue[currentRawValueLength] = L'\0';
+            rawValueLength = currentRawValueLength;
+        }
+
+        if (fragment) {
+            _MkConfGenToken * token;
+            if (_MkConfGenAddFragmentToken(fragment, _MKCONFGEN_TOKEN_VALUE, currentLine, currentKey, currentKeyLength, &token)) {
+                token->row = row;
+                token->mapKey = mapKey;
+                token->mapKeyLength = mapKeyLength;
+                token->value = configWcs + valueBegin;
+                token->valueLength = valueEnd - valueBegin;
+                token->isStr = valueIsStr;
+            } else {
+                memoryError = true;
+            }
+            currentLine++;
+            continue;
+        }
+
+        if (!section) {
+            currentLine++;
+            continue;
+        }
 
         size_t j;
-        for (j = 0; j != keyCount; j++) {
-            size_t index = keyIndices[j];
-            size_t length = keyIndices[j + 1] - index;
-            if (wcsncmp(currentKey, keys + index, length) == 0) {
+        for (j = 0; j != section->keyCount; j++) {
+            size_t index = section->keyIndices[j];
+            size_t length = section->keyIndices[j + 1] - index;
+            if (length == currentKeyLength && wcsncmp(currentKey, section->keys + index, length) == 0) {
                 break;
             }
         }
-        if (j == keyCount) {
+        if (j == section->keyCount) {
+            currentLine++;
+            continue;
+        }
+
+        // Lazy sections and chunks get the value as written, see _MkConfGenRawValue.
+        if (section->isLazy || chunk) {
+            rawValue = const_cast<wchar_t *>(configWcs + valueBegin);
+            rawValueLength = valueEnd - valueBegin;
+        }
+
+        if (chunk) {
+            if (chunk->recordCount == chunk->recordCapacity) {
+                size_t newCapacity = chunk->recordCapacity ? chunk->recordCapacity * 2 : 256;
+                _MkConfGenRecord * newRecords = (_MkConfGenRecord *)realloc(chunk->records, newCapacity * sizeof(_MkConfGenRecord));
+                if (!newRecords) {
+                    return false;
+                }
+                chunk->records = newRecords;
+                chunk->recordCapacity = newCapacity;
+            }
+
+            _MkConfGenRecord * recordPtr = &chunk->records[chunk->recordCount++];
+            recordPtr->line = currentLine;
+            recordPtr->index = j;
+            recordPtr->row = row;
+            recordPtr->mapKey = mapKey;
+            recordPtr->mapKeyLength = mapKeyLength;
+            recordPtr->value = rawValue;
+            recordPtr->valueLength = rawValueLength;
+            recordPtr->isStr = valueIsStr;
+            recordPtr->isBeforeHeader = !chunk->hasHeader;
+            recordPtr->isInclude = false;
+            recordPtr->isParsed = false;
+            currentLine++;
             continue;
         }
 
         MkConfGenLoadErrorType parseErrorType;
-        if (!parseValueCallback(config, j, currentRawValue, currentRawValueLength, valueIsStr, &parseErrorType)) {
+        if (!section->parseValueCallback(section->config, j, row, mapKey, mapKeyLength, rawValue, rawValueLength, valueIsStr, &parseErrorType)) {
             AddError(parseErrorType);
         }
 
@@ -280,4 +1498,2329 @@ bool _MkConfGenLoad(
     }
 
     return !memoryError;
-}
\ No newline at end of file
+}
+
+bool _MkConfGenLoadSections(
+    const wchar_t * configWcs,
+    size_t configLength,
+    size_t sectionCount,
+    const _MkConfGenSection * sections,
+    MkConfGenLoadError ** errors,
+    size_t * errorCount)
+{
+    return _MkConfGenScan(configWcs, configLength, sectionCount, sections, NULL, NULL, NULL, errors, errorCount);
+}
+
+static void _MkConfGenScanChunk(_MkConfGenChunk * chunk, const _MkConfGenSection * section) {
+    for (const wchar_t * pos = chunk->wcs; (pos = wmemchr(pos, L'\n', chunk->wcs + chunk->length - pos)) != NULL; pos++) {
+        chunk->lineCount++;
+    }
+    chunk->isScanned = _MkConfGenScan(chunk->wcs, chunk->length, 1, section, NULL, chunk, NULL, &chunk->errors, &chunk->errorCount);
+}
+
+// Hands the records of a scanned chunk to the section and adds its errors in line order, records parsed by a worker
+// only add their error. isSectionValid and lineOffset carry the state from one chunk to the next. Includes are resolved
+// relative to path.
+static bool _MkConfGenMergeChunk(
+    const _MkConfGenChunk * chunk,
+    const _MkConfGenSection * section,
+    const wchar_t * path,
+    bool * isSectionValid,
+    size_t * lineOffset,
+    MkConfGenLoadError ** errors,
+    size_t * errorCount)
+{
+    if (chunk->hasInclude) {
+        _MkConfGenPrefetchSource(path, chunk->wcs, chunk->length);
+    }
+
+    bool memoryError = !chunk->isScanned;
+    size_t e = 0;
+    for (size_t r = 0; r != chunk->recordCount; r++) {
+        _MkConfGenRecord * recordPtr = &chunk->records[r];
+        for (; e != chunk->errorCount && chunk->errors[e].line < recordPtr->line; e++) {
+            memoryError |= !_MkConfGenAddError(errors, errorCount, chunk->errors[e].type, *lineOffset + chunk->errors[e].line, NULL);
+        }
+        if (recordPtr->isInclude) {
+            bool isValid = recordPtr->isBeforeHeader ? *isSectionValid : recordPtr->isSectionValid;
+            memoryError |= !_MkConfGenInclude(
+                path,
+                recordPtr->value,
+                recordPtr->valueLength,
+                *lineOffset + recordPtr->line,
+                1,
+                section,
+                isValid ? section : NULL,
+                errors,
+                errorCount);
+            continue;
+        }
+        if (recordPtr->isBeforeHeader && !*isSectionValid) {
+            continue;
+        }
+        if (recordPtr->isParsed) {
+            if (recordPtr->isRejected) {
+                memoryError |= !_MkConfGenAddError(errors, errorCount, recordPtr->errorType, *lineOffset + recordPtr->line, NULL);
+            }
+            continue;
+        }
+
+        wchar_t buffer[MK_CONF_MAX_VALUE_COUNT];
+        size_t rawValueLength;
+        wchar_t * rawValue = _MkConfGenRawValue(recordPtr->value, recordPtr->valueLength, recordPtr->isStr, buffer, &rawValueLength);
+        MkConfGenLoadErrorType parseErrorType;
+        if (!section->parseValueCallback(section->config, recordPtr->index, recordPtr->row, recordPtr->mapKey, recordPtr->mapKeyLength, rawValue, rawValueLength, recordPtr->isStr, &parseErrorType)) {
+            memoryError |= !_MkConfGenAddError(errors, errorCount, parseErrorType, *lineOffset + recordPtr->line, NULL);
+        }
+    }
+    for (; e != chunk->errorCount; e++) {
+        memoryError |= !_MkConfGenAddError(errors, errorCount, chunk->errors[e].type, *lineOffset + chunk->errors[e].line, NULL);
+    }
+
+    if (chunk->hasHeader) {
+        *isSectionValid = chunk->isLastHeaderValid;
+    }
+    *lineOffset += chunk->lineCount;
+    return !memoryError;
+}
+
+#ifdef _WIN32
+typedef struct _MkConfGenWorkerContext {
+    _MkConfGenChunk * chunks;
+    size_t chunkCount;
+    const _MkConfGenSection * section;
+    volatile long nextChunk;
+    _MkConfGenRecord ** groupRecords; // the values of each group in line order, groups back to back
+    const size_t * groupOffsets; // groupCount + 1 entries
+    size_t groupCount;
+    volatile long nextGroup;
+} _MkConfGenWorkerContext;
+
+static DWORD WINAPI _MkConfGenScanWorker(LPVOID param) {
+    _MkConfGenWorkerContext * context = (_MkConfGenWorkerContext *)param;
+
+    while (true) {
+        size_t k = (size_t)InterlockedIncrement(&context->nextChunk) - 1;
+        if (k >= context->chunkCount) {
+            return 0;
+        }
+        _MkConfGenScanChunk(&context->chunks[k], context->section);
+    }
+}
+
+// Each group is parsed by a single thread, so the last valid value of an item wins like with the serial loader.
+static DWORD WINAPI _MkConfGenParseWorker(LPVOID param) {
+    _MkConfGenWorkerContext * context = (_MkConfGenWorkerContext *)param;
+    const _MkConfGenSection * section = context->section;
+
+    while (true) {
+        size_t g = (size_t)InterlockedIncrement(&context->nextGroup) - 1;
+        if (g >= context->groupCount) {
+            return 0;
+        }
+
+        for (size_t r = context->groupOffsets[g]; r != context->groupOffsets[g + 1]; r++) {
+            _MkConfGenRecord * recordPtr = context->groupRecords[r];
+            wchar_t buffer[MK_CONF_MAX_VALUE_COUNT];
+            size_t rawValueLength;
+            wchar_t * rawValue = _MkConfGenRawValue(recordPtr->value, recordPtr->valueLength, recordPtr->isStr, buffer, &rawValueLength);
+            recordPtr->isRejected = !section->parseValueCallback(section->config, recordPtr->index, recordPtr->row, recordPtr->mapKey, recordPtr->mapKeyLength, rawValue, rawValueLength, recordPtr->isStr, &recordPtr->errorType);
+            recordPtr->isParsed = true;
+        }
+    }
+}
+
+// Runs the worker on the calling thread and up to threadCount - 1 more threads until it returns everywhere.
+static void _MkConfGenRunWorkers(LPTHREAD_START_ROUTINE worker, _MkConfGenWorkerContext * context, HANDLE * threads, size_t threadCount) {
+    for (size_t t = 1; t < threadCount; t++) {
+        threads[t] = CreateThread(NULL, 0, worker, context, 0, NULL);
+    }
+    worker(context);
+    for (size_t t = 1; t < threadCount; t++) {
+        if (threads[t]) {
+            WaitForSingleObject(threads[t], INFINITE);
+            CloseHandle(threads[t]);
+        }
+    }
+}
+
+// Sorts the values of the scanned chunks into their parse groups. Values ignored by the merge are left out, the section
+// state is tracked like there. Returns false on memory errors.
+static bool _MkConfGenGroupRecords(_MkConfGenWorkerContext * context, const uint32_t * itemGroups, size_t groupCount) {
+    size_t * groupOffsets = (size_t *)calloc(groupCount + 1, sizeof(size_t));
+    size_t * groupEnds = (size_t *)malloc(groupCount * sizeof(size_t));
+    size_t recordCount = 0;
+    for (size_t k = 0; k != context->chunkCount; k++) {
+        recordCount += context->chunks[k].recordCount;
+    }
+    _MkConfGenRecord ** groupRecords = (_MkConfGenRecord **)malloc((recordCount ? recordCount : 1) * sizeof(_MkConfGenRecord *));
+    if (!groupOffsets || !groupEnds || !groupRecords) {
+        free(groupOffsets);
+        free(groupEnds);
+        free(groupRecords);
+        return false;
+    }
+
+    for (int pass = 0; pass != 2; pass++) {
+        bool isSectionValid = true;
+        for (size_t k = 0; k != context->chunkCount; k++) {
+            const _MkConfGenChunk * chunk = &context->chunks[k];
+            for (size_t r = 0; r != chunk->recordCount; r++) {
+                _MkConfGenRecord * recordPtr = &chunk->records[r];
+                if (recordPtr->isBeforeHeader && !isSectionValid) {
+                    continue;
+                }
+                size_t g = itemGroups[recordPtr->index];
+                if (pass == 0) {
+                    groupOffsets[g + 1]++;
+                } else {
+                    groupRecords[groupEnds[g]++] = recordPtr;
+                }
+            }
+            if (chunk->hasHeader) {
+                isSectionValid = chunk->isLastHeaderValid;
+            }
+        }
+
+        if (pass == 0) {
+            for (size_t g = 0; g != groupCount; g++) {
+                groupOffsets[g + 1] += groupOffsets[g];
+                groupEnds[g] = groupOffsets[g];
+            }
+        }
+    }
+    free(groupEnds);
+
+    context->groupRecords = groupRecords;
+    context->groupOffsets = groupOffsets;
+    context->groupCount = groupCount;
+    return true;
+}
+
+bool _MkConfGenLoadParallel(
+    const wchar_t * configWcs,
+    size_t configLength,
+    const _MkConfGenSection * section,
+    const uint32_t * itemGroups,
+    size_t threadCount,
+    MkConfGenLoadError ** errors,
+    size_t * errorCount)
+{
+    _MKCONFGEN_ASSERT(configWcs || configLength == 0);
+    _MKCONFGEN_ASSERT(section && !section->name && !section->isLazy);
+    _MKCONFGEN_ASSERT(errors);
+    _MKCONFGEN_ASSERT(errorCount);
+
+    if (threadCount == 0) {
+        SYSTEM_INFO systemInfo;
+        GetSystemInfo(&systemInfo);
+        threadCount = systemInfo.dwNumberOfProcessors;
+    }
+
+    // Small files are not worth the threads.
+    size_t chunkCount = threadCount * _MKCONFGEN_CHUNKS_PER_THREAD;
+    if (threadCount < 2 || configLength / chunkCount < _MKCONFGEN_MIN_CHUNK_LENGTH) {
+        return _MkConfGenLoadSections(configWcs, configLength, 1, section, errors, errorCount);
+    }
+
+    *errors = NULL;
+    *errorCount = 0;
+
+    _MkConfGenChunk * chunks = (_MkConfGenChunk *)calloc(chunkCount, sizeof(_MkConfGenChunk));
+    HANDLE * threads = (HANDLE *)calloc(threadCount, sizeof(HANDLE));
+    if (!chunks || !threads) {
+        free(chunks);
+        free(threads);
+        return false;
+    }
+
+    // Chunks end after the first newline following an even split, so no line is cut.
+    size_t begin = 0;
+    for (size_t k = 0; k != chunkCount; k++) {
+        size_t end = configLength;
+        if (k != chunkCount - 1) {
+            end = configLength / chunkCount * (k + 1);
+            if (end < begin) {
+                end = begin;
+            }
+            const wchar_t * lineEnd = wmemchr(configWcs + end, L'\n', configLength - end);
+            end = lineEnd ? lineEnd + 1 - configWcs : configLength;
+        }
+        chunks[k].wcs = configWcs + begin;
+        chunks[k].length = end - begin;
+        begin = end;
+    }
+
+    _MkConfGenWorkerContext context = { chunks, chunkCount, section, 0, NULL, NULL, 0, 0 };
+    _MkConfGenRunWorkers(_MkConfGenScanWorker, &context, threads, threadCount);
+
+    // Included files are applied in the middle of the values, so with includes everything is parsed in the merge.
+    bool isGrouped = itemGroups != NULL;
+    for (size_t k = 0; k != chunkCount; k++) {
+        isGrouped &= !chunks[k].hasInclude;
+    }
+    if (isGrouped && _MkConfGenGroupRecords(&context, itemGroups, section->keyCount)) {
+        _MkConfGenRunWorkers(_MkConfGenParseWorker, &context, threads, threadCount);
+    }
+
+    // Adds the errors of both phases in line order.
+    bool memoryError = false;
+    bool isSectionValid = true;
+    size_t lineOffset = 0;
+    for (size_t k = 0; k != chunkCount; k++) {
+        memoryError |= !_MkConfGenMergeChunk(&chunks[k], section, NULL, &isSectionValid, &lineOffset, errors, errorCount);
+    }
+
+    for (size_t k = 0; k != chunkCount; k++) {
+        free(chunks[k].records);
+        free(chunks[k].errors);
+    }
+    free(context.groupRecords);
+    free((void *)context.groupOffsets);
+    free(chunks);
+    free(threads);
+
+    return !memoryError;
+}
+
+//--------------
+// Shared Memory
+
+#define _MKCONFGEN_SHARED_SEMAPHORE_SUFFIX L".Changed"
+
+// Lies in its own view at the start of the mapping, readers map it writable to register as waiters.
+typedef struct _MkConfGenSharedHeader {
+    volatile LONG64 sequence; // odd while the image is being written
+    volatile LONG waiterCount;
+    uint64_t imageSize;
+} _MkConfGenSharedHeader;
+
+// The image starts at the allocation granularity so that it can be mapped with its own protection.
+static bool _MkConfGenSharedMap(MkConfGenShared * shared, const wchar_t * name, size_t imageSize, bool isPublisher) {
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo(&systemInfo);
+    size_t imageOffset = systemInfo.dwAllocationGranularity;
+    uint64_t mappingSize = (uint64_t)imageOffset + imageSize;
+
+    size_t nameLength = wcslen(name);
+    size_t suffixLength = sizeof _MKCONFGEN_SHARED_SEMAPHORE_SUFFIX / sizeof(wchar_t);
+    wchar_t * semaphoreName = (wchar_t *)malloc((nameLength + suffixLength) * sizeof(wchar_t));
+    if (!semaphoreName) {
+        return false;
+    }
+    wmemcpy(semaphoreName, name, nameLength);
+    wmemcpy(semaphoreName + nameLength, _MKCONFGEN_SHARED_SEMAPHORE_SUFFIX, suffixLength);
+
+    HANDLE mapping;
+    if (isPublisher) {
+        mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, (DWORD)(mappingSize >> 32), (DWORD)mappingSize, name);
+    } else {
+        mapping = OpenFileMappingW(FILE_MAP_READ | FILE_MAP_WRITE, FALSE, name);
+    }
+    HANDLE semaphore = CreateSemaphoreW(NULL, 0, LONG_MAX, semaphoreName);
+    free(semaphoreName);
+
+    _MkConfGenSharedHeader * header = NULL;
+    void * image = NULL;
+    if (mapping && semaphore) {
+        header = (_MkConfGenSharedHeader *)MapViewOfFile(mapping, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, sizeof(_MkConfGenSharedHeader));
+    }
+    if (header) {
+        // A fresh mapping is zeroed, an existing one must have been created for the same config.
+        if (isPublisher && header->imageSize == 0) {
+            header->imageSize = imageSize;
+        }
+        if (header->imageSize == imageSize) {
+            image = MapViewOfFile(mapping, isPublisher ? FILE_MAP_WRITE : FILE_MAP_READ, (DWORD)((uint64_t)imageOffset >> 32), (DWORD)imageOffset, imageSize);
+        }
+    }
+
+    if (!image) {
+        if (header) {
+            UnmapViewOfFile(header);
+        }
+        if (mapping) {
+            CloseHandle(mapping);
+        }
+        if (semaphore) {
+            CloseHandle(semaphore);
+        }
+        return false;
+    }
+
+    shared->mapping = mapping;
+    shared->semaphore = semaphore;
+    shared->header = header;
+    shared->image = image;
+    shared->imageSize = imageSize;
+    return true;
+}
+
+bool _MkConfGenSharedCreate(MkConfGenShared * shared, const wchar_t * name, size_t imageSize) {
+    _MKCONFGEN_ASSERT(shared);
+    _MKCONFGEN_ASSERT(name);
+    return _MkConfGenSharedMap(shared, name, imageSize, true);
+}
+
+bool _MkConfGenSharedOpen(MkConfGenShared * shared, const wchar_t * name, size_t imageSize) {
+    _MKCONFGEN_ASSERT(shared);
+    _MKCONFGEN_ASSERT(name);
+    return _MkConfGenSharedMap(shared, name, imageSize, false);
+}
+
+void MkConfGenSharedClose(MkConfGenShared * shared) {
+    _MKCONFGEN_ASSERT(shared);
+    UnmapViewOfFile(shared->image);
+    UnmapViewOfFile(shared->header);
+    CloseHandle(shared->mapping);
+    CloseHandle(shared->semaphore);
+}
+
+uint64_t MkConfGenSharedSequence(const MkConfGenShared * shared) {
+    _MKCONFGEN_ASSERT(shared);
+    return (uint64_t)(shared->header->sequence & ~(LONG64)1);
+}
+
+// Takes back the registration of a waiter that returns without being woken. If the publisher already took it, the
+// permit it released for it is consumed instead, or causes a single spurious wakeup of a later waiter when it comes late.
+static void _MkConfGenSharedWithdraw(MkConfGenShared * shared) {
+    LONG waiterCount = shared->header->waiterCount;
+    while (waiterCount > 0) {
+        LONG previousCount = InterlockedCompareExchange(&shared->header->waiterCount, waiterCount - 1, waiterCount);
+        if (previousCount == waiterCount) {
+            return;
+        }
+        waiterCount = previousCount;
+    }
+    WaitForSingleObject(shared->semaphore, 0);
+}
+
+bool MkConfGenSharedWait(MkConfGenShared * shared, uint64_t sequence, unsigned long timeout) {
+    _MKCONFGEN_ASSERT(shared);
+
+    // Registering before the second check makes sure the publisher either sees the waiter or the reader sees the new
+    // sequence. Wakeups for older images register again and wait for the rest of the timeout.
+    ULONGLONG deadline = GetTickCount64() + timeout;
+    while (true) {
+        if (MkConfGenSharedSequence(shared) > sequence) {
+            return true;
+        }
+        InterlockedIncrement(&shared->header->waiterCount);
+        if (MkConfGenSharedSequence(shared) > sequence) {
+            _MkConfGenSharedWithdraw(shared);
+            return true;
+        }
+
+        DWORD remaining = INFINITE;
+        if (timeout != INFINITE) {
+            ULONGLONG now = GetTickCount64();
+            remaining = now < deadline ? (DWORD)(deadline - now) : 0;
+        }
+        if (WaitForSingleObject(shared->semaphore, remaining) != WAIT_OBJECT_0) {
+            _MkConfGenSharedWithdraw(shared);
+            return MkConfGenSharedSequence(shared) > sequence;
+        }
+    }
+}
+
+void * _MkConfGenSharedBeginWrite(MkConfGenShared * shared) {
+    _MKCONFGEN_ASSERT(shared);
+
+    // A publisher that died while writing left the sequence odd, readers keep waiting until this write ends.
+    if (!(shared->header->sequence & 1)) {
+        InterlockedIncrement64(&shared->header->sequence);
+    }
+    return shared->image;
+}
+
+void _MkConfGenSharedEndWrite(MkConfGenShared * shared) {
+    _MKCONFGEN_ASSERT(shared);
+    InterlockedIncrement64(&shared->header->sequence);
+
+    LONG waiterCount = InterlockedExchange(&shared->header->waiterCount, 0);
+    if (waiterCount != 0) {
+        ReleaseSemaphore(shared->semaphore, waiterCount, NULL);
+    }
+}
+
+uint64_t _MkConfGenSharedBeginRead(const MkConfGenShared * shared) {
+    _MKCONFGEN_ASSERT(shared);
+    LONG64 sequence;
+    while ((sequence = shared->header->sequence) & 1) {
+        YieldProcessor();
+    }
+    MemoryBarrier();
+    return (uint64_t)sequence;
+}
+
+bool _MkConfGenSharedRetryRead(const MkConfGenShared * shared, uint64_t sequence) {
+    _MKCONFGEN_ASSERT(shared);
+    MemoryBarrier();
+    return (uint64_t)shared->header->sequence != sequence;
+}
+
+#endif
+
+//---------
+// Replicas
+
+// Readers count themselves in the counter of the parity of the epoch, the publisher flips the epoch so that new readers
+// use the other counter while it waits for the old one to drain.
+typedef struct _MkConfGenReplica {
+    std::atomic<void *> image; // the config followed by the entries of its maps
+    unsigned long node; // ULONG_MAX with a single replica
+    std::atomic<uint64_t> epoch;
+    alignas(64) std::atomic<long> readerCounts[2]; // written by all readers, so on a cache line of their own
+} _MkConfGenReplica;
+
+#ifdef _WIN32
+#define _MKCONFGEN_GROUP_PROCESSOR_COUNT (sizeof(KAFFINITY) * CHAR_BIT)
+
+// Pages of a node-preferred allocation come from that node no matter which thread touches them first, so the
+// publisher may run anywhere.
+static void * _MkConfGenReplicaAlloc(unsigned long node, size_t size) {
+    if (node == ULONG_MAX) {
+        return VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    }
+    return VirtualAllocExNuma(GetCurrentProcess(), NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, node);
+}
+
+static void _MkConfGenReplicaFree(void * memory) {
+    VirtualFree(memory, 0, MEM_RELEASE);
+}
+#else
+// Without NUMA placement there is a single replica in ordinary memory.
+static void * _MkConfGenReplicaAlloc(unsigned long, size_t size) {
+    return malloc(size);
+}
+
+static void _MkConfGenReplicaFree(void * memory) {
+    free(memory);
+}
+#endif
+
+static bool _MkConfGenReplicaAdd(MkConfGenReplicas * replicas, unsigned long node) {
+    void * memory = _MkConfGenReplicaAlloc(node, sizeof(_MkConfGenReplica));
+    if (!memory) {
+        return false;
+    }
+    _MkConfGenReplica * replica = new (memory) _MkConfGenReplica();
+    replica->node = node;
+    replicas->replicas[replicas->replicaCount++] = replica;
+    return true;
+}
+
+#ifdef _WIN32
+// Adds a replica for every node with processors, machines with one node or none are left to the caller. Nodes may span
+// processor groups, processors outside of all masks read the first replica.
+static bool _MkConfGenReplicasAddNodes(MkConfGenReplicas * replicas) {
+    ULONG highestNode;
+    if (!GetNumaHighestNodeNumber(&highestNode) || highestNode == 0) {
+        return true;
+    }
+    USHORT groupCount = GetActiveProcessorGroupCount();
+    replicas->replicas = (_MkConfGenReplica **)calloc((size_t)highestNode + 1, sizeof(_MkConfGenReplica *));
+    replicas->processorCount = (size_t)groupCount * _MKCONFGEN_GROUP_PROCESSOR_COUNT;
+    replicas->processorReplicas = (uint16_t *)calloc(replicas->processorCount, sizeof(uint16_t));
+    GROUP_AFFINITY * masks = (GROUP_AFFINITY *)malloc(groupCount * sizeof(GROUP_AFFINITY));
+    if (!replicas->replicas || !replicas->processorReplicas || !masks) {
+        free(masks);
+        return false;
+    }
+
+    for (ULONG node = 0; node <= highestNode; node++) {
+        USHORT maskCount;
+        if (!GetNumaNodeProcessorMask2((USHORT)node, masks, groupCount, &maskCount)) {
+            continue;
+        }
+        bool hasProcessors = false;
+        for (USHORT m = 0; m != maskCount; m++) {
+            hasProcessors = hasProcessors || masks[m].Mask != 0;
+        }
+        if (!hasProcessors) {
+            continue;
+        }
+        if (!_MkConfGenReplicaAdd(replicas, node)) {
+            free(masks);
+            return false;
+        }
+        for (USHORT m = 0; m != maskCount; m++) {
+            size_t groupStart = (size_t)masks[m].Group * _MKCONFGEN_GROUP_PROCESSOR_COUNT;
+            for (size_t k = 0; k != _MKCONFGEN_GROUP_PROCESSOR_COUNT && groupStart + k < replicas->processorCount; k++) {
+                if ((masks[m].Mask >> k) & 1) {
+                    replicas->processorReplicas[groupStart + k] = (uint16_t)(replicas->replicaCount - 1);
+                }
+            }
+        }
+    }
+    free(masks);
+    return true;
+}
+#endif
+
+bool _MkConfGenReplicasCreate(MkConfGenReplicas * replicas, const void * image, size_t imageSize, const size_t * mapOffsets, size_t mapCount) {
+    _MKCONFGEN_ASSERT(replicas);
+    _MKCONFGEN_ASSERT(image);
+
+    replicas->replicaCount = 0;
+    replicas->replicas = NULL;
+    replicas->imageSize = imageSize;
+    replicas->processorCount = 0;
+    replicas->processorReplicas = NULL;
+
+    bool isCreated = true;
+#ifdef _WIN32
+    isCreated = _MkConfGenReplicasAddNodes(replicas);
+#endif
+
+    // A single replica can't be misplaced, its memory is left to the system.
+    if (isCreated && replicas->replicaCount <= 1) {
+        free(replicas->processorReplicas);
+        replicas->processorCount = 0;
+        replicas->processorReplicas = NULL;
+        if (replicas->replicaCount == 1) {
+            replicas->replicas[0]->node = ULONG_MAX;
+        } else {
+            if (!replicas->replicas) {
+                replicas->replicas = (_MkConfGenReplica **)malloc(sizeof(_MkConfGenReplica *));
+            }
+            isCreated = replicas->replicas && _MkConfGenReplicaAdd(replicas, ULONG_MAX);
+        }
+    }
+
+    if (!isCreated || !_MkConfGenReplicasPublish(replicas, image, mapOffsets, mapCount)) {
+        MkConfGenReplicasFree(replicas);
+        return false;
+    }
+    return true;
+}
+
+void MkConfGenReplicasFree(MkConfGenReplicas * replicas) {
+    _MKCONFGEN_ASSERT(replicas);
+    for (size_t r = 0; r != replicas->replicaCount; r++) {
+        void * image = replicas->replicas[r]->image.load();
+        if (image) {
+            _MkConfGenReplicaFree(image);
+        }
+        _MkConfGenReplicaFree(replicas->replicas[r]);
+    }
+    free(replicas->replicas);
+    free(replicas->processorReplicas);
+}
+
+// Every reader that could have seen the old image counted itself before reading the pointer, so once both counters
+// were seen at zero after the swap, none of them holds it anymore.
+static void _MkConfGenReplicaSynchronize(_MkConfGenReplica * replica) {
+    for (size_t pass = 0; pass != 2; pass++) {
+        size_t parity = (size_t)replica->epoch.fetch_add(1) & 1;
+        while (replica->readerCounts[parity].load() != 0) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+bool _MkConfGenReplicasPublish(MkConfGenReplicas * replicas, const void * image, const size_t * mapOffsets, size_t mapCount) {
+    _MKCONFGEN_ASSERT(replicas);
+    _MKCONFGEN_ASSERT(image);
+    _MKCONFGEN_ASSERT(mapOffsets || mapCount == 0);
+
+    size_t size = _MKCONFGEN_ALIGN(replicas->imageSize);
+    for (size_t m = 0; m != mapCount; m++) {
+        size += _MkConfGenMapCopySize((const MkConfGenMap *)((const unsigned char *)image + mapOffsets[m]));
+    }
+
+    void ** newImages = (void **)malloc(replicas->replicaCount * sizeof(void *));
+    if (!newImages) {
+        return false;
+    }
+    size_t r;
+    for (r = 0; r != replicas->replicaCount; r++) {
+        unsigned char * newImage = (unsigned char *)_MkConfGenReplicaAlloc(replicas->replicas[r]->node, size);
+        if (!newImage) {
+            break;
+        }
+        memcpy(newImage, image, replicas->imageSize);
+        unsigned char * memory = newImage + _MKCONFGEN_ALIGN(replicas->imageSize);
+        for (size_t m = 0; m != mapCount; m++) {
+            const MkConfGenMap * map = (const MkConfGenMap *)((const unsigned char *)image + mapOffsets[m]);
+            _MkConfGenMapCopyTo((MkConfGenMap *)(newImage + mapOffsets[m]), map, memory);
+            memory += _MkConfGenMapCopySize(map);
+        }
+        newImages[r] = newImage;
+    }
+    if (r != replicas->replicaCount) {
+        while (r != 0) {
+            _MkConfGenReplicaFree(newImages[--r]);
+        }
+        free(newImages);
+        return false;
+    }
+
+    // The new images are all swapped in before waiting, so readers of every node move on at once.
+    for (r = 0; r != replicas->replicaCount; r++) {
+        newImages[r] = replicas->replicas[r]->image.exchange(newImages[r]);
+    }
+    for (r = 0; r != replicas->replicaCount; r++) {
+        if (newImages[r]) {
+            _MkConfGenReplicaSynchronize(replicas->replicas[r]);
+            _MkConfGenReplicaFree(newImages[r]);
+        }
+    }
+    free(newImages);
+    return true;
+}
+
+const void * _MkConfGenReplicaAcquire(const MkConfGenReplicas * replicas, MkConfGenReplicaLease * lease) {
+    _MKCONFGEN_ASSERT(replicas);
+    _MKCONFGEN_ASSERT(lease);
+
+    size_t index = 0;
+#ifdef _WIN32
+    if (replicas->processorReplicas) {
+        PROCESSOR_NUMBER processor;
+        GetCurrentProcessorNumberEx(&processor);
+        size_t processorIndex = (size_t)processor.Group * _MKCONFGEN_GROUP_PROCESSOR_COUNT + processor.Number;
+        index = processorIndex < replicas->processorCount ? replicas->processorReplicas[processorIndex] : 0;
+    }
+#endif
+
+    // The image is read after the reader is counted, both are sequentially consistent.
+    _MkConfGenReplica * replica = replicas->replicas[index];
+    size_t parity = (size_t)replica->epoch.load() & 1;
+    replica->readerCounts[parity].fetch_add(1);
+    lease->replica = replica;
+    lease->parity = parity;
+    return replica->image.load();
+}
+
+void MkConfGenReplicaRelease(MkConfGenReplicaLease * lease) {
+    _MKCONFGEN_ASSERT(lease);
+    lease->replica->readerCounts[lease->parity].fetch_sub(1);
+}
+
+//--------
+// Writing
+
+wchar_t * _MkConfGenWriteWcs(wchar_t * pos, const wchar_t * wcs, size_t length) {
+    wmemcpy(pos, wcs, length);
+    return pos + length;
+}
+
+// Backslashes are escaped as well as quotes so that a trailing one can't swallow the closing quote. Values are read
+// up to the end of the line, so control characters other than tabs can't be written at all.
+wchar_t * _MkConfGenWriteStr(wchar_t * pos, const wchar_t * wcs, bool * isWritable) {
+    *pos++ = L'\"';
+    for (; *wcs; wcs++) {
+        if (*wcs == L'\"' || *wcs == L'\\') {
+            *pos++ = L'\\';
+        } else if (*wcs < 0x20 && *wcs != L'\t') {
+            *isWritable = false;
+        }
+        *pos++ = *wcs;
+    }
+    *pos++ = L'\"';
+    return pos;
+}
+
+// Digits are produced two at a time from the back.
+wchar_t * _MkConfGenWriteUint(wchar_t * pos, unsigned long long value) {
+    static const char digitPairs[] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+
+    wchar_t digits[20];
+    wchar_t * end = digits + 20;
+    wchar_t * begin = end;
+    while (value >= 100) {
+        size_t pair = (size_t)(value % 100) * 2;
+        value /= 100;
+        *--begin = digitPairs[pair + 1];
+        *--begin = digitPairs[pair];
+    }
+    if (value >= 10) {
+        *--begin = digitPairs[value * 2 + 1];
+        *--begin = digitPairs[value * 2];
+    } else {
+        *--begin = (wchar_t)(L'0' + value);
+    }
+    return _MkConfGenWriteWcs(pos, begin, end - begin);
+}
+
+wchar_t * _MkConfGenWriteInt(wchar_t * pos, long long value) {
+    if (value < 0) {
+        *pos++ = L'-';
+        return _MkConfGenWriteUint(pos, 0 - (unsigned long long)value);
+    }
+    return _MkConfGenWriteUint(pos, (unsigned long long)value);
+}
+
+// Shortest text that parses back to the same value.
+wchar_t * _MkConfGenWriteFloat(wchar_t * pos, double value) {
+    char chars[_MKCONFGEN_MAX_NUMBER_LENGTH];
+    std::to_chars_result result = std::to_chars(chars, chars + _MKCONFGEN_MAX_NUMBER_LENGTH, value);
+    for (const char * c = chars; c != result.ptr; c++) {
+        *pos++ = (wchar_t)*c;
+    }
+    return pos;
+}
+
+wchar_t * _MkConfGenWriteBool(wchar_t * pos, bool value) {
+    return value ? _MkConfGenWriteWcs(pos, L"true", 4) : _MkConfGenWriteWcs(pos, L"false", 5);
+}
+
+// Picks the largest unit that represents the value exactly.
+static wchar_t * _MkConfGenWriteUnitValue(wchar_t * pos, uint64_t value, const _MkConfGenUnit * units, size_t unitCount) {
+    if (value == 0) {
+        *pos++ = L'0';
+        return pos;
+    }
+    const _MkConfGenUnit * unit = &units[0];
+    for (size_t k = 1; k != unitCount; k++) {
+        if (value % units[k].factor == 0 && units[k].factor > unit->factor) {
+            unit = &units[k];
+        }
+    }
+    pos = _MkConfGenWriteUint(pos, value / unit->factor);
+    return _MkConfGenWriteWcs(pos, unit->wcs, unit->length);
+}
+
+wchar_t * _MkConfGenWriteDuration(wchar_t * pos, uint64_t value) {
+    return _MkConfGenWriteUnitValue(pos, value, _mkConfGenDurationUnits, sizeof _mkConfGenDurationUnits / sizeof(_MkConfGenUnit));
+}
+
+wchar_t * _MkConfGenWriteSize(wchar_t * pos, uint64_t value) {
+    return _MkConfGenWriteUnitValue(pos, value, _mkConfGenSizeUnits, sizeof _mkConfGenSizeUnits / sizeof(_MkConfGenUnit));
+}
+
+bool _MkConfGenAreWstrArraysEqual(const wchar_t * wcs, const wchar_t * otherWcs, size_t count, size_t length) {
+    for (size_t k = 0; k != count; k++) {
+        if (wcscmp(wcs + k * length, otherWcs + k * length) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#ifdef _WIN32
+//---------
+// Patching
+
+#define _MKCONFGEN_TMP_SUFFIX L".tmp"
+
+typedef struct _MkConfGenPatchScan {
+    _MkConfGenPatch * patches;
+    size_t patchCount;
+    const wchar_t * source;
+} _MkConfGenPatchScan;
+
+// Replaces the characters from begin to end of the source with the text, begin == end inserts it.
+typedef struct _MkConfGenPatchEdit {
+    size_t begin;
+    size_t end;
+    size_t order; // keeps insertions at the same position in patch order
+    size_t textOffset;
+    size_t textLength;
+    size_t byteBegin;
+    size_t byteEnd;
+    size_t byteOffset;
+    size_t byteLength;
+} _MkConfGenPatchEdit;
+
+static int _MkConfGenComparePatches(const void * a, const void * b) {
+    const _MkConfGenPatch * patchPtr = (const _MkConfGenPatch *)a;
+    const _MkConfGenPatch * otherPtr = (const _MkConfGenPatch *)b;
+    if (patchPtr->index != otherPtr->index) {
+        return patchPtr->index < otherPtr->index ? -1 : 1;
+    }
+    if (patchPtr->row != otherPtr->row) {
+        return patchPtr->row < otherPtr->row ? -1 : 1;
+    }
+    if (!patchPtr->mapKey || !otherPtr->mapKey) {
+        return (patchPtr->mapKey != NULL) - (otherPtr->mapKey != NULL);
+    }
+    size_t length = patchPtr->mapKeyLength < otherPtr->mapKeyLength ? patchPtr->mapKeyLength : otherPtr->mapKeyLength;
+    int order = wmemcmp(patchPtr->mapKey, otherPtr->mapKey, length);
+    if (order != 0) {
+        return order;
+    }
+    return patchPtr->mapKeyLength == otherPtr->mapKeyLength ? 0 : (patchPtr->mapKeyLength < otherPtr->mapKeyLength ? -1 : 1);
+}
+
+static int _MkConfGenCompareEdits(const void * a, const void * b) {
+    const _MkConfGenPatchEdit * editPtr = (const _MkConfGenPatchEdit *)a;
+    const _MkConfGenPatchEdit * otherPtr = (const _MkConfGenPatchEdit *)b;
+    if (editPtr->begin != otherPtr->begin) {
+        return editPtr->begin < otherPtr->begin ? -1 : 1;
+    }
+    return editPtr->order < otherPtr->order ? -1 : 1;
+}
+
+// Records the last span of every patched key, the value is not parsed.
+static bool _MkConfGenPatchRecord(
+    void * config,
+    size_t index,
+    size_t row,
+    const wchar_t * mapKey,
+    size_t mapKeyLength,
+    wchar_t * rawValue,
+    size_t rawValueLength,
+    bool,
+    MkConfGenLoadErrorType *)
+{
+    _MkConfGenPatchScan * scan = (_MkConfGenPatchScan *)config;
+    _MkConfGenPatch key = { index, row, mapKey, mapKeyLength, 0, 0, 0, 0, 0 };
+    _MkConfGenPatch * patchPtr = (_MkConfGenPatch *)bsearch(&key, scan->patches, scan->patchCount, sizeof(_MkConfGenPatch), _MkConfGenComparePatches);
+    if (patchPtr) {
+        patchPtr->sourceBegin = rawValue - scan->source;
+        patchPtr->sourceEnd = patchPtr->sourceBegin + rawValueLength;
+    }
+    return true;
+}
+
+static size_t _MkConfGenUtf8Length(const wchar_t * wcs, size_t length) {
+    return length == 0 ? 0 : (size_t)WideCharToMultiByte(CP_UTF8, 0, wcs, (int)length, NULL, 0, NULL, NULL);
+}
+
+// Decodes a whole UTF-8 file into a NULL-terminated source, a byte order mark is skipped.
+static bool _MkConfGenDecodeUtf8(const char * bytes, size_t byteCount, size_t * bomLength, wchar_t ** source, size_t * sourceLength) {
+    *bomLength = byteCount >= 3 && memcmp(bytes, "\xEF\xBB\xBF", 3) == 0 ? 3 : 0;
+    int length = 0;
+    if (byteCount != *bomLength) {
+        length = MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, bytes + *bomLength, (int)(byteCount - *bomLength), NULL, 0);
+        if (length == 0) {
+            return false;
+        }
+    }
+    *source = (wchar_t *)malloc((length + 1) * sizeof(wchar_t));
+    if (!*source) {
+        return false;
+    }
+    if (length != 0) {
+        MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, bytes + *bomLength, (int)(byteCount - *bomLength), *source, length);
+    }
+    (*source)[length] = L'\0';
+    *sourceLength = length;
+    return true;
+}
+
+// Reads a whole UTF-8 file, a byte order mark is kept in the bytes but not decoded.
+static bool _MkConfGenReadUtf8File(HANDLE file, char ** bytes, size_t * byteCount, size_t * bomLength, wchar_t ** source, size_t * sourceLength) {
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart > INT_MAX) {
+        return false;
+    }
+    *byteCount = (size_t)fileSize.QuadPart;
+    *bytes = (char *)malloc(*byteCount + 1);
+    if (!*bytes) {
+        return false;
+    }
+    DWORD readCount;
+    if (!ReadFile(file, *bytes, (DWORD)*byteCount, &readCount, NULL) || readCount != *byteCount
+        || !_MkConfGenDecodeUtf8(*bytes, *byteCount, bomLength, source, sourceLength))
+    {
+        free(*bytes);
+        return false;
+    }
+    return true;
+}
+
+// Finds where each heading of the file ends, after its last line that is not empty. headingEnds has one more element
+// for the lines before the first heading, headings missing from the file get SIZE_MAX.
+static void _MkConfGenFindHeadingEnds(const wchar_t * source, size_t sourceLength, const _MkConfGenSection * section, size_t * headingEnds) {
+    for (size_t k = 0; k != section->headingCount; k++) {
+        headingEnds[k] = SIZE_MAX;
+    }
+    headingEnds[section->headingCount] = 0;
+
+    size_t current = section->headingCount;
+    size_t i = 0;
+    while (i != sourceLength) {
+        const wchar_t * newline = wmemchr(source + i, L'\n', sourceLength - i);
+        size_t lineEnd = newline ? newline - source + 1 : sourceLength;
+        while (i != lineEnd && (source[i] == L' ' || source[i] == L'\t')) {
+            i++;
+        }
+
+        if (i != lineEnd && source[i] == L'[') {
+            const wchar_t * close = wmemchr(source + i, L']', lineEnd - i);
+            size_t nameLength = close ? close - source - i - 1 : 0;
+            current = SIZE_MAX;
+            for (size_t k = 0; k != section->headingCount; k++) {
+                if (close && wcslen(section->headings[k]) == nameLength && wmemcmp(section->headings[k], source + i + 1, nameLength) == 0) {
+                    current = k;
+                    break;
+                }
+            }
+            if (current != SIZE_MAX) {
+                headingEnds[current] = lineEnd;
+            }
+        } else if (i != lineEnd && source[i] != L'\n' && source[i] != L'\r' && current != SIZE_MAX) {
+            headingEnds[current] = lineEnd;
+        }
+        i = lineEnd;
+    }
+}
+
+static bool _MkConfGenWriteFileBytes(HANDLE file, const char * bytes, size_t byteCount, size_t offset) {
+    OVERLAPPED overlapped = {};
+    overlapped.Offset = (DWORD)offset;
+    overlapped.OffsetHigh = (DWORD)((uint64_t)offset >> 32);
+    DWORD writtenCount;
+    return WriteFile(file, bytes, (DWORD)byteCount, &writtenCount, &overlapped) && writtenCount == byteCount;
+}
+
+bool _MkConfGenPatchFile(
+    const wchar_t * path,
+    const _MkConfGenSection * section,
+    _MkConfGenPatch * patches,
+    size_t patchCount,
+    const wchar_t * text,
+    size_t textLength)
+{
+    _MKCONFGEN_ASSERT(path);
+    _MKCONFGEN_ASSERT(section && !section->name);
+    _MKCONFGEN_ASSERT(patches || patchCount == 0);
+    _MKCONFGEN_ASSERT(text || textLength == 0);
+
+    for (size_t k = 0; k != patchCount; k++) {
+        patches[k].valueLength = (k + 1 == patchCount ? textLength : patches[k + 1].valueOffset) - patches[k].valueOffset;
+        patches[k].sourceBegin = SIZE_MAX;
+        patches[k].sourceEnd = SIZE_MAX;
+    }
+    qsort(patches, patchCount, sizeof(_MkConfGenPatch), _MkConfGenComparePatches);
+
+    HANDLE file = CreateFileW(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    char * bytes;
+    size_t byteCount;
+    size_t bomLength;
+    wchar_t * source;
+    size_t sourceLength;
+    if (!_MkConfGenReadUtf8File(file, &bytes, &byteCount, &bomLength, &source, &sourceLength)) {
+        CloseHandle(file);
+        return false;
+    }
+
+    // Scan
+    // The loader finds the value spans, so keys are matched exactly like when loading.
+
+    _MkConfGenPatchScan scan = { patches, patchCount, source };
+    _MkConfGenSection scanSection = *section;
+    scanSection.headingMask = UINT64_MAX;
+    scanSection.parseValueCallback = _MkConfGenPatchRecord;
+    scanSection.config = &scan;
+    scanSection.isLazy = true;
+    MkConfGenLoadError * errors;
+    size_t errorCount;
+    bool isPatched = _MkConfGenLoadSections(source, sourceLength, 1, &scanSection, &errors, &errorCount);
+    free(errors);
+
+    size_t * headingEnds = (size_t *)malloc((section->headingCount + 1) * sizeof(size_t));
+    _MkConfGenPatchEdit * edits = (_MkConfGenPatchEdit *)malloc((patchCount + 1) * sizeof(_MkConfGenPatchEdit));
+    size_t editTextCapacity = textLength + 1;
+    for (size_t k = 0; k != patchCount; k++) {
+        if (patches[k].sourceBegin == SIZE_MAX) {
+            editTextCapacity += section->keyIndices[patches[k].index + 1] - section->keyIndices[patches[k].index] + patches[k].mapKeyLength + 32;
+            if (patches[k].heading != SIZE_MAX) {
+                editTextCapacity += wcslen(section->headings[patches[k].heading]) + 4;
+            }
+        }
+    }
+    wchar_t * editText = (wchar_t *)malloc(editTextCapacity * sizeof(wchar_t));
+    isPatched = isPatched && headingEnds && edits && editText;
+
+    // Edits
+
+    size_t editCount = 0;
+    if (isPatched) {
+        _MkConfGenFindHeadingEnds(source, sourceLength, section, headingEnds);
+        // Keys of headings that are appended go after all keys added to the end of the last heading of the file.
+        bool isTerminated = sourceLength == 0 || source[sourceLength - 1] == L'\n';
+        uint64_t appendedMask = 0;
+        wchar_t * pos = editText;
+        for (size_t k = 0; k != patchCount; k++) {
+            _MkConfGenPatch * patchPtr = &patches[k];
+            _MkConfGenPatchEdit * editPtr = &edits[editCount++];
+            editPtr->order = k + 1;
+            editPtr->textOffset = pos - editText;
+            if (patchPtr->sourceBegin != SIZE_MAX) {
+                editPtr->begin = patchPtr->sourceBegin;
+                editPtr->end = patchPtr->sourceEnd;
+                pos = _MkConfGenWriteWcs(pos, text + patchPtr->valueOffset, patchPtr->valueLength);
+                editPtr->textLength = pos - editText - editPtr->textOffset;
+                continue;
+            }
+
+            // Missing keys go after the last line of their heading, missing headings are appended to the file.
+            size_t * endPtr = &headingEnds[patchPtr->heading == SIZE_MAX ? section->headingCount : patchPtr->heading];
+            bool isAppended = *endPtr == SIZE_MAX;
+            if ((isAppended || *endPtr == sourceLength) && !isTerminated) {
+                _MkConfGenPatchEdit * newlinePtr = &edits[editCount++];
+                newlinePtr->begin = sourceLength;
+                newlinePtr->end = sourceLength;
+                newlinePtr->order = 0;
+                newlinePtr->textOffset = pos - editText;
+                newlinePtr->textLength = 1;
+                *pos++ = L'\n';
+                editPtr->textOffset = pos - editText;
+                isTerminated = true;
+            }
+            if (isAppended) {
+                *endPtr = sourceLength;
+                appendedMask |= (uint64_t)1 << patchPtr->heading;
+                if (sourceLength != 0 || k != 0) {
+                    *pos++ = L'\n';
+                }
+                *pos++ = L'[';
+                pos = _MkConfGenWriteWcs(pos, section->headings[patchPtr->heading], wcslen(section->headings[patchPtr->heading]));
+                pos = _MkConfGenWriteWcs(pos, L"]\n", 2);
+            }
+            if (patchPtr->heading != SIZE_MAX && (appendedMask & ((uint64_t)1 << patchPtr->heading))) {
+                editPtr->order += patchCount;
+            }
+            editPtr->begin = *endPtr;
+            editPtr->end = *endPtr;
+
+            const wchar_t * key = section->keys + section->keyIndices[patchPtr->index];
+            size_t keyLength = section->keyIndices[patchPtr->index + 1] - section->keyIndices[patchPtr->index];
+            if (patchPtr->row != SIZE_MAX) {
+                const wchar_t * column = wmemchr(key, L'.', keyLength);
+                pos = _MkConfGenWriteWcs(pos, key, column - key);
+                *pos++ = L'[';
+                pos = _MkConfGenWriteUint(pos, patchPtr->row);
+                *pos++ = L']';
+                pos = _MkConfGenWriteWcs(pos, column, key + keyLength - column);
+            } else {
+                pos = _MkConfGenWriteWcs(pos, key, keyLength);
+            }
+            if (patchPtr->mapKey) {
+                *pos++ = L'.';
+                pos = _MkConfGenWriteWcs(pos, patchPtr->mapKey, patchPtr->mapKeyLength);
+            }
+            pos = _MkConfGenWriteWcs(pos, L" = ", 3);
+            pos = _MkConfGenWriteWcs(pos, text + patchPtr->valueOffset, patchPtr->valueLength);
+            *pos++ = L'\n';
+            editPtr->textLength = pos - editText - editPtr->textOffset;
+        }
+        _MKCONFGEN_ASSERT((size_t)(pos - editText) <= editTextCapacity);
+        qsort(edits, editCount, sizeof(_MkConfGenPatchEdit), _MkConfGenCompareEdits);
+    }
+
+    // UTF-8
+    // Edits are sorted and don't overlap, so their byte offsets are found in one pass over the source.
+
+    size_t editByteCount = 0;
+    char * editBytes = isPatched ? (char *)malloc(3 * editTextCapacity) : NULL;
+    isPatched = isPatched && editBytes;
+    bool isInPlace = isPatched;
+    if (isPatched) {
+        size_t sourcePos = 0;
+        size_t bytePos = bomLength;
+        for (size_t k = 0; k != editCount; k++) {
+            _MkConfGenPatchEdit * editPtr = &edits[k];
+            bytePos += _MkConfGenUtf8Length(source + sourcePos, editPtr->begin - sourcePos);
+            editPtr->byteBegin = bytePos;
+            bytePos += _MkConfGenUtf8Length(source + editPtr->begin, editPtr->end - editPtr->begin);
+            editPtr->byteEnd = bytePos;
+            sourcePos = editPtr->end;
+
+            editPtr->byteOffset = editByteCount;
+            editPtr->byteLength = (size_t)WideCharToMultiByte(
+                CP_UTF8, 0, editText + editPtr->textOffset, (int)editPtr->textLength, editBytes + editByteCount, (int)(3 * editTextCapacity - editByteCount), NULL, NULL);
+            editByteCount += editPtr->byteLength;
+            isInPlace = isInPlace && editPtr->begin != editPtr->end && editPtr->byteEnd - editPtr->byteBegin == editPtr->byteLength;
+        }
+    }
+
+    // Write
+    // Values of the same length are overwritten where they are, anything else replaces the file atomically.
+
+    if (isInPlace) {
+        for (size_t k = 0; k != editCount && isPatched; k++) {
+            isPatched = _MkConfGenWriteFileBytes(file, editBytes + edits[k].byteOffset, edits[k].byteLength, edits[k].byteBegin);
+        }
+        CloseHandle(file);
+    } else {
+        CloseHandle(file);
+
+        size_t pathLength = wcslen(path);
+        size_t suffixLength = wcslen(_MKCONFGEN_TMP_SUFFIX);
+        wchar_t * tmpPath = isPatched ? (wchar_t *)malloc((pathLength + suffixLength + 1) * sizeof(wchar_t)) : NULL;
+        char * newBytes = isPatched ? (char *)malloc(byteCount + editByteCount + 1) : NULL;
+        isPatched = isPatched && tmpPath && newBytes;
+        if (isPatched) {
+            wmemcpy(tmpPath, path, pathLength);
+            wmemcpy(tmpPath + pathLength, _MKCONFGEN_TMP_SUFFIX, suffixLength + 1);
+
+            size_t newByteCount = 0;
+            size_t bytePos = 0;
+            for (size_t k = 0; k != editCount; k++) {
+                memcpy(newBytes + newByteCount, bytes + bytePos, edits[k].byteBegin - bytePos);
+                newByteCount += edits[k].byteBegin - bytePos;
+                memcpy(newBytes + newByteCount, editBytes + edits[k].byteOffset, edits[k].byteLength);
+                newByteCount += edits[k].byteLength;
+                bytePos = edits[k].byteEnd;
+            }
+            memcpy(newBytes + newByteCount, bytes + bytePos, byteCount - bytePos);
+            newByteCount += byteCount - bytePos;
+
+            HANDLE tmpFile = CreateFileW(tmpPath, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+            isPatched = tmpFile != INVALID_HANDLE_VALUE;
+            if (isPatched) {
+                isPatched = _MkConfGenWriteFileBytes(tmpFile, newBytes, newByteCount, 0) && FlushFileBuffers(tmpFile);
+                CloseHandle(tmpFile);
+                isPatched = isPatched && MoveFileExW(tmpPath, path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+                if (!isPatched) {
+                    DeleteFileW(tmpPath);
+                }
+            }
+        }
+        free(tmpPath);
+        free(newBytes);
+    }
+
+    free(bytes);
+    free(source);
+    free(headingEnds);
+    free(edits);
+    free(editText);
+    free(editBytes);
+    return isPatched;
+}
+#endif
+
+//---------------------
+// Asynchronous Loading
+
+#ifndef _WIN32
+#define _MKCONFGEN_ASYNC_WORKER_COUNT 2
+
+// Decodes a whole UTF-8 file into a NULL-terminated source like MultiByteToWideChar does on Win32, into UTF-16 or UTF-32
+// depending on the size of wchar_t. Malformed sequences, overlong forms and surrogates fail.
+static bool _MkConfGenDecodeUtf8(const char * bytes, size_t byteCount, size_t * bomLength, wchar_t ** source, size_t * sourceLength) {
+    *bomLength = byteCount >= 3 && memcmp(bytes, "\xEF\xBB\xBF", 3) == 0 ? 3 : 0;
+    // No sequence yields more code units than it has bytes.
+    wchar_t * wcs = (wchar_t *)malloc((byteCount - *bomLength + 1) * sizeof(wchar_t));
+    if (!wcs) {
+        return false;
+    }
+    const unsigned char * pos = (const unsigned char *)bytes + *bomLength;
+    const unsigned char * end = (const unsigned char *)bytes + byteCount;
+    size_t length = 0;
+    while (pos != end) {
+        uint32_t ch = *pos++;
+        size_t extraCount = ch < 0x80 ? 0 : ch >= 0xC2 && ch < 0xE0 ? 1 : ch >= 0xE0 && ch < 0xF0 ? 2 : ch >= 0xF0 && ch < 0xF5 ? 3 : SIZE_MAX;
+        bool isValid = extraCount != SIZE_MAX && (size_t)(end - pos) >= extraCount;
+        if (isValid && extraCount != 0) {
+            ch &= 0x3F >> extraCount;
+            for (size_t k = 0; k != extraCount && isValid; k++) {
+                isValid = (*pos & 0xC0) == 0x80;
+                ch = ch << 6 | (*pos++ & 0x3F);
+            }
+            isValid = isValid
+                && !(extraCount == 2 && ch < 0x800)
+                && !(extraCount == 3 && (ch < 0x10000 || ch > 0x10FFFF))
+                && !(ch >= 0xD800 && ch < 0xE000);
+        }
+        if (!isValid) {
+            free(wcs);
+            return false;
+        }
+        if (sizeof(wchar_t) == 2 && ch >= 0x10000) {
+            wcs[length++] = (wchar_t)(0xD800 + ((ch - 0x10000) >> 10));
+            wcs[length++] = (wchar_t)(0xDC00 + ((ch - 0x10000) & 0x3FF));
+        } else {
+            wcs[length++] = (wchar_t)ch;
+        }
+    }
+    wcs[length] = L'\0';
+    *source = wcs;
+    *sourceLength = length;
+    return true;
+}
+
+// fopen takes a narrow path, which is UTF-8 on the systems this fallback is meant for.
+static FILE * _MkConfGenOpenFile(const wchar_t * path) {
+    size_t pathLength = wcslen(path);
+    char * narrowPath = (char *)malloc(pathLength * 4 + 1);
+    if (!narrowPath) {
+        return NULL;
+    }
+    char * pos = narrowPath;
+    for (size_t i = 0; i != pathLength; i++) {
+        uint32_t ch = (uint32_t)path[i];
+        if (sizeof(wchar_t) == 2 && ch >= 0xD800 && ch < 0xDC00 && i + 1 != pathLength && (uint32_t)path[i + 1] - 0xDC00 < 0x400) {
+            ch = 0x10000 + ((ch - 0xD800) << 10) + ((uint32_t)path[++i] - 0xDC00);
+        }
+        if (ch < 0x80) {
+            *pos++ = (char)ch;
+        } else if (ch < 0x800) {
+            *pos++ = (char)(0xC0 | ch >> 6);
+            *pos++ = (char)(0x80 | (ch & 0x3F));
+        } else if (ch < 0x10000) {
+            *pos++ = (char)(0xE0 | ch >> 12);
+            *pos++ = (char)(0x80 | (ch >> 6 & 0x3F));
+            *pos++ = (char)(0x80 | (ch & 0x3F));
+        } else {
+            *pos++ = (char)(0xF0 | ch >> 18);
+            *pos++ = (char)(0x80 | (ch >> 12 & 0x3F));
+            *pos++ = (char)(0x80 | (ch >> 6 & 0x3F));
+            *pos++ = (char)(0x80 | (ch & 0x3F));
+        }
+    }
+    *pos = '\0';
+    FILE * file = fopen(narrowPath, "rb");
+    free(narrowPath);
+    return file;
+}
+#endif
+
+typedef struct _MkConfGenAsyncLoad {
+    _MkConfGenSection section;
+    wchar_t * path;
+    _MkConfGenPrepareCallback prepareCallback;
+    size_t lineBudget;
+    MkConfGenLoadReady ready;
+    MkConfGenLoadCompletion completion;
+    void * context;
+#ifdef _WIN32
+    HANDLE file;
+    PTP_IO io;
+    PTP_WORK work;
+    OVERLAPPED overlapped;
+#else
+    FILE * file;
+    _MkConfGenAsyncLoad * next; // queued for the worker pool
+#endif
+    char * bytes;
+    size_t byteCount;
+    wchar_t * source; // NULL until the file is read
+    size_t sourceLength;
+    size_t pos;
+    size_t lineOffset;
+    bool isSectionValid;
+    bool isLoaded;
+    MkConfGenLoadError * errors;
+    size_t errorCount;
+} _MkConfGenAsyncLoad;
+
+static void _MkConfGenAsyncFree(_MkConfGenAsyncLoad * load) {
+#ifdef _WIN32
+    if (load->io) {
+        CloseThreadpoolIo(load->io);
+    }
+    if (load->file != INVALID_HANDLE_VALUE) {
+        CloseHandle(load->file);
+    }
+    if (load->work) {
+        CloseThreadpoolWork(load->work);
+    }
+#else
+    if (load->file) {
+        fclose(load->file);
+    }
+#endif
+    free(load->path);
+    free(load->bytes);
+    free(load->source);
+    free(load);
+}
+
+// Scans the next slice of at most lineBudget lines, or everything without a budget. Returns true when done.
+static bool _MkConfGenAsyncScanSlice(_MkConfGenAsyncLoad * load) {
+    if (load->lineBudget == 0) {
+        load->isLoaded = _MkConfGenScan(load->source, load->sourceLength, 1, &load->section, load->path, NULL, NULL, &load->errors, &load->errorCount);
+        return true;
+    }
+
+    size_t end = load->pos;
+    for (size_t n = 0; n != load->lineBudget && end != load->sourceLength; n++) {
+        const wchar_t * lineEnd = wmemchr(load->source + end, L'\n', load->sourceLength - end);
+        end = lineEnd ? lineEnd + 1 - load->source : load->sourceLength;
+    }
+
+    _MkConfGenChunk chunk = {};
+    chunk.wcs = load->source + load->pos;
+    chunk.length = end - load->pos;
+    _MkConfGenScanChunk(&chunk, &load->section);
+    if (!_MkConfGenMergeChunk(&chunk, &load->section, load->path, &load->isSectionValid, &load->lineOffset, &load->errors, &load->errorCount)) {
+        load->isLoaded = false;
+    }
+    free(chunk.records);
+    free(chunk.errors);
+
+    load->pos = end;
+    return end == load->sourceLength;
+}
+
+// Runs on the background thread once the bytes are read, isRead is false if that failed. A failed sliced load is still
+// handed over, its first step reports the failure.
+static void _MkConfGenAsyncRun(_MkConfGenAsyncLoad * load, bool isRead) {
+    size_t bomLength;
+    if (!isRead
+        || !_MkConfGenDecodeUtf8(load->bytes, load->byteCount, &bomLength, &load->source, &load->sourceLength)
+        || (load->prepareCallback && !load->prepareCallback(load->section.config, load->source, load->sourceLength)))
+    {
+        load->isLoaded = false;
+        free(load->source);
+        load->source = NULL;
+    }
+    free(load->bytes);
+    load->bytes = NULL;
+
+    if (load->ready) {
+        load->ready(load->context, load);
+        return;
+    }
+    if (load->source) {
+        _MkConfGenAsyncScanSlice(load);
+    }
+    load->completion(load->context, load->isLoaded, load->errors, load->errorCount);
+    _MkConfGenAsyncFree(load);
+}
+
+bool MkConfGenLoadStep(MkConfGenLoadTask * task, MkConfGenLoadResult * result) {
+    _MKCONFGEN_ASSERT(task && task->ready);
+    _MKCONFGEN_ASSERT(result);
+
+    if (task->source && !_MkConfGenAsyncScanSlice(task)) {
+        return false;
+    }
+    *result = { task->isLoaded, task->errors, task->errorCount };
+    _MkConfGenAsyncFree(task);
+    return true;
+}
+
+#ifdef _WIN32
+static void CALLBACK _MkConfGenAsyncWork(PTP_CALLBACK_INSTANCE, PVOID context, PTP_WORK) {
+    _MkConfGenAsyncRun((_MkConfGenAsyncLoad *)context, true);
+}
+
+static void CALLBACK _MkConfGenAsyncRead(PTP_CALLBACK_INSTANCE, PVOID context, PVOID, ULONG ioResult, ULONG_PTR transferredCount, PTP_IO) {
+    _MkConfGenAsyncLoad * load = (_MkConfGenAsyncLoad *)context;
+
+    CloseThreadpoolIo(load->io);
+    load->io = NULL;
+    CloseHandle(load->file);
+    load->file = INVALID_HANDLE_VALUE;
+
+    if (ioResult != NO_ERROR || transferredCount != load->byteCount) {
+        _MkConfGenAsyncRun(load, false);
+        return;
+    }
+    SubmitThreadpoolWork(load->work);
+}
+#else
+typedef struct _MkConfGenAsyncPool {
+    std::mutex lock;
+    std::condition_variable signal;
+    _MkConfGenAsyncLoad * first; // oldest queued load
+    _MkConfGenAsyncLoad * last;
+    size_t workerCount;
+} _MkConfGenAsyncPool;
+
+// The pool lives as long as the process, so its workers are never joined.
+static _MkConfGenAsyncPool * _MkConfGenGetAsyncPool() {
+    static _MkConfGenAsyncPool * pool = new (std::nothrow) _MkConfGenAsyncPool();
+    return pool;
+}
+
+static void _MkConfGenAsyncWorker(_MkConfGenAsyncPool * pool) {
+    while (true) {
+        _MkConfGenAsyncLoad * load;
+        {
+            std::unique_lock<std::mutex> lock(pool->lock);
+            pool->signal.wait(lock, [pool] { return pool->first != NULL; });
+            load = pool->first;
+            pool->first = load->next;
+            if (!pool->first) {
+                pool->last = NULL;
+            }
+        }
+
+        bool isRead = fread(load->bytes, 1, load->byteCount, load->file) == load->byteCount;
+        fclose(load->file);
+        load->file = NULL;
+        _MkConfGenAsyncRun(load, isRead);
+    }
+}
+
+// Starts another worker while there are fewer than _MKCONFGEN_ASYNC_WORKER_COUNT, fails only if there is none at all.
+static bool _MkConfGenAsyncSubmit(_MkConfGenAsyncLoad * load) {
+    _MkConfGenAsyncPool * pool = _MkConfGenGetAsyncPool();
+    if (!pool) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(pool->lock);
+    if (pool->workerCount != _MKCONFGEN_ASYNC_WORKER_COUNT) {
+        try {
+            std::thread(_MkConfGenAsyncWorker, pool).detach();
+            pool->workerCount++;
+        } catch (...) {
+            if (pool->workerCount == 0) {
+                return false;
+            }
+        }
+    }
+    load->next = NULL;
+    if (pool->last) {
+        pool->last->next = load;
+    } else {
+        pool->first = load;
+    }
+    pool->last = load;
+    pool->signal.notify_one();
+    return true;
+}
+#endif
+
+bool _MkConfGenLoadAsync(
+    const wchar_t * path,
+    const _MkConfGenSection * section,
+    _MkConfGenPrepareCallback prepareCallback,
+    size_t lineBudget,
+    MkConfGenLoadReady ready,
+    MkConfGenLoadCompletion completion,
+    void * context)
+{
+    _MKCONFGEN_ASSERT(path);
+    _MKCONFGEN_ASSERT(section && !section->name && !section->isLazy);
+    _MKCONFGEN_ASSERT(!ready != !completion);
+
+    _MkConfGenAsyncLoad * load = (_MkConfGenAsyncLoad *)calloc(1, sizeof(_MkConfGenAsyncLoad));
+    if (!load) {
+        return false;
+    }
+    load->section = *section;
+    if (!load->section.prepareCallback) {
+        load->section.prepareCallback = prepareCallback;
+    }
+    load->prepareCallback = prepareCallback;
+    load->lineBudget = ready ? lineBudget : 0;
+    load->ready = ready;
+    load->completion = completion;
+    load->context = context;
+    load->isSectionValid = true;
+    load->isLoaded = true;
+
+#ifdef _WIN32
+    load->file = INVALID_HANDLE_VALUE;
+    load->path = _wcsdup(path);
+    if (!load->path) {
+        _MkConfGenAsyncFree(load);
+        return false;
+    }
+    load->file = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    LARGE_INTEGER fileSize;
+    if (load->file == INVALID_HANDLE_VALUE || !GetFileSizeEx(load->file, &fileSize) || fileSize.QuadPart > INT_MAX) {
+        _MkConfGenAsyncFree(load);
+        return false;
+    }
+    load->byteCount = (size_t)fileSize.QuadPart;
+    load->bytes = (char *)malloc(load->byteCount + 1);
+    load->work = CreateThreadpoolWork(_MkConfGenAsyncWork, load, NULL);
+    if (!load->bytes || !load->work) {
+        _MkConfGenAsyncFree(load);
+        return false;
+    }
+
+    // Empty files have nothing to read.
+    if (load->byteCount == 0) {
+        CloseHandle(load->file);
+        load->file = INVALID_HANDLE_VALUE;
+        SubmitThreadpoolWork(load->work);
+        return true;
+    }
+
+    load->io = CreateThreadpoolIo(load->file, _MkConfGenAsyncRead, load, NULL);
+    if (!load->io) {
+        _MkConfGenAsyncFree(load);
+        return false;
+    }
+
+    // The completion is queued to the pool even if the read finishes right away.
+    StartThreadpoolIo(load->io);
+    if (!ReadFile(load->file, load->bytes, (DWORD)load->byteCount, NULL, &load->overlapped) && GetLastError() != ERROR_IO_PENDING) {
+        CancelThreadpoolIo(load->io);
+        _MkConfGenAsyncFree(load);
+        return false;
+    }
+    return true;
+#else
+    // The file is opened here so that a missing one fails right away like on Win32, it is read by a worker.
+    size_t pathLength = wcslen(path);
+    load->path = (wchar_t *)malloc((pathLength + 1) * sizeof(wchar_t));
+    if (!load->path) {
+        _MkConfGenAsyncFree(load);
+        return false;
+    }
+    wmemcpy(load->path, path, pathLength + 1);
+    load->file = _MkConfGenOpenFile(path);
+    long fileSize = -1;
+    if (load->file && fseek(load->file, 0, SEEK_END) == 0) {
+        fileSize = ftell(load->file);
+        rewind(load->file);
+    }
+    if (fileSize < 0 || fileSize > INT_MAX) {
+        _MkConfGenAsyncFree(load);
+        return false;
+    }
+    load->byteCount = (size_t)fileSize;
+    load->bytes = (char *)malloc(load->byteCount + 1);
+    if (!load->bytes || !_MkConfGenAsyncSubmit(load)) {
+        _MkConfGenAsyncFree(load);
+        return false;
+    }
+    return true;
+#endif
+}
+
+//---------
+// Includes
+
+#define _MKCONFGEN_INCLUDE_DIRECTIVE L"@include"
+#define _MKCONFGEN_MAX_INCLUDE_DEPTH 16
+
+#ifdef _WIN32
+static SRWLOCK _mkConfGenFragmentLock = SRWLOCK_INIT;
+static _MkConfGenFragment * _mkConfGenFragments; // newest first
+#endif
+
+// Reads the path of an include directive at the start of wcs, returns false if it is malformed. pathEnd is the
+// closing quote, or the end of the line for malformed directives.
+static bool _MkConfGenReadInclude(const wchar_t * wcs, size_t length, size_t * pathBegin, size_t * pathEnd) {
+    size_t directiveLength = wcslen(_MKCONFGEN_INCLUDE_DIRECTIVE);
+    size_t i = 0;
+    bool isValid = length >= directiveLength && wmemcmp(wcs, _MKCONFGEN_INCLUDE_DIRECTIVE, directiveLength) == 0;
+    if (isValid) {
+        i = directiveLength;
+        while (i != length && (wcs[i] == L' ' || wcs[i] == L'\t')) {
+            i++;
+        }
+        isValid = i != length && wcs[i] == L'\"';
+    }
+
+    *pathBegin = isValid ? ++i : i;
+    while (i != length && wcs[i] != L'\"' && wcs[i] != L'\n') {
+        i++;
+    }
+    *pathEnd = i;
+    return isValid && i != length && wcs[i] == L'\"' && i != *pathBegin;
+}
+
+// Appends a token, text is copied into the text of the fragment. The other members of the token are zeroed.
+static bool _MkConfGenAddFragmentToken(
+    _MkConfGenFragment * fragment,
+    _MkConfGenTokenType type,
+    size_t line,
+    const wchar_t * text,
+    size_t textLength,
+    _MkConfGenToken ** token)
+{
+    if (fragment->tokenCount == fragment->tokenCapacity) {
+        size_t newCapacity = fragment->tokenCapacity ? fragment->tokenCapacity * 2 : 64;
+        _MkConfGenToken * newTokens = (_MkConfGenToken *)realloc(fragment->tokens, newCapacity * sizeof(_MkConfGenToken));
+        if (!newTokens) {
+            return false;
+        }
+        fragment->tokens = newTokens;
+        fragment->tokenCapacity = newCapacity;
+    }
+    if (fragment->textLength + textLength + 1 > fragment->textCapacity) {
+        size_t newCapacity = fragment->textCapacity ? fragment->textCapacity * 2 : 1024;
+        if (newCapacity < fragment->textLength + textLength + 1) {
+            newCapacity = fragment->textLength + textLength + 1;
+        }
+        wchar_t * newText = (wchar_t *)realloc(fragment->text, newCapacity * sizeof(wchar_t));
+        if (!newText) {
+            return false;
+        }
+        fragment->text = newText;
+        fragment->textCapacity = newCapacity;
+    }
+
+    _MkConfGenToken * tokenPtr = &fragment->tokens[fragment->tokenCount++];
+    memset(tokenPtr, 0, sizeof(_MkConfGenToken));
+    tokenPtr->type = type;
+    tokenPtr->line = line;
+    tokenPtr->textOffset = fragment->textLength;
+    tokenPtr->textLength = textLength;
+    wmemcpy(fragment->text + fragment->textLength, text, textLength);
+    fragment->text[fragment->textLength + textLength] = L'\0';
+    fragment->textLength += textLength + 1;
+    *token = tokenPtr;
+    return true;
+}
+
+// Joins a relative path to the directory of basePath, or the working directory without one, and makes it absolute.
+static wchar_t * _MkConfGenResolvePath(const wchar_t * basePath, const wchar_t * path, size_t pathLength) {
+    bool isRelative = !(pathLength != 0 && (path[0] == L'\\' || path[0] == L'/')) && !(pathLength > 1 && path[1] == L':');
+    size_t directoryLength = 0;
+    if (basePath && isRelative) {
+        for (size_t k = 0; basePath[k] != L'\0'; k++) {
+            if (basePath[k] == L'\\' || basePath[k] == L'/') {
+                directoryLength = k + 1;
+            }
+        }
+    }
+
+    wchar_t * joinedPath = (wchar_t *)malloc((directoryLength + pathLength + 1) * sizeof(wchar_t));
+    if (!joinedPath) {
+        return NULL;
+    }
+    wmemcpy(joinedPath, basePath, directoryLength);
+    wmemcpy(joinedPath + directoryLength, path, pathLength);
+    joinedPath[directoryLength + pathLength] = L'\0';
+
+#ifdef _WIN32
+    DWORD fullPathCount = GetFullPathNameW(joinedPath, 0, NULL, NULL);
+    wchar_t * fullPath = fullPathCount != 0 ? (wchar_t *)malloc(fullPathCount * sizeof(wchar_t)) : NULL;
+    if (fullPath && GetFullPathNameW(joinedPath, fullPathCount, fullPath, NULL) >= fullPathCount) {
+        free(fullPath);
+        fullPath = NULL;
+    }
+    free(joinedPath);
+    return fullPath;
+#else
+    return joinedPath;
+#endif
+}
+
+#ifdef _WIN32
+
+static BOOL CALLBACK _MkConfGenReadFragment(PINIT_ONCE, PVOID parameter, PVOID *) {
+    _MkConfGenFragment * fragment = (_MkConfGenFragment *)parameter;
+
+    HANDLE file = CreateFileW(fragment->path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file != INVALID_HANDLE_VALUE) {
+        char * bytes;
+        size_t byteCount;
+        size_t bomLength;
+        fragment->isRead = _MkConfGenReadUtf8File(file, &bytes, &byteCount, &bomLength, &fragment->source, &fragment->sourceLength);
+        if (fragment->isRead) {
+            free(bytes);
+        }
+        CloseHandle(file);
+    }
+
+    fragment->isTokenized = true;
+    if (fragment->isRead) {
+        MkConfGenLoadError * errors;
+        size_t errorCount;
+        fragment->isTokenized = _MkConfGenScan(fragment->source, fragment->sourceLength, 0, NULL, fragment->path, NULL, fragment, &errors, &errorCount);
+        free(errors);
+    }
+    return TRUE;
+}
+
+static void _MkConfGenReleaseFragment(_MkConfGenFragment * fragment) {
+    if (fragment && InterlockedDecrement(&fragment->refCount) == 0) {
+        free(fragment->source);
+        free(fragment->text);
+        free(fragment->tokens);
+        free(fragment);
+    }
+}
+
+// Returns the fragment of the file, read and tokenized by the first caller, and must be released. NULL if out of
+// memory.
+static _MkConfGenFragment * _MkConfGenGetFragment(const wchar_t * fullPath) {
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    bool exists = GetFileAttributesExW(fullPath, GetFileExInfoStandard, &attributes) != FALSE;
+    uint64_t size = exists ? ((uint64_t)attributes.nFileSizeHigh << 32) | attributes.nFileSizeLow : 0;
+    FILETIME writeTime = {};
+    if (exists) {
+        writeTime = attributes.ftLastWriteTime;
+    }
+
+    AcquireSRWLockExclusive(&_mkConfGenFragmentLock);
+    _MkConfGenFragment ** linkPtr;
+    for (linkPtr = &_mkConfGenFragments; *linkPtr; linkPtr = &(*linkPtr)->next) {
+        if (_wcsicmp((*linkPtr)->path, fullPath) == 0) {
+            break;
+        }
+    }
+    _MkConfGenFragment * fragment = *linkPtr;
+    if (!fragment || fragment->exists != exists || fragment->size != size || CompareFileTime(&fragment->writeTime, &writeTime) != 0) {
+        _MkConfGenFragment * staleFragment = fragment;
+        fragment = (_MkConfGenFragment *)calloc(1, sizeof(_MkConfGenFragment));
+        if (fragment) {
+            fragment->path = staleFragment ? staleFragment->path : _wcsdup(fullPath);
+            if (fragment->path) {
+                fragment->refCount = 1;
+                fragment->exists = exists;
+                fragment->size = size;
+                fragment->writeTime = writeTime;
+                InitOnceInitialize(&fragment->once);
+                if (staleFragment) {
+                    fragment->next = staleFragment->next;
+                    *linkPtr = fragment;
+                    _MkConfGenReleaseFragment(staleFragment);
+                } else {
+                    fragment->next = _mkConfGenFragments;
+                    _mkConfGenFragments = fragment;
+                }
+            } else {
+                free(fragment);
+                fragment = NULL;
+            }
+        }
+    }
+    if (fragment) {
+        InterlockedIncrement(&fragment->refCount);
+    }
+    ReleaseSRWLockExclusive(&_mkConfGenFragmentLock);
+
+    if (fragment) {
+        InitOnceExecuteOnce(&fragment->once, _MkConfGenReadFragment, fragment, NULL);
+    }
+    return fragment;
+}
+
+typedef struct _MkConfGenFetch {
+    const wchar_t * const * paths;
+    _MkConfGenFragment ** fragments;
+    size_t count;
+    volatile long next;
+} _MkConfGenFetch;
+
+static void _MkConfGenFetchFragments(_MkConfGenFetch * fetch) {
+    while (true) {
+        size_t k = (size_t)InterlockedIncrement(&fetch->next) - 1;
+        if (k >= fetch->count) {
+            return;
+        }
+        fetch->fragments[k] = _MkConfGenGetFragment(fetch->paths[k]);
+    }
+}
+
+static void CALLBACK _MkConfGenFetchWork(PTP_CALLBACK_INSTANCE, PVOID context, PTP_WORK) {
+    _MkConfGenFetchFragments((_MkConfGenFetch *)context);
+}
+
+// Reads and tokenizes the files and everything they include, the files of one level of includes in parallel on the
+// thread pool. This only fills the cache, failures are reported when the includes are replayed.
+static void _MkConfGenPrefetch(const wchar_t * const * paths, size_t pathCount) {
+    // All paths in the order they are found, each level of includes follows the one before.
+    const wchar_t ** levelPaths = (const wchar_t **)malloc(pathCount * sizeof(const wchar_t *));
+    _MkConfGenFragment ** fragments = (_MkConfGenFragment **)malloc(pathCount * sizeof(_MkConfGenFragment *));
+    if (!levelPaths || !fragments) {
+        free(levelPaths);
+        free(fragments);
+        return;
+    }
+    memcpy(levelPaths, paths, pathCount * sizeof(const wchar_t *));
+    size_t capacity = pathCount;
+
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo(&systemInfo);
+
+    size_t levelBegin = 0;
+    size_t levelEnd = pathCount;
+    for (size_t depth = 0; depth != _MKCONFGEN_MAX_INCLUDE_DEPTH && levelBegin != levelEnd; depth++) {
+        _MkConfGenFetch fetch = { levelPaths + levelBegin, fragments + levelBegin, levelEnd - levelBegin, 0 };
+        PTP_WORK work = fetch.count > 1 ? CreateThreadpoolWork(_MkConfGenFetchWork, &fetch, NULL) : NULL;
+        if (work) {
+            for (size_t t = 1; t != fetch.count && t != systemInfo.dwNumberOfProcessors; t++) {
+                SubmitThreadpoolWork(work);
+            }
+        }
+        _MkConfGenFetchFragments(&fetch);
+        if (work) {
+            WaitForThreadpoolWorkCallbacks(work, FALSE);
+            CloseThreadpoolWork(work);
+        }
+
+        size_t nextLevelEnd = levelEnd;
+        for (size_t k = levelBegin; k != levelEnd; k++) {
+            _MkConfGenFragment * fragment = fragments[k];
+            for (size_t t = 0; fragment && t != fragment->tokenCount; t++) {
+                if (fragment->tokens[t].type != _MKCONFGEN_TOKEN_INCLUDE) {
+                    continue;
+                }
+                const wchar_t * path = fragment->text + fragment->tokens[t].textOffset;
+                size_t p;
+                for (p = 0; p != nextLevelEnd && _wcsicmp(levelPaths[p], path) != 0; p++);
+                if (p != nextLevelEnd) {
+                    continue;
+                }
+
+                if (nextLevelEnd == capacity) {
+                    size_t newCapacity = capacity * 2;
+                    const wchar_t ** newLevelPaths = (const wchar_t **)realloc(levelPaths, newCapacity * sizeof(const wchar_t *));
+                    if (newLevelPaths) {
+                        levelPaths = newLevelPaths;
+                    }
+                    _MkConfGenFragment ** newFragments = (_MkConfGenFragment **)realloc(fragments, newCapacity * sizeof(_MkConfGenFragment *));
+                    if (newFragments) {
+                        fragments = newFragments;
+                    }
+                    if (!newLevelPaths || !newFragments) {
+                        break;
+                    }
+                    capacity = newCapacity;
+                }
+                levelPaths[nextLevelEnd++] = path;
+            }
+        }
+        levelBegin = levelEnd;
+        levelEnd = nextLevelEnd;
+    }
+
+    // Paths of the levels point into the fragments, so they are released last.
+    for (size_t k = 0; k != levelBegin; k++) {
+        _MkConfGenReleaseFragment(fragments[k]);
+    }
+    free(levelPaths);
+    free(fragments);
+}
+
+// Prefetches the files of the include directives at the line starts of the source.
+static void _MkConfGenPrefetchSource(const wchar_t * basePath, const wchar_t * wcs, size_t length) {
+    wchar_t ** paths = NULL;
+    size_t pathCount = 0;
+    for (const wchar_t * pos = wcs, * end = wcs + length; pos != end;) {
+        while (pos != end && (*pos == L' ' || *pos == L'\t')) {
+            pos++;
+        }
+
+        size_t pathBegin;
+        size_t pathEnd;
+        if (pos != end && *pos == L'@' && _MkConfGenReadInclude(pos, end - pos, &pathBegin, &pathEnd)) {
+            wchar_t ** newPaths = (wchar_t **)realloc(paths, (pathCount + 1) * sizeof(wchar_t *));
+            if (!newPaths) {
+                break;
+            }
+            paths = newPaths;
+            paths[pathCount] = _MkConfGenResolvePath(basePath, pos + pathBegin, pathEnd - pathBegin);
+            if (!paths[pathCount]) {
+                break;
+            }
+            pathCount++;
+        }
+
+        const wchar_t * lineEnd = wmemchr(pos, L'\n', end - pos);
+        pos = lineEnd ? lineEnd + 1 : end;
+    }
+
+    if (pathCount != 0) {
+        _MkConfGenPrefetch(paths, pathCount);
+    }
+    for (size_t k = 0; k != pathCount; k++) {
+        free(paths[k]);
+    }
+    free(paths);
+}
+
+static bool _MkConfGenIncludeFragment(
+    _MkConfGenFragment ** stack,
+    size_t depth,
+    const wchar_t * fullPath,
+    size_t line,
+    const wchar_t * file,
+    size_t sectionCount,
+    const _MkConfGenSection * sections,
+    const _MkConfGenSection * section,
+    MkConfGenLoadError ** errors,
+    size_t * errorCount);
+
+// Hands the values of the innermost fragment of the stack to the sections like the scanner, starting in the given
+// section. Errors are reported with the given file.
+static bool _MkConfGenReplay(
+    _MkConfGenFragment ** stack,
+    size_t depth,
+    const wchar_t * file,
+    size_t sectionCount,
+    const _MkConfGenSection * sections,
+    const _MkConfGenSection * section,
+    MkConfGenLoadError ** errors,
+    size_t * errorCount)
+{
+    const _MkConfGenFragment * fragment = stack[depth - 1];
+    bool memoryError = false;
+
+    for (size_t k = 0; k != sectionCount; k++) {
+        if (sections[k].prepareCallback && !sections[k].prepareCallback(sections[k].config, fragment->source, fragment->sourceLength)) {
+            memoryError = true;
+        }
+    }
+
+    bool isSkipped = false;
+    for (size_t t = 0; t != fragment->tokenCount; t++) {
+        const _MkConfGenToken * token = &fragment->tokens[t];
+        if (token->type == _MKCONFGEN_TOKEN_HEADER) {
+            isSkipped = false;
+            section = token->value ? _MkConfGenFindSection(token->value, token->valueLength, sectionCount, sections, &isSkipped) : NULL;
+            if (!section) {
+                memoryError |= !_MkConfGenAddError(errors, errorCount, MKCONFGEN_LOAD_ERROR_SECTION, token->line, file);
+            }
+            continue;
+        }
+        if (isSkipped) {
+            continue;
+        }
+
+        if (token->type == _MKCONFGEN_TOKEN_ERROR) {
+            memoryError |= !_MkConfGenAddError(errors, errorCount, token->errorType, token->line, file);
+        } else if (token->type == _MKCONFGEN_TOKEN_INCLUDE) {
+            memoryError |= !_MkConfGenIncludeFragment(
+                stack,
+                depth,
+                fragment->text + token->textOffset,
+                token->line,
+                file,
+                sectionCount,
+                sections,
+                section,
+                errors,
+                errorCount);
+        } else if (section) {
+            const wchar_t * key = fragment->text + token->textOffset;
+            size_t j;
+            for (j = 0; j != section->keyCount; j++) {
+                size_t index = section->keyIndices[j];
+                size_t length = section->keyIndices[j + 1] - index;
+                if (length == token->textLength && wcsncmp(key, section->keys + index, length) == 0) {
+                    break;
+                }
+            }
+            if (j == section->keyCount) {
+                continue;
+            }
+
+            wchar_t buffer[MK_CONF_MAX_VALUE_COUNT];
+            size_t rawValueLength;
+            wchar_t * rawValue = _MkConfGenRawValue(const_cast<wchar_t *>(token->value), token->valueLength, token->isStr, buffer, &rawValueLength);
+            MkConfGenLoadErrorType parseErrorType;
+            if (!section->parseValueCallback(section->config, j, token->row, token->mapKey, token->mapKeyLength, rawValue, rawValueLength, token->isStr, &parseErrorType)) {
+                memoryError |= !_MkConfGenAddError(errors, errorCount, parseErrorType, token->line, file);
+            }
+        }
+    }
+    return !memoryError;
+}
+
+// Replays the included file on top of the stack. line and file are those of the include directive.
+static bool _MkConfGenIncludeFragment(
+    _MkConfGenFragment ** stack,
+    size_t depth,
+    const wchar_t * fullPath,
+    size_t line,
+    const wchar_t * file,
+    size_t sectionCount,
+    const _MkConfGenSection * sections,
+    const _MkConfGenSection * section,
+    MkConfGenLoadError ** errors,
+    size_t * errorCount)
+{
+    _MkConfGenFragment * fragment = _MkConfGenGetFragment(fullPath);
+    if (!fragment || !fragment->isTokenized) {
+        _MkConfGenReleaseFragment(fragment);
+        return false;
+    }
+
+    bool isCycle = depth == _MKCONFGEN_MAX_INCLUDE_DEPTH;
+    for (size_t k = 0; k != depth && !isCycle; k++) {
+        isCycle = stack[k] == fragment;
+    }
+    if (!fragment->isRead || isCycle) {
+        _MkConfGenReleaseFragment(fragment);
+        return _MkConfGenAddError(errors, errorCount, MKCONFGEN_LOAD_ERROR_INCLUDE, line, file);
+    }
+
+    stack[depth] = fragment;
+    bool isReplayed = _MkConfGenReplay(stack, depth + 1, fragment->path, sectionCount, sections, section, errors, errorCount);
+    _MkConfGenReleaseFragment(fragment);
+    return isReplayed;
+}
+
+// Includes a file into the source being scanned, which has no fragment of its own.
+static bool _MkConfGenInclude(
+    const wchar_t * basePath,
+    const wchar_t * path,
+    size_t pathLength,
+    size_t line,
+    size_t sectionCount,
+    const _MkConfGenSection * sections,
+    const _MkConfGenSection * section,
+    MkConfGenLoadError ** errors,
+    size_t * errorCount)
+{
+    wchar_t * fullPath = _MkConfGenResolvePath(basePath, path, pathLength);
+    if (!fullPath) {
+        return false;
+    }
+    _MkConfGenFragment * stack[_MKCONFGEN_MAX_INCLUDE_DEPTH];
+    bool isIncluded = _MkConfGenIncludeFragment(stack, 0, fullPath, line, NULL, sectionCount, sections, section, errors, errorCount);
+    free(fullPath);
+    return isIncluded;
+}
+
+bool _MkConfGenLoadFile(
+    const wchar_t * path,
+    size_t sectionCount,
+    const _MkConfGenSection * sections,
+    MkConfGenLoadError ** errors,
+    size_t * errorCount)
+{
+    _MKCONFGEN_ASSERT(path);
+    _MKCONFGEN_ASSERT(sections && sectionCount != 0 && !sections[0].isLazy);
+    _MKCONFGEN_ASSERT(errors);
+    _MKCONFGEN_ASSERT(errorCount);
+
+    *errors = NULL;
+    *errorCount = 0;
+
+    wchar_t * fullPath = _MkConfGenResolvePath(NULL, path, wcslen(path));
+    if (!fullPath) {
+        return false;
+    }
+    _MkConfGenPrefetch(&fullPath, 1);
+    _MkConfGenFragment * fragment = _MkConfGenGetFragment(fullPath);
+    free(fullPath);
+    if (!fragment || !fragment->isRead || !fragment->isTokenized) {
+        _MkConfGenReleaseFragment(fragment);
+        return false;
+    }
+
+    // Errors of the file itself have no path, like with the other loaders.
+    _MkConfGenFragment * stack[_MKCONFGEN_MAX_INCLUDE_DEPTH] = { fragment };
+    bool isReplayed = _MkConfGenReplay(stack, 1, NULL, sectionCount, sections, sections[0].name ? NULL : sections, errors, errorCount);
+    _MkConfGenReleaseFragment(fragment);
+    return isReplayed;
+}
+
+void MkConfGenClearFragments(void) {
+    AcquireSRWLockExclusive(&_mkConfGenFragmentLock);
+    while (_mkConfGenFragments) {
+        _MkConfGenFragment * fragment = _mkConfGenFragments;
+        _mkConfGenFragments = fragment->next;
+        free(fragment->path);
+        _MkConfGenReleaseFragment(fragment);
+    }
+    ReleaseSRWLockExclusive(&_mkConfGenFragmentLock);
+}
+#else
+// Without the fragment cache includes can't be read, they are reported as errors of their line.
+static void _MkConfGenPrefetchSource(const wchar_t *, const wchar_t *, size_t) {
+}
+
+static bool _MkConfGenInclude(
+    const wchar_t *,
+    const wchar_t *,
+    size_t,
+    size_t line,
+    size_t,
+    const _MkConfGenSection *,
+    const _MkConfGenSection *,
+    MkConfGenLoadError ** errors,
+    size_t * errorCount)
+{
+    return _MkConfGenAddError(errors, errorCount, MKCONFGEN_LOAD_ERROR_INCLUDE, line, NULL);
+}
+#endif
+
+//-----------
+// Reflection
+
+// Must match the generator, item keys are hashed with 64-bit FNV-1a and mixed with the SplitMix64 finalizer.
+static uint64_t _MkConfGenMixItemHash(uint64_t hash) {
+    hash ^= hash >> 30;
+    hash *= 0xbf58476d1ce4e5b9ull;
+    hash ^= hash >> 27;
+    hash *= 0x94d049bb133111ebull;
+    hash ^= hash >> 31;
+    return hash;
+}
+
+// Returns the index + 1 of the only key that can have the name, 0 if there is none.
+static uint32_t _MkConfGenProbeItemHash(const _MkConfGenItemHash * hash, const wchar_t * name, size_t nameLength) {
+    uint64_t keyHash = 14695981039346656037ull;
+    for (size_t i = 0; i != nameLength; i++) {
+        keyHash ^= (uint64_t)name[i];
+        keyHash *= 1099511628211ull;
+    }
+
+    uint32_t seed = hash->seeds[_MkConfGenMixItemHash(keyHash) & hash->bucketMask];
+    return hash->slots[_MkConfGenMixItemHash(keyHash ^ seed) & hash->slotMask];
+}
+
+size_t _MkConfGenFindItem(const _MkConfGenItemHash * hash, const MkConfGenItemInfo * infos, const wchar_t * name, size_t nameLength) {
+    _MKCONFGEN_ASSERT(hash);
+    _MKCONFGEN_ASSERT(infos);
+    _MKCONFGEN_ASSERT(name || nameLength == 0);
+
+    uint32_t entry = _MkConfGenProbeItemHash(hash, name, nameLength);
+    if (entry == 0) {
+        return SIZE_MAX;
+    }
+
+    const MkConfGenItemInfo * infoPtr = &infos[entry - 1];
+    if (infoPtr->nameLength != nameLength || wmemcmp(infoPtr->name, name, nameLength) != 0) {
+        return SIZE_MAX;
+    }
+    return entry - 1;
+}
+
+bool _MkConfGenSetFromText(
+    _MkConfGenParseValueCallback parseValueCallback,
+    void * config,
+    size_t index,
+    size_t row,
+    const wchar_t * mapKey,
+    size_t mapKeyLength,
+    const wchar_t * text,
+    size_t textLength,
+    MkConfGenLoadErrorType * errorType)
+{
+    _MKCONFGEN_ASSERT(parseValueCallback);
+    _MKCONFGEN_ASSERT(config);
+    _MKCONFGEN_ASSERT(text || textLength == 0);
+    _MKCONFGEN_ASSERT(errorType);
+
+    bool isStr = textLength >= 2 && text[0] == L'\"' && text[textLength - 1] == L'\"';
+    bool isList = !isStr && textLength != 0 && text[0] == L'[';
+    if (!isList && textLength >= MK_CONF_MAX_VALUE_COUNT) {
+        *errorType = MKCONFGEN_LOAD_ERROR_VALUE_LENGTH;
+        return false;
+    }
+
+    // Lists are parsed in place and the parsers rely on a terminator, so the text is copied.
+    wchar_t * value = (wchar_t *)malloc((textLength + 1) * sizeof(wchar_t));
+    if (!value) {
+        *errorType = MKCONFGEN_LOAD_ERROR_MEMORY;
+        return false;
+    }
+    wmemcpy(value, text, textLength);
+    value[textLength] = L'\0';
+
+    wchar_t buffer[MK_CONF_MAX_VALUE_COUNT];
+    size_t rawValueLength;
+    wchar_t * rawValue = _MkConfGenRawValue(value, textLength, isStr, buffer, &rawValueLength);
+    bool isSet = parseValueCallback(config, index, row, mapKey, mapKeyLength, rawValue, rawValueLength, isStr, errorType);
+    free(value);
+    return isSet;
+}
+
+//------
+// Packs
+
+// Checks that count elements of the given size at offset lie within the file.
+static bool _MkConfGenPackHasRange(const MkConfGenPack * pack, uint64_t offset, uint64_t count, size_t elemSize) {
+    return offset <= pack->size && count <= (pack->size - offset) / elemSize;
+}
+
+#ifdef _WIN32
+bool MkConfGenPackOpen(MkConfGenPack * pack, const wchar_t * path) {
+    _MKCONFGEN_ASSERT(pack);
+    _MKCONFGEN_ASSERT(path);
+
+    HANDLE file = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || (uint64_t)fileSize.QuadPart < sizeof(_MkConfGenPackHeader)
+        || (uint64_t)fileSize.QuadPart > SIZE_MAX)
+    {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    const _MkConfGenPackHeader * header = NULL;
+    if (mapping) {
+        header = (const _MkConfGenPackHeader *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    }
+    if (!header) {
+        if (mapping) {
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+        return false;
+    }
+
+    pack->file = file;
+    pack->mapping = mapping;
+    pack->header = header;
+    pack->size = (size_t)fileSize.QuadPart;
+
+    // The tables are checked once here, entries are checked when they are read.
+    bool isValid = header->magic == _MKCONFGEN_PACK_MAGIC
+        && header->version == _MKCONFGEN_PACK_VERSION
+        && header->charSize == sizeof(wchar_t)
+        && header->fileSize == (uint64_t)fileSize.QuadPart
+        && header->bucketCount != 0 && (header->bucketCount & (header->bucketCount - 1)) == 0
+        && header->slotCount != 0 && (header->slotCount & (header->slotCount - 1)) == 0
+        && header->seedsOffset % sizeof(uint32_t) == 0
+        && header->slotsOffset % sizeof(uint32_t) == 0
+        && header->entriesOffset % sizeof(uint64_t) == 0
+        && _MkConfGenPackHasRange(pack, header->seedsOffset, header->bucketCount, sizeof(uint32_t))
+        && _MkConfGenPackHasRange(pack, header->slotsOffset, header->slotCount, sizeof(uint32_t))
+        && _MkConfGenPackHasRange(pack, header->entriesOffset, header->memberCount, sizeof(_MkConfGenPackEntry));
+    if (!isValid) {
+        MkConfGenPackClose(pack);
+        return false;
+    }
+    return true;
+}
+
+void MkConfGenPackClose(MkConfGenPack * pack) {
+    _MKCONFGEN_ASSERT(pack);
+    UnmapViewOfFile(pack->header);
+    CloseHandle(pack->mapping);
+    CloseHandle(pack->file);
+}
+#endif
+
+size_t MkConfGenPackCount(const MkConfGenPack * pack) {
+    _MKCONFGEN_ASSERT(pack);
+    return (size_t)pack->header->memberCount;
+}
+
+bool MkConfGenPackGet(const MkConfGenPack * pack, size_t index, MkConfGenPackMember * member) {
+    _MKCONFGEN_ASSERT(pack);
+    _MKCONFGEN_ASSERT(index < pack->header->memberCount);
+    _MKCONFGEN_ASSERT(member);
+
+    const char * base = (const char *)pack->header;
+    const _MkConfGenPackEntry * entry = (const _MkConfGenPackEntry *)(base + pack->header->entriesOffset) + index;
+    if (entry->nameOffset % sizeof(wchar_t) != 0
+        || !_MkConfGenPackHasRange(pack, entry->nameOffset, entry->nameLength, sizeof(wchar_t))
+        || entry->dataOffset % sizeof(uint64_t) != 0
+        || !_MkConfGenPackHasRange(pack, entry->dataOffset, entry->dataSize, 1)
+        || (entry->isText && (entry->dataSize % sizeof(wchar_t) != 0
+            || !_MkConfGenPackHasRange(pack, entry->dataOffset, entry->dataSize / sizeof(wchar_t) + 1, sizeof(wchar_t)))))
+    {
+        return false;
+    }
+
+    member->name = (const wchar_t *)(base + entry->nameOffset);
+    member->nameLength = (size_t)entry->nameLength;
+    member->data = base + entry->dataOffset;
+    member->size = (size_t)entry->dataSize;
+    member->isText = entry->isText != 0;
+    return true;
+}
+
+bool MkConfGenPackFind(const MkConfGenPack * pack, const wchar_t * name, size_t nameLength, MkConfGenPackMember * member) {
+    _MKCONFGEN_ASSERT(pack);
+    _MKCONFGEN_ASSERT(name || nameLength == 0);
+    _MKCONFGEN_ASSERT(member);
+
+    const _MkConfGenPackHeader * header = pack->header;
+    const char * base = (const char *)header;
+    const _MkConfGenItemHash hash = {
+        (size_t)header->bucketCount - 1,
+        (const uint32_t *)(base + header->seedsOffset),
+        (size_t)header->slotCount - 1,
+        (const uint32_t *)(base + header->slotsOffset)
+    };
+    uint32_t entry = _MkConfGenProbeItemHash(&hash, name, nameLength);
+    if (entry == 0 || entry > header->memberCount || !MkConfGenPackGet(pack, entry - 1, member)) {
+        return false;
+    }
+    return member->nameLength == nameLength && wmemcmp(member->name, name, nameLength) == 0;
+}
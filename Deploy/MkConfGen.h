@@ -25,6 +25,8 @@ SOFTWARE.
 #ifndef _MKCONFGEN_H
 #define _MKCONFGEN_H
 
+#include <atomic>
+#include <stdint.h>
 #include <stdlib.h>
 #include <wchar.h>
 #include <wctype.h>
@@ -41,17 +43,134 @@ SOFTWARE.
 #define MKCONFGEN_FILE_BEGIN
 #define MKCONFGEN_FILE_END
 
+// Arrays are checked with their elements and count, like the generated code passes them to validate callbacks.
+template <typename T, size_t MaxCount>
+struct _MkConfGenCheckArray {
+    T elems[MaxCount];
+    size_t count;
+};
+
+template <typename Callback, typename T>
+bool _MkConfGenCheckValidate(Callback callback, T & value) {
+    return callback(value);
+}
+
+template <typename Callback, typename T, size_t MaxCount>
+bool _MkConfGenCheckValidate(Callback callback, _MkConfGenCheckArray<T, MaxCount> & array) {
+    return callback(array.elems, array.count);
+}
+
+// ONE_OF lists are checked at compile time against the default, which items that can have one keep in a constant
+// next to the item. Maps have no default.
+typedef struct _MkConfGenNoDefault {} _MkConfGenNoDefault;
+
+template <typename T>
+struct _MkConfGenOneOfElem {
+    typedef T Type;
+};
+
+template <size_t Count>
+struct _MkConfGenOneOfElem<wchar_t[Count]> {
+    typedef const wchar_t * Type;
+};
+
+template <typename T>
+constexpr bool _MkConfGenIsOneOfEqual(T value, T other) {
+    return value == other;
+}
+
+constexpr bool _MkConfGenIsOneOfEqual(const wchar_t * value, const wchar_t * other) {
+    while (*value != L'\0' && *value == *other) {
+        value++;
+        other++;
+    }
+    return *value == *other;
+}
+
+template <typename V, typename T, size_t Count>
+constexpr bool _MkConfGenIsOneOf(const V & value, const T (&values)[Count]) {
+    for (size_t k = 0; k != Count; k++) {
+        if (_MkConfGenIsOneOfEqual((T)value, values[k])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename T, size_t Count>
+constexpr bool _MkConfGenIsOneOf(_MkConfGenNoDefault, const T (&)[Count]) {
+    return true;
+}
+
+template <typename T, size_t Count>
+constexpr bool _MkConfGenAreOneOfDistinct(const T (&values)[Count]) {
+    for (size_t k = 0; k != Count; k++) {
+        for (size_t l = k + 1; l != Count; l++) {
+            if (_MkConfGenIsOneOfEqual(values[k], values[l])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+#define _MKCONFGEN_CHECK_TYPE_INT long
+#define _MKCONFGEN_CHECK_TYPE_UINT unsigned long
+#define _MKCONFGEN_CHECK_TYPE_FLOAT double
+#define _MKCONFGEN_CHECK_TYPE_BOOL bool
+#define _MKCONFGEN_CHECK_TYPE_I8 int8_t
+#define _MKCONFGEN_CHECK_TYPE_I16 int16_t
+#define _MKCONFGEN_CHECK_TYPE_I32 int32_t
+#define _MKCONFGEN_CHECK_TYPE_I64 int64_t
+#define _MKCONFGEN_CHECK_TYPE_U8 uint8_t
+#define _MKCONFGEN_CHECK_TYPE_U16 uint16_t
+#define _MKCONFGEN_CHECK_TYPE_U32 uint32_t
+#define _MKCONFGEN_CHECK_TYPE_U64 uint64_t
+
+#define _MKCONFGEN_CHECK_DEFAULT(itemName, defaultValue) [[maybe_unused]] constexpr auto _mkConfGenDefault_##itemName = defaultValue;
+
 #define MKCONFGEN_DEF_BEGIN(confName) void _MkConfGenCheck##confName() { bool validateResult;
 #define MKCONFGEN_DEF_END }
 
 #define MKCONFGEN_HEADING(headingName)
 
-#define MKCONFGEN_ITEM_INT(itemName, defaultValue) long itemName = defaultValue;
-#define MKCONFGEN_ITEM_UINT(itemName, defaultValue) unsigned long itemName = defaultValue;
+#define MKCONFGEN_ITEM_INT(itemName, defaultValue) long itemName = defaultValue; _MKCONFGEN_CHECK_DEFAULT(itemName, defaultValue)
+#define MKCONFGEN_ITEM_UINT(itemName, defaultValue) unsigned long itemName = defaultValue; _MKCONFGEN_CHECK_DEFAULT(itemName, defaultValue)
 #define MKCONFGEN_ITEM_FLOAT(itemName, defaultValue) double itemName = defaultValue;
-#define MKCONFGEN_ITEM_WSTR(itemName, count, defaultValue) wchar_t itemName[count] = defaultValue;
+#define MKCONFGEN_ITEM_WSTR(itemName, count, defaultValue) wchar_t itemName[count] = defaultValue; _MKCONFGEN_CHECK_DEFAULT(itemName, defaultValue)
+#define MKCONFGEN_ITEM_BOOL(itemName, defaultValue) bool itemName = defaultValue;
+#define MKCONFGEN_ITEM_I8(itemName, defaultValue) int8_t itemName = defaultValue; _MKCONFGEN_CHECK_DEFAULT(itemName, defaultValue)
+#define MKCONFGEN_ITEM_I16(itemName, defaultValue) int16_t itemName = defaultValue; _MKCONFGEN_CHECK_DEFAULT(itemName, defaultValue)
+#define MKCONFGEN_ITEM_I32(itemName, defaultValue) int32_t itemName = defaultValue; _MKCONFGEN_CHECK_DEFAULT(itemName, defaultValue)
+#define MKCONFGEN_ITEM_I64(itemName, defaultValue) int64_t itemName = defaultValue; _MKCONFGEN_CHECK_DEFAULT(itemName, defaultValue)
+#define MKCONFGEN_ITEM_U8(itemName, defaultValue) uint8_t itemName = defaultValue; _MKCONFGEN_CHECK_DEFAULT(itemName, defaultValue)
+#define MKCONFGEN_ITEM_U16(itemName, defaultValue) uint16_t itemName = defaultValue; _MKCONFGEN_CHECK_DEFAULT(itemName, defaultValue)
+#define MKCONFGEN_ITEM_U32(itemName, defaultValue) uint32_t itemName = defaultValue; _MKCONFGEN_CHECK_DEFAULT(itemName, defaultValue)
+#define MKCONFGEN_ITEM_U64(itemName, defaultValue) uint64_t itemName = defaultValue; _MKCONFGEN_CHECK_DEFAULT(itemName, defaultValue)
+#define MKCONFGEN_ITEM_DURATION(itemName, defaultValue) uint64_t itemName = 0;
+#define MKCONFGEN_ITEM_SIZE(itemName, defaultValue) uint64_t itemName = 0;
+#define MKCONFGEN_ITEM_ENUM(itemName, enumName, defaultValue, ...) \
+    enum class _MkConfGenCheck##itemName __VA_ARGS__; \
+    _MkConfGenCheck##itemName itemName = _MkConfGenCheck##itemName::defaultValue;
+#define MKCONFGEN_ITEM_INT_ARRAY(itemName, maxCount, ...) _MkConfGenCheckArray<long, maxCount> itemName = { __VA_ARGS__, maxCount };
+#define MKCONFGEN_ITEM_FLOAT_ARRAY(itemName, maxCount, ...) _MkConfGenCheckArray<double, maxCount> itemName = { __VA_ARGS__, maxCount };
+#define MKCONFGEN_ITEM_STR_ARRAY(itemName, maxCount, count, ...) _MkConfGenCheckArray<wchar_t[count], maxCount> itemName = { __VA_ARGS__, maxCount };
+#define MKCONFGEN_ITEM_MAP(itemName, valueType) \
+    _MKCONFGEN_CHECK_TYPE_##valueType itemName = 0; \
+    [[maybe_unused]] constexpr _MkConfGenNoDefault _mkConfGenDefault_##itemName = {};
 
-#define MKCONFGEN_VALIDATE(itemName, callback) validateResult = callback(itemName);
+#define MKCONFGEN_TABLE_BEGIN(tableName, maxRows) { static_assert(maxRows > 0, "empty table");
+#define MKCONFGEN_TABLE_END }
+
+#define MKCONFGEN_VALIDATE(itemName, callback) validateResult = _MkConfGenCheckValidate(callback, itemName);
+#define MKCONFGEN_RANGE(itemName, minValue, maxValue) validateResult = itemName >= (minValue) && itemName <= (maxValue);
+#define MKCONFGEN_MAX_LEN(itemName, maxLength) validateResult = wcslen(itemName) <= (maxLength);
+#define MKCONFGEN_ONE_OF(itemName, ...) { \
+    static constexpr typename _MkConfGenOneOfElem<decltype(itemName)>::Type _mkConfGenOneOf[] = __VA_ARGS__; \
+    static_assert(_MkConfGenAreOneOfDistinct(_mkConfGenOneOf), "duplicate ONE_OF value of " #itemName); \
+    static_assert(_MkConfGenIsOneOf(_mkConfGenDefault_##itemName, _mkConfGenOneOf), "default of " #itemName " not in ONE_OF"); \
+    validateResult = _MkConfGenIsOneOf(itemName, _mkConfGenOneOf); }
+#define MKCONFGEN_PATTERN(itemName, pattern) { (void)itemName; static_assert(sizeof(pattern) > sizeof(pattern[0]), "empty pattern"); }
 #else
 #define _MKCONFGEN_ASSERT(E)
 
@@ -67,8 +186,31 @@ SOFTWARE.
 #define MKCONFGEN_ITEM_UINT(itemName, defaultValue)
 #define MKCONFGEN_ITEM_FLOAT(itemName, defaultValue)
 #define MKCONFGEN_ITEM_WSTR(itemName, count, defaultValue)
+#define MKCONFGEN_ITEM_BOOL(itemName, defaultValue)
+#define MKCONFGEN_ITEM_I8(itemName, defaultValue)
+#define MKCONFGEN_ITEM_I16(itemName, defaultValue)
+#define MKCONFGEN_ITEM_I32(itemName, defaultValue)
+#define MKCONFGEN_ITEM_I64(itemName, defaultValue)
+#define MKCONFGEN_ITEM_U8(itemName, defaultValue)
+#define MKCONFGEN_ITEM_U16(itemName, defaultValue)
+#define MKCONFGEN_ITEM_U32(itemName, defaultValue)
+#define MKCONFGEN_ITEM_U64(itemName, defaultValue)
+#define MKCONFGEN_ITEM_DURATION(itemName, defaultValue)
+#define MKCONFGEN_ITEM_SIZE(itemName, defaultValue)
+#define MKCONFGEN_ITEM_ENUM(itemName, enumName, defaultValue, ...)
+#define MKCONFGEN_ITEM_INT_ARRAY(itemName, maxCount, ...)
+#define MKCONFGEN_ITEM_FLOAT_ARRAY(itemName, maxCount, ...)
+#define MKCONFGEN_ITEM_STR_ARRAY(itemName, maxCount, count, ...)
+#define MKCONFGEN_ITEM_MAP(itemName, valueType)
+
+#define MKCONFGEN_TABLE_BEGIN(tableName, maxRows)
+#define MKCONFGEN_TABLE_END
 
 #define MKCONFGEN_VALIDATE(itemName, callback)
+#define MKCONFGEN_RANGE(itemName, minValue, maxValue)
+#define MKCONFGEN_MAX_LEN(itemName, maxLength)
+#define MKCONFGEN_ONE_OF(itemName, ...)
+#define MKCONFGEN_PATTERN(itemName, pattern)
 #endif
 
 #define MK_CONF_MAX_KEY_COUNT 64
@@ -85,30 +227,743 @@ typedef enum MkConfGenLoadErrorType {
     MKCONFGEN_LOAD_ERROR_VALUE_TYPE, // The value has the wrong type.
     MKCONFGEN_LOAD_ERROR_VALUE_OVERFLOW, // The numeric value is out of bounds or the string value is too long.
     MKCONFGEN_LOAD_ERROR_VALUE_INVALID, // The value is invalid.
+    MKCONFGEN_LOAD_ERROR_KEY_INDEX, // The row index of a table key is out of bounds.
+    MKCONFGEN_LOAD_ERROR_MEMORY, // There was not enough memory to store the value.
+    MKCONFGEN_LOAD_ERROR_KEY_OVERLAY, // The item can't be overridden by an overlay.
+    MKCONFGEN_LOAD_ERROR_SECTION, // The section header is malformed or names an unknown config or heading.
+    MKCONFGEN_LOAD_ERROR_INCLUDE, // The included file can't be read, includes itself or is nested too deeply.
 } MkConfGenLoadErrorType;
 
 typedef struct MkConfGenLoadError {
     MkConfGenLoadErrorType type;
     size_t line;
+    const wchar_t * file; // full path of the included file, NULL for the loaded source
 } MkConfGenLoadError;
 
+// List values point into the config buffer and are not NULL-terminated. row is the index given in table keys like
+// "name[3].column", SIZE_MAX for all other keys. mapKey is the part after the dot in map keys like "name.key" and
+// points into the config buffer as well, it is NULL for all other keys.
 typedef bool (*_MkConfGenParseValueCallback)(
     void * config,
     size_t index,
+    size_t row,
+    const wchar_t * mapKey,
+    size_t mapKeyLength,
     wchar_t * rawValue,
     size_t rawValueLength,
     bool isStr,
     MkConfGenLoadErrorType * errorType);
 
+// Accepts true/false, on/off and 1/0.
+bool _MkConfGenParseBool(const wchar_t * rawValue, size_t rawValueLength, bool * value);
+
+// Unit-suffixed values like 250ms or 4KiB. Durations are converted to milliseconds (ms, s, min, h, d), sizes to bytes
+// (B, KB, MB, GB, TB and KiB, MiB, GiB, TiB).
+bool _MkConfGenParseDuration(const wchar_t * rawValue, size_t rawValueLength, uint64_t * value, MkConfGenLoadErrorType * errorType);
+bool _MkConfGenParseSize(const wchar_t * rawValue, size_t rawValueLength, uint64_t * value, MkConfGenLoadErrorType * errorType);
+
+// List values are passed including the enclosing brackets. The elements are written into values, count is only set
+// on success.
+
+bool _MkConfGenParseIntArray(
+    const wchar_t * rawValue,
+    size_t rawValueLength,
+    long * values,
+    size_t maxCount,
+    size_t * count,
+    MkConfGenLoadErrorType * errorType);
+
+bool _MkConfGenParseFloatArray(
+    const wchar_t * rawValue,
+    size_t rawValueLength,
+    double * values,
+    size_t maxCount,
+    size_t * count,
+    MkConfGenLoadErrorType * errorType);
+
+// Each string occupies strCount characters including the NULL-terminator.
+bool _MkConfGenParseWstrArray(
+    const wchar_t * rawValue,
+    size_t rawValueLength,
+    wchar_t * values,
+    size_t maxCount,
+    size_t strCount,
+    size_t * count,
+    MkConfGenLoadErrorType * errorType);
+
+// DFA of a MKCONFGEN_PATTERN constraint. Characters are mapped to classes, ASCII through the table and all others
+// through the sorted ranges, each ending at its last character.
+typedef struct _MkConfGenPattern {
+    const uint8_t * asciiClasses;
+    size_t rangeCount;
+    const uint32_t * rangeLasts;
+    const uint8_t * rangeClasses;
+    size_t classCount;
+    const uint16_t * transitions; // classCount entries per state, state 0 is the start
+    const bool * isAccepting;
+    size_t deadState; // SIZE_MAX if there is none
+} _MkConfGenPattern;
+
+// Matches the whole value.
+bool _MkConfGenMatchPattern(const _MkConfGenPattern * pattern, const wchar_t * value, size_t valueLength);
+
+//-----
+// Maps
+
+typedef struct MkConfGenMapSlot {
+    uint32_t hash;
+    uint32_t entry; // entry index + 1, 0 for empty slots
+} MkConfGenMapSlot;
+
+// Flat open-addressing hash table with linear probing. Entries are stored densely in insertion order, their keys are
+// interned back to back in one arena. Everything lives in a single allocation that is sized up front, inserting never
+// rehashes.
+typedef struct MkConfGenMap {
+    size_t count;
+    size_t capacity; // maximum entry count
+    size_t slotMask; // slot count - 1
+    size_t keyArenaLength;
+    size_t keyArenaCapacity;
+    size_t valueSize;
+    MkConfGenMapSlot * slots;
+    unsigned char * values; // valueSize bytes per entry
+    size_t * keyOffsets; // capacity + 1 offsets into the arena
+    wchar_t * keyArena;
+} MkConfGenMap;
+
+// Returns the value stored for the key or NULL.
+const void * MkConfGenMapFind(const MkConfGenMap * map, const wchar_t * key, size_t keyLength);
+
+// Entries can be iterated by index in insertion order. The key is not NULL-terminated.
+const wchar_t * MkConfGenMapKey(const MkConfGenMap * map, size_t index, size_t * keyLength);
+const void * MkConfGenMapValue(const MkConfGenMap * map, size_t index);
+
+// Makes room for additional entries and key characters, existing entries are kept.
+bool _MkConfGenMapReserve(MkConfGenMap * map, size_t additionalCount, size_t additionalKeyLength, size_t valueSize);
+
+// Returns the value of the existing or newly added entry, NULL if the reserved space is exhausted.
+void * _MkConfGenMapInsert(MkConfGenMap * map, const wchar_t * key, size_t keyLength);
+
+void _MkConfGenMapFree(MkConfGenMap * map);
+
+// Copies the entries of source into a new allocation of map, which is overwritten. An empty map on failure.
+bool _MkConfGenMapCopy(MkConfGenMap * map, const MkConfGenMap * source);
+
+//---------
+// Overlays
+
+// Sparse set of overridden items on top of a shared base config. A presence bitmap tells whether an item is
+// overridden, its rank within the bitmap gives the index of its dense value slot, so reads stay O(1).
+typedef struct MkConfGenOverlay {
+    size_t itemCount;
+    size_t count;
+    uint64_t * presence; // one bit per item
+    uint32_t * ranks; // overrides before each bitmap word
+    uint32_t * offsets; // value offset per slot
+    unsigned char * values;
+} MkConfGenOverlay;
+
+// Returns the overriding value of the item or NULL if the base value applies.
+const void * MkConfGenOverlayFind(const MkConfGenOverlay * overlay, size_t index);
+
+// Allocates one value slot of valueSizes[index] bytes per item set in presence, slots are 8-byte aligned.
+bool _MkConfGenOverlayAlloc(MkConfGenOverlay * overlay, size_t itemCount, const uint64_t * presence, const size_t * valueSizes);
+
+void _MkConfGenOverlayFree(MkConfGenOverlay * overlay);
+
+//-----------
+// Lazy Items
+
+// Value span of a lazily parsed item in the retained source, parsed on first access.
+typedef struct _MkConfGenLazyItem {
+    size_t offset; // SIZE_MAX if the item was not set
+    size_t length;
+    std::atomic<long> state; // 0 unparsed, 1 being parsed, 2 parsed
+    bool isStr;
+} _MkConfGenLazyItem;
+
+// Turns a value as written in the source into the form the parse callbacks expect. Strings are unquoted and unescaped
+// into the buffer of MK_CONF_MAX_VALUE_COUNT characters, lists are returned in place.
+wchar_t * _MkConfGenRawValue(wchar_t * value, size_t valueLength, bool isStr, wchar_t * buffer, size_t * rawValueLength);
+
+// Parses the item exactly once, even when called from several threads at the same time.
+void _MkConfGenLazyParse(
+    _MkConfGenLazyItem * item,
+    const wchar_t * source,
+    size_t index,
+    _MkConfGenParseValueCallback parseValueCallback,
+    void * config);
+
+// Counting pre-pass over a config file: number of lines and key characters per map prefix ("name." is matched).
+void _MkConfGenCountMapKeys(
+    const wchar_t * configWcs,
+    size_t configLength,
+    size_t mapCount,
+    const wchar_t * const * mapNames,
+    size_t * keyCounts,
+    size_t * keyLengths);
+
 bool _MkConfGenLoad(
     const wchar_t * configWcs,
     size_t configLength,
     size_t keyCount,
     const size_t * keyIndices,
     const wchar_t * keys,
+    size_t headingCount,
+    const wchar_t * const * headings,
+    uint64_t headingMask,
     _MkConfGenParseValueCallback parseValueCallback,
     void * config,
     MkConfGenLoadError ** errors,
     size_t * errorCount);
 
+// Prepares the config for loading the whole source, for example by reserving map space.
+typedef bool (*_MkConfGenPrepareCallback)(void * config, const wchar_t * configWcs, size_t configLength);
+
+// One config of a combined file. A NULL name makes the whole file a single section without [ConfigName] headers.
+// Headings whose bit is cleared in headingMask are skipped without tokenizing their lines.
+typedef struct _MkConfGenSection {
+    const wchar_t * name;
+    size_t keyCount;
+    const size_t * keyIndices;
+    const wchar_t * keys;
+    size_t headingCount;
+    const wchar_t * const * headings;
+    uint64_t headingMask;
+    _MkConfGenParseValueCallback parseValueCallback;
+    void * config;
+    bool isLazy; // values are passed as written in the source, including quotes
+    _MkConfGenPrepareCallback prepareCallback; // called for every included file, may be NULL
+} _MkConfGenSection;
+
+// Loads a file with [ConfigName] or [ConfigName.Heading] section headers in a single pass, keys are dispatched to the
+// config of the current section. Keys before the first or after an unknown section header are ignored.
+// A line @include "path" loads another file in its place, relative paths are resolved against the working directory.
+// The included file starts in the current section and its headers end with it. Included files are read and tokenized
+// once per process and shared by all loads, files included together are read in parallel.
+bool _MkConfGenLoadSections(
+    const wchar_t * configWcs,
+    size_t configLength,
+    size_t sectionCount,
+    const _MkConfGenSection * sections,
+    MkConfGenLoadError ** errors,
+    size_t * errorCount);
+
+#ifdef _WIN32
+// Loads a file like _MkConfGenLoadSections, includes are resolved relative to it instead of the working directory.
+// The file itself is read through the fragment cache as well. Returns false without errors if it can't be read.
+bool _MkConfGenLoadFile(
+    const wchar_t * path,
+    size_t sectionCount,
+    const _MkConfGenSection * sections,
+    MkConfGenLoadError ** errors,
+    size_t * errorCount);
+
+// Frees the cached included files. Paths in load errors are invalid afterwards and no load may be running.
+void MkConfGenClearFragments(void);
+
+// Loads a file of a single config like _MkConfGenLoadSections on worker threads. Chunks of the file are tokenized in
+// parallel, then the values are parsed in parallel by item group: itemGroups maps every item to a group, and the values
+// of one group are handed to the callback by a single thread in line order. Items that share memory, like the bitfield
+// booleans or the columns of a table, must share a group. Results and errors match the serial loader. Without groups or
+// when the file has includes the values are parsed on the calling thread. A thread count of 0 uses one thread per
+// processor.
+bool _MkConfGenLoadParallel(
+    const wchar_t * configWcs,
+    size_t configLength,
+    const _MkConfGenSection * section,
+    const uint32_t * itemGroups,
+    size_t threadCount,
+    MkConfGenLoadError ** errors,
+    size_t * errorCount);
+
+//--------------
+// Shared Memory
+
+// Flat config image in a named file mapping, written by one publisher process and read by any number of processes
+// without locks. The sequence is odd while the image is being written, readers retry when it changed during a read.
+// Changes are announced through a named semaphore released once per registered waiter.
+typedef struct MkConfGenShared {
+    void * mapping;
+    void * semaphore;
+    struct _MkConfGenSharedHeader * header;
+    void * image; // read-only for readers
+    size_t imageSize;
+} MkConfGenShared;
+
+bool _MkConfGenSharedCreate(MkConfGenShared * shared, const wchar_t * name, size_t imageSize);
+bool _MkConfGenSharedOpen(MkConfGenShared * shared, const wchar_t * name, size_t imageSize);
+
+void MkConfGenSharedClose(MkConfGenShared * shared);
+
+// Number of the last published image times two, 0 if nothing was published yet.
+uint64_t MkConfGenSharedSequence(const MkConfGenShared * shared);
+
+// Waits until an image newer than the given sequence is published, returns false on timeout (in milliseconds, INFINITE
+// waits forever). The timeout is a deadline for the whole call, wakeups for older images don't restart it.
+bool MkConfGenSharedWait(MkConfGenShared * shared, uint64_t sequence, unsigned long timeout);
+
+// Only one thread of one process may write at a time.
+void * _MkConfGenSharedBeginWrite(MkConfGenShared * shared);
+void _MkConfGenSharedEndWrite(MkConfGenShared * shared);
+
+// Reads between the two calls are consistent if the retry check returns false.
+uint64_t _MkConfGenSharedBeginRead(const MkConfGenShared * shared);
+bool _MkConfGenSharedRetryRead(const MkConfGenShared * shared, uint64_t sequence);
+#endif
+
+//---------
+// Replicas
+
+// One copy of a config per NUMA node, placed in memory of that node together with the entries of its maps, so threads
+// don't read across sockets. Publishing writes new copies and swaps them in, readers use the copy of their node in
+// place between acquiring and releasing it. Old copies are freed once no reader holds them anymore. Processors are
+// assigned the replica of their node on creation, a single replica is used when the machine has one node or reports
+// none, and always without Win32.
+typedef struct MkConfGenReplicas {
+    size_t replicaCount;
+    struct _MkConfGenReplica ** replicas;
+    size_t imageSize;
+    size_t processorCount; // processor groups are sizeof(KAFFINITY) * 8 entries apart, 0 with a single replica
+    uint16_t * processorReplicas; // NULL with a single replica
+} MkConfGenReplicas;
+
+// A copy held by a reader, from acquiring until MkConfGenReplicaRelease.
+typedef struct MkConfGenReplicaLease {
+    struct _MkConfGenReplica * replica;
+    size_t parity;
+} MkConfGenReplicaLease;
+
+// The replicas start with a copy of image as published by _MkConfGenReplicasPublish.
+bool _MkConfGenReplicasCreate(MkConfGenReplicas * replicas, const void * image, size_t imageSize, const size_t * mapOffsets, size_t mapCount);
+
+void MkConfGenReplicasFree(MkConfGenReplicas * replicas);
+
+// Copies the image and the entries of the maps at the given offsets into new copies on every node. Waits until no
+// reader holds the previous copies before freeing them. Returns false if out of memory, the previous copies stay then.
+// Only one thread may publish at a time.
+bool _MkConfGenReplicasPublish(MkConfGenReplicas * replicas, const void * image, const size_t * mapOffsets, size_t mapCount);
+
+// The current copy of the node the calling thread runs on. Threads may move to another node meanwhile, the copy is
+// still valid, only slower to read. Readers should release it soon, publishing waits for them.
+const void * _MkConfGenReplicaAcquire(const MkConfGenReplicas * replicas, MkConfGenReplicaLease * lease);
+
+void MkConfGenReplicaRelease(MkConfGenReplicaLease * lease);
+
+//------
+// Packs
+
+#define _MKCONFGEN_PACK_MAGIC 0x4B4341504746434Dull // "MCFGPACK"
+#define _MKCONFGEN_PACK_VERSION 1
+
+// Pack files start with this header, followed by the seeds and slots of a perfect hash over the member names like
+// _MkConfGenItemHash, the entries sorted by name and then the names and data. Offsets are from the start of the file,
+// all parts are 8-byte aligned.
+typedef struct _MkConfGenPackHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t charSize; // sizeof(wchar_t) of the writer
+    uint64_t fileSize;
+    uint64_t memberCount;
+    uint64_t bucketCount;
+    uint64_t slotCount;
+    uint64_t seedsOffset;
+    uint64_t slotsOffset;
+    uint64_t entriesOffset;
+} _MkConfGenPackHeader;
+
+typedef struct _MkConfGenPackEntry {
+    uint64_t nameOffset;
+    uint64_t nameLength;
+    uint64_t dataOffset;
+    uint64_t dataSize; // bytes, texts are followed by a NULL-terminator
+    uint64_t isText;
+} _MkConfGenPackEntry;
+
+// Config files packed into one file by MkConfGen --pack and mapped read-only, members are used in place.
+typedef struct MkConfGenPack {
+    void * file;
+    void * mapping;
+    const _MkConfGenPackHeader * header;
+    size_t size;
+} MkConfGenPack;
+
+// Points into the mapping, the name is not NULL-terminated. Texts are size / sizeof(wchar_t) characters of a config
+// file, other members hold the bytes of the packed file.
+typedef struct MkConfGenPackMember {
+    const wchar_t * name;
+    size_t nameLength;
+    const void * data;
+    size_t size;
+    bool isText;
+} MkConfGenPackMember;
+
+#ifdef _WIN32
+// Returns false if the file can't be mapped or is no pack of this build.
+bool MkConfGenPackOpen(MkConfGenPack * pack, const wchar_t * path);
+void MkConfGenPackClose(MkConfGenPack * pack);
+#endif
+
+size_t MkConfGenPackCount(const MkConfGenPack * pack);
+
+// Members are ordered by name. Returns false for damaged entries.
+bool MkConfGenPackGet(const MkConfGenPack * pack, size_t index, MkConfGenPackMember * member);
+
+// Finds a member with a single probe of the hash, returns false if there is none of that name.
+bool MkConfGenPackFind(const MkConfGenPack * pack, const wchar_t * name, size_t nameLength, MkConfGenPackMember * member);
+
+//--------
+// Writing
+
+// Receives the whole text of a config in a single call.
+typedef bool (*MkConfGenWriteCallback)(void * context, const wchar_t * wcs, size_t length);
+
+// Longest text of a single scalar value, including the unit of durations and sizes.
+#define _MKCONFGEN_MAX_NUMBER_LENGTH 32
+
+// The writers append to the buffer at pos and return the new end, the buffer is sized by the caller. Strings clear
+// isWritable if they hold a character the loader can't read back.
+wchar_t * _MkConfGenWriteWcs(wchar_t * pos, const wchar_t * wcs, size_t length);
+wchar_t * _MkConfGenWriteStr(wchar_t * pos, const wchar_t * wcs, bool * isWritable);
+wchar_t * _MkConfGenWriteInt(wchar_t * pos, long long value);
+wchar_t * _MkConfGenWriteUint(wchar_t * pos, unsigned long long value);
+wchar_t * _MkConfGenWriteFloat(wchar_t * pos, double value);
+wchar_t * _MkConfGenWriteBool(wchar_t * pos, bool value);
+wchar_t * _MkConfGenWriteDuration(wchar_t * pos, uint64_t value);
+wchar_t * _MkConfGenWriteSize(wchar_t * pos, uint64_t value);
+
+// Compares the first count strings of two string arrays with rows of the given length.
+bool _MkConfGenAreWstrArraysEqual(const wchar_t * wcs, const wchar_t * otherWcs, size_t count, size_t length);
+
+//---------
+// Patching
+
+// New value of an item, table cell or map entry. The values of all patches of a file are written back to back into one
+// text in the order of the patches.
+typedef struct _MkConfGenPatch {
+    size_t index;
+    size_t row; // SIZE_MAX unless a table cell
+    const wchar_t * mapKey; // NULL unless a map entry
+    size_t mapKeyLength;
+    size_t heading; // SIZE_MAX for items before the first heading
+    size_t valueOffset;
+    size_t valueLength; // this and the spans below are set by _MkConfGenPatchFile
+    size_t sourceBegin; // span of the current value in the file, SIZE_MAX if the key is missing
+    size_t sourceEnd;
+} _MkConfGenPatch;
+
+#ifdef _WIN32
+// Replaces the values of the patched keys of a single config file found with one scan of the loader, keys that are
+// missing are added at the end of their heading. When every value keeps its byte length only the values are
+// overwritten in place, otherwise the file is written to path.tmp which then replaces it.
+bool _MkConfGenPatchFile(
+    const wchar_t * path,
+    const _MkConfGenSection * section,
+    _MkConfGenPatch * patches,
+    size_t patchCount,
+    const wchar_t * text,
+    size_t textLength);
+#endif
+
+//---------------------
+// Asynchronous Loading
+
+// Called once on a background thread when an asynchronous load is done. The errors are owned by the callee like with
+// the synchronous loaders.
+typedef void (*MkConfGenLoadCompletion)(void * context, bool isLoaded, MkConfGenLoadError * errors, size_t errorCount);
+
+typedef struct MkConfGenLoadResult {
+    bool isLoaded;
+    MkConfGenLoadError * errors;
+    size_t errorCount;
+} MkConfGenLoadResult;
+
+// A load whose file was read in the background and that is parsed on the caller's thread by MkConfGenLoadStep.
+typedef struct _MkConfGenAsyncLoad MkConfGenLoadTask;
+
+// Called once on a background thread when the file of a sliced load is read, also if that failed. The callee hands the
+// task to the thread that steps it, for example by posting it to its event loop.
+typedef void (*MkConfGenLoadReady)(void * context, MkConfGenLoadTask * task);
+
+// Reads the file in the background, with overlapped I/O on the Win32 thread pool or with a small pool of worker threads
+// elsewhere. With a completion the file is also loaded like _MkConfGenLoadSections on that thread. With ready instead the
+// task is handed over once the file is read and parsed in slices of lineBudget lines by MkConfGenLoadStep, all at once
+// if lineBudget is 0. Returns false if the load could not be started, neither callback is called then.
+bool _MkConfGenLoadAsync(
+    const wchar_t * path,
+    const _MkConfGenSection * section,
+    _MkConfGenPrepareCallback prepareCallback,
+    size_t lineBudget,
+    MkConfGenLoadReady ready,
+    MkConfGenLoadCompletion completion,
+    void * context);
+
+// Parses the next slice of a sliced load on the calling thread. Returns false while lines are left; otherwise the result
+// is filled in and the task is freed.
+bool MkConfGenLoadStep(MkConfGenLoadTask * task, MkConfGenLoadResult * result);
+
+#ifdef __cpp_impl_coroutine
+#include <coroutine>
+
+// Awaits a generated LoadAsync function, the coroutine is resumed on the background thread that completed the load.
+template <typename Config>
+struct MkConfGenLoadAwaitable {
+    bool (*loadAsync)(Config * configPtr, const wchar_t * path, MkConfGenLoadCompletion completion, void * context);
+    Config * configPtr;
+    const wchar_t * path;
+    MkConfGenLoadResult result;
+    std::coroutine_handle<> handle;
+
+    static void Complete(void * context, bool isLoaded, MkConfGenLoadError * errors, size_t errorCount) {
+        MkConfGenLoadAwaitable * awaitable = (MkConfGenLoadAwaitable *)context;
+        awaitable->result = { isLoaded, errors, errorCount };
+        awaitable->handle.resume();
+    }
+
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    // The awaitable may already be gone when the load was started, so it is not touched afterwards.
+    bool await_suspend(std::coroutine_handle<> awaitingHandle) noexcept {
+        handle = awaitingHandle;
+        result = { false, NULL, 0 };
+        return loadAsync(configPtr, path, Complete, this);
+    }
+
+    MkConfGenLoadResult await_resume() const noexcept {
+        return result;
+    }
+};
+
+// Awaits a generated LoadSliced function and yields its task, or NULL if the load could not be started. The coroutine is
+// resumed on the background thread that read the file and steps the task from wherever it moves to next.
+template <typename Config>
+struct MkConfGenLoadSlicedAwaitable {
+    bool (*loadSliced)(Config * configPtr, const wchar_t * path, size_t lineBudget, MkConfGenLoadReady ready, void * context);
+    Config * configPtr;
+    const wchar_t * path;
+    size_t lineBudget;
+    MkConfGenLoadTask * task;
+    std::coroutine_handle<> handle;
+
+    static void Ready(void * context, MkConfGenLoadTask * task) {
+        MkConfGenLoadSlicedAwaitable * awaitable = (MkConfGenLoadSlicedAwaitable *)context;
+        awaitable->task = task;
+        awaitable->handle.resume();
+    }
+
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    bool await_suspend(std::coroutine_handle<> awaitingHandle) noexcept {
+        handle = awaitingHandle;
+        task = NULL;
+        return loadSliced(configPtr, path, lineBudget, Ready, this);
+    }
+
+    MkConfGenLoadTask * await_resume() const noexcept {
+        return task;
+    }
+};
+#endif
+
+//-----------
+// Reflection
+
+typedef enum MkConfGenType {
+    MKCONFGEN_TYPE_INT,
+    MKCONFGEN_TYPE_UINT,
+    MKCONFGEN_TYPE_FLOAT,
+    MKCONFGEN_TYPE_WSTR,
+    MKCONFGEN_TYPE_BOOL,
+    MKCONFGEN_TYPE_I8,
+    MKCONFGEN_TYPE_I16,
+    MKCONFGEN_TYPE_I32,
+    MKCONFGEN_TYPE_I64,
+    MKCONFGEN_TYPE_U8,
+    MKCONFGEN_TYPE_U16,
+    MKCONFGEN_TYPE_U32,
+    MKCONFGEN_TYPE_U64,
+    MKCONFGEN_TYPE_DURATION,
+    MKCONFGEN_TYPE_SIZE,
+    MKCONFGEN_TYPE_ENUM,
+    MKCONFGEN_TYPE_INT_ARRAY,
+    MKCONFGEN_TYPE_FLOAT_ARRAY,
+    MKCONFGEN_TYPE_STR_ARRAY,
+} MkConfGenType;
+
+// Describes one item of a config, see the generated ItemInfos tables.
+typedef struct MkConfGenItemInfo {
+    const wchar_t * name; // key in config files, "table.column" for table columns
+    size_t nameLength;
+    MkConfGenType type; // value type of maps
+    size_t offset; // of the member in the config struct, SIZE_MAX for booleans outside of tables since they are bitfields
+    size_t size; // bytes of the value, of a single row for table columns
+    size_t capacity; // characters of strings, elements of arrays, rows of table columns, 0 otherwise
+    size_t countOffset; // of the element count of arrays or the row count of table columns, SIZE_MAX otherwise
+    size_t heading; // SIZE_MAX for items before the first heading
+    const wchar_t * validator; // name of the MKCONFGEN_VALIDATE callback, NULL if there is none
+    bool isConstrained; // RANGE, MAX_LEN, ONE_OF or PATTERN
+    bool isMap;
+    bool isTableColumn;
+} MkConfGenItemInfo;
+
+// Value of an item read with the generated GetByIndex functions. Integers are widened to 64 bits, enums are given by
+// their underlying value.
+typedef struct MkConfGenValue {
+    MkConfGenType type;
+    union {
+        int64_t i; // INT and I8 to I64
+        uint64_t u; // UINT, U8 to U64, DURATION, SIZE and ENUM
+        double f;
+        bool b;
+        const wchar_t * wcs;
+        const void * elems; // arrays, STR_ARRAY elements are MkConfGenItemInfo::size / capacity bytes apart
+        const MkConfGenMap * map; // maps of any value type
+    };
+    size_t count; // elements of arrays
+} MkConfGenValue;
+
+// Perfect hash over the keys of the items of a config, built by the generator. The bucket of a key selects the seed
+// that moves it into a slot of its own.
+typedef struct _MkConfGenItemHash {
+    size_t bucketMask;
+    const uint32_t * seeds;
+    size_t slotMask;
+    const uint32_t * slots; // item index + 1, 0 for empty slots
+} _MkConfGenItemHash;
+
+// Returns the index of the item or SIZE_MAX.
+size_t _MkConfGenFindItem(const _MkConfGenItemHash * hash, const MkConfGenItemInfo * infos, const wchar_t * name, size_t nameLength);
+
+// Hands a value written like in config files to the parse callback, so it is checked like a loaded value.
+bool _MkConfGenSetFromText(
+    _MkConfGenParseValueCallback parseValueCallback,
+    void * config,
+    size_t index,
+    size_t row,
+    const wchar_t * mapKey,
+    size_t mapKeyLength,
+    const wchar_t * text,
+    size_t textLength,
+    MkConfGenLoadErrorType * errorType);
+
+// Compile-time field lists for generic code, see the generated <Config>Fields tuples. Needs class types as template
+// arguments from C++20.
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+#define _MKCONFGEN_FIELDS
+#include <tuple>
+#include <utility>
+
+// Item name as a template argument, like in MkConfGenGet<"fontSize">(config).
+template <size_t Length>
+struct MkConfGenName {
+    char chars[Length];
+
+    constexpr MkConfGenName(const char (&name)[Length]) {
+        for (size_t i = 0; i != Length; i++) {
+            chars[i] = name[i];
+        }
+    }
+};
+
+// A plain member of the config struct.
+template <typename Config, typename Value>
+struct MkConfGenMemberField {
+    using Type = Value;
+    const char * name; // key in config files
+    size_t index; // _ITEM_ index
+    MkConfGenType type; // value type of maps
+    Value Config::* member;
+    size_t Config::* count; // element count of arrays, NULL otherwise
+};
+
+// A boolean outside of tables, those are bitfields and can only be read through a function.
+template <typename Config>
+struct MkConfGenBitField {
+    using Type = bool;
+    const char * name;
+    size_t index;
+    MkConfGenType type;
+    bool (*get)(const Config & config);
+};
+
+// A table column, the array of all rows within the member struct of its table.
+template <typename Config, typename Table, typename Value>
+struct MkConfGenColumnField {
+    using Type = Value;
+    const char * name; // "table.column"
+    size_t index;
+    MkConfGenType type;
+    Table Config::* table;
+    Value Table::* column;
+    size_t Config::* count; // row count of the table
+};
+
+// Specialized by the generated headers, fields holds the tuple of all fields of the config. Configs with too many
+// items for a tuple get no specialization, using their fields fails to compile here.
+template <typename Config>
+struct MkConfGenFieldsOf {
+    static_assert(sizeof(Config) == 0, "config too large for Fields");
+};
+
+template <typename Config, typename Value>
+constexpr const Value & MkConfGenGet(const Config & config, const MkConfGenMemberField<Config, Value> & field) {
+    return config.*field.member;
+}
+
+template <typename Config, typename Value>
+constexpr Value & MkConfGenGet(Config & config, const MkConfGenMemberField<Config, Value> & field) {
+    return config.*field.member;
+}
+
+template <typename Config>
+constexpr bool MkConfGenGet(const Config & config, const MkConfGenBitField<Config> & field) {
+    return field.get(config);
+}
+
+template <typename Config, typename Table, typename Value>
+constexpr const Value & MkConfGenGet(const Config & config, const MkConfGenColumnField<Config, Table, Value> & field) {
+    return config.*field.table.*field.column;
+}
+
+template <typename Config, typename Table, typename Value>
+constexpr Value & MkConfGenGet(Config & config, const MkConfGenColumnField<Config, Table, Value> & field) {
+    return config.*field.table.*field.column;
+}
+
+template <size_t Length>
+constexpr bool _MkConfGenIsName(const char * name, const MkConfGenName<Length> & otherName) {
+    for (size_t i = 0; i != Length; i++) {
+        if (name[i] != otherName.chars[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename Fields, size_t Length, size_t... Indices>
+constexpr size_t _MkConfGenFindField(const Fields & fields, const MkConfGenName<Length> & name, std::index_sequence<Indices...>) {
+    size_t index = SIZE_MAX;
+    ((index = index == SIZE_MAX && _MkConfGenIsName(std::get<Indices>(fields).name, name) ? Indices : index), ...);
+    return index;
+}
+
+// Field of the item with the given key, resolved at compile time.
+template <MkConfGenName Name, typename Config>
+constexpr const auto & MkConfGenField() {
+    constexpr const auto & fields = MkConfGenFieldsOf<Config>::fields;
+    constexpr size_t index = _MkConfGenFindField(fields, Name, std::make_index_sequence<std::tuple_size_v<std::remove_cvref_t<decltype(fields)>>>());
+    static_assert(index != SIZE_MAX, "unknown config item");
+    return std::get<index != SIZE_MAX ? index : 0>(fields);
+}
+
+template <MkConfGenName Name, typename Config>
+constexpr decltype(auto) MkConfGenGet(Config & config) {
+    return MkConfGenGet(config, MkConfGenField<Name, std::remove_const_t<Config>>());
+}
+#endif
+
 #endif
\ No newline at end of file
@@ -1,15 +1,24 @@
 #include <Windows.h>
 
 #include <assert.h>
+#include <errno.h>
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <wchar.h>
 
 #include "Import/MkDynArray.h"
 #include "Import/MkString.h"
 
+#include "../Deploy/MkConfGen.h"
+
 // 0 - ok
 // 1 - file not readable
 // 2 - out of memory
-int ReadInputFile(wchar_t * filePath, MkDynArray<wchar_t> * inputListPtr) {
+int ReadFileBytes(const wchar_t * filePath, char ** bytesPtr, size_t * countPtr) {
     size_t argLength = wcslen(filePath);
     if (argLength >= MAX_PATH) {
         return 1;
@@ -27,50 +36,154 @@ int ReadInputFile(wchar_t * filePath, MkDynArray<wchar_t> * inputListPtr) {
         return 1;
     }
 
-    auto readCallback = [](void * stream, void * buffer, ulong count, void * status) {
-        ulong * error = static_cast<ulong *>(status);
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        return 1;
+    }
+    size_t count = (size_t)fileSize.QuadPart;
+    char * bytes = (char *)malloc(count + 1);
+    if (!bytes) {
+        CloseHandle(file);
+        return 2;
+    }
+    size_t readTotal = 0;
+    ulong readCount;
+    while (readTotal != count
+        && ReadFile(file, bytes + readTotal, (ulong)(count - readTotal), &readCount, nullptr)
+        && readCount != 0)
+    {
+        readTotal += readCount;
+    }
+    CloseHandle(file);
+    if (readTotal != count) {
+        free(bytes);
+        return 1;
+    }
 
-        ulong readCount;
-        if (ReadFile(stream, buffer, count, &readCount, nullptr)) {
-            *error = ERROR_SUCCESS;
-            if (readCount == 0) {
-                return false;
-            } else {
-                return true;
-            }
-        } else {
-            *error = GetLastError();
+    *bytesPtr = bytes;
+    *countPtr = count;
+    return 0;
+}
+
+// 0 - ok
+// 1 - file not readable
+// 2 - out of memory
+int ReadInputFile(wchar_t * filePath, MkDynArray<wchar_t> * inputListPtr) {
+    // The whole file is read at once and decoded from memory, the decoder asks for single bytes. UTF-8 never has
+    // fewer bytes than UTF-16 code units, so the list is allocated only once.
+    struct ByteStream {
+        char * bytes;
+        size_t count;
+    };
+    ByteStream stream;
+    int rc = ReadFileBytes(filePath, &stream.bytes, &stream.count);
+    if (rc != 0) {
+        return rc;
+    }
+    char * fileBytes = stream.bytes;
+    inputListPtr->Init(stream.count + 1);
+    if (!inputListPtr->elems) {
+        free(fileBytes);
+        return 2;
+    }
+
+    auto readCallback = [](void * stream, void * buffer, ulong count, void * status) {
+        ByteStream * streamPtr = (ByteStream *)stream;
+        if (streamPtr->count == 0) {
             return false;
         }
+        size_t readCount = count < streamPtr->count ? count : streamPtr->count;
+        memcpy(buffer, streamPtr->bytes, readCount);
+        streamPtr->bytes += readCount;
+        streamPtr->count -= readCount;
+        return true;
     };
 
     auto writeCallback = [](void * stream, const void * buffer, ulong count, void * status) {
         MkDynArray<wchar_t> * list = (MkDynArray<wchar_t> *)stream;
-        const wchar_t * chars = (const wchar_t *)buffer;
 
         wchar_t * newElems = list->Insert(SIZE_MAX, count);
         if (!newElems) {
             return false;
         }
-        for (ulong i = 0; i != count; i++) {
-            newElems[i] = chars[i];
-        }
+        wmemcpy(newElems, (const wchar_t *)buffer, count);
         return true;
     };
 
-    ulong readStatus;
     bool success = MkUtf8Read(
-        readCallback, file, &readStatus,
+        readCallback, &stream, nullptr,
         writeCallback, inputListPtr, nullptr);
 
-    CloseHandle(file);
+    free(fileBytes);
     if (!success) {
+        free(inputListPtr->elems);
         return 2;
     }
 
     return 0;
 }
 
+// Files with unchanged content are not rewritten, so their timestamps don't trigger recompiles.
+// 0 - ok
+// 2 - out of memory
+// 4 - file not writable
+int WriteOutputFile(const wchar_t * filePath, MkDynArray<char> * outputPtr) {
+    HANDLE file = CreateFileW(
+        filePath,
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_FLAG_SEQUENTIAL_SCAN,
+        nullptr);
+    if (file != INVALID_HANDLE_VALUE) {
+        LARGE_INTEGER fileSize;
+        bool isEqual = false;
+        if (GetFileSizeEx(file, &fileSize) && (uint64_t)fileSize.QuadPart == outputPtr->count) {
+            char * fileChars = (char *)malloc(outputPtr->count + 1);
+            if (!fileChars) {
+                CloseHandle(file);
+                return 2;
+            }
+            size_t readTotal = 0;
+            ulong readCount;
+            while (readTotal != outputPtr->count
+                && ReadFile(file, fileChars + readTotal, (ulong)(outputPtr->count - readTotal), &readCount, nullptr)
+                && readCount != 0)
+            {
+                readTotal += readCount;
+            }
+            isEqual = readTotal == outputPtr->count && memcmp(fileChars, outputPtr->elems, outputPtr->count) == 0;
+            free(fileChars);
+        }
+        CloseHandle(file);
+        if (isEqual) {
+            return 0;
+        }
+    }
+
+    file = CreateFileW(
+        filePath,
+        GENERIC_WRITE,
+        0,
+        NULL,
+        CREATE_ALWAYS,
+        FILE_ATTRIBUTE_NORMAL,
+        NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return 4;
+    }
+    ulong writeCount;
+    bool success = outputPtr->count == 0 || WriteFile(file, outputPtr->elems, (ulong)outputPtr->count, &writeCount, nullptr);
+    CloseHandle(file);
+    if (!success) {
+        return 4;
+    }
+
+    return 0;
+}
+
 struct Heading {
     size_t index;
     MkWstr name;
@@ -82,1303 +195,7632 @@ enum ItemType {
     ITEM_UINT,
     ITEM_FLOAT,
     ITEM_WSTR,
+    ITEM_BOOL,
+    ITEM_I8,
+    ITEM_I16,
+    ITEM_I32,
+    ITEM_I64,
+    ITEM_U8,
+    ITEM_U16,
+    ITEM_U32,
+    ITEM_U64,
+    ITEM_DURATION,
+    ITEM_SIZE,
+    ITEM_ENUM,
+    ITEM_INT_ARRAY,
+    ITEM_FLOAT_ARRAY,
+    ITEM_STR_ARRAY,
 };
 
-struct Item {
-    ItemType type;
-    MkWstr name;
-    MkWstr length; // WSTR only
-    MkWstr defaultValue;
-    MkWstr validateCallback;
-};
+// C type of the struct member and default value.
+const wchar_t * ItemTypeName(ItemType type) {
+    switch (type) {
+        case ITEM_INT: return L"long";
+        case ITEM_UINT: return L"unsigned long";
+        case ITEM_FLOAT: return L"double";
+        case ITEM_WSTR: return L"wchar_t";
+        case ITEM_BOOL: return L"bool";
+        case ITEM_I8: return L"int8_t";
+        case ITEM_I16: return L"int16_t";
+        case ITEM_I32: return L"int32_t";
+        case ITEM_I64: return L"int64_t";
+        case ITEM_U8: return L"uint8_t";
+        case ITEM_U16: return L"uint16_t";
+        case ITEM_U32: return L"uint32_t";
+        case ITEM_U64: return L"uint64_t";
+        case ITEM_DURATION: return L"uint64_t";
+        case ITEM_SIZE: return L"uint64_t";
+        case ITEM_INT_ARRAY: return L"long";
+        case ITEM_FLOAT_ARRAY: return L"double";
+        case ITEM_STR_ARRAY: return L"wchar_t";
+        default: return L"";
+    }
+}
 
-struct Config {
-    MkWstr name;
-    MkDynArray<Heading> headings;
-    MkDynArray<Item> items;
+// MKCONFGEN_PATTERN regexes are compiled into a Thompson NFA, turned into a DFA by subset construction over the
+// character intervals the pattern distinguishes and minimized. Intervals that behave the same become one class.
+
+#define PATTERN_CHAR_MAX UINT32_MAX
+#define PATTERN_MAX_NFA_STATES 4096
+#define PATTERN_MAX_RANGES 4096
+#define PATTERN_MAX_CLASS_RANGES 256
+#define PATTERN_MAX_INTERVALS 512
+#define PATTERN_MAX_DFA_STATES 1024
+#define PATTERN_MAX_REPEAT 255
+
+struct CharRange {
+    uint32_t first;
+    uint32_t last;
 };
 
-enum ParseState {
-    PARSE_FILE,
-    PARSE_DEF_BEGIN_KEYWORD,
-    PARSE_DEF_BEGIN_OPEN,
-    PARSE_DEF_BEGIN_NAME,
-    PARSE_DEF,
-    PARSE_HEADING_KEYWORD,
-    PARSE_HEADING_OPEN,
-    PARSE_HEADING_NAME,
-    PARSE_WSTR_KEYWORD,
-    PARSE_WSTR_OPEN,
-    PARSE_WSTR_NAME,
-    PARSE_WSTR_NAME_SEP,
-    PARSE_WSTR_COUNT,
-    PARSE_WSTR_COUNT_SEP,
-    PARSE_WSTR_DEFAULT,
-    PARSE_INT_KEYWORD,
-    PARSE_INT_OPEN,
-    PARSE_INT_NAME,
-    PARSE_INT_SEP,
-    PARSE_INT_DEFAULT,
-    PARSE_UINT_KEYWORD,
-    PARSE_UINT_OPEN,
-    PARSE_UINT_NAME,
-    PARSE_UINT_SEP,
-    PARSE_UINT_DEFAULT,
-    PARSE_FLOAT_KEYWORD,
-    PARSE_FLOAT_OPEN,
-    PARSE_FLOAT_NAME,
-    PARSE_FLOAT_SEP,
-    PARSE_FLOAT_DEFAULT,
-    PARSE_VALIDATE_KEYWORD,
-    PARSE_VALIDATE_OPEN,
-    PARSE_VALIDATE_NAME,
-    PARSE_VALIDATE_SEP,
-    PARSE_VALIDATE_CALLBACK,
-    PARSE_STOP,
+// Minimized DFA, state 0 is the start state. The ranges cover all characters in order.
+struct Pattern {
+    size_t rangeCount;
+    uint32_t * rangeLasts;
+    uint8_t * rangeClasses;
+    size_t classCount;
+    size_t stateCount;
+    uint16_t * transitions; // classCount entries per state
+    bool * isAccepting;
+    size_t deadState; // SIZE_MAX if there is none
 };
 
-const wchar_t fullTokenFileBegin[] = L"MKCONFGEN_FILE_BEGIN";
+// Either a character set edge to next[0] or up to two epsilon edges.
+struct NfaState {
+    size_t rangeBegin;
+    size_t rangeCount;
+    size_t next[2];
+};
 
-const wchar_t tokenPrefix[] = L"MKCONFGEN_";
+struct NfaFragment {
+    size_t start;
+    size_t end; // has no edges yet
+};
 
-const wchar_t tokenFileEnd[] = L"FILE_END";
-const wchar_t tokenDefBegin[] = L"DEF_BEGIN";
-const wchar_t tokenDefEnd[] = L"DEF_END";
-const wchar_t tokenHeading[] = L"HEADING";
-const wchar_t tokenValidate[] = L"VALIDATE";
+struct PatternCompiler {
+    const wchar_t * wcs;
+    size_t length;
+    size_t pos;
+    NfaState states[PATTERN_MAX_NFA_STATES];
+    size_t stateCount;
+    CharRange ranges[PATTERN_MAX_RANGES];
+    size_t rangeCount;
+};
 
-const wchar_t tokenPrefixItem[] = L"ITEM_";
-const wchar_t tokenItemWstr[] = L"WSTR";
-const wchar_t tokenItemInt[] = L"INT";
-const wchar_t tokenItemUint[] = L"UINT";
-const wchar_t tokenItemFloat[] = L"FLOAT";
+size_t AddNfaState(PatternCompiler * c) {
+    if (c->stateCount == PATTERN_MAX_NFA_STATES) {
+        return SIZE_MAX;
+    }
+    NfaState * statePtr = &c->states[c->stateCount];
+    statePtr->rangeBegin = 0;
+    statePtr->rangeCount = 0;
+    statePtr->next[0] = SIZE_MAX;
+    statePtr->next[1] = SIZE_MAX;
+    return c->stateCount++;
+}
 
-const wchar_t closeChars[] = { L' ', L'\t', L'\n', L')' };
-const wchar_t sepChars[] = { L' ', L'\t', L'\n', L',' };
+void AddNfaEpsilon(PatternCompiler * c, size_t from, size_t to) {
+    NfaState * statePtr = &c->states[from];
+    statePtr->next[statePtr->next[0] == SIZE_MAX ? 0 : 1] = to;
+}
 
-#define ConsumeWhitespace() while (inputWcs < inputWcsEnd && (*inputWcs == L' ' || *inputWcs == L'\t' || *inputWcs == L'\n')) inputWcs++
-#define CheckTruncation() if (inputWcs >= inputWcsEnd) return 3
-#define AdvanceAndCheck(n) inputWcs += (n); CheckTruncation()
-#define WcsLengthR(s) ((sizeof s / sizeof(wchar_t)) - 1)
-#define inputWcsLength (inputWcsEnd - inputWcs)
+int CompareCharRanges(const void * a, const void * b) {
+    uint32_t firstA = ((const CharRange *)a)->first;
+    uint32_t firstB = ((const CharRange *)b)->first;
+    return (firstA > firstB) - (firstA < firstB);
+}
 
-// 0 - ok
-// 3 - syntax error
-int Parse(MkDynArray<wchar_t> * inputWcsListPtr, MkDynArray<Config> * configsPtr, MkWstr * includeLinePtr, MkWstr * inputHeadPtr) {
-    wchar_t * inputWcs = inputWcsListPtr->elems;
-    wchar_t * inputWcsEnd = inputWcs + inputWcsListPtr->count;
+// Sorts and merges overlapping or adjacent ranges, returns the new count.
+size_t NormalizeCharRanges(CharRange * ranges, size_t count) {
+    if (count == 0) {
+        return 0;
+    }
+    qsort(ranges, count, sizeof(CharRange), CompareCharRanges);
+    size_t j = 0;
+    for (size_t i = 1; i != count; i++) {
+        if (ranges[j].last != PATTERN_CHAR_MAX && ranges[i].first > ranges[j].last + 1) {
+            ranges[++j] = ranges[i];
+        } else if (ranges[i].last > ranges[j].last) {
+            ranges[j].last = ranges[i].last;
+        }
+    }
+    return j + 1;
+}
 
-    // Include Line
+// The ranges must be normalized, out needs room for count + 1 ranges.
+size_t NegateCharRanges(const CharRange * ranges, size_t count, CharRange * out) {
+    size_t outCount = 0;
+    uint32_t next = 0;
+    bool isDone = false;
+    for (size_t i = 0; i != count; i++) {
+        if (ranges[i].first > next) {
+            out[outCount++] = { next, ranges[i].first - 1 };
+        }
+        if (ranges[i].last == PATTERN_CHAR_MAX) {
+            isDone = true;
+            break;
+        }
+        next = ranges[i].last + 1;
+    }
+    if (!isDone) {
+        out[outCount++] = { next, PATTERN_CHAR_MAX };
+    }
+    return outCount;
+}
 
-    includeLinePtr->wcs = inputWcs;
-    includeLinePtr->length = MkWcsFindCharIndex(inputWcs, inputWcsLength, L'\n');
-    if (includeLinePtr->length == SIZE_MAX) {
-        return 3;
+bool AddCharSetFragment(PatternCompiler * c, const CharRange * ranges, size_t count, NfaFragment * fragmentPtr) {
+    if (count == 0 || c->rangeCount + count > PATTERN_MAX_RANGES) {
+        return false;
     }
-    AdvanceAndCheck(includeLinePtr->length + 1);
+    size_t start = AddNfaState(c);
+    size_t end = AddNfaState(c);
+    if (start == SIZE_MAX || end == SIZE_MAX) {
+        return false;
+    }
+    memcpy(c->ranges + c->rangeCount, ranges, count * sizeof(CharRange));
+    c->states[start].rangeBegin = c->rangeCount;
+    c->states[start].rangeCount = count;
+    c->states[start].next[0] = end;
+    c->rangeCount += count;
+    fragmentPtr->start = start;
+    fragmentPtr->end = end;
+    return true;
+}
 
-    // User Code
+// \d, \w and \s and their negations give classes, \n, \t, \r and escaped ASCII punctuation stand for a character.
+// Other escapes like \b or \1 have meanings the DFA can't express and are syntax errors.
+bool ParsePatternEscape(PatternCompiler * c, CharRange * ranges, size_t * count) {
+    static const CharRange digitRanges[] = { { L'0', L'9' } };
+    static const CharRange wordRanges[] = { { L'0', L'9' }, { L'A', L'Z' }, { L'_', L'_' }, { L'a', L'z' } };
+    static const CharRange spaceRanges[] = { { L'\t', L'\r' }, { L' ', L' ' } };
 
-    inputHeadPtr->wcs = inputWcs;
-    inputHeadPtr->length = MkWcsFindSubstrIndex(inputWcs, inputWcsLength, fullTokenFileBegin);
-    if (inputHeadPtr->length == SIZE_MAX) {
-        return 3;
+    if (c->pos == c->length) {
+        return false;
+    }
+    wchar_t ch = c->wcs[c->pos++];
+
+    const CharRange * classRanges = NULL;
+    size_t classCount = 0;
+    switch (towlower(ch)) {
+        case L'd':
+            classRanges = digitRanges;
+            classCount = sizeof digitRanges / sizeof(CharRange);
+            break;
+        case L'w':
+            classRanges = wordRanges;
+            classCount = sizeof wordRanges / sizeof(CharRange);
+            break;
+        case L's':
+            classRanges = spaceRanges;
+            classCount = sizeof spaceRanges / sizeof(CharRange);
+            break;
     }
-    AdvanceAndCheck(inputHeadPtr->length + WcsLengthR(fullTokenFileBegin));
 
-    if (!(*inputWcs == L' ' || *inputWcs == L'\n' || *inputWcs == L'\t')) {
-        return 3;
+    if (!classRanges) {
+        uint32_t value = ch == L'n' ? L'\n' : ch == L't' ? L'\t' : ch == L'r' ? L'\r' : (uint32_t)ch;
+        if (value == (uint32_t)ch && !(ch < 0x80 && iswpunct(ch))) {
+            return false;
+        }
+        ranges[0] = { value, value };
+        *count = 1;
+    } else if (iswupper(ch)) {
+        *count = NegateCharRanges(classRanges, classCount, ranges);
+    } else {
+        memcpy(ranges, classRanges, classCount * sizeof(CharRange));
+        *count = classCount;
     }
+    return true;
+}
 
-    // Definitions
+bool ParsePatternClass(PatternCompiler * c, NfaFragment * fragmentPtr) {
+    CharRange ranges[PATTERN_MAX_CLASS_RANGES];
+    size_t count = 0;
 
-    Config * configPtr = NULL;
-    Item * itemPtr = NULL;
+    bool isNegated = c->pos != c->length && c->wcs[c->pos] == L'^';
+    if (isNegated) {
+        c->pos++;
+    }
 
-    MkWstr validateName;
-    MkWstr validateCallback;
+    while (true) {
+        if (c->pos == c->length || count + 5 > PATTERN_MAX_CLASS_RANGES) {
+            return false;
+        }
+        wchar_t ch = c->wcs[c->pos++];
+        if (ch == L']') {
+            break;
+        }
 
-    ParseState parseState = PARSE_FILE;
-    while (parseState != PARSE_STOP) {
-        switch (parseState) {
-            case PARSE_FILE:
-            {
-                ConsumeWhitespace();
-                if (!MkWcsIsPrefix(inputWcs, inputWcsLength, tokenPrefix)) {
-                    return 3;
-                }
-                AdvanceAndCheck(WcsLengthR(tokenPrefix));
+        uint32_t first = ch;
+        if (ch == L'\\') {
+            size_t escapeCount;
+            if (!ParsePatternEscape(c, ranges + count, &escapeCount)) {
+                return false;
+            }
+            if (escapeCount != 1 || ranges[count].first != ranges[count].last) {
+                count += escapeCount;
+                continue;
+            }
+            first = ranges[count].first;
+        }
 
-                if (MkWcsIsPrefix(inputWcs, inputWcsLength, tokenFileEnd)) {
-                    parseState = PARSE_STOP;
-                } else if (MkWcsIsPrefix(inputWcs, inputWcsLength, tokenDefBegin)) {
-                    AdvanceAndCheck((WcsLengthR(tokenDefBegin)));
-                    parseState = PARSE_DEF_BEGIN_KEYWORD;
-                } else {
-                    return 3;
+        uint32_t last = first;
+        if (c->length - c->pos >= 2 && c->wcs[c->pos] == L'-' && c->wcs[c->pos + 1] != L']') {
+            c->pos++;
+            ch = c->wcs[c->pos++];
+            last = ch;
+            if (ch == L'\\') {
+                size_t escapeCount;
+                if (!ParsePatternEscape(c, ranges + count, &escapeCount) || escapeCount != 1 || ranges[count].first != ranges[count].last) {
+                    return false;
                 }
-                break;
+                last = ranges[count].first;
+            }
+            if (last < first) {
+                return false;
             }
+        }
+        ranges[count++] = { first, last };
+    }
 
-            case PARSE_DEF_BEGIN_KEYWORD:
-            {
-                ConsumeWhitespace();
-                CheckTruncation();
+    count = NormalizeCharRanges(ranges, count);
+    if (isNegated) {
+        CharRange negatedRanges[PATTERN_MAX_CLASS_RANGES + 1];
+        size_t negatedCount = NegateCharRanges(ranges, count, negatedRanges);
+        return AddCharSetFragment(c, negatedRanges, negatedCount, fragmentPtr);
+    }
+    return AddCharSetFragment(c, ranges, count, fragmentPtr);
+}
 
-                if (*inputWcs == L'(') {
-                    AdvanceAndCheck(1);
-                    parseState = PARSE_DEF_BEGIN_OPEN;
+bool ParsePatternAlternation(PatternCompiler * c, NfaFragment * fragmentPtr);
 
-                    configPtr = configsPtr->Insert(SIZE_MAX, 1);
-                    configPtr->headings.Init(4);
-                    configPtr->items.Init(16);
-                } else {
-                    return 3;
-                }
-                break;
+bool ParsePatternAtom(PatternCompiler * c, NfaFragment * fragmentPtr) {
+    if (c->pos == c->length) {
+        return false;
+    }
+    wchar_t ch = c->wcs[c->pos++];
+
+    CharRange ranges[8];
+    size_t count = 1;
+    switch (ch) {
+        case L'(':
+            // Groups don't capture, so (?:...) is the same.
+            if (c->length - c->pos >= 2 && c->wcs[c->pos] == L'?' && c->wcs[c->pos + 1] == L':') {
+                c->pos += 2;
+            }
+            if (!ParsePatternAlternation(c, fragmentPtr) || c->pos == c->length || c->wcs[c->pos] != L')') {
+                return false;
+            }
+            c->pos++;
+            return true;
+        case L'[':
+            return ParsePatternClass(c, fragmentPtr);
+        case L'.':
+            ranges[0] = { 0, PATTERN_CHAR_MAX };
+            break;
+        case L'\\':
+            if (!ParsePatternEscape(c, ranges, &count)) {
+                return false;
             }
+            break;
+        case L'*':
+        case L'+':
+        case L'?':
+        case L'{':
+        case L')':
+        case L'|':
+        case L'^':
+        case L'$':
+            return false;
+        default:
+            ranges[0] = { (uint32_t)ch, (uint32_t)ch };
+            break;
+    }
+    return AddCharSetFragment(c, ranges, count, fragmentPtr);
+}
 
-            case PARSE_DEF_BEGIN_OPEN:
-            {
-                ConsumeWhitespace();
-                size_t j = MkWcsFindCharsIndex(inputWcs, inputWcsLength, closeChars, 4);
-                if (j == SIZE_MAX) {
-                    return 3;
+// Wraps the fragment for *, + or ?.
+bool ApplyPatternQuantifier(PatternCompiler * c, NfaFragment * fragmentPtr, wchar_t quantifier) {
+    size_t start = AddNfaState(c);
+    size_t end = AddNfaState(c);
+    if (start == SIZE_MAX || end == SIZE_MAX) {
+        return false;
+    }
+    AddNfaEpsilon(c, start, fragmentPtr->start);
+    if (quantifier != L'+') {
+        AddNfaEpsilon(c, start, end);
+    }
+    if (quantifier != L'?') {
+        AddNfaEpsilon(c, fragmentPtr->end, fragmentPtr->start);
+    }
+    AddNfaEpsilon(c, fragmentPtr->end, end);
+    fragmentPtr->start = start;
+    fragmentPtr->end = end;
+    return true;
+}
+
+bool ParsePatternCount(PatternCompiler * c, size_t * count) {
+    size_t begin = c->pos;
+    *count = 0;
+    while (c->pos != c->length && iswdigit(c->wcs[c->pos])) {
+        *count = *count * 10 + (c->wcs[c->pos++] - L'0');
+        if (*count > PATTERN_MAX_REPEAT) {
+            return false;
+        }
+    }
+    return c->pos != begin;
+}
+
+bool ParsePatternRepeat(PatternCompiler * c, NfaFragment * fragmentPtr) {
+    size_t atomBegin = c->pos;
+    if (!ParsePatternAtom(c, fragmentPtr)) {
+        return false;
+    }
+
+    bool isQuantified = false;
+    while (c->pos != c->length) {
+        wchar_t ch = c->wcs[c->pos];
+        if (ch == L'*' || ch == L'+' || ch == L'?') {
+            c->pos++;
+            if (!ApplyPatternQuantifier(c, fragmentPtr, ch)) {
+                return false;
+            }
+        } else if (ch == L'{' && !isQuantified) {
+            // {m}, {m,} and {m,n} repeat the atom by parsing it again for every copy.
+            c->pos++;
+            size_t minCount;
+            size_t maxCount;
+            if (!ParsePatternCount(c, &minCount) || c->pos == c->length) {
+                return false;
+            }
+            bool isUnbounded = false;
+            maxCount = minCount;
+            if (c->wcs[c->pos] == L',') {
+                c->pos++;
+                isUnbounded = c->pos != c->length && c->wcs[c->pos] == L'}';
+                if (!isUnbounded && (!ParsePatternCount(c, &maxCount) || maxCount < minCount)) {
+                    return false;
                 }
-                MkWstrSet(&configPtr->name, inputWcs, j);
-                AdvanceAndCheck(j);
-                parseState = PARSE_DEF_BEGIN_NAME;
-                break;
             }
+            if (c->pos == c->length || c->wcs[c->pos] != L'}') {
+                return false;
+            }
+            size_t quantifierEnd = c->pos + 1;
 
-            case PARSE_DEF_BEGIN_NAME:
-            {
-                ConsumeWhitespace();
-                if (*inputWcs != L')') {
-                    return 3;
+            size_t start = AddNfaState(c);
+            if (start == SIZE_MAX) {
+                return false;
+            }
+            fragmentPtr->start = start;
+            fragmentPtr->end = start;
+            size_t copyCount = isUnbounded ? minCount + 1 : maxCount;
+            for (size_t k = 0; k != copyCount; k++) {
+                NfaFragment copy;
+                c->pos = atomBegin;
+                if (!ParsePatternAtom(c, &copy)) {
+                    return false;
                 }
-                AdvanceAndCheck(1);
-                parseState = PARSE_DEF;
-                break;
+                if (k >= minCount && !ApplyPatternQuantifier(c, &copy, isUnbounded ? L'*' : L'?')) {
+                    return false;
+                }
+                AddNfaEpsilon(c, fragmentPtr->end, copy.start);
+                fragmentPtr->end = copy.end;
             }
+            c->pos = quantifierEnd;
+        } else {
+            break;
+        }
+        isQuantified = true;
+    }
+    return true;
+}
 
-            case PARSE_DEF:
-            {
-                ConsumeWhitespace();
-                if (!MkWcsIsPrefix(inputWcs, inputWcsLength, tokenPrefix)) {
-                    return 3;
-                }
-                AdvanceAndCheck(WcsLengthR(tokenPrefix));
-
-                if (MkWcsIsPrefix(inputWcs, inputWcsLength, tokenHeading)) {
-                    AdvanceAndCheck(WcsLengthR(tokenHeading));
-                    parseState = PARSE_HEADING_KEYWORD;
-                } else if (MkWcsIsPrefix(inputWcs, inputWcsLength, tokenPrefixItem)) {
-                    AdvanceAndCheck(WcsLengthR(tokenPrefixItem));
+bool ParsePatternConcat(PatternCompiler * c, NfaFragment * fragmentPtr) {
+    size_t start = AddNfaState(c);
+    if (start == SIZE_MAX) {
+        return false;
+    }
+    fragmentPtr->start = start;
+    fragmentPtr->end = start;
+
+    while (c->pos != c->length && c->wcs[c->pos] != L'|' && c->wcs[c->pos] != L')') {
+        // Patterns always match the whole value, so anchors at the ends are redundant.
+        if ((c->wcs[c->pos] == L'^' && c->pos == 0) || (c->wcs[c->pos] == L'$' && c->pos == c->length - 1)) {
+            c->pos++;
+            continue;
+        }
+        NfaFragment next;
+        if (!ParsePatternRepeat(c, &next)) {
+            return false;
+        }
+        AddNfaEpsilon(c, fragmentPtr->end, next.start);
+        fragmentPtr->end = next.end;
+    }
+    return true;
+}
 
-                    if (MkWcsIsPrefix(inputWcs, inputWcsLength, tokenItemInt)) {
-                        AdvanceAndCheck(WcsLengthR(tokenItemInt));
-                        parseState = PARSE_INT_KEYWORD;
-                    } else if (MkWcsIsPrefix(inputWcs, inputWcsLength, tokenItemUint)) {
-                        AdvanceAndCheck(WcsLengthR(tokenItemUint));
-                        parseState = PARSE_UINT_KEYWORD;
-                    } else if (MkWcsIsPrefix(inputWcs, inputWcsLength, tokenItemFloat)) {
-                        AdvanceAndCheck(WcsLengthR(tokenItemFloat));
-                        parseState = PARSE_FLOAT_KEYWORD;
-                    } else if (MkWcsIsPrefix(inputWcs, inputWcsLength, tokenItemWstr)) {
-                        AdvanceAndCheck(WcsLengthR(tokenItemWstr));
-                        parseState = PARSE_WSTR_KEYWORD;
-                    } else {
-                        return 3;
-                    }
-                } else if (MkWcsIsPrefix(inputWcs, inputWcsLength, tokenValidate)) {
-                    AdvanceAndCheck(WcsLengthR(tokenValidate));
-                    parseState = PARSE_VALIDATE_KEYWORD;
-                } else if (MkWcsIsPrefix(inputWcs, inputWcsLength, tokenDefEnd)) {
-                    AdvanceAndCheck(WcsLengthR(tokenDefEnd));
-                    if (!(*inputWcs == L' ' || *inputWcs == L'\t' || *inputWcs == L'\n')) {
-                        return 3;
-                    }
-                    parseState = PARSE_FILE;
-                } else {
-                    return 3;
-                }
-                break;
-            }
+bool ParsePatternAlternation(PatternCompiler * c, NfaFragment * fragmentPtr) {
+    if (!ParsePatternConcat(c, fragmentPtr)) {
+        return false;
+    }
+    while (c->pos != c->length && c->wcs[c->pos] == L'|') {
+        c->pos++;
+        NfaFragment other;
+        if (!ParsePatternConcat(c, &other)) {
+            return false;
+        }
+        size_t start = AddNfaState(c);
+        size_t end = AddNfaState(c);
+        if (start == SIZE_MAX || end == SIZE_MAX) {
+            return false;
+        }
+        AddNfaEpsilon(c, start, fragmentPtr->start);
+        AddNfaEpsilon(c, start, other.start);
+        AddNfaEpsilon(c, fragmentPtr->end, end);
+        AddNfaEpsilon(c, other.end, end);
+        fragmentPtr->start = start;
+        fragmentPtr->end = end;
+    }
+    return true;
+}
 
-            case PARSE_HEADING_KEYWORD:
-            {
-                ConsumeWhitespace();
-                if (*inputWcs != L'(') {
-                    return 3;
-                }
-                AdvanceAndCheck(1);
-                parseState = PARSE_HEADING_OPEN;
-                break;
+void CloseNfaSet(const PatternCompiler * c, uint64_t * set, size_t * stack) {
+    size_t stackCount = 0;
+    for (size_t s = 0; s != c->stateCount; s++) {
+        if (set[s / 64] & ((uint64_t)1 << (s % 64))) {
+            stack[stackCount++] = s;
+        }
+    }
+    while (stackCount != 0) {
+        const NfaState * statePtr = &c->states[stack[--stackCount]];
+        if (statePtr->rangeCount != 0) {
+            continue;
+        }
+        for (size_t k = 0; k != 2; k++) {
+            size_t next = statePtr->next[k];
+            if (next != SIZE_MAX && !(set[next / 64] & ((uint64_t)1 << (next % 64)))) {
+                set[next / 64] |= (uint64_t)1 << (next % 64);
+                stack[stackCount++] = next;
             }
+        }
+    }
+}
 
-            case PARSE_HEADING_OPEN:
-            {
-                ConsumeWhitespace();
-                size_t j = MkWcsFindCharsIndex(inputWcs, inputWcsLength, closeChars, 4);
-                if (j == SIZE_MAX) {
-                    return 3;
-                }
-                Heading * headingPtr = configPtr->headings.Insert(SIZE_MAX, 1);
-                headingPtr->index = configPtr->items.count;
-                MkWstrSet(&headingPtr->name, inputWcs, j);
-                AdvanceAndCheck(j);
-                parseState = PARSE_HEADING_NAME;
-                break;
-            }
+int ComparePoints(const void * a, const void * b) {
+    uint32_t pointA = *(const uint32_t *)a;
+    uint32_t pointB = *(const uint32_t *)b;
+    return (pointA > pointB) - (pointA < pointB);
+}
 
-            case PARSE_HEADING_NAME:
-            {
-                ConsumeWhitespace();
-                if (*inputWcs != L')') {
-                    return 3;
-                }
-                AdvanceAndCheck(1);
-                parseState = PARSE_DEF;
-                break;
-            }
+bool BuildPattern(PatternCompiler * c, const NfaFragment * fragmentPtr, Pattern * patternPtr) {
+    size_t acceptState = fragmentPtr->end;
 
-            case PARSE_INT_KEYWORD:
-            {
-                ConsumeWhitespace();
-                if (*inputWcs != L'(') {
-                    return 3;
-                }
-                AdvanceAndCheck(1);
-                parseState = PARSE_INT_OPEN;
-                break;
-            }
+    // Character Intervals
 
-            case PARSE_INT_OPEN:
-            {
-                ConsumeWhitespace();
-                size_t j = MkWcsFindCharsIndex(inputWcs, inputWcsLength, sepChars, 4);
-                if (j == SIZE_MAX) {
-                    return 3;
-                }
-                itemPtr = configPtr->items.Insert(SIZE_MAX, 1);
-                itemPtr->type = ITEM_INT;
-                MkWstrSet(&itemPtr->name, inputWcs, j);
-                itemPtr->validateCallback.length = 0;
-                AdvanceAndCheck(j);
-                parseState = PARSE_INT_NAME;
-                break;
-            }
+    size_t pointCount = 0;
+    uint32_t * points = (uint32_t *)malloc((c->rangeCount * 2 + 2) * sizeof(uint32_t));
+    if (!points) {
+        return false;
+    }
+    points[pointCount++] = 0;
+    points[pointCount++] = 128;
+    for (size_t r = 0; r != c->rangeCount; r++) {
+        points[pointCount++] = c->ranges[r].first;
+        if (c->ranges[r].last != PATTERN_CHAR_MAX) {
+            points[pointCount++] = c->ranges[r].last + 1;
+        }
+    }
+    qsort(points, pointCount, sizeof(uint32_t), ComparePoints);
+    size_t intervalCount = 1;
+    for (size_t p = 1; p != pointCount; p++) {
+        if (points[p] != points[intervalCount - 1]) {
+            points[intervalCount++] = points[p];
+        }
+    }
+    if (intervalCount > PATTERN_MAX_INTERVALS) {
+        free(points);
+        return false;
+    }
 
-            case PARSE_INT_NAME:
-            {
-                ConsumeWhitespace();
-                if (*inputWcs != L',') {
-                    return 3;
-                }
-                AdvanceAndCheck(1);
-                parseState = PARSE_INT_SEP;
-                break;
-            }
+    // Subset Construction
+
+    size_t wordCount = (c->stateCount + 63) / 64;
+    uint64_t * sets = (uint64_t *)calloc((PATTERN_MAX_DFA_STATES + 1) * wordCount, sizeof(uint64_t));
+    uint16_t * dfaTransitions = (uint16_t *)malloc(PATTERN_MAX_DFA_STATES * intervalCount * sizeof(uint16_t));
+    size_t * stack = (size_t *)malloc(c->stateCount * sizeof(size_t));
+    size_t * blocks = (size_t *)malloc(PATTERN_MAX_DFA_STATES * 2 * sizeof(size_t));
+    if (!sets || !dfaTransitions || !stack || !blocks) {
+        free(points);
+        free(sets);
+        free(dfaTransitions);
+        free(stack);
+        free(blocks);
+        return false;
+    }
 
-            case PARSE_INT_SEP:
-            {
-                ConsumeWhitespace();
-                size_t j = MkWcsFindCharsIndex(inputWcs, inputWcsLength, closeChars, 4);
-                if (j == SIZE_MAX) {
-                    return 3;
+    // The set after the last DFA state is scratch space for the next target.
+    size_t dfaCount = 1;
+    sets[fragmentPtr->start / 64] = (uint64_t)1 << (fragmentPtr->start % 64);
+    CloseNfaSet(c, sets, stack);
+    bool isValid = true;
+    for (size_t d = 0; d != dfaCount && isValid; d++) {
+        for (size_t i = 0; i != intervalCount; i++) {
+            uint64_t * target = sets + dfaCount * wordCount;
+            memset(target, 0, wordCount * sizeof(uint64_t));
+            for (size_t s = 0; s != c->stateCount; s++) {
+                const NfaState * statePtr = &c->states[s];
+                if (statePtr->rangeCount == 0 || !(sets[d * wordCount + s / 64] & ((uint64_t)1 << (s % 64)))) {
+                    continue;
                 }
-                MkWstrSet(&itemPtr->defaultValue, inputWcs, j);
-                AdvanceAndCheck(j);
-                parseState = PARSE_INT_DEFAULT;
-                break;
-            }
-
-            case PARSE_INT_DEFAULT:
-            {
-                ConsumeWhitespace();
-                if (*inputWcs != L')') {
-                    return 3;
+                for (size_t r = statePtr->rangeBegin; r != statePtr->rangeBegin + statePtr->rangeCount; r++) {
+                    if (points[i] >= c->ranges[r].first && points[i] <= c->ranges[r].last) {
+                        target[statePtr->next[0] / 64] |= (uint64_t)1 << (statePtr->next[0] % 64);
+                        break;
+                    }
                 }
-                AdvanceAndCheck(1);
-                parseState = PARSE_DEF;
-                break;
             }
+            CloseNfaSet(c, target, stack);
 
-            case PARSE_UINT_KEYWORD:
-            {
-                ConsumeWhitespace();
-                if (*inputWcs != L'(') {
-                    return 3;
+            size_t t;
+            for (t = 0; t != dfaCount; t++) {
+                if (memcmp(sets + t * wordCount, target, wordCount * sizeof(uint64_t)) == 0) {
+                    break;
                 }
-                AdvanceAndCheck(1);
-                parseState = PARSE_UINT_OPEN;
-                break;
             }
-
-            case PARSE_UINT_OPEN:
-            {
-                ConsumeWhitespace();
-                size_t j = MkWcsFindCharsIndex(inputWcs, inputWcsLength, sepChars, 4);
-                if (j == SIZE_MAX) {
-                    return 3;
+            if (t == dfaCount) {
+                if (dfaCount == PATTERN_MAX_DFA_STATES) {
+                    isValid = false;
+                    break;
                 }
-                itemPtr = configPtr->items.Insert(SIZE_MAX, 1);
-                itemPtr->type = ITEM_UINT;
-                MkWstrSet(&itemPtr->name, inputWcs, j);
-                itemPtr->validateCallback.length = 0;
-                AdvanceAndCheck(j);
-                parseState = PARSE_UINT_NAME;
-                break;
+                dfaCount++;
             }
+            dfaTransitions[d * intervalCount + i] = (uint16_t)t;
+        }
+    }
 
-            case PARSE_UINT_NAME:
-            {
-                ConsumeWhitespace();
-                if (*inputWcs != L',') {
-                    return 3;
-                }
-                AdvanceAndCheck(1);
-                parseState = PARSE_UINT_SEP;
-                break;
-            }
+    // Minimization
+    // Blocks are refined by their successor blocks until nothing splits anymore.
 
-            case PARSE_UINT_SEP:
-            {
-                ConsumeWhitespace();
-                size_t j = MkWcsFindCharsIndex(inputWcs, inputWcsLength, closeChars, 4);
-                if (j == SIZE_MAX) {
-                    return 3;
+    size_t blockCount = 0;
+    if (isValid) {
+        size_t * newBlocks = blocks + PATTERN_MAX_DFA_STATES;
+        for (size_t d = 0; d != dfaCount; d++) {
+            blocks[d] = (sets[d * wordCount + acceptState / 64] >> (acceptState % 64)) & 1;
+        }
+        while (true) {
+            size_t newBlockCount = 0;
+            for (size_t d = 0; d != dfaCount; d++) {
+                size_t e;
+                for (e = 0; e != d; e++) {
+                    if (blocks[e] != blocks[d]) {
+                        continue;
+                    }
+                    size_t i;
+                    for (i = 0; i != intervalCount; i++) {
+                        if (blocks[dfaTransitions[e * intervalCount + i]] != blocks[dfaTransitions[d * intervalCount + i]]) {
+                            break;
+                        }
+                    }
+                    if (i == intervalCount) {
+                        break;
+                    }
                 }
-                MkWstrSet(&itemPtr->defaultValue, inputWcs, j);
-                AdvanceAndCheck(j);
-                parseState = PARSE_UINT_DEFAULT;
-                break;
+                newBlocks[d] = e == d ? newBlockCount++ : newBlocks[e];
             }
-
-            case PARSE_UINT_DEFAULT:
-            {
-                ConsumeWhitespace();
-                if (*inputWcs != L')') {
-                    return 3;
-                }
-                AdvanceAndCheck(1);
-                parseState = PARSE_DEF;
+            memcpy(blocks, newBlocks, dfaCount * sizeof(size_t));
+            if (newBlockCount == blockCount) {
                 break;
             }
+            blockCount = newBlockCount;
+        }
+    }
 
-            case PARSE_FLOAT_KEYWORD:
-            {
-                ConsumeWhitespace();
-                if (*inputWcs != L'(') {
-                    return 3;
+    // Classes
+    // Intervals whose columns are the same in every state share a class. The start state is in block 0 already since
+    // blocks are numbered in order of their first state.
+
+    uint8_t * intervalClasses = (uint8_t *)malloc(intervalCount);
+    patternPtr->classCount = 0;
+    if (isValid && intervalClasses) {
+        size_t * representatives = stack;
+        for (size_t i = 0; i != intervalCount && isValid; i++) {
+            size_t k;
+            for (k = 0; k != patternPtr->classCount; k++) {
+                size_t d;
+                for (d = 0; d != dfaCount; d++) {
+                    if (blocks[dfaTransitions[d * intervalCount + i]] != blocks[dfaTransitions[d * intervalCount + representatives[k]]]) {
+                        break;
+                    }
                 }
-                AdvanceAndCheck(1);
-                parseState = PARSE_FLOAT_OPEN;
-                break;
-            }
-
-            case PARSE_FLOAT_OPEN:
-            {
-                ConsumeWhitespace();
-                size_t j = MkWcsFindCharsIndex(inputWcs, inputWcsLength, sepChars, 4);
-                if (j == SIZE_MAX) {
-                    return 3;
+                if (d == dfaCount) {
+                    break;
                 }
-                itemPtr = configPtr->items.Insert(SIZE_MAX, 1);
-                itemPtr->type = ITEM_FLOAT;
-                MkWstrSet(&itemPtr->name, inputWcs, j);
-                itemPtr->validateCallback.length = 0;
-                AdvanceAndCheck(j);
-                parseState = PARSE_FLOAT_NAME;
-                break;
             }
-
-            case PARSE_FLOAT_NAME:
-            {
-                ConsumeWhitespace();
-                if (*inputWcs != L',') {
-                    return 3;
+            if (k == patternPtr->classCount) {
+                if (k == 255) {
+                    isValid = false;
+                    break;
                 }
-                AdvanceAndCheck(1);
-                parseState = PARSE_FLOAT_SEP;
-                break;
+                representatives[patternPtr->classCount++] = i;
             }
+            intervalClasses[i] = (uint8_t)k;
+        }
 
-            case PARSE_FLOAT_SEP:
-            {
-                ConsumeWhitespace();
-                size_t j = MkWcsFindCharsIndex(inputWcs, inputWcsLength, closeChars, 4);
-                if (j == SIZE_MAX) {
-                    return 3;
+        patternPtr->stateCount = blockCount;
+        patternPtr->transitions = (uint16_t *)malloc(blockCount * patternPtr->classCount * sizeof(uint16_t));
+        patternPtr->isAccepting = (bool *)malloc(blockCount * sizeof(bool));
+        patternPtr->rangeLasts = (uint32_t *)malloc(intervalCount * sizeof(uint32_t));
+        patternPtr->rangeClasses = (uint8_t *)malloc(intervalCount);
+        if (!patternPtr->transitions || !patternPtr->isAccepting || !patternPtr->rangeLasts || !patternPtr->rangeClasses) {
+            isValid = false;
+        }
+
+        if (isValid) {
+            for (size_t d = 0; d != dfaCount; d++) {
+                patternPtr->isAccepting[blocks[d]] = (sets[d * wordCount + acceptState / 64] >> (acceptState % 64)) & 1;
+                for (size_t k = 0; k != patternPtr->classCount; k++) {
+                    patternPtr->transitions[blocks[d] * patternPtr->classCount + k] = (uint16_t)blocks[dfaTransitions[d * intervalCount + representatives[k]]];
                 }
-                MkWstrSet(&itemPtr->defaultValue, inputWcs, j);
-                AdvanceAndCheck(j);
-                parseState = PARSE_FLOAT_DEFAULT;
-                break;
             }
 
-            case PARSE_FLOAT_DEFAULT:
-            {
-                ConsumeWhitespace();
-                if (*inputWcs != L')') {
-                    return 3;
+            patternPtr->deadState = SIZE_MAX;
+            for (size_t b = 0; b != blockCount && patternPtr->deadState == SIZE_MAX; b++) {
+                size_t k;
+                for (k = 0; k != patternPtr->classCount; k++) {
+                    if (patternPtr->transitions[b * patternPtr->classCount + k] != b) {
+                        break;
+                    }
+                }
+                if (!patternPtr->isAccepting[b] && k == patternPtr->classCount) {
+                    patternPtr->deadState = b;
                 }
-                AdvanceAndCheck(1);
-                parseState = PARSE_DEF;
-                break;
             }
 
-            case PARSE_WSTR_KEYWORD:
-            {
-                ConsumeWhitespace();
-                if (*inputWcs != L'(') {
-                    return 3;
+            patternPtr->rangeCount = 0;
+            for (size_t i = 0; i != intervalCount; i++) {
+                uint32_t last = i + 1 == intervalCount ? PATTERN_CHAR_MAX : points[i + 1] - 1;
+                if (patternPtr->rangeCount != 0 && patternPtr->rangeClasses[patternPtr->rangeCount - 1] == intervalClasses[i]) {
+                    patternPtr->rangeLasts[patternPtr->rangeCount - 1] = last;
+                } else {
+                    patternPtr->rangeLasts[patternPtr->rangeCount] = last;
+                    patternPtr->rangeClasses[patternPtr->rangeCount++] = intervalClasses[i];
                 }
-                AdvanceAndCheck(1);
-                parseState = PARSE_WSTR_OPEN;
-                break;
             }
+        }
+    } else {
+        isValid = false;
+    }
 
-            case PARSE_WSTR_OPEN:
-            {
-                ConsumeWhitespace();
-                size_t j = MkWcsFindCharsIndex(inputWcs, inputWcsLength, sepChars, 4);
-                if (j == SIZE_MAX) {
-                    return 3;
-                }
-                itemPtr = configPtr->items.Insert(SIZE_MAX, 1);
-                itemPtr->type = ITEM_WSTR;
-                MkWstrSet(&itemPtr->name, inputWcs, j);
-                itemPtr->validateCallback.length = 0;
-                AdvanceAndCheck(j);
-                parseState = PARSE_WSTR_NAME;
-                break;
-            }
+    free(intervalClasses);
+    free(points);
+    free(sets);
+    free(dfaTransitions);
+    free(stack);
+    free(blocks);
+    return isValid;
+}
 
-            case PARSE_WSTR_NAME:
-            {
-                ConsumeWhitespace();
-                if (*inputWcs != L',') {
-                    return 3;
-                }
-                AdvanceAndCheck(1);
-                parseState = PARSE_WSTR_NAME_SEP;
-                break;
-            }
+size_t FindPatternClass(const Pattern * patternPtr, uint32_t ch) {
+    size_t low = 0;
+    size_t high = patternPtr->rangeCount - 1;
+    while (low != high) {
+        size_t middle = (low + high) / 2;
+        if (patternPtr->rangeLasts[middle] < ch) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return patternPtr->rangeClasses[low];
+}
 
-            case PARSE_WSTR_NAME_SEP:
-            {
-                ConsumeWhitespace();
-                size_t j = MkWcsFindCharsIndex(inputWcs, inputWcsLength, sepChars, 4);
-                if (j == SIZE_MAX) {
-                    return 3;
-                }
-                MkWstrSet(&itemPtr->length, inputWcs, j);
-                AdvanceAndCheck(j);
-                parseState = PARSE_WSTR_COUNT;
-                break;
-            }
+bool MatchPattern(const Pattern * patternPtr, const wchar_t * wcs, size_t length) {
+    size_t state = 0;
+    for (size_t i = 0; i != length; i++) {
+        state = patternPtr->transitions[state * patternPtr->classCount + FindPatternClass(patternPtr, (uint32_t)wcs[i])];
+        if (state == patternPtr->deadState) {
+            return false;
+        }
+    }
+    return patternPtr->isAccepting[state];
+}
 
-            case PARSE_WSTR_COUNT:
-            {
-                ConsumeWhitespace();
-                if (*inputWcs != L',') {
-                    return 3;
-                }
-                AdvanceAndCheck(1);
-                parseState = PARSE_WSTR_COUNT_SEP;
-                break;
+// Resolves the simple escape sequences of the contents of a string literal, out needs room for the length of the
+// contents. Returns SIZE_MAX for other escape sequences.
+size_t UnescapeLiteral(const MkWstr * wstrPtr, wchar_t * out) {
+    size_t length = 0;
+    for (size_t i = 0; i < wstrPtr->length; i++) {
+        wchar_t ch = wstrPtr->wcs[i];
+        if (ch == L'\\') {
+            if (++i == wstrPtr->length) {
+                return SIZE_MAX;
+            }
+            switch (wstrPtr->wcs[i]) {
+                case L'\\': ch = L'\\'; break;
+                case L'\"': ch = L'\"'; break;
+                case L'\'': ch = L'\''; break;
+                case L'n': ch = L'\n'; break;
+                case L'r': ch = L'\r'; break;
+                case L't': ch = L'\t'; break;
+                default: return SIZE_MAX;
             }
+        }
+        out[length++] = ch;
+    }
+    return length;
+}
 
-            case PARSE_WSTR_COUNT_SEP:
-            {
-                ConsumeWhitespace();
+// The pattern text is the contents of a string literal, so C escapes are resolved before the regex is parsed.
+// Returns false for invalid or too complex patterns.
+bool CompilePattern(const MkWstr * literalPtr, Pattern * patternPtr) {
+    PatternCompiler * c = (PatternCompiler *)malloc(sizeof(PatternCompiler));
+    wchar_t * wcs = (wchar_t *)malloc((literalPtr->length + 1) * sizeof(wchar_t));
+    if (!c || !wcs) {
+        free(c);
+        free(wcs);
+        return false;
+    }
 
-                if (!(inputWcsLength >= 2 && *inputWcs == L'L' && *(inputWcs + 1) == L'\"')) {
-                    return 3;
-                }
-                AdvanceAndCheck(2);
+    size_t length = UnescapeLiteral(literalPtr, wcs);
+    if (length == SIZE_MAX) {
+        free(c);
+        free(wcs);
+        return false;
+    }
 
-                size_t j = 0;
-                while (!(inputWcs[j] == L'\"' && (j == 0 || inputWcs[j - 1] != L'\\'))) {
-                    j++;
-                }
-                MkWstrSet(&itemPtr->defaultValue, inputWcs, j);
-                AdvanceAndCheck(j + 1);
+    c->wcs = wcs;
+    c->length = length;
+    c->pos = 0;
+    c->stateCount = 0;
+    c->rangeCount = 0;
 
-                parseState = PARSE_WSTR_DEFAULT;
-                break;
-            }
+    NfaFragment fragment;
+    bool isValid = ParsePatternAlternation(c, &fragment) && c->pos == c->length && BuildPattern(c, &fragment, patternPtr);
 
-            case PARSE_WSTR_DEFAULT:
-            {
-                ConsumeWhitespace();
-                if (*inputWcs != L')') {
-                    return 3;
-                }
-                AdvanceAndCheck(1);
-                parseState = PARSE_DEF;
-                break;
-            }
+    free(c);
+    free(wcs);
+    return isValid;
+}
 
-            case PARSE_VALIDATE_KEYWORD:
-            {
-                ConsumeWhitespace();
-                if (*inputWcs != L'(') {
-                    return 3;
-                }
-                AdvanceAndCheck(1);
-                parseState = PARSE_VALIDATE_OPEN;
-                break;
-            }
+struct Item {
+    ItemType type;
+    MkWstr name;
+    MkWstr length; // WSTR and STR_ARRAY only
+    MkWstr defaultValue;
+    MkWstr validateCallback;
+    MkWstr rangeMin; // RANGE constraint, empty if not set
+    MkWstr rangeMax;
+    MkWstr maxLength; // MAX_LEN constraint, empty if not set
+    MkDynArray<MkWstr> oneOf; // ONE_OF constraint, only initialized if hasOneOf is set
+    bool hasOneOf;
+    Pattern * patternPtr; // PATTERN constraint, NULL if not set
+    MkWstr enumName; // ENUM only
+    MkWstr maxCount; // arrays only
+    MkDynArray<MkWstr> values; // ENUM: names, arrays: default elements
+    size_t table; // index of the table this item is a column of, SIZE_MAX otherwise
+    bool isMap; // type is the value type then
+};
 
-            case PARSE_VALIDATE_OPEN:
-            {
-                ConsumeWhitespace();
-                size_t j = MkWcsFindCharsIndex(inputWcs, inputWcsLength, sepChars, 4);
-                if (j == SIZE_MAX) {
-                    return 3;
-                }
-                MkWstrSet(&validateName, inputWcs, j);
-                AdvanceAndCheck(j);
-                parseState = PARSE_VALIDATE_NAME;
-                break;
-            }
+// The columns of a table are stored contiguously in the item list.
+struct Table {
+    MkWstr name;
+    MkWstr maxRows;
+    size_t firstItem;
+    size_t itemCount;
+};
 
-            case PARSE_VALIDATE_NAME:
-            {
-                ConsumeWhitespace();
-                if (*inputWcs != L',') {
-                    return 3;
-                }
-                AdvanceAndCheck(1);
-                parseState = PARSE_VALIDATE_SEP;
-                break;
-            }
+bool IsArray(ItemType type) {
+    return type == ITEM_INT_ARRAY || type == ITEM_FLOAT_ARRAY || type == ITEM_STR_ARRAY;
+}
 
-            case PARSE_VALIDATE_SEP:
-            {
-                ConsumeWhitespace();
-                size_t j = MkWcsFindCharsIndex(inputWcs, inputWcsLength, closeChars, 4);
-                if (j == SIZE_MAX) {
-                    return 3;
-                }
-                MkWstrSet(&validateCallback, inputWcs, j);
+// Table columns and maps own variable amounts of data and can't be overridden by overlays.
+bool IsOverlayItem(const Item * itemPtr) {
+    return itemPtr->table == SIZE_MAX && !itemPtr->isMap;
+}
 
-                for (int k = 0; k != configPtr->items.count; k++) {
-                    Item * validateItemPtr = &configPtr->items.elems[k];
-                    if (MkWcsAreEqual(validateItemPtr->name.wcs, validateItemPtr->name.length, validateName.wcs, validateName.length)) {
-                        validateItemPtr->validateCallback = validateCallback;
-                    }
-                }
+// Booleans share bitfield words, so they are parsed right away in lazy mode along with tables and maps.
+bool IsLazyItem(const Item * itemPtr) {
+    return IsOverlayItem(itemPtr) && itemPtr->type != ITEM_BOOL;
+}
 
-                AdvanceAndCheck(j);
-                parseState = PARSE_VALIDATE_CALLBACK;
-                break;
-            }
+// Strings, arrays and tables are read from shared memory as a whole with SharedRead.
+bool IsSharedItem(const Item * itemPtr) {
+    return IsOverlayItem(itemPtr) && !IsArray(itemPtr->type) && itemPtr->type != ITEM_WSTR;
+}
 
-            case PARSE_VALIDATE_CALLBACK:
-            {
-                ConsumeWhitespace();
-                if (*inputWcs != L')') {
-                    return 3;
-                }
-                AdvanceAndCheck(1);
-                parseState = PARSE_DEF;
-                break;
+bool IsIntegerType(ItemType type) {
+    return type == ITEM_INT || type == ITEM_UINT || (type >= ITEM_I8 && type <= ITEM_U64);
+}
+
+bool IsSignedType(ItemType type) {
+    return type == ITEM_INT || type == ITEM_FLOAT || (type >= ITEM_I8 && type <= ITEM_I64);
+}
+
+// Runtime function that writes a value or array element back as text, enums are written by name.
+const wchar_t * ItemWriterName(ItemType type) {
+    switch (type) {
+        case ITEM_FLOAT: return L"_MkConfGenWriteFloat";
+        case ITEM_FLOAT_ARRAY: return L"_MkConfGenWriteFloat";
+        case ITEM_WSTR: return L"_MkConfGenWriteStr";
+        case ITEM_STR_ARRAY: return L"_MkConfGenWriteStr";
+        case ITEM_BOOL: return L"_MkConfGenWriteBool";
+        case ITEM_DURATION: return L"_MkConfGenWriteDuration";
+        case ITEM_SIZE: return L"_MkConfGenWriteSize";
+        case ITEM_INT_ARRAY: return L"_MkConfGenWriteInt";
+        default: return IsSignedType(type) ? L"_MkConfGenWriteInt" : L"_MkConfGenWriteUint";
+    }
+}
+
+// MkConfGenType constant of the item descriptors, the value type for maps.
+const wchar_t * ItemTypeConstant(ItemType type) {
+    switch (type) {
+        case ITEM_INT: return L"MKCONFGEN_TYPE_INT";
+        case ITEM_UINT: return L"MKCONFGEN_TYPE_UINT";
+        case ITEM_FLOAT: return L"MKCONFGEN_TYPE_FLOAT";
+        case ITEM_WSTR: return L"MKCONFGEN_TYPE_WSTR";
+        case ITEM_BOOL: return L"MKCONFGEN_TYPE_BOOL";
+        case ITEM_I8: return L"MKCONFGEN_TYPE_I8";
+        case ITEM_I16: return L"MKCONFGEN_TYPE_I16";
+        case ITEM_I32: return L"MKCONFGEN_TYPE_I32";
+        case ITEM_I64: return L"MKCONFGEN_TYPE_I64";
+        case ITEM_U8: return L"MKCONFGEN_TYPE_U8";
+        case ITEM_U16: return L"MKCONFGEN_TYPE_U16";
+        case ITEM_U32: return L"MKCONFGEN_TYPE_U32";
+        case ITEM_U64: return L"MKCONFGEN_TYPE_U64";
+        case ITEM_DURATION: return L"MKCONFGEN_TYPE_DURATION";
+        case ITEM_SIZE: return L"MKCONFGEN_TYPE_SIZE";
+        case ITEM_ENUM: return L"MKCONFGEN_TYPE_ENUM";
+        case ITEM_INT_ARRAY: return L"MKCONFGEN_TYPE_INT_ARRAY";
+        case ITEM_FLOAT_ARRAY: return L"MKCONFGEN_TYPE_FLOAT_ARRAY";
+        case ITEM_STR_ARRAY: return L"MKCONFGEN_TYPE_STR_ARRAY";
+        default: return L"";
+    }
+}
+
+struct Unit {
+    const wchar_t * wcs;
+    uint64_t factor;
+};
+
+// Durations are stored in milliseconds, sizes in bytes. Must match the tables of the runtime.
+const Unit durationUnits[] = {
+    { L"ms", 1 },
+    { L"s", 1000 },
+    { L"min", 60000 },
+    { L"h", 3600000 },
+    { L"d", 86400000 },
+};
+
+const Unit sizeUnits[] = {
+    { L"B", 1 },
+    { L"KB", 1000 },
+    { L"kB", 1000 },
+    { L"MB", 1000000 },
+    { L"GB", 1000000000 },
+    { L"TB", 1000000000000 },
+    { L"KiB", (uint64_t)1 << 10 },
+    { L"MiB", (uint64_t)1 << 20 },
+    { L"GiB", (uint64_t)1 << 30 },
+    { L"TiB", (uint64_t)1 << 40 },
+};
+
+// Parses a DURATION or SIZE default like 250ms or 4KiB into the base unit. A unit is required except for 0.
+bool ParseUnitValue(const MkWstr * wstrPtr, ItemType type, uint64_t * value) {
+    const Unit * units = type == ITEM_DURATION ? durationUnits : sizeUnits;
+    size_t unitCount = type == ITEM_DURATION ? sizeof durationUnits / sizeof(Unit) : sizeof sizeUnits / sizeof(Unit);
+
+    size_t i = 0;
+    uint64_t number = 0;
+    while (i != wstrPtr->length && iswdigit(wstrPtr->wcs[i])) {
+        uint64_t digit = wstrPtr->wcs[i++] - L'0';
+        if (number > (UINT64_MAX - digit) / 10) {
+            return false;
+        }
+        number = number * 10 + digit;
+    }
+    if (i == 0) {
+        return false;
+    }
+    if (i == wstrPtr->length) {
+        *value = number;
+        return number == 0;
+    }
+
+    for (size_t k = 0; k != unitCount; k++) {
+        if (MkWcsAreEqual(wstrPtr->wcs + i, wstrPtr->length - i, units[k].wcs, wcslen(units[k].wcs))) {
+            if (number > UINT64_MAX / units[k].factor) {
+                return false;
             }
+            *value = number * units[k].factor;
+            return true;
         }
     }
+    return false;
+}
 
-    return 0;
+// Numeric literal of the definition file, integers keep their full 64 bits.
+struct Literal {
+    double real; // FLOAT only
+    uint64_t magnitude;
+    bool isNegative;
+};
+
+// Fails for anything but a plain literal, like macro names or expressions.
+bool ParseLiteral(const MkWstr * wstrPtr, ItemType type, Literal * literalPtr) {
+    wchar_t buffer[64];
+    size_t length = wstrPtr->length;
+    bool isHex = length > 2 && wstrPtr->wcs[0] == L'0' && (wstrPtr->wcs[1] == L'x' || wstrPtr->wcs[1] == L'X');
+    while (length != 0 && (wcschr(L"uUlL", wstrPtr->wcs[length - 1]) || (type == ITEM_FLOAT && !isHex && wcschr(L"fF", wstrPtr->wcs[length - 1])))) {
+        length--;
+    }
+    if (length == 0 || length >= 64) {
+        return false;
+    }
+    wmemcpy(buffer, wstrPtr->wcs, length);
+    buffer[length] = L'\0';
+
+    literalPtr->isNegative = buffer[0] == L'-';
+    const wchar_t * digits = buffer + literalPtr->isNegative;
+    if (!(iswdigit(digits[0]) || (type == ITEM_FLOAT && digits[0] == L'.'))) {
+        return false;
+    }
+
+    wchar_t * end;
+    if (type == ITEM_FLOAT) {
+        literalPtr->real = wcstod(buffer, &end);
+        literalPtr->magnitude = 0;
+    } else {
+        literalPtr->real = 0;
+        literalPtr->magnitude = wcstoull(digits, &end, 0);
+        if (literalPtr->magnitude == ULLONG_MAX) {
+            return false;
+        }
+        if (literalPtr->magnitude == 0) {
+            literalPtr->isNegative = false;
+        }
+    }
+    return end == buffer + length;
 }
 
-#define OutputWcs(s) if (!MkUtf8WriteWcs((s), SIZE_MAX, true, writeCallback, file, nullptr)) return 4
-#define OutputWstr(s) if (!MkUtf8WriteWcs((s)->wcs, (s)->length, true, writeCallback, file, nullptr)) return 4
+int CompareLiterals(const Literal * a, const Literal * b, ItemType type) {
+    if (type == ITEM_FLOAT) {
+        return (a->real > b->real) - (a->real < b->real);
+    }
+    if (a->isNegative != b->isNegative) {
+        return a->isNegative ? -1 : 1;
+    }
+    int order = (a->magnitude > b->magnitude) - (a->magnitude < b->magnitude);
+    return a->isNegative ? -order : order;
+}
 
-// Errors:
-// 1 - file not readable
-// 2 - out of memory
-// 3 - syntax error
-// 4 - write error
-int wmain(int argCount, wchar_t ** args) {
-    if (argCount != 2) {
-        return 1;
+// Strings are compared as written, numbers by value. Values that aren't literals are never equal here.
+bool AreOneOfValuesEqual(const Item * itemPtr, const MkWstr * valuePtr, const MkWstr * otherPtr) {
+    if (itemPtr->type == ITEM_WSTR) {
+        return MkWcsAreEqual(valuePtr->wcs, valuePtr->length, otherPtr->wcs, otherPtr->length);
     }
+    Literal literal;
+    Literal otherLiteral;
+    return ParseLiteral(valuePtr, itemPtr->type, &literal) && ParseLiteral(otherPtr, itemPtr->type, &otherLiteral)
+        && CompareLiterals(&literal, &otherLiteral, itemPtr->type) == 0;
+}
 
-    int rc;
+// Length of the contents of a string literal, escape sequences count as one character.
+size_t UnescapedLength(const MkWstr * wstrPtr) {
+    size_t length = 0;
+    for (size_t i = 0; i < wstrPtr->length; i++) {
+        if (wstrPtr->wcs[i] == L'\\') {
+            i++;
+        }
+        length++;
+    }
+    return length;
+}
 
-    MkDynArray<wchar_t> inputWcsList;
-    inputWcsList.Init(128);
-    rc = ReadInputFile(args[1], &inputWcsList);
-    if (rc != 0) return rc;
+// Value of the commented-out entry of a map in the example file, NULL for 0. Zero is only replaced when literal
+// constraints reject it, by the range minimum or the first literal allowed value.
+const MkWstr * MapExampleValue(const Item * itemPtr) {
+    Literal zeroLiteral = { 0, 0, false };
+    Literal literal;
+    if (itemPtr->hasOneOf) {
+        const MkWstr * firstLiteralPtr = NULL;
+        for (size_t k = 0; k != itemPtr->oneOf.count; k++) {
+            if (!ParseLiteral(&itemPtr->oneOf.elems[k], itemPtr->type, &literal)) {
+                continue;
+            }
+            if (CompareLiterals(&literal, &zeroLiteral, itemPtr->type) == 0) {
+                return NULL;
+            }
+            if (!firstLiteralPtr) {
+                firstLiteralPtr = &itemPtr->oneOf.elems[k];
+            }
+        }
+        return firstLiteralPtr;
+    }
+    if (itemPtr->rangeMin.length != 0 && ParseLiteral(&itemPtr->rangeMin, itemPtr->type, &literal)) {
+        Literal maxLiteral;
+        bool isBelowMin = CompareLiterals(&zeroLiteral, &literal, itemPtr->type) < 0;
+        bool isAboveMax = ParseLiteral(&itemPtr->rangeMax, itemPtr->type, &maxLiteral) && CompareLiterals(&zeroLiteral, &maxLiteral, itemPtr->type) > 0;
+        if (isBelowMin || isAboveMax) {
+            return &itemPtr->rangeMin;
+        }
+    }
+    return NULL;
+}
 
-    MkDynArray<Config> configs;
-    configs.Init(4);
-    MkWstr includeLine;
-    MkWstr inputHead;
-    rc = Parse(&inputWcsList, &configs, &includeLine, &inputHead);
+// Unsigned values can't be below a lower bound of 0, so the comparison is left out.
+bool HasLowerBound(const Item * itemPtr) {
+    Literal minLiteral;
+    return IsSignedType(itemPtr->type) || !ParseLiteral(&itemPtr->rangeMin, itemPtr->type, &minLiteral) || minLiteral.magnitude != 0;
+}
 
-    const wchar_t * fileName;
-    size_t fileBaseNameLength;
-    {
-        fileName = wcsrchr(args[1], L'\\');
-        if (fileName) {
-            fileName++;
-        } else {
-            fileName = args[1];
+// Checks the constraints and the default value against them as far as they are literals, anything else is left to
+// the compiler.
+bool AreConstraintsValid(const Item * itemPtr) {
+    Literal defaultLiteral;
+    bool isDefaultLiteral = ParseLiteral(&itemPtr->defaultValue, itemPtr->type, &defaultLiteral);
+
+    if (itemPtr->rangeMin.length != 0) {
+        Literal minLiteral;
+        Literal maxLiteral;
+        bool isMinLiteral = ParseLiteral(&itemPtr->rangeMin, itemPtr->type, &minLiteral);
+        bool isMaxLiteral = ParseLiteral(&itemPtr->rangeMax, itemPtr->type, &maxLiteral);
+        if (!IsSignedType(itemPtr->type) && ((isMinLiteral && minLiteral.isNegative) || (isMaxLiteral && maxLiteral.isNegative))) {
+            return false;
         }
-        const wchar_t * extBegin = wcsrchr(fileName, L'.');
-        if (extBegin) {
-            fileBaseNameLength = extBegin - fileName;
-        } else {
-            fileBaseNameLength = wcslen(fileName);
+        if (isMinLiteral && isMaxLiteral && CompareLiterals(&minLiteral, &maxLiteral, itemPtr->type) > 0) {
+            return false;
+        }
+        if (isDefaultLiteral && isMinLiteral && CompareLiterals(&defaultLiteral, &minLiteral, itemPtr->type) < 0) {
+            return false;
+        }
+        if (isDefaultLiteral && isMaxLiteral && CompareLiterals(&defaultLiteral, &maxLiteral, itemPtr->type) > 0) {
+            return false;
+        }
+    }
+
+    if (itemPtr->maxLength.length != 0) {
+        Literal maxLengthLiteral;
+        if (ParseLiteral(&itemPtr->maxLength, ITEM_U64, &maxLengthLiteral) && UnescapedLength(&itemPtr->defaultValue) > maxLengthLiteral.magnitude) {
+            return false;
+        }
+    }
+
+    // Defaults with other escape sequences are left unchecked.
+    if (itemPtr->patternPtr) {
+        wchar_t * defaultWcs = (wchar_t *)malloc((itemPtr->defaultValue.length + 1) * sizeof(wchar_t));
+        if (!defaultWcs) {
+            return false;
+        }
+        size_t defaultLength = UnescapeLiteral(&itemPtr->defaultValue, defaultWcs);
+        bool isMatch = defaultLength == SIZE_MAX || MatchPattern(itemPtr->patternPtr, defaultWcs, defaultLength);
+        free(defaultWcs);
+        if (!isMatch) {
+            return false;
+        }
+    }
+
+    // Maps have no default.
+    if (itemPtr->hasOneOf && !itemPtr->isMap && (itemPtr->type == ITEM_WSTR || isDefaultLiteral)) {
+        for (size_t k = 0; k != itemPtr->oneOf.count; k++) {
+            const MkWstr * valuePtr = &itemPtr->oneOf.elems[k];
+            Literal valueLiteral;
+            if (itemPtr->type == ITEM_WSTR) {
+                if (MkWcsAreEqual(valuePtr->wcs, valuePtr->length, itemPtr->defaultValue.wcs, itemPtr->defaultValue.length)) {
+                    return true;
+                }
+            } else if (!ParseLiteral(valuePtr, itemPtr->type, &valueLiteral) || CompareLiterals(&valueLiteral, &defaultLiteral, itemPtr->type) == 0) {
+                return true;
+            }
         }
+        return false;
     }
 
-    auto writeCallback = [](void * stream, const void * buffer, ulong count, void * status) {
-        ulong writeCount;
-        return (bool)WriteFile(stream, buffer, count, &writeCount, nullptr);
-    };
+    return true;
+}
+
+struct Config {
+    MkWstr name;
+    MkDynArray<Heading> headings;
+    MkDynArray<Item> items;
+    MkDynArray<Table> tables;
+};
+
+size_t CountMaps(const Config * configPtr) {
+    size_t mapCount = 0;
+    for (size_t j = 0; j != configPtr->items.count; j++) {
+        mapCount += configPtr->items.elems[j].isMap;
+    }
+    return mapCount;
+}
+
+// Perfect hash over the item keys of a config: the bucket of a key selects a seed that moves the key into a slot of
+// its own. Buckets are placed largest first by trying seeds until all their keys hit free slots. Must match
+// _MkConfGenFindItem of the runtime.
+
+#define ITEM_HASH_KEYS_PER_BUCKET 4
+#define ITEM_HASH_MAX_SEED 0x100000
+
+struct ItemHash {
+    size_t bucketCount;
+    uint32_t * seeds;
+    size_t slotCount;
+    uint32_t * slots; // item index + 1, 0 for empty slots
+};
+
+#define KEY_HASH_BASIS 14695981039346656037ull
+
+uint64_t HashWcs(uint64_t hash, const wchar_t * wcs, size_t length) {
+    for (size_t i = 0; i != length; i++) {
+        hash ^= (uint64_t)wcs[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+uint64_t HashItemKey(const Config * configPtr, const Item * itemPtr) {
+    uint64_t hash = KEY_HASH_BASIS;
+    if (itemPtr->table != SIZE_MAX) {
+        const MkWstr * tableNamePtr = &configPtr->tables.elems[itemPtr->table].name;
+        hash = HashWcs(hash, tableNamePtr->wcs, tableNamePtr->length);
+        hash = HashWcs(hash, L".", 1);
+    }
+    return HashWcs(hash, itemPtr->name.wcs, itemPtr->name.length);
+}
+
+uint64_t MixItemHash(uint64_t hash) {
+    hash ^= hash >> 30;
+    hash *= 0xbf58476d1ce4e5b9ull;
+    hash ^= hash >> 27;
+    hash *= 0x94d049bb133111ebull;
+    hash ^= hash >> 31;
+    return hash;
+}
+
+// Also used for the member names of packs, hashes[j] is the hash of key j.
+bool BuildKeyHash(const uint64_t * hashes, size_t itemCount, ItemHash * hashPtr) {
+    hashPtr->bucketCount = 1;
+    while (hashPtr->bucketCount * ITEM_HASH_KEYS_PER_BUCKET < itemCount) {
+        hashPtr->bucketCount *= 2;
+    }
+    hashPtr->slotCount = 1;
+    while (hashPtr->slotCount < itemCount) {
+        hashPtr->slotCount *= 2;
+    }
+
+    size_t * order = (size_t *)malloc((itemCount + 1) * sizeof(size_t));
+    size_t * bucketSizes = (size_t *)calloc(hashPtr->bucketCount, sizeof(size_t));
+    size_t * bucketStarts = (size_t *)malloc((hashPtr->bucketCount + 1) * sizeof(size_t));
+    size_t * bucketOrder = (size_t *)malloc(hashPtr->bucketCount * sizeof(size_t));
+    hashPtr->seeds = (uint32_t *)calloc(hashPtr->bucketCount, sizeof(uint32_t));
+    hashPtr->slots = NULL;
+    if (!order || !bucketSizes || !bucketStarts || !bucketOrder || !hashPtr->seeds) {
+        free(order);
+        free(bucketSizes);
+        free(bucketStarts);
+        free(bucketOrder);
+        free(hashPtr->seeds);
+        return false;
+    }
+
+    size_t bucketMask = hashPtr->bucketCount - 1;
+    for (size_t j = 0; j != itemCount; j++) {
+        bucketSizes[MixItemHash(hashes[j]) & bucketMask]++;
+    }
+
+    // Items grouped by bucket, each bucket's members start at bucketStarts[bucket] in order.
+    size_t maxBucketSize = 0;
+    bucketStarts[0] = 0;
+    for (size_t b = 0; b != hashPtr->bucketCount; b++) {
+        if (bucketSizes[b] > maxBucketSize) {
+            maxBucketSize = bucketSizes[b];
+        }
+        bucketStarts[b + 1] = bucketStarts[b] + bucketSizes[b];
+    }
+    for (size_t j = 0; j != itemCount; j++) {
+        size_t bucket = MixItemHash(hashes[j]) & bucketMask;
+        order[bucketStarts[bucket + 1] - bucketSizes[bucket]--] = j;
+    }
+
+    // Buckets by decreasing size, a counting sort is enough since buckets are small.
+    size_t * sizeStarts = (size_t *)calloc(maxBucketSize + 2, sizeof(size_t));
+    if (!sizeStarts) {
+        free(order);
+        free(bucketSizes);
+        free(bucketStarts);
+        free(bucketOrder);
+        free(hashPtr->seeds);
+        return false;
+    }
+    for (size_t b = 0; b != hashPtr->bucketCount; b++) {
+        sizeStarts[maxBucketSize - (bucketStarts[b + 1] - bucketStarts[b]) + 1]++;
+    }
+    for (size_t size = 0; size != maxBucketSize + 1; size++) {
+        sizeStarts[size + 1] += sizeStarts[size];
+    }
+    size_t bucketOrderCount = 0;
+    for (size_t b = 0; b != hashPtr->bucketCount; b++) {
+        size_t bucketSize = bucketStarts[b + 1] - bucketStarts[b];
+        if (bucketSize != 0) {
+            bucketOrder[sizeStarts[maxBucketSize - bucketSize]++] = b;
+            bucketOrderCount++;
+        }
+    }
+    free(sizeStarts);
+
+    bool isBuilt = false;
+    while (!isBuilt) {
+        free(hashPtr->slots);
+        hashPtr->slots = (uint32_t *)calloc(hashPtr->slotCount, sizeof(uint32_t));
+        if (!hashPtr->slots) {
+            break;
+        }
+        size_t slotMask = hashPtr->slotCount - 1;
+
+        isBuilt = true;
+        for (size_t k = 0; k != bucketOrderCount && isBuilt; k++) {
+            size_t bucket = bucketOrder[k];
+            size_t * members = order + bucketStarts[bucket];
+            size_t memberCount = bucketStarts[bucket + 1] - bucketStarts[bucket];
+
+            uint32_t seed;
+            for (seed = 0; seed != ITEM_HASH_MAX_SEED; seed++) {
+                size_t placedCount = 0;
+                for (; placedCount != memberCount; placedCount++) {
+                    size_t slot = MixItemHash(hashes[members[placedCount]] ^ seed) & slotMask;
+                    if (hashPtr->slots[slot] != 0) {
+                        break;
+                    }
+                    hashPtr->slots[slot] = (uint32_t)(members[placedCount] + 1);
+                }
+                if (placedCount == memberCount) {
+                    break;
+                }
+                for (size_t m = 0; m != placedCount; m++) {
+                    hashPtr->slots[MixItemHash(hashes[members[m]] ^ seed) & slotMask] = 0;
+                }
+            }
+
+            // Retry with more room if a bucket can't be placed.
+            if (seed == ITEM_HASH_MAX_SEED) {
+                hashPtr->slotCount *= 2;
+                isBuilt = false;
+            } else {
+                hashPtr->seeds[bucket] = seed;
+            }
+        }
+    }
+
+    free(order);
+    free(bucketSizes);
+    free(bucketStarts);
+    free(bucketOrder);
+    if (!isBuilt) {
+        free(hashPtr->seeds);
+        return false;
+    }
+    return true;
+}
+
+bool BuildItemHash(const Config * configPtr, ItemHash * hashPtr) {
+    size_t itemCount = configPtr->items.count;
+    uint64_t * hashes = (uint64_t *)malloc((itemCount + 1) * sizeof(uint64_t));
+    if (!hashes) {
+        return false;
+    }
+    for (size_t j = 0; j != itemCount; j++) {
+        hashes[j] = HashItemKey(configPtr, &configPtr->items.elems[j]);
+    }
+    bool success = BuildKeyHash(hashes, itemCount, hashPtr);
+    free(hashes);
+    return success;
+}
+
+enum ParseState {
+    PARSE_FILE,
+    PARSE_DEF_BEGIN_KEYWORD,
+    PARSE_DEF_BEGIN_OPEN,
+    PARSE_DEF_BEGIN_NAME,
+    PARSE_DEF,
+    PARSE_HEADING_KEYWORD,
+    PARSE_HEADING_OPEN,
+    PARSE_HEADING_NAME,
+    PARSE_WSTR_KEYWORD,
+    PARSE_WSTR_OPEN,
+    PARSE_WSTR_NAME,
+    PARSE_WSTR_NAME_SEP,
+    PARSE_WSTR_COUNT,
+    PARSE_WSTR_COUNT_SEP,
+    PARSE_WSTR_DEFAULT,
+    PARSE_ENUM_KEYWORD,
+    PARSE_ENUM_OPEN,
+    PARSE_ENUM_NAME,
+    PARSE_ENUM_NAME_SEP,
+    PARSE_ENUM_TYPE,
+    PARSE_ENUM_TYPE_SEP,
+    PARSE_ENUM_DEFAULT,
+    PARSE_ENUM_DEFAULT_SEP,
+    PARSE_ENUM_VALUE,
+    PARSE_ENUM_VALUES,
+    PARSE_ARRAY_KEYWORD,
+    PARSE_ARRAY_OPEN,
+    PARSE_ARRAY_NAME,
+    PARSE_ARRAY_NAME_SEP,
+    PARSE_ARRAY_COUNT,
+    PARSE_ARRAY_COUNT_SEP,
+    PARSE_ARRAY_LIST_OPEN,
+    PARSE_ARRAY_LIST,
+    PARSE_ARRAY_ELEM,
+    PARSE_ARRAY_ELEMS,
+    PARSE_SCALAR_KEYWORD,
+    PARSE_SCALAR_OPEN,
+    PARSE_SCALAR_NAME,
+    PARSE_SCALAR_SEP,
+    PARSE_SCALAR_DEFAULT,
+    PARSE_MAP_KEYWORD,
+    PARSE_MAP_OPEN,
+    PARSE_MAP_NAME,
+    PARSE_MAP_NAME_SEP,
+    PARSE_MAP_TYPE,
+    PARSE_TABLE_KEYWORD,
+    PARSE_TABLE_OPEN,
+    PARSE_TABLE_NAME,
+    PARSE_TABLE_NAME_SEP,
+    PARSE_TABLE_ROWS,
+    PARSE_VALIDATE_KEYWORD,
+    PARSE_VALIDATE_OPEN,
+    PARSE_VALIDATE_NAME,
+    PARSE_VALIDATE_SEP,
+    PARSE_VALIDATE_CALLBACK,
+    PARSE_CONSTRAINT_KEYWORD,
+    PARSE_CONSTRAINT_OPEN,
+    PARSE_CONSTRAINT_NAME,
+    PARSE_RANGE_MIN,
+    PARSE_RANGE_MIN_SEP,
+    PARSE_RANGE_MAX,
+    PARSE_MAX_LEN,
+    PARSE_ONE_OF_OPEN,
+    PARSE_ONE_OF_LIST,
+    PARSE_ONE_OF_ELEM,
+    PARSE_PATTERN,
+    PARSE_CONSTRAINT_CLOSE,
+    PARSE_STOP,
+};
+
+const wchar_t fullTokenFileBegin[] = L"MKCONFGEN_FILE_BEGIN";
+
+const wchar_t tokenPrefix[] = L"MKCONFGEN_";
+
+const wchar_t tokenFileEnd[] = L"FILE_END";
+const wchar_t tokenDefBegin[] = L"DEF_BEGIN";
+const wchar_t tokenDefEnd[] = L"DEF_END";
+const wchar_t tokenHeading[] = L"HEADING";
+const wchar_t tokenValidate[] = L"VALIDATE";
+const wchar_t tokenRange[] = L"RANGE";
+const wchar_t tokenMaxLen[] = L"MAX_LEN";
+const wchar_t tokenOneOf[] = L"ONE_OF";
+const wchar_t tokenPattern[] = L"PATTERN";
+const wchar_t tokenTableBegin[] = L"TABLE_BEGIN";
+const wchar_t tokenTableEnd[] = L"TABLE_END";
+
+const wchar_t tokenPrefixItem[] = L"ITEM_";
+const wchar_t tokenItemWstr[] = L"WSTR";
+const wchar_t tokenItemEnum[] = L"ENUM";
+const wchar_t tokenItemIntArray[] = L"INT_ARRAY";
+const wchar_t tokenItemFloatArray[] = L"FLOAT_ARRAY";
+const wchar_t tokenItemStrArray[] = L"STR_ARRAY";
+const wchar_t tokenItemMap[] = L"MAP";
+
+struct ScalarToken {
+    const wchar_t * wcs;
+    ItemType type;
+};
+
+const ScalarToken scalarTokens[] = {
+    { L"INT", ITEM_INT },
+    { L"UINT", ITEM_UINT },
+    { L"FLOAT", ITEM_FLOAT },
+    { L"BOOL", ITEM_BOOL },
+    { L"I8", ITEM_I8 },
+    { L"I16", ITEM_I16 },
+    { L"I32", ITEM_I32 },
+    { L"I64", ITEM_I64 },
+    { L"U8", ITEM_U8 },
+    { L"U16", ITEM_U16 },
+    { L"U32", ITEM_U32 },
+    { L"U64", ITEM_U64 },
+    { L"DURATION", ITEM_DURATION },
+    { L"SIZE", ITEM_SIZE },
+};
+
+const wchar_t closeChars[] = { L' ', L'\t', L'\n', L')' };
+const wchar_t sepChars[] = { L' ', L'\t', L'\n', L',' };
+const wchar_t listChars[] = { L' ', L'\t', L'\n', L',', L'}' };
+
+#define ConsumeWhitespace() while (inputWcs < inputWcsEnd && (*inputWcs == L' ' || *inputWcs == L'\t' || *inputWcs == L'\n')) inputWcs++
+#define CheckTruncation() if (inputWcs >= inputWcsEnd) return 3
+#define AdvanceAndCheck(n) inputWcs += (n); CheckTruncation()
+#define WcsLengthR(s) ((sizeof s / sizeof(wchar_t)) - 1)
+#define inputWcsLength (inputWcsEnd - inputWcs)
+
+// Like MkWcsIsPrefix, but the keyword must not continue with further name characters.
+bool IsKeyword(const wchar_t * wcs, size_t length, const wchar_t * keyword) {
+    size_t keywordLength = wcslen(keyword);
+    if (!MkWcsIsPrefix(wcs, length, keyword)) {
+        return false;
+    }
+    return keywordLength == length || !(iswalnum(wcs[keywordLength]) || wcs[keywordLength] == L'_');
+}
+
+// Upper bound for the items up to the next DEF_END, so the item array of a config is allocated once.
+size_t CountItemTokens(const wchar_t * wcs, const wchar_t * wcsEnd) {
+    size_t itemCount = 0;
+    for (; wcsEnd - wcs > (ptrdiff_t)WcsLengthR(tokenPrefix); wcs++) {
+        if (*wcs != L'M' || wmemcmp(wcs, tokenPrefix, WcsLengthR(tokenPrefix)) != 0) {
+            continue;
+        }
+        wcs += WcsLengthR(tokenPrefix);
+        if (MkWcsIsPrefix(wcs, wcsEnd - wcs, tokenDefEnd)) {
+            break;
+        }
+        if (MkWcsIsPrefix(wcs, wcsEnd - wcs, tokenPrefixItem)) {
+            itemCount++;
+        }
+    }
+    return itemCount;
+}
+
+// The items of the config being parsed by table and name, so that statements referencing them don't scan all
+// previous items.
+struct ItemIndex {
+    size_t slotCount;
+    size_t * slots; // item index + 1, 0 for empty slots
+    size_t itemCount;
+};
+
+uint64_t HashItemName(size_t table, const wchar_t * wcs, size_t length) {
+    uint64_t hash = 14695981039346656037ull ^ (uint64_t)table;
+    for (size_t i = 0; i != length; i++) {
+        hash ^= (uint64_t)wcs[i];
+        hash *= 1099511628211ull;
+    }
+    return MixItemHash(hash);
+}
+
+// Adds the items parsed since the last update, the slots are kept at most half full. Of items with the same name
+// the first one is found.
+bool UpdateItemIndex(ItemIndex * indexPtr, const Config * configPtr) {
+    if (!indexPtr->slots || configPtr->items.count * 2 > indexPtr->slotCount) {
+        size_t slotCount = indexPtr->slotCount != 0 ? indexPtr->slotCount : 64;
+        while (configPtr->items.count * 2 > slotCount) {
+            slotCount *= 2;
+        }
+        size_t * slots = (size_t *)realloc(indexPtr->slots, slotCount * sizeof(size_t));
+        if (!slots) {
+            return false;
+        }
+        memset(slots, 0, slotCount * sizeof(size_t));
+        indexPtr->slotCount = slotCount;
+        indexPtr->slots = slots;
+        indexPtr->itemCount = 0;
+    }
+
+    size_t slotMask = indexPtr->slotCount - 1;
+    for (; indexPtr->itemCount != configPtr->items.count; indexPtr->itemCount++) {
+        const Item * itemPtr = &configPtr->items.elems[indexPtr->itemCount];
+        size_t slot = HashItemName(itemPtr->table, itemPtr->name.wcs, itemPtr->name.length) & slotMask;
+        while (indexPtr->slots[slot] != 0) {
+            const Item * slotItemPtr = &configPtr->items.elems[indexPtr->slots[slot] - 1];
+            if (slotItemPtr->table == itemPtr->table && MkWcsAreEqual(slotItemPtr->name.wcs, slotItemPtr->name.length, itemPtr->name.wcs, itemPtr->name.length)) {
+                break;
+            }
+            slot = (slot + 1) & slotMask;
+        }
+        if (indexPtr->slots[slot] == 0) {
+            indexPtr->slots[slot] = indexPtr->itemCount + 1;
+        }
+    }
+    return true;
+}
+
+Item * FindParsedItem(const ItemIndex * indexPtr, Config * configPtr, size_t table, const wchar_t * wcs, size_t length) {
+    size_t slotMask = indexPtr->slotCount - 1;
+    size_t slot = HashItemName(table, wcs, length) & slotMask;
+    while (indexPtr->slots[slot] != 0) {
+        Item * itemPtr = &configPtr->items.elems[indexPtr->slots[slot] - 1];
+        if (itemPtr->table == table && MkWcsAreEqual(itemPtr->name.wcs, itemPtr->name.length, wcs, length)) {
+            return itemPtr;
+        }
+        slot = (slot + 1) & slotMask;
+    }
+    return NULL;
+}
+
+// First item of each enum type.
+struct EnumType {
+    size_t config;
+    size_t item;
+};
+
+// Values may be listed only once, and all items of an enum type must list the same values in the same order.
+// 0 - ok
+// 2 - out of memory
+// 3 - syntax error
+int AddEnumType(MkDynArray<EnumType> * enumTypesPtr, const MkDynArray<Config> * configsPtr, size_t config, size_t item) {
+    const Item * itemPtr = &configsPtr->elems[config].items.elems[item];
+    for (size_t k = 0; k != itemPtr->values.count; k++) {
+        for (size_t l = 0; l != k; l++) {
+            if (MkWcsAreEqual(itemPtr->values.elems[k].wcs, itemPtr->values.elems[k].length, itemPtr->values.elems[l].wcs, itemPtr->values.elems[l].length)) {
+                return 3;
+            }
+        }
+    }
+
+    for (size_t t = 0; t != enumTypesPtr->count; t++) {
+        const Item * typeItemPtr = &configsPtr->elems[enumTypesPtr->elems[t].config].items.elems[enumTypesPtr->elems[t].item];
+        if (!MkWcsAreEqual(typeItemPtr->enumName.wcs, typeItemPtr->enumName.length, itemPtr->enumName.wcs, itemPtr->enumName.length)) {
+            continue;
+        }
+        if (typeItemPtr->values.count != itemPtr->values.count) {
+            return 3;
+        }
+        for (size_t k = 0; k != itemPtr->values.count; k++) {
+            if (!MkWcsAreEqual(typeItemPtr->values.elems[k].wcs, typeItemPtr->values.elems[k].length, itemPtr->values.elems[k].wcs, itemPtr->values.elems[k].length)) {
+                return 3;
+            }
+        }
+        return 0;
+    }
+
+    EnumType * enumTypePtr = enumTypesPtr->Insert(SIZE_MAX, 1);
+    if (!enumTypePtr) {
+        return 2;
+    }
+    enumTypePtr->config = config;
+    enumTypePtr->item = item;
+    return 0;
+}
+
+// 0 - ok
+// 2 - out of memory
+// 3 - syntax error
+int Parse(MkDynArray<wchar_t> * inputWcsListPtr, MkDynArray<Config> * configsPtr, MkWstr * includeLinePtr, MkWstr * inputHeadPtr) {
+    wchar_t * inputWcs = inputWcsListPtr->elems;
+    wchar_t * inputWcsEnd = inputWcs + inputWcsListPtr->count;
+
+    // Include Line
+
+    includeLinePtr->wcs = inputWcs;
+    includeLinePtr->length = MkWcsFindCharIndex(inputWcs, inputWcsLength, L'\n');
+    if (includeLinePtr->length == SIZE_MAX) {
+        return 3;
+    }
+    AdvanceAndCheck(includeLinePtr->length + 1);
+
+    // User Code
+
+    inputHeadPtr->wcs = inputWcs;
+    inputHeadPtr->length = MkWcsFindSubstrIndex(inputWcs, inputWcsLength, fullTokenFileBegin);
+    if (inputHeadPtr->length == SIZE_MAX) {
+        return 3;
+    }
+    AdvanceAndCheck(inputHeadPtr->length + WcsLengthR(fullTokenFileBegin));
+
+    if (!(*inputWcs == L' ' || *inputWcs == L'\n' || *inputWcs == L'\t')) {
+        return 3;
+    }
+
+    // Definitions
+
+    Config * configPtr = NULL;
+    Item * itemPtr = NULL;
+
+    MkWstr validateName;
+    MkWstr validateCallback;
+
+    Item * constraintItemPtr = NULL;
+    ParseState constraintState = PARSE_STOP;
+
+    ItemType scalarType = ITEM_NONE;
+    ItemType arrayType = ITEM_NONE;
+
+    size_t tableIndex = SIZE_MAX;
+
+    ItemIndex itemIndex = {};
+
+    MkDynArray<EnumType> enumTypes;
+    enumTypes.Init(4);
+    if (!enumTypes.elems) {
+        return 2;
+    }
+
+    ParseState parseState = PARSE_FILE;
+    while (parseState != PARSE_STOP) {
+        switch (parseState) {
+            case PARSE_FILE:
+            {
+                ConsumeWhitespace();
+                if (!MkWcsIsPrefix(inputWcs, inputWcsLength, tokenPrefix)) {
+                    return 3;
+                }
+                AdvanceAndCheck(WcsLengthR(tokenPrefix));
+
+                if (MkWcsIsPrefix(inputWcs, inputWcsLength, tokenFileEnd)) {
+                    parseState = PARSE_STOP;
+                } else if (MkWcsIsPrefix(inputWcs, inputWcsLength, tokenDefBegin)) {
+                    AdvanceAndCheck((WcsLengthR(tokenDefBegin)));
+                    parseState = PARSE_DEF_BEGIN_KEYWORD;
+                } else {
+                    return 3;
+                }
+                break;
+            }
+
+            case PARSE_DEF_BEGIN_KEYWORD:
+            {
+                ConsumeWhitespace();
+                CheckTruncation();
+
+                if (*inputWcs == L'(') {
+                    AdvanceAndCheck(1);
+                    parseState = PARSE_DEF_BEGIN_OPEN;
+
+                    configPtr = configsPtr->Insert(SIZE_MAX, 1);
+                    configPtr->headings.Init(4);
+                    size_t itemCount = CountItemTokens(inputWcs, inputWcsEnd);
+                    configPtr->items.Init(itemCount > 16 ? itemCount : 16);
+                    configPtr->tables.Init(2);
+                    itemIndex.itemCount = 0;
+                    if (itemIndex.slots) {
+                        memset(itemIndex.slots, 0, itemIndex.slotCount * sizeof(size_t));
+                    }
+                } else {
+                    return 3;
+                }
+                break;
+            }
+
+            case PARSE_DEF_BEGIN_OPEN:
+            {
+                ConsumeWhitespace();
+                size_t j = MkWcsFindCharsIndex(inputWcs, inputWcsLength, closeChars, 4);
+                if (j == SIZE_MAX) {
+                    return 3;
+                }
+                MkWstrSet(&configPtr->name, inputWcs, j);
+                AdvanceAndCheck(j);
+                parseState = PARSE_DEF_BEGIN_NAME;
+                break;
+            }
+
+            case PARSE_DEF_BEGIN_NAME:
+            {
+                ConsumeWhitespace();
+                if (*inputWcs != L')') {
+                    return 3;
+                }
+                AdvanceAndCheck(1);
+                parseState = PARSE_DEF;
+                break;
+            }
+
+            case PARSE_DEF:
+            {
+                ConsumeWhitespace();
+                if (!MkWcsIsPrefix(inputWcs, inputWcsLength, tokenPrefix)) {
+                    return 3;
+                }
+                AdvanceAndCheck(WcsLengthR(tokenPrefix));
+
+                if (MkWcsIsPrefix(inputWcs, inputWcsLength, tokenHeading)) {
+                    if (tableIndex != SIZE_MAX) {
+                        return 3;
+                    }
+                    AdvanceAndCheck(WcsLengthR(tokenHeading));
+                    parseState = PARSE_HEADING_KEYWORD;
+                } else if (MkWcsIsPrefix(inputWcs, inputWcsLength, tokenPrefixItem)) {
+                    AdvanceAndCheck(WcsLengthR(tokenPrefixItem));
+
+                    if (IsKeyword(inputWcs, inputWcsLength, tokenItemWstr)) {
+                        AdvanceAndCheck(WcsLengthR(tokenItemWstr));
+                        parseState = PARSE_WSTR_KEYWORD;
+                    } else if (IsKeyword(inputWcs, inputWcsLength, tokenItemEnum)) {
+                        AdvanceAndCheck(WcsLengthR(tokenItemEnum));
+                        parseState = PARSE_ENUM_KEYWORD;
+                    } else if (IsKeyword(inputWcs, inputWcsLength, tokenItemMap)) {
+                        if (tableIndex != SIZE_MAX) {
+                            return 3;
+                        }
+                        AdvanceAndCheck(WcsLengthR(tokenItemMap));
+                        parseState = PARSE_MAP_KEYWORD;
+                    } else if (IsKeyword(inputWcs, inputWcsLength, tokenItemIntArray)) {
+                        AdvanceAndCheck(WcsLengthR(tokenItemIntArray));
+                        arrayType = ITEM_INT_ARRAY;
+                        parseState = PARSE_ARRAY_KEYWORD;
+                    } else if (IsKeyword(inputWcs, inputWcsLength, tokenItemFloatArray)) {
+                        AdvanceAndCheck(WcsLengthR(tokenItemFloatArray));
+                        arrayType = ITEM_FLOAT_ARRAY;
+                        parseState = PARSE_ARRAY_KEYWORD;
+                    } else if (IsKeyword(inputWcs, inputWcsLength, tokenItemStrArray)) {
+                        AdvanceAndCheck(WcsLengthR(tokenItemStrArray));
+                        arrayType = ITEM_STR_ARRAY;
+                        parseState = PARSE_ARRAY_KEYWORD;
+                    } else {
+                        size_t k;
+                        for (k = 0; k != sizeof scalarTokens / sizeof(ScalarToken); k++) {
+                            if (IsKeyword(inputWcs, inputWcsLength, scalarTokens[k].wcs)) {
+                                break;
+                            }
+                        }
+                        if (k == sizeof scalarTokens / sizeof(ScalarToken)) {
+                            return 3;
+                        }
+                        AdvanceAndCheck(wcslen(scalarTokens[k].wcs));
+                        scalarType = scalarTokens[k].type;
+                        parseState = PARSE_SCALAR_KEYWORD;
+                    }
+                } else if (MkWcsIsPrefix(inputWcs, inputWcsLength, tokenValidate)) {
+                    AdvanceAndCheck(WcsLengthR(tokenValidate));
+                    parseState = PARSE_VALIDATE_KEYWORD;
+                } else if (IsKeyword(inputWcs, inputWcsLength, tokenRange)) {
+                    AdvanceAndCheck(WcsLengthR(tokenRange));
+                    constraintState = PARSE_RANGE_MIN;
+                    parseState = PARSE_CONSTRAINT_KEYWORD;
+                } else if (IsKeyword(inputWcs, inputWcsLength, tokenMaxLen)) {
+                    AdvanceAndCheck(WcsLengthR(tokenMaxLen));
+                    constraintState = PARSE_MAX_LEN;
+                    parseState = PARSE_CONSTRAINT_KEYWORD;
+                } else if (IsKeyword(inputWcs, inputWcsLength, tokenOneOf)) {
+                    AdvanceAndCheck(WcsLengthR(tokenOneOf));
+                    constraintState = PARSE_ONE_OF_OPEN;
+                    parseState = PARSE_CONSTRAINT_KEYWORD;
+                } else if (IsKeyword(inputWcs, inputWcsLength, tokenPattern)) {
+                    AdvanceAndCheck(WcsLengthR(tokenPattern));
+                    constraintState = PARSE_PATTERN;
+                    parseState = PARSE_CONSTRAINT_KEYWORD;
+                } else if (IsKeyword(inputWcs, inputWcsLength, tokenTableBegin)) {
+                    if (tableIndex != SIZE_MAX) {
+                        return 3;
+                    }
+                    AdvanceAndCheck(WcsLengthR(tokenTableBegin));
+                    parseState = PARSE_TABLE_KEYWORD;
+                } else if (IsKeyword(inputWcs, inputWcsLength, tokenTableEnd)) {
+                    if (tableIndex == SIZE_MAX) {
+                        return 3;
+                    }
+                    Table * tablePtr = &configPtr->tables.elems[tableIndex];
+                    tablePtr->itemCount = configPtr->items.count - tablePtr->firstItem;
+                    if (tablePtr->itemCount == 0) {
+                        return 3;
+                    }
+                    tableIndex = SIZE_MAX;
+                    AdvanceAndCheck(WcsLengthR(tokenTableEnd));
+                } else if (MkWcsIsPrefix(inputWcs, inputWcsLength, tokenDefEnd)) {
+                    if (tableIndex != SIZE_MAX) {
+                        return 3;
+                    }
+                    AdvanceAndCheck(WcsLengthR(tokenDefEnd));
+                    if (!(*inputWcs == L' ' || *inputWcs == L'\t' || *inputWcs == L'\n')) {
+                        return 3;
+                    }
+                    parseState = PARSE_FILE;
+                } else {
+                    return 3;
+                }
+                break;
+            }
+
+            case PARSE_HEADING_KEYWORD:
+            {
+                ConsumeWhitespace();
+                if (*inputWcs != L'(') {
+                    return 3;
+                }
+                AdvanceAndCheck(1);
+                parseState = PARSE_HEADING_OPEN;
+                break;
+            }
+
+            case PARSE_HEADING_OPEN:
+            {
+                ConsumeWhitespace();
+                size_t j = MkWcsFindCharsIndex(inputWcs, inputWcsLength, closeChars, 4);
+                if (j == SIZE_MAX) {
+                    return 3;
+                }
+                // Headings are selected by the bits of a 64-bit mask.
+                if (configPtr->headings.count == 64) {
+                    return 3;
+                }
+                Heading * headingPtr = configPtr->headings.Insert(SIZE_MAX, 1);
+                headingPtr->index = configPtr->items.count;
+                MkWstrSet(&headingPtr->name, inputWcs, j);
+                AdvanceAndCheck(j);
+                parseState = PARSE_HEADING_NAME;
+                break;
+            }
+
+            case PARSE_HEADING_NAME:
+            {
+                ConsumeWhitespace();
+                if (*inputWcs != L')') {
+                    return 3;
+                }
+                AdvanceAndCheck(1);
+                parseState = PARSE_DEF;
+                break;
+            }
+
+            case PARSE_SCALAR_KEYWORD:
+            {
+                ConsumeWhitespace();
+                if (*inputWcs != L'(') {
+                    return 3;
+                }
+                AdvanceAndCheck(1);
+                parseState = PARSE_SCALAR_OPEN;
+                break;
+            }
+
+            case PARSE_SCALAR_OPEN:
+            {
+                ConsumeWhitespace();
+                size_t j = MkWcsFindCharsIndex(inputWcs, inputWcsLength, sepChars, 4);
+                if (j == SIZE_MAX) {
+                    return 3;
+                }
+                itemPtr = configPtr->items.Insert(SIZE_MAX, 1);
+                itemPtr->table = tableIndex;
+                itemPtr->isMap = false;
+                itemPtr->type = scalarType;
+                MkWstrSet(&itemPtr->name, inputWcs, j);
+                itemPtr->validateCallback.length = 0;
+                itemPtr->rangeMin.length = 0;
+                itemPtr->rangeMax.length = 0;
+                itemPtr->maxLength.length = 0;
+                itemPtr->hasOneOf = false;
+                itemPtr->patternPtr = NULL;
+                AdvanceAndCheck(j);
+                parseState = PARSE_SCALAR_NAME;
+                break;
+            }
+
+            case PARSE_SCALAR_NAME:
+            {
+                ConsumeWhitespace();
+                if (*inputWcs != L',') {
+                    return 3;
+                }
+                AdvanceAndCheck(1);
+                parseState = PARSE_SCALAR_SEP;
+                break;
+            }
+
+            case PARSE_SCALAR_SEP:
+            {
+                ConsumeWhitespace();
+                size_t j = MkWcsFindCharsIndex(inputWcs, inputWcsLength, closeChars, 4);
+                if (j == SIZE_MAX) {
+                    return 3;
+                }
+                MkWstrSet(&itemPtr->defaultValue, inputWcs, j);
+                if (itemPtr->type == ITEM_BOOL
+                    && !MkWcsAreEqual(inputWcs, j, L"true", 4)
+                    && !MkWcsAreEqual(inputWcs, j, L"false", 5))
+                {
+                    return 3;
+                }
+                uint64_t unitValue;
+                if ((itemPtr->type == ITEM_DURATION || itemPtr->type == ITEM_SIZE) && !ParseUnitValue(&itemPtr->defaultValue, itemPtr->type, &unitValue)) {
+                    return 3;
+                }
+                AdvanceAndCheck(j);
+                parseState = PARSE_SCALAR_DEFAULT;
+                break;
+            }
+
+            case PARSE_SCALAR_DEFAULT:
+            {
+                ConsumeWhitespace();
+                if (*inputWcs != L')') {
+                    return 3;
+                }
+                AdvanceAndCheck(1);
+                parseState = PARSE_DEF;
+                break;
+            }
+
+            case PARSE_WSTR_KEYWORD:
+            {
+                ConsumeWhitespace();
+                if (*inputWcs != L'(') {
+                    return 3;
+                }
+                AdvanceAndCheck(1);
+                parseState = PARSE_WSTR_OPEN;
+                break;
+            }
+
+            case PARSE_WSTR_OPEN:
+            {
+                ConsumeWhitespace();
+                size_t j = MkWcsFindCharsIndex(inputWcs, inputWcsLength, sepChars, 4);
+                if (j == SIZE_MAX) {
+                    return 3;
+                }
+                itemPtr = configPtr->items.Insert(SIZE_MAX, 1);
+                itemPtr->table = tableIndex;
+                itemPtr->isMap = false;
+                itemPtr->type = ITEM_WSTR;
+                MkWstrSet(&itemPtr->name, inputWcs, j);
+                itemPtr->validateCallback.length = 0;
+                itemPtr->rangeMin.length = 0;
+                itemPtr->rangeMax.length = 0;
+                itemPtr->maxLength.length = 0;
+                itemPtr->hasOneOf = false;
+                itemPtr->patternPtr = NULL;
+                AdvanceAndCheck(j);
+                parseState = PARSE_WSTR_NAME;
+                break;
+            }
+
+            case PARSE_WSTR_NAME:
+            {
+                ConsumeWhitespace();
+                if (*inputWcs != L',') {
+                    return 3;
+                }
+                AdvanceAndCheck(1);
+                parseState = PARSE_WSTR_NAME_SEP;
+                break;
+            }
+
+            case PARSE_WSTR_NAME_SEP:
+            {
+                ConsumeWhitespace();
+                size_t j = MkWcsFindCharsIndex(inputWcs, inputWcsLength, sepChars, 4);
+                if (j == SIZE_MAX) {
+                    return 3;
+                }
+                MkWstrSet(&itemPtr->length, inputWcs, j);
+                AdvanceAndCheck(j);
+                parseState = PARSE_WSTR_COUNT;
+                break;
+            }
+
+            case PARSE_WSTR_COUNT:
+            {
+                ConsumeWhitespace();
+                if (*inputWcs != L',') {
+                    return 3;
+                }
+                AdvanceAndCheck(1);
+                parseState = PARSE_WSTR_COUNT_SEP;
+                break;
+            }
+
+            case PARSE_WSTR_COUNT_SEP:
+            {
+                ConsumeWhitespace();
+
+                if (!(inputWcsLength >= 2 && *inputWcs == L'L' && *(inputWcs + 1) == L'\"')) {
+                    return 3;
+                }
+                AdvanceAndCheck(2);
+
+                size_t j = 0;
+                while (inputWcs[j] != L'\"') {
+                    if (inputWcs[j] == L'\\') {
+                        j++;
+                    }
+                    j++;
+                    if (j >= inputWcsLength) {
+                        return 3;
+                    }
+                }
+                MkWstrSet(&itemPtr->defaultValue, inputWcs, j);
+                AdvanceAndCheck(j + 1);
+
+                parseState = PARSE_WSTR_DEFAULT;
+                break;
+            }
+
+            case PARSE_WSTR_DEFAULT:
+            {
+                ConsumeWhitespace();
+                if (*inputWcs != L')') {
+                    return 3;
+                }
+                AdvanceAndCheck(1);
+                parseState = PARSE_DEF;
+                break;
+            }
+
+            case PARSE_ENUM_KEYWORD:
+            {
+                ConsumeWhitespace();
+                if (*inputWcs != L'(') {
+                    return 3;
+                }
+                AdvanceAndCheck(1);
+                parseState = PARSE_ENUM_OPEN;
+                break;
+            }
+
+            case PARSE_ENUM_OPEN:
+            {
+                ConsumeWhitespace();
+                size_t j = MkWcsFindCharsIndex(inputWcs, inputWcsLength, sepChars, 4);
+                if (j == SIZE_MAX) {
+                    return 3;
+                }
+                itemPtr = configPtr->items.Insert(SIZE_MAX, 1);
+                itemPtr->table = tableIndex;
+                itemPtr->isMap = false;
+                itemPtr->type = ITEM_ENUM;
+                MkWstrSet(&itemPtr->name, inputWcs, j);
+                itemPtr->validateCallback.length = 0;
+                itemPtr->rangeMin.length = 0;
+                itemPtr->rangeMax.length = 0;
+                itemPtr->maxLength.length = 0;
+                itemPtr->hasOneOf = false;
+                itemPtr->patternPtr = NULL;
+                itemPtr->values.Init(4);
+                AdvanceAndCheck(j);
+                parseState = PARSE_ENUM_NAME;
+                break;
+            }
+
+            case PARSE_ENUM_NAME:
+            {
+                ConsumeWhitespace();
+                if (*inputWcs != L',') {
+                    return 3;
+                }
+                AdvanceAndCheck(1);
+                parseState = PARSE_ENUM_NAME_SEP;
+                break;
+            }
+
+            case PARSE_ENUM_NAME_SEP:
+            {
+                ConsumeWhitespace();
+                size_t j = MkWcsFindCharsIndex(inputWcs, inputWcsLength, sepChars, 4);
+                if (j == SIZE_MAX) {
+                    return 3;
+                }
+                MkWstrSet(&itemPtr->enumName, inputWcs, j);
+                AdvanceAndCheck(j);
+                parseState = PARSE_ENUM_TYPE;
+                break;
+            }
+
+            case PARSE_ENUM_TYPE:
+            {
+                ConsumeWhitespace();
+                if (*inputWcs != L',') {
+                    return 3;
+                }
+                AdvanceAndCheck(1);
+                parseState = PARSE_ENUM_TYPE_SEP;
+                break;
+            }
+
+            case PARSE_ENUM_TYPE_SEP:
+            {
+                ConsumeWhitespace();
+                size_t j = MkWcsFindCharsIndex(inputWcs, inputWcsLength, sepChars, 4);
+                if (j == SIZE_MAX) {
+                    return 3;
+                }
+                MkWstrSet(&itemPtr->defaultValue, inputWcs, j);
+                AdvanceAndCheck(j);
+                parseState = PARSE_ENUM_DEFAULT;
+                break;
+            }
+
+            case PARSE_ENUM_DEFAULT:
+            {
+                ConsumeWhitespace();
+                if (*inputWcs != L',') {
+                    return 3;
+                }
+                AdvanceAndCheck(1);
+                ConsumeWhitespace();
+                if (*inputWcs != L'{') {
+                    return 3;
+                }
+                AdvanceAndCheck(1);
+                parseState = PARSE_ENUM_DEFAULT_SEP;
+                break;
+            }
+
+            case PARSE_ENUM_DEFAULT_SEP:
+            {
+                ConsumeWhitespace();
+                size_t j = MkWcsFindCharsIndex(inputWcs, inputWcsLength, listChars, 5);
+                if (j == SIZE_MAX || j == 0) {
+                    return 3;
+                }
+                MkWstr * valuePtr = itemPtr->values.Insert(SIZE_MAX, 1);
+                MkWstrSet(valuePtr, inputWcs, j);
+                AdvanceAndCheck(j);
+                parseState = PARSE_ENUM_VALUE;
+                break;
+            }
+
+            case PARSE_ENUM_VALUE:
+            {
+                ConsumeWhitespace();
+                CheckTruncation();
+                if (*inputWcs == L',') {
+                    AdvanceAndCheck(1);
+                    parseState = PARSE_ENUM_DEFAULT_SEP;
+                } else if (*inputWcs == L'}') {
+                    AdvanceAndCheck(1);
+                    parseState = PARSE_ENUM_VALUES;
+                } else {
+                    return 3;
+                }
+                break;
+            }
+
+            case PARSE_ENUM_VALUES:
+            {
+                ConsumeWhitespace();
+                if (*inputWcs != L')') {
+                    return 3;
+                }
+
+                // The default must be one of the listed values.
+                size_t k;
+                for (k = 0; k != itemPtr->values.count; k++) {
+                    MkWstr * valuePtr = &itemPtr->values.elems[k];
+                    if (MkWcsAreEqual(valuePtr->wcs, valuePtr->length, itemPtr->defaultValue.wcs, itemPtr->defaultValue.length)) {
+                        break;
+                    }
+                }
+                if (k == itemPtr->values.count) {
+                    return 3;
+                }
+                int rc = AddEnumType(&enumTypes, configsPtr, configsPtr->count - 1, itemPtr - configPtr->items.elems);
+                if (rc != 0) {
+                    return rc;
+                }
+
+                AdvanceAndCheck(1);
+                parseState = PARSE_DEF;
+                break;
+            }
+
+            case PARSE_ARRAY_KEYWORD:
+            {
+                // Table columns are arrays already.
+                if (tableIndex != SIZE_MAX) {
+                    return 3;
+                }
+
+                ConsumeWhitespace();
+                if (*inputWcs != L'(') {
+                    return 3;
+                }
+                AdvanceAndCheck(1);
+                parseState = PARSE_ARRAY_OPEN;
+                break;
+            }
+
+            case PARSE_ARRAY_OPEN:
+            {
+                ConsumeWhitespace();
+                size_t j = MkWcsFindCharsIndex(inputWcs, inputWcsLength, sepChars, 4);
+                if (j == SIZE_MAX) {
+                    return 3;
+                }
+                itemPtr = configPtr->items.Insert(SIZE_MAX, 1);
+                itemPtr->table = tableIndex;
+                itemPtr->isMap = false;
+                itemPtr->type = arrayType;
+                MkWstrSet(&itemPtr->name, inputWcs, j);
+                itemPtr->validateCallback.length = 0;
+                itemPtr->rangeMin.length = 0;
+                itemPtr->rangeMax.length = 0;
+                itemPtr->maxLength.length = 0;
+                itemPtr->hasOneOf = false;
+                itemPtr->patternPtr = NULL;
+                itemPtr->values.Init(4);
+                AdvanceAndCheck(j);
+                parseState = PARSE_ARRAY_NAME;
+                break;
+            }
+
+            case PARSE_ARRAY_NAME:
+            {
+                ConsumeWhitespace();
+                if (*inputWcs != L',') {
+                    return 3;
+                }
+                AdvanceAndCheck(1);
+                parseState = PARSE_ARRAY_NAME_SEP;
+                break;
+            }
+
+            case PARSE_ARRAY_NAME_SEP:
+            {
+                ConsumeWhitespace();
+                size_t j = MkWcsFindCharsIndex(inputWcs, inputWcsLength, sepChars, 4);
+                if (j == SIZE_MAX) {
+                    return 3;
+                }
+                MkWstrSet(&itemPtr->maxCount, inputWcs, j);
+                AdvanceAndCheck(j);
+                parseState = PARSE_ARRAY_COUNT;
+                break;
+            }
+
+            case PARSE_ARRAY_COUNT:
+            {
+                ConsumeWhitespace();
+                if (*inputWcs != L',') {
+                    return 3;
+                }
+                AdvanceAndCheck(1);
+                parseState = itemPtr->type == ITEM_STR_ARRAY ? PARSE_ARRAY_COUNT_SEP : PARSE_ARRAY_LIST_OPEN;
+                break;
+            }
+
+            case PARSE_ARRAY_COUNT_SEP:
+            {
+                ConsumeWhitespace();
+                size_t j = MkWcsFindCharsIndex(inputWcs, inputWcsLength, sepChars, 4);
+                if (j == SIZE_MAX) {
+                    return 3;
+                }
+                MkWstrSet(&itemPtr->length, inputWcs, j);
+                AdvanceAndCheck(j);
+                ConsumeWhitespace();
+                if (*inputWcs != L',') {
+                    return 3;
+                }
+                AdvanceAndCheck(1);
+                parseState = PARSE_ARRAY_LIST_OPEN;
+                break;
+            }
+
+            case PARSE_ARRAY_LIST_OPEN:
+            {
+                ConsumeWhitespace();
+                if (*inputWcs != L'{') {
+                    return 3;
+                }
+                AdvanceAndCheck(1);
+                parseState = PARSE_ARRAY_LIST;
+                break;
+            }
+
+            case PARSE_ARRAY_LIST:
+            {
+                ConsumeWhitespace();
+                CheckTruncation();
+                if (*inputWcs == L'}') {
+                    AdvanceAndCheck(1);
+                    parseState = PARSE_ARRAY_ELEMS;
+                    break;
+                }
+
+                MkWstr * valuePtr = itemPtr->values.Insert(SIZE_MAX, 1);
+                if (itemPtr->type == ITEM_STR_ARRAY) {
+                    if (!(inputWcsLength >= 2 && *inputWcs == L'L' && *(inputWcs + 1) == L'\"')) {
+                        return 3;
+                    }
+                    AdvanceAndCheck(2);
+
+                    size_t j = 0;
+                    while (inputWcs[j] != L'\"') {
+                        if (inputWcs[j] == L'\\') {
+                            j++;
+                        }
+                        j++;
+                        if (j >= inputWcsLength) {
+                            return 3;
+                        }
+                    }
+                    MkWstrSet(valuePtr, inputWcs, j);
+                    AdvanceAndCheck(j + 1);
+                } else {
+                    size_t j = MkWcsFindCharsIndex(inputWcs, inputWcsLength, listChars, 5);
+                    if (j == SIZE_MAX || j == 0) {
+                        return 3;
+                    }
+                    MkWstrSet(valuePtr, inputWcs, j);
+                    AdvanceAndCheck(j);
+                }
+                parseState = PARSE_ARRAY_ELEM;
+                break;
+            }
+
+            case PARSE_ARRAY_ELEM:
+            {
+                ConsumeWhitespace();
+                CheckTruncation();
+                if (*inputWcs == L',') {
+                    AdvanceAndCheck(1);
+                    parseState = PARSE_ARRAY_LIST;
+                } else if (*inputWcs == L'}') {
+                    AdvanceAndCheck(1);
+                    parseState = PARSE_ARRAY_ELEMS;
+                } else {
+                    return 3;
+                }
+                break;
+            }
+
+            case PARSE_ARRAY_ELEMS:
+            {
+                ConsumeWhitespace();
+                if (*inputWcs != L')') {
+                    return 3;
+                }
+
+                // Literal counts can be checked right away, anything else is left to the compiler.
+                wchar_t * end;
+                unsigned long maxCount = wcstoul(itemPtr->maxCount.wcs, &end, 0);
+                if (end == itemPtr->maxCount.wcs + itemPtr->maxCount.length && itemPtr->values.count > maxCount) {
+                    return 3;
+                }
+
+                AdvanceAndCheck(1);
+                parseState = PARSE_DEF;
+                break;
+            }
+
+            case PARSE_MAP_KEYWORD:
+            {
+                ConsumeWhitespace();
+                if (*inputWcs != L'(') {
+                    return 3;
+                }
+                AdvanceAndCheck(1);
+                parseState = PARSE_MAP_OPEN;
+                break;
+            }
+
+            case PARSE_MAP_OPEN:
+            {
+                ConsumeWhitespace();
+                size_t j = MkWcsFindCharsIndex(inputWcs, inputWcsLength, sepChars, 4);
+                if (j == SIZE_MAX) {
+                    return 3;
+                }
+                itemPtr = configPtr->items.Insert(SIZE_MAX, 1);
+                itemPtr->type = ITEM_NONE;
+                MkWstrSet(&itemPtr->name, inputWcs, j);
+                itemPtr->defaultValue.length = 0;
+                itemPtr->validateCallback.length = 0;
+                itemPtr->rangeMin.length = 0;
+                itemPtr->rangeMax.length = 0;
+                itemPtr->maxLength.length = 0;
+                itemPtr->hasOneOf = false;
+                itemPtr->patternPtr = NULL;
+                itemPtr->table = SIZE_MAX;
+                itemPtr->isMap = true;
+                AdvanceAndCheck(j);
+                parseState = PARSE_MAP_NAME;
+                break;
+            }
+
+            case PARSE_MAP_NAME:
+            {
+                ConsumeWhitespace();
+                if (*inputWcs != L',') {
+                    return 3;
+                }
+                AdvanceAndCheck(1);
+                parseState = PARSE_MAP_NAME_SEP;
+                break;
+            }
+
+            case PARSE_MAP_NAME_SEP:
+            {
+                // Maps can hold any scalar type.
+                ConsumeWhitespace();
+                size_t k;
+                for (k = 0; k != sizeof scalarTokens / sizeof(ScalarToken); k++) {
+                    if (IsKeyword(inputWcs, inputWcsLength, scalarTokens[k].wcs)) {
+                        break;
+                    }
+                }
+                if (k == sizeof scalarTokens / sizeof(ScalarToken)) {
+                    return 3;
+                }
+                itemPtr->type = scalarTokens[k].type;
+                AdvanceAndCheck(wcslen(scalarTokens[k].wcs));
+                parseState = PARSE_MAP_TYPE;
+                break;
+            }
+
+            case PARSE_MAP_TYPE:
+            {
+                ConsumeWhitespace();
+                if (*inputWcs != L')') {
+                    return 3;
+                }
+                AdvanceAndCheck(1);
+                parseState = PARSE_DEF;
+                break;
+            }
+
+            case PARSE_TABLE_KEYWORD:
+            {
+                ConsumeWhitespace();
+                if (*inputWcs != L'(') {
+                    return 3;
+                }
+                AdvanceAndCheck(1);
+                parseState = PARSE_TABLE_OPEN;
+                break;
+            }
+
+            case PARSE_TABLE_OPEN:
+            {
+                ConsumeWhitespace();
+                size_t j = MkWcsFindCharsIndex(inputWcs, inputWcsLength, sepChars, 4);
+                if (j == SIZE_MAX) {
+                    return 3;
+                }
+                tableIndex = configPtr->tables.count;
+                Table * tablePtr = configPtr->tables.Insert(SIZE_MAX, 1);
+                MkWstrSet(&tablePtr->name, inputWcs, j);
+                tablePtr->firstItem = configPtr->items.count;
+                tablePtr->itemCount = 0;
+                AdvanceAndCheck(j);
+                parseState = PARSE_TABLE_NAME;
+                break;
+            }
+
+            case PARSE_TABLE_NAME:
+            {
+                ConsumeWhitespace();
+                if (*inputWcs != L',') {
+                    return 3;
+                }
+                AdvanceAndCheck(1);
+                parseState = PARSE_TABLE_NAME_SEP;
+                break;
+            }
+
+            case PARSE_TABLE_NAME_SEP:
+            {
+                ConsumeWhitespace();
+                size_t j = MkWcsFindCharsIndex(inputWcs, inputWcsLength, closeChars, 4);
+                if (j == SIZE_MAX) {
+                    return 3;
+                }
+                MkWstrSet(&configPtr->tables.elems[tableIndex].maxRows, inputWcs, j);
+                AdvanceAndCheck(j);
+                parseState = PARSE_TABLE_ROWS;
+                break;
+            }
+
+            case PARSE_TABLE_ROWS:
+            {
+                ConsumeWhitespace();
+                if (*inputWcs != L')') {
+                    return 3;
+                }
+                AdvanceAndCheck(1);
+                parseState = PARSE_DEF;
+                break;
+            }
+
+            case PARSE_VALIDATE_KEYWORD:
+            {
+                ConsumeWhitespace();
+                if (*inputWcs != L'(') {
+                    return 3;
+                }
+                AdvanceAndCheck(1);
+                parseState = PARSE_VALIDATE_OPEN;
+                break;
+            }
+
+            case PARSE_VALIDATE_OPEN:
+            {
+                ConsumeWhitespace();
+                size_t j = MkWcsFindCharsIndex(inputWcs, inputWcsLength, sepChars, 4);
+                if (j == SIZE_MAX) {
+                    return 3;
+                }
+                MkWstrSet(&validateName, inputWcs, j);
+                AdvanceAndCheck(j);
+                parseState = PARSE_VALIDATE_NAME;
+                break;
+            }
+
+            case PARSE_VALIDATE_NAME:
+            {
+                ConsumeWhitespace();
+                if (*inputWcs != L',') {
+                    return 3;
+                }
+                AdvanceAndCheck(1);
+                parseState = PARSE_VALIDATE_SEP;
+                break;
+            }
+
+            case PARSE_VALIDATE_SEP:
+            {
+                ConsumeWhitespace();
+                size_t j = MkWcsFindCharsIndex(inputWcs, inputWcsLength, closeChars, 4);
+                if (j == SIZE_MAX) {
+                    return 3;
+                }
+                MkWstrSet(&validateCallback, inputWcs, j);
+
+                // Inside a table only its columns can be referenced.
+                if (!UpdateItemIndex(&itemIndex, configPtr)) {
+                    return 2;
+                }
+                Item * validateItemPtr = FindParsedItem(&itemIndex, configPtr, tableIndex, validateName.wcs, validateName.length);
+                if (validateItemPtr) {
+                    validateItemPtr->validateCallback = validateCallback;
+                }
+
+                AdvanceAndCheck(j);
+                parseState = PARSE_VALIDATE_CALLBACK;
+                break;
+            }
+
+            case PARSE_VALIDATE_CALLBACK:
+            {
+                ConsumeWhitespace();
+                if (*inputWcs != L')') {
+                    return 3;
+                }
+                AdvanceAndCheck(1);
+                parseState = PARSE_DEF;
+                break;
+            }
+
+            case PARSE_CONSTRAINT_KEYWORD:
+            {
+                ConsumeWhitespace();
+                if (*inputWcs != L'(') {
+                    return 3;
+                }
+                AdvanceAndCheck(1);
+                parseState = PARSE_CONSTRAINT_OPEN;
+                break;
+            }
+
+            case PARSE_CONSTRAINT_OPEN:
+            {
+                ConsumeWhitespace();
+                size_t j = MkWcsFindCharsIndex(inputWcs, inputWcsLength, sepChars, 4);
+                if (j == SIZE_MAX) {
+                    return 3;
+                }
+
+                // Like validation statements, but the item must exist since its type decides the checks.
+                if (!UpdateItemIndex(&itemIndex, configPtr)) {
+                    return 2;
+                }
+                constraintItemPtr = FindParsedItem(&itemIndex, configPtr, tableIndex, inputWcs, j);
+                if (!constraintItemPtr) {
+                    return 3;
+                }
+
+                // Ranges apply to numbers, lengths and patterns to strings and value lists to integers and strings.
+                ItemType type = constraintItemPtr->type;
+                switch (constraintState) {
+                    case PARSE_RANGE_MIN:
+                        if ((!IsIntegerType(type) && type != ITEM_FLOAT) || constraintItemPtr->rangeMin.length != 0) {
+                            return 3;
+                        }
+                        break;
+                    case PARSE_MAX_LEN:
+                        if (type != ITEM_WSTR || constraintItemPtr->maxLength.length != 0) {
+                            return 3;
+                        }
+                        break;
+                    case PARSE_PATTERN:
+                        if (type != ITEM_WSTR || constraintItemPtr->isMap || constraintItemPtr->patternPtr) {
+                            return 3;
+                        }
+                        break;
+                    default:
+                        if ((!IsIntegerType(type) && type != ITEM_WSTR) || constraintItemPtr->hasOneOf) {
+                            return 3;
+                        }
+                        break;
+                }
+
+                AdvanceAndCheck(j);
+                parseState = PARSE_CONSTRAINT_NAME;
+                break;
+            }
+
+            case PARSE_CONSTRAINT_NAME:
+            {
+                ConsumeWhitespace();
+                if (*inputWcs != L',') {
+                    return 3;
+                }
+                AdvanceAndCheck(1);
+                parseState = constraintState;
+                break;
+            }
+
+            case PARSE_RANGE_MIN:
+            {
+                ConsumeWhitespace();
+                size_t j = MkWcsFindCharsIndex(inputWcs, inputWcsLength, sepChars, 4);
+                if (j == SIZE_MAX || j == 0) {
+                    return 3;
+                }
+                MkWstrSet(&constraintItemPtr->rangeMin, inputWcs, j);
+                AdvanceAndCheck(j);
+                parseState = PARSE_RANGE_MIN_SEP;
+                break;
+            }
+
+            case PARSE_RANGE_MIN_SEP:
+            {
+                ConsumeWhitespace();
+                if (*inputWcs != L',') {
+                    return 3;
+                }
+                AdvanceAndCheck(1);
+                parseState = PARSE_RANGE_MAX;
+                break;
+            }
+
+            case PARSE_RANGE_MAX:
+            {
+                ConsumeWhitespace();
+                size_t j = MkWcsFindCharsIndex(inputWcs, inputWcsLength, closeChars, 4);
+                if (j == SIZE_MAX || j == 0) {
+                    return 3;
+                }
+                MkWstrSet(&constraintItemPtr->rangeMax, inputWcs, j);
+                AdvanceAndCheck(j);
+                parseState = PARSE_CONSTRAINT_CLOSE;
+                break;
+            }
+
+            case PARSE_MAX_LEN:
+            {
+                ConsumeWhitespace();
+                size_t j = MkWcsFindCharsIndex(inputWcs, inputWcsLength, closeChars, 4);
+                if (j == SIZE_MAX || j == 0) {
+                    return 3;
+                }
+                MkWstrSet(&constraintItemPtr->maxLength, inputWcs, j);
+                AdvanceAndCheck(j);
+                parseState = PARSE_CONSTRAINT_CLOSE;
+                break;
+            }
+
+            case PARSE_ONE_OF_OPEN:
+            {
+                ConsumeWhitespace();
+                if (*inputWcs != L'{') {
+                    return 3;
+                }
+                AdvanceAndCheck(1);
+                constraintItemPtr->oneOf.Init(4);
+                constraintItemPtr->hasOneOf = true;
+                parseState = PARSE_ONE_OF_LIST;
+                break;
+            }
+
+            case PARSE_ONE_OF_LIST:
+            {
+                ConsumeWhitespace();
+                MkWstr * valuePtr = constraintItemPtr->oneOf.Insert(SIZE_MAX, 1);
+                if (constraintItemPtr->type == ITEM_WSTR) {
+                    if (!(inputWcsLength >= 2 && *inputWcs == L'L' && *(inputWcs + 1) == L'\"')) {
+                        return 3;
+                    }
+                    AdvanceAndCheck(2);
+
+                    size_t j = 0;
+                    while (inputWcs[j] != L'\"') {
+                        if (inputWcs[j] == L'\\') {
+                            j++;
+                        }
+                        j++;
+                        if (j >= inputWcsLength) {
+                            return 3;
+                        }
+                    }
+                    MkWstrSet(valuePtr, inputWcs, j);
+                    AdvanceAndCheck(j + 1);
+                } else {
+                    size_t j = MkWcsFindCharsIndex(inputWcs, inputWcsLength, listChars, 5);
+                    if (j == SIZE_MAX || j == 0) {
+                        return 3;
+                    }
+                    MkWstrSet(valuePtr, inputWcs, j);
+                    AdvanceAndCheck(j);
+                }
+
+                // Duplicates would become duplicate case labels of the generated checks.
+                for (size_t k = 0; k + 1 < constraintItemPtr->oneOf.count; k++) {
+                    if (AreOneOfValuesEqual(constraintItemPtr, &constraintItemPtr->oneOf.elems[k], valuePtr)) {
+                        return 3;
+                    }
+                }
+                parseState = PARSE_ONE_OF_ELEM;
+                break;
+            }
+
+            case PARSE_ONE_OF_ELEM:
+            {
+                ConsumeWhitespace();
+                CheckTruncation();
+                if (*inputWcs == L',') {
+                    AdvanceAndCheck(1);
+                    parseState = PARSE_ONE_OF_LIST;
+                } else if (*inputWcs == L'}') {
+                    AdvanceAndCheck(1);
+                    parseState = PARSE_CONSTRAINT_CLOSE;
+                } else {
+                    return 3;
+                }
+                break;
+            }
+
+            case PARSE_PATTERN:
+            {
+                ConsumeWhitespace();
+                if (inputWcsLength >= 2 && *inputWcs == L'L') {
+                    AdvanceAndCheck(1);
+                }
+                if (*inputWcs != L'\"') {
+                    return 3;
+                }
+                AdvanceAndCheck(1);
+
+                size_t j = 0;
+                while (inputWcs[j] != L'\"') {
+                    if (inputWcs[j] == L'\\') {
+                        j++;
+                    }
+                    j++;
+                    if (j >= inputWcsLength) {
+                        return 3;
+                    }
+                }
+                MkWstr patternLiteral;
+                MkWstrSet(&patternLiteral, inputWcs, j);
+                constraintItemPtr->patternPtr = (Pattern *)malloc(sizeof(Pattern));
+                if (!constraintItemPtr->patternPtr) {
+                    return 2;
+                }
+                if (!CompilePattern(&patternLiteral, constraintItemPtr->patternPtr)) {
+                    return 3;
+                }
+                AdvanceAndCheck(j + 1);
+                parseState = PARSE_CONSTRAINT_CLOSE;
+                break;
+            }
+
+            case PARSE_CONSTRAINT_CLOSE:
+            {
+                ConsumeWhitespace();
+                if (*inputWcs != L')') {
+                    return 3;
+                }
+                if (!AreConstraintsValid(constraintItemPtr)) {
+                    return 3;
+                }
+                AdvanceAndCheck(1);
+                parseState = PARSE_DEF;
+                break;
+            }
+        }
+    }
+
+    free(itemIndex.slots);
+    free(enumTypes.elems);
+    return 0;
+}
+
+// Constraints whose bounds or numeric ONE_OF values are no literals can't be checked while generating, they are
+// emitted as static_asserts against the initializer of the value instead.
+enum BakeCheckType {
+    BAKE_CHECK_RANGE = 1,
+    BAKE_CHECK_ONE_OF = 2,
+    BAKE_CHECK_MAX_LEN = 4,
+};
+
+struct BakeCheck {
+    size_t index; // item
+    unsigned types; // BakeCheckType flags
+    MkWstr text; // initializer of the value
+    size_t length; // of strings, for MAX_LEN
+};
+
+// Config file whose values are compiled into the generated code, given by --bake <ConfigName>=<path>. The file is
+// read with the loader of the runtime and every value is checked like the generated parser would, so errors show up
+// when generating instead of at startup.
+struct Bake {
+    MkWstr configName;
+    wchar_t * path;
+    Config * configPtr;
+    MkDynArray<MkWstr> * texts; // per item, the initializer of each table row or of the item; NULL wcs for defaults
+    MkConfGenMap * maps; // per item, only used by maps
+    MkDynArray<BakeCheck> checks;
+};
+
+const wchar_t * loadErrorNames[] = {
+    L"undefined",
+    L"malformed key",
+    L"key too long",
+    L"no value",
+    L"malformed line",
+    L"malformed value",
+    L"value too long",
+    L"wrong value type",
+    L"value out of bounds",
+    L"invalid value",
+    L"row out of bounds",
+    L"out of memory",
+    L"item can't be overridden",
+    L"unknown section",
+    L"include failed",
+};
+
+bool AppendWcs(MkDynArray<wchar_t> * textPtr, const wchar_t * wcs, size_t length) {
+    wchar_t * elems = textPtr->Insert(SIZE_MAX, length);
+    if (!elems) {
+        return false;
+    }
+    wmemcpy(elems, wcs, length);
+    return true;
+}
+
+// Wide string literal of the given characters. Anything outside of printable ASCII is escaped, so the generated file
+// doesn't depend on the source encoding of the compiler.
+bool AppendWstrLiteral(MkDynArray<wchar_t> * textPtr, const wchar_t * wcs, size_t length) {
+    if (!AppendWcs(textPtr, L"L\"", 2)) {
+        return false;
+    }
+    for (size_t i = 0; i != length; i++) {
+        uint32_t ch = (uint32_t)wcs[i];
+        wchar_t buffer[32];
+        if (ch == L'\\' || ch == L'\"') {
+            buffer[0] = L'\\';
+            buffer[1] = (wchar_t)ch;
+            buffer[2] = L'\0';
+        } else if (ch >= 0x20 && ch < 0x7f) {
+            buffer[0] = (wchar_t)ch;
+            buffer[1] = L'\0';
+        } else if (ch < 0xa0) {
+            swprintf_s(buffer, 32, L"\\%03o", ch);
+        } else if (ch >= 0xd800 && ch < 0xdc00 && i + 1 != length && (uint32_t)wcs[i + 1] >= 0xdc00 && (uint32_t)wcs[i + 1] < 0xe000) {
+            swprintf_s(buffer, 32, L"\\U%08x", 0x10000 + ((ch - 0xd800) << 10) + ((uint32_t)wcs[++i] - 0xdc00));
+        } else if (ch >= 0xd800 && ch < 0xe000) {
+            // Lone surrogates have no universal character name, the literal is split so that no hex digit follows.
+            swprintf_s(buffer, 32, L"\\x%x\" L\"", ch);
+        } else if (ch > 0xffff) {
+            swprintf_s(buffer, 32, L"\\U%08x", ch);
+        } else {
+            swprintf_s(buffer, 32, L"\\u%04x", ch);
+        }
+        if (!AppendWcs(textPtr, buffer, wcslen(buffer))) {
+            return false;
+        }
+    }
+    return AppendWcs(textPtr, L"\"", 1);
+}
+
+// Range and one-of constraints of a numeric value. Constraints with bounds or values that are no literals are added
+// to checkTypes if the literal ones don't decide them.
+bool IsBakedValueAllowed(const Item * itemPtr, const Literal * literalPtr, unsigned * checkTypes) {
+    if (itemPtr->rangeMin.length != 0) {
+        Literal minLiteral;
+        Literal maxLiteral;
+        bool isMinLiteral = ParseLiteral(&itemPtr->rangeMin, itemPtr->type, &minLiteral);
+        bool isMaxLiteral = ParseLiteral(&itemPtr->rangeMax, itemPtr->type, &maxLiteral);
+        if (isMinLiteral && CompareLiterals(literalPtr, &minLiteral, itemPtr->type) < 0) {
+            return false;
+        }
+        if (isMaxLiteral && CompareLiterals(literalPtr, &maxLiteral, itemPtr->type) > 0) {
+            return false;
+        }
+        if (!isMinLiteral || !isMaxLiteral) {
+            *checkTypes |= BAKE_CHECK_RANGE;
+        }
+    }
+
+    if (itemPtr->hasOneOf) {
+        bool hasNonLiteral = false;
+        for (size_t k = 0; k != itemPtr->oneOf.count; k++) {
+            Literal valueLiteral;
+            if (!ParseLiteral(&itemPtr->oneOf.elems[k], itemPtr->type, &valueLiteral)) {
+                hasNonLiteral = true;
+            } else if (CompareLiterals(&valueLiteral, literalPtr, itemPtr->type) == 0) {
+                return true;
+            }
+        }
+        if (!hasNonLiteral) {
+            return false;
+        }
+        *checkTypes |= BAKE_CHECK_ONE_OF;
+    }
+
+    return true;
+}
+
+// Size of a value of a map in the struct.
+size_t ItemValueSize(ItemType type) {
+    switch (type) {
+        case ITEM_INT: return sizeof(long);
+        case ITEM_UINT: return sizeof(unsigned long);
+        case ITEM_FLOAT: return sizeof(double);
+        case ITEM_BOOL: return sizeof(bool);
+        case ITEM_I8: case ITEM_U8: return 1;
+        case ITEM_I16: case ITEM_U16: return 2;
+        case ITEM_I32: case ITEM_U32: return 4;
+        default: return 8;
+    }
+}
+
+// Parses a scalar value like the generated parser. The value is appended as initializer text and stored in the
+// representation of its type for maps.
+bool BakeScalar(
+    const Item * itemPtr,
+    const wchar_t * rawValue,
+    size_t rawValueLength,
+    bool isStr,
+    MkDynArray<wchar_t> * textPtr,
+    unsigned char * value,
+    unsigned * checkTypes,
+    MkConfGenLoadErrorType * errorType)
+{
+    wchar_t buffer[64];
+    Literal literal;
+    literal.real = 0;
+    literal.magnitude = 0;
+    literal.isNegative = false;
+
+    if (isStr && itemPtr->type != ITEM_ENUM) {
+        *errorType = MKCONFGEN_LOAD_ERROR_VALUE_TYPE;
+        return false;
+    }
+
+    switch (itemPtr->type) {
+        case ITEM_INT:
+        case ITEM_I8:
+        case ITEM_I16:
+        case ITEM_I32:
+        case ITEM_I64:
+        {
+            wchar_t * end;
+            errno = 0;
+            long long parsedValue = wcstoll(rawValue, &end, 0);
+            if (end != rawValue + rawValueLength) {
+                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_TYPE;
+                return false;
+            }
+
+            // INT is parsed with wcstol, which reports overflows as LONG_MIN or LONG_MAX.
+            long long minValue = LLONG_MIN;
+            long long maxValue = LLONG_MAX;
+            switch (itemPtr->type) {
+                case ITEM_INT: minValue = (long long)LONG_MIN + 1; maxValue = (long long)LONG_MAX - 1; break;
+                case ITEM_I8: minValue = INT8_MIN; maxValue = INT8_MAX; break;
+                case ITEM_I16: minValue = INT16_MIN; maxValue = INT16_MAX; break;
+                case ITEM_I32: minValue = INT32_MIN; maxValue = INT32_MAX; break;
+                default: break;
+            }
+            if (errno == ERANGE || parsedValue < minValue || parsedValue > maxValue) {
+                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_OVERFLOW;
+                return false;
+            }
+
+            literal.isNegative = parsedValue < 0;
+            literal.magnitude = parsedValue < 0 ? 0 - (uint64_t)parsedValue : (uint64_t)parsedValue;
+            if (parsedValue == LLONG_MIN) {
+                wcscpy_s(buffer, 64, L"INT64_MIN");
+            } else {
+                swprintf_s(buffer, 64, L"%lld", parsedValue);
+            }
+
+            int8_t i8 = (int8_t)parsedValue;
+            int16_t i16 = (int16_t)parsedValue;
+            int32_t i32 = (int32_t)parsedValue;
+            long l = (long)parsedValue;
+            switch (itemPtr->type) {
+                case ITEM_INT: memcpy(value, &l, sizeof l); break;
+                case ITEM_I8: memcpy(value, &i8, sizeof i8); break;
+                case ITEM_I16: memcpy(value, &i16, sizeof i16); break;
+                case ITEM_I32: memcpy(value, &i32, sizeof i32); break;
+                default: memcpy(value, &parsedValue, sizeof parsedValue); break;
+            }
+            break;
+        }
+
+        case ITEM_UINT:
+        case ITEM_U8:
+        case ITEM_U16:
+        case ITEM_U32:
+        case ITEM_U64:
+        {
+            wchar_t * end;
+            errno = 0;
+            unsigned long long parsedValue;
+            if (itemPtr->type == ITEM_UINT) {
+                parsedValue = wcstoul(rawValue, &end, 0);
+            } else {
+                parsedValue = wcstoull(rawValue, &end, 0);
+            }
+            if (end != rawValue + rawValueLength || (itemPtr->type != ITEM_UINT && rawValue[0] == L'-')) {
+                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_TYPE;
+                return false;
+            }
+
+            unsigned long long maxValue = ULLONG_MAX;
+            switch (itemPtr->type) {
+                case ITEM_UINT: maxValue = ULONG_MAX - 1; break;
+                case ITEM_U8: maxValue = UINT8_MAX; break;
+                case ITEM_U16: maxValue = UINT16_MAX; break;
+                case ITEM_U32: maxValue = UINT32_MAX; break;
+                default: break;
+            }
+            if ((itemPtr->type != ITEM_UINT && errno == ERANGE) || parsedValue > maxValue) {
+                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_OVERFLOW;
+                return false;
+            }
+
+            literal.magnitude = parsedValue;
+            swprintf_s(buffer, 64, L"%lluu", parsedValue);
+
+            uint8_t u8 = (uint8_t)parsedValue;
+            uint16_t u16 = (uint16_t)parsedValue;
+            uint32_t u32 = (uint32_t)parsedValue;
+            unsigned long ul = (unsigned long)parsedValue;
+            switch (itemPtr->type) {
+                case ITEM_UINT: memcpy(value, &ul, sizeof ul); break;
+                case ITEM_U8: memcpy(value, &u8, sizeof u8); break;
+                case ITEM_U16: memcpy(value, &u16, sizeof u16); break;
+                case ITEM_U32: memcpy(value, &u32, sizeof u32); break;
+                default: memcpy(value, &parsedValue, sizeof parsedValue); break;
+            }
+            break;
+        }
+
+        case ITEM_FLOAT:
+        {
+            wchar_t * end;
+            double parsedValue = wcstod(rawValue, &end);
+            if (end != rawValue + rawValueLength) {
+                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_TYPE;
+                return false;
+            }
+            if (parsedValue == HUGE_VAL || parsedValue == -HUGE_VAL) {
+                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_OVERFLOW;
+                return false;
+            }
+
+            literal.real = parsedValue;
+            if (parsedValue != parsedValue) {
+                wcscpy_s(buffer, 64, L"NAN");
+            } else {
+                swprintf_s(buffer, 64, L"%.17g", parsedValue);
+                if (!wcspbrk(buffer, L".eE")) {
+                    wcscat_s(buffer, 64, L".0");
+                }
+            }
+            memcpy(value, &parsedValue, sizeof parsedValue);
+            break;
+        }
+
+        case ITEM_BOOL:
+        {
+            bool parsedValue;
+            if (!_MkConfGenParseBool(rawValue, rawValueLength, &parsedValue)) {
+                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_TYPE;
+                return false;
+            }
+            wcscpy_s(buffer, 64, parsedValue ? L"true" : L"false");
+            memcpy(value, &parsedValue, sizeof parsedValue);
+            break;
+        }
+
+        case ITEM_DURATION:
+        case ITEM_SIZE:
+        {
+            uint64_t parsedValue;
+            bool isValid = itemPtr->type == ITEM_DURATION
+                ? _MkConfGenParseDuration(rawValue, rawValueLength, &parsedValue, errorType)
+                : _MkConfGenParseSize(rawValue, rawValueLength, &parsedValue, errorType);
+            if (!isValid) {
+                return false;
+            }
+            swprintf_s(buffer, 64, L"%lluu", (unsigned long long)parsedValue);
+            memcpy(value, &parsedValue, sizeof parsedValue);
+            break;
+        }
+
+        case ITEM_ENUM:
+        {
+            size_t k;
+            for (k = 0; k != itemPtr->values.count; k++) {
+                if (MkWcsAreEqual(rawValue, rawValueLength, itemPtr->values.elems[k].wcs, itemPtr->values.elems[k].length)) {
+                    break;
+                }
+            }
+            if (k == itemPtr->values.count) {
+                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_INVALID;
+                return false;
+            }
+            return AppendWcs(textPtr, itemPtr->enumName.wcs, itemPtr->enumName.length)
+                && AppendWcs(textPtr, L"::", 2)
+                && AppendWcs(textPtr, itemPtr->values.elems[k].wcs, itemPtr->values.elems[k].length);
+        }
+
+        default:
+            *errorType = MKCONFGEN_LOAD_ERROR_UNDEFINED;
+            return false;
+    }
+
+    if (itemPtr->type != ITEM_BOOL && itemPtr->type != ITEM_DURATION && itemPtr->type != ITEM_SIZE && !IsBakedValueAllowed(itemPtr, &literal, checkTypes)) {
+        *errorType = MKCONFGEN_LOAD_ERROR_VALUE_INVALID;
+        return false;
+    }
+    return AppendWcs(textPtr, buffer, wcslen(buffer));
+}
+
+bool BakeWstr(
+    const Item * itemPtr,
+    const wchar_t * rawValue,
+    size_t rawValueLength,
+    bool isStr,
+    MkDynArray<wchar_t> * textPtr,
+    unsigned * checkTypes,
+    MkConfGenLoadErrorType * errorType)
+{
+    if (!isStr) {
+        *errorType = MKCONFGEN_LOAD_ERROR_VALUE_TYPE;
+        return false;
+    }
+
+    Literal literal;
+    if (ParseLiteral(&itemPtr->length, ITEM_U64, &literal) && rawValueLength >= literal.magnitude) {
+        *errorType = MKCONFGEN_LOAD_ERROR_VALUE_OVERFLOW;
+        return false;
+    }
+    if (itemPtr->maxLength.length != 0) {
+        if (!ParseLiteral(&itemPtr->maxLength, ITEM_U64, &literal)) {
+            *checkTypes |= BAKE_CHECK_MAX_LEN;
+        } else if (rawValueLength > literal.magnitude) {
+            *errorType = MKCONFGEN_LOAD_ERROR_VALUE_INVALID;
+            return false;
+        }
+    }
+
+    if (itemPtr->hasOneOf) {
+        bool isMatch = false;
+        for (size_t k = 0; k != itemPtr->oneOf.count && !isMatch; k++) {
+            const MkWstr * valuePtr = &itemPtr->oneOf.elems[k];
+            wchar_t * valueWcs = (wchar_t *)malloc((valuePtr->length + 1) * sizeof(wchar_t));
+            if (!valueWcs) {
+                *errorType = MKCONFGEN_LOAD_ERROR_MEMORY;
+                return false;
+            }
+            size_t valueLength = UnescapeLiteral(valuePtr, valueWcs);
+            isMatch = valueLength != SIZE_MAX && MkWcsAreEqual(valueWcs, valueLength, rawValue, rawValueLength);
+            free(valueWcs);
+        }
+        if (!isMatch) {
+            *errorType = MKCONFGEN_LOAD_ERROR_VALUE_INVALID;
+            return false;
+        }
+    }
+
+    if (itemPtr->patternPtr && !MatchPattern(itemPtr->patternPtr, rawValue, rawValueLength)) {
+        *errorType = MKCONFGEN_LOAD_ERROR_VALUE_INVALID;
+        return false;
+    }
+
+    return AppendWstrLiteral(textPtr, rawValue, rawValueLength);
+}
+
+// Lists are parsed with the parsers of the runtime into a buffer, then written as { elements }, count.
+bool BakeArray(
+    const Item * itemPtr,
+    wchar_t * rawValue,
+    size_t rawValueLength,
+    bool isStr,
+    MkDynArray<wchar_t> * textPtr,
+    MkConfGenLoadErrorType * errorType)
+{
+    if (isStr) {
+        *errorType = MKCONFGEN_LOAD_ERROR_VALUE_TYPE;
+        return false;
+    }
+
+    // Without literal dimensions the list is only bounded by its length, the compiler rejects excess elements.
+    Literal literal;
+    size_t maxCount = ParseLiteral(&itemPtr->maxCount, ITEM_U64, &literal) ? (size_t)literal.magnitude : rawValueLength / 2 + 1;
+    size_t strCount = 1;
+    size_t elementSize = itemPtr->type == ITEM_INT_ARRAY ? sizeof(long) : sizeof(double);
+    if (itemPtr->type == ITEM_STR_ARRAY) {
+        strCount = ParseLiteral(&itemPtr->length, ITEM_U64, &literal) ? (size_t)literal.magnitude : rawValueLength + 1;
+        elementSize = strCount * sizeof(wchar_t);
+    }
+
+    void * elements = malloc(maxCount * elementSize + 1);
+    if (!elements) {
+        *errorType = MKCONFGEN_LOAD_ERROR_MEMORY;
+        return false;
+    }
+
+    size_t count;
+    bool isValid;
+    switch (itemPtr->type) {
+        case ITEM_INT_ARRAY:
+            isValid = _MkConfGenParseIntArray(rawValue, rawValueLength, (long *)elements, maxCount, &count, errorType);
+            break;
+        case ITEM_FLOAT_ARRAY:
+            isValid = _MkConfGenParseFloatArray(rawValue, rawValueLength, (double *)elements, maxCount, &count, errorType);
+            break;
+        default:
+            isValid = _MkConfGenParseWstrArray(rawValue, rawValueLength, (wchar_t *)elements, maxCount, strCount, &count, errorType);
+            break;
+    }
+
+    isValid = isValid && AppendWcs(textPtr, L"{", 1);
+    for (size_t k = 0; k != count && isValid; k++) {
+        wchar_t buffer[64];
+        isValid = AppendWcs(textPtr, k == 0 ? L" " : L", ", k == 0 ? 1 : 2);
+        switch (itemPtr->type) {
+            case ITEM_INT_ARRAY:
+                swprintf_s(buffer, 64, L"%ld", ((long *)elements)[k]);
+                isValid = isValid && AppendWcs(textPtr, buffer, wcslen(buffer));
+                break;
+            case ITEM_FLOAT_ARRAY:
+            {
+                double element = ((double *)elements)[k];
+                if (element != element) {
+                    wcscpy_s(buffer, 64, L"NAN");
+                } else {
+                    swprintf_s(buffer, 64, L"%.17g", element);
+                    if (!wcspbrk(buffer, L".eEn")) {
+                        wcscat_s(buffer, 64, L".0");
+                    }
+                }
+                isValid = isValid && AppendWcs(textPtr, buffer, wcslen(buffer));
+                break;
+            }
+            default:
+            {
+                const wchar_t * str = (wchar_t *)elements + k * strCount;
+                isValid = isValid && AppendWstrLiteral(textPtr, str, wcslen(str));
+                break;
+            }
+        }
+    }
+    if (isValid) {
+        wchar_t buffer[32];
+        swprintf_s(buffer, 32, count == 0 ? L"}, %zu" : L" }, %zu", count);
+        isValid = AppendWcs(textPtr, buffer, wcslen(buffer));
+        if (!isValid) {
+            *errorType = MKCONFGEN_LOAD_ERROR_MEMORY;
+        }
+    }
+
+    free(elements);
+    return isValid;
+}
+
+bool BakeValue(
+    void * config,
+    size_t index,
+    size_t row,
+    const wchar_t * mapKey,
+    size_t mapKeyLength,
+    wchar_t * rawValue,
+    size_t rawValueLength,
+    bool isStr,
+    MkConfGenLoadErrorType * errorType)
+{
+    Bake * bakePtr = (Bake *)config;
+    const Item * itemPtr = &bakePtr->configPtr->items.elems[index];
+
+    if (itemPtr->table != SIZE_MAX) {
+        Literal maxRowsLiteral;
+        bool isMaxRowsLiteral = ParseLiteral(&bakePtr->configPtr->tables.elems[itemPtr->table].maxRows, ITEM_U64, &maxRowsLiteral);
+        if (row == SIZE_MAX || (isMaxRowsLiteral && row >= maxRowsLiteral.magnitude)) {
+            *errorType = row == SIZE_MAX ? MKCONFGEN_LOAD_ERROR_KEY_FORMAT : MKCONFGEN_LOAD_ERROR_KEY_INDEX;
+            return false;
+        }
+    } else if (row != SIZE_MAX || (mapKey != NULL) != itemPtr->isMap) {
+        *errorType = MKCONFGEN_LOAD_ERROR_KEY_FORMAT;
+        return false;
+    }
+
+    MkDynArray<wchar_t> text;
+    text.Init(32);
+    if (!text.elems) {
+        *errorType = MKCONFGEN_LOAD_ERROR_MEMORY;
+        return false;
+    }
+
+    unsigned char value[8];
+    unsigned checkTypes = 0;
+    bool isValid;
+    if (IsArray(itemPtr->type)) {
+        isValid = BakeArray(itemPtr, rawValue, rawValueLength, isStr, &text, errorType);
+    } else if (itemPtr->type == ITEM_WSTR) {
+        isValid = BakeWstr(itemPtr, rawValue, rawValueLength, isStr, &text, &checkTypes, errorType);
+    } else {
+        isValid = BakeScalar(itemPtr, rawValue, rawValueLength, isStr, &text, value, &checkTypes, errorType);
+    }
+    if (!isValid) {
+        free(text.elems);
+        return false;
+    }
+
+    // Every line is checked like when loading, including the ones that later lines override.
+    if (checkTypes != 0) {
+        wchar_t * checkText = (wchar_t *)malloc(text.count * sizeof(wchar_t));
+        BakeCheck * checkPtr = checkText ? bakePtr->checks.Insert(SIZE_MAX, 1) : NULL;
+        if (!checkPtr) {
+            free(checkText);
+            free(text.elems);
+            *errorType = MKCONFGEN_LOAD_ERROR_MEMORY;
+            return false;
+        }
+        wmemcpy(checkText, text.elems, text.count);
+        checkPtr->index = index;
+        checkPtr->types = checkTypes;
+        MkWstrSet(&checkPtr->text, checkText, text.count);
+        checkPtr->length = rawValueLength;
+    }
+
+    if (itemPtr->isMap) {
+        free(text.elems);
+
+        // Grown by doubling, the baked map is emitted with the slots of the final capacity.
+        MkConfGenMap * mapPtr = &bakePtr->maps[index];
+        size_t valueSize = ItemValueSize(itemPtr->type);
+        if (mapPtr->count == mapPtr->capacity || mapPtr->keyArenaCapacity - mapPtr->keyArenaLength < mapKeyLength) {
+            size_t additionalCount = mapPtr->count < 8 ? 8 : mapPtr->count;
+            size_t additionalKeyLength = mapPtr->keyArenaLength < 64 * mapKeyLength ? 64 * mapKeyLength : mapPtr->keyArenaLength;
+            if (!_MkConfGenMapReserve(mapPtr, additionalCount, additionalKeyLength, valueSize)) {
+                *errorType = MKCONFGEN_LOAD_ERROR_MEMORY;
+                return false;
+            }
+        }
+        void * mapValue = _MkConfGenMapInsert(mapPtr, mapKey, mapKeyLength);
+        if (!mapValue) {
+            *errorType = MKCONFGEN_LOAD_ERROR_MEMORY;
+            return false;
+        }
+        memcpy(mapValue, value, valueSize);
+        return true;
+    }
+
+    // Later lines win, like when loading.
+    MkDynArray<MkWstr> * textsPtr = &bakePtr->texts[index];
+    size_t slot = row == SIZE_MAX ? 0 : row;
+    if (slot >= textsPtr->count) {
+        size_t oldCount = textsPtr->count;
+        if (!textsPtr->Insert(SIZE_MAX, slot + 1 - oldCount)) {
+            free(text.elems);
+            *errorType = MKCONFGEN_LOAD_ERROR_MEMORY;
+            return false;
+        }
+        for (size_t k = oldCount; k != textsPtr->count; k++) {
+            MkWstrSet(&textsPtr->elems[k], NULL, 0);
+        }
+    }
+    free(textsPtr->elems[slot].wcs);
+    MkWstrSet(&textsPtr->elems[slot], text.elems, text.count);
+    return true;
+}
+
+// 0 - ok
+// 1 - file not readable
+// 2 - out of memory
+// 5 - invalid values, reported on stderr
+int LoadBake(Bake * bakePtr) {
+    Config * configPtr = bakePtr->configPtr;
+    int rc = 0;
+
+    // The keys are laid out like the generated _mkConfGen<ConfigName>Keys.
+    size_t keysLength = 0;
+    for (size_t j = 0; j != configPtr->items.count; j++) {
+        Item * itemPtr = &configPtr->items.elems[j];
+        keysLength += itemPtr->name.length + (itemPtr->table != SIZE_MAX ? configPtr->tables.elems[itemPtr->table].name.length + 1 : 0);
+    }
+    size_t headingNamesLength = 0;
+    for (size_t j = 0; j != configPtr->headings.count; j++) {
+        headingNamesLength += configPtr->headings.elems[j].name.length + 1;
+    }
+
+    size_t * keyIndices = (size_t *)malloc((configPtr->items.count + 1) * sizeof(size_t));
+    wchar_t * keys = (wchar_t *)malloc((keysLength + 1) * sizeof(wchar_t));
+    wchar_t ** headings = (wchar_t **)malloc((configPtr->headings.count + 1) * sizeof(wchar_t *));
+    wchar_t * headingNames = (wchar_t *)malloc((headingNamesLength + 1) * sizeof(wchar_t));
+    bakePtr->texts = (MkDynArray<MkWstr> *)calloc(configPtr->items.count + 1, sizeof(MkDynArray<MkWstr>));
+    bakePtr->maps = (MkConfGenMap *)calloc(configPtr->items.count + 1, sizeof(MkConfGenMap));
+    bakePtr->checks.Init(4);
+    if (!keyIndices || !keys || !headings || !headingNames || !bakePtr->texts || !bakePtr->maps || !bakePtr->checks.elems) {
+        rc = 2;
+    }
+
+    for (size_t j = 0; j != configPtr->items.count && rc == 0; j++) {
+        bakePtr->texts[j].Init(1);
+        if (!bakePtr->texts[j].elems) {
+            rc = 2;
+        }
+    }
+
+    if (rc == 0) {
+        size_t keyIndex = 0;
+        for (size_t j = 0; j != configPtr->items.count; j++) {
+            Item * itemPtr = &configPtr->items.elems[j];
+            keyIndices[j] = keyIndex;
+            if (itemPtr->table != SIZE_MAX) {
+                MkWstr * tableNamePtr = &configPtr->tables.elems[itemPtr->table].name;
+                wmemcpy(keys + keyIndex, tableNamePtr->wcs, tableNamePtr->length);
+                keyIndex += tableNamePtr->length;
+                keys[keyIndex++] = L'.';
+            }
+            wmemcpy(keys + keyIndex, itemPtr->name.wcs, itemPtr->name.length);
+            keyIndex += itemPtr->name.length;
+        }
+        keyIndices[configPtr->items.count] = keyIndex;
+        keys[keyIndex] = L'\0';
+
+        wchar_t * headingName = headingNames;
+        for (size_t j = 0; j != configPtr->headings.count; j++) {
+            MkWstr * namePtr = &configPtr->headings.elems[j].name;
+            wmemcpy(headingName, namePtr->wcs, namePtr->length);
+            headingName[namePtr->length] = L'\0';
+            headings[j] = headingName;
+            headingName += namePtr->length + 1;
+        }
+
+        // Loaded from the file, so includes are resolved relative to it.
+        const _MkConfGenSection section = {
+            NULL, configPtr->items.count, keyIndices, keys, configPtr->headings.count, headings, UINT64_MAX, BakeValue, bakePtr, false, NULL
+        };
+        MkConfGenLoadError * errors;
+        size_t errorCount;
+        bool isLoaded = _MkConfGenLoadFile(bakePtr->path, 1, &section, &errors, &errorCount);
+        if (!isLoaded) {
+            rc = 1;
+        } else if (errorCount != 0) {
+            for (size_t k = 0; k != errorCount; k++) {
+                const wchar_t * file = errors[k].file ? errors[k].file : bakePtr->path;
+                fwprintf(stderr, L"%ls(%zu): error: %ls\n", file, errors[k].line + 1, loadErrorNames[errors[k].type]);
+            }
+            rc = 5;
+        }
+        free(errors);
+    }
+
+    free(keyIndices);
+    free(keys);
+    free(headings);
+    free(headingNames);
+    return rc;
+}
+
+// std::tuple recurses once per element, larger configs would hit the template depth limits of compilers.
+#define MAX_FIELDS_COUNT 256
+
+// Definition file for --bench: items of all kinds with constraints, headings and a table, named item0, item1, ...
+bool MakeBenchDefinition(size_t itemCount, MkDynArray<wchar_t> * inputListPtr) {
+    const wchar_t * const itemFormats[] = {
+        L"MKCONFGEN_ITEM_INT(item%zu, %zu)\nMKCONFGEN_RANGE(item%zu, 0, 1000000000)\nMKCONFGEN_VALIDATE(item%zu, IsEven)\n",
+        L"MKCONFGEN_ITEM_WSTR(item%zu, 32, L\"value%zu\")\nMKCONFGEN_MAX_LEN(item%zu, 24)\n",
+        L"MKCONFGEN_ITEM_BOOL(item%zu, true)\n",
+        L"MKCONFGEN_ITEM_ENUM(item%zu, BenchMode, fast, {fast, safe, off})\n",
+        L"MKCONFGEN_ITEM_U16(item%zu, 8)\nMKCONFGEN_ONE_OF(item%zu, {8, 16, 32})\n",
+        L"MKCONFGEN_ITEM_INT_ARRAY(item%zu, 4, {1, 2})\n",
+        L"MKCONFGEN_ITEM_FLOAT(item%zu, 1.5)\n",
+        L"MKCONFGEN_ITEM_DURATION(item%zu, 30s)\n",
+    };
+    const wchar_t head[] =
+        L"#include \"Import/MkConfGen.h\"\n\n"
+        L"static bool IsEven(long value) {\n    return value % 2 == 0;\n}\n\n"
+        L"MKCONFGEN_FILE_BEGIN\n\nMKCONFGEN_DEF_BEGIN(Bench)\n";
+    const wchar_t tail[] =
+        L"MKCONFGEN_HEADING(Tables)\n"
+        L"MKCONFGEN_TABLE_BEGIN(rows, 16)\nMKCONFGEN_ITEM_WSTR(name, 32, L\"\")\nMKCONFGEN_ITEM_UINT(weight, 1)\nMKCONFGEN_TABLE_END\n"
+        L"MKCONFGEN_ITEM_MAP(limits, U32)\n\nMKCONFGEN_DEF_END\n\nMKCONFGEN_FILE_END\n";
+
+    inputListPtr->Init(128 * itemCount + 1024);
+    if (!inputListPtr->elems) {
+        return false;
+    }
+    if (!AppendWcs(inputListPtr, head, WcsLengthR(head))) {
+        return false;
+    }
+    // Up to 32 headings, configs are limited to 64.
+    size_t headingSpan = itemCount / 32 + 1;
+    wchar_t buffer[512];
+    for (size_t i = 0; i != itemCount; i++) {
+        int length = 0;
+        if (i % headingSpan == 0) {
+            length = swprintf_s(buffer, 512, L"\nMKCONFGEN_HEADING(Part%zu)\n", i / headingSpan);
+            if (!AppendWcs(inputListPtr, buffer, length)) {
+                return false;
+            }
+        }
+        length = swprintf_s(buffer, 512, itemFormats[i % 8], i, i, i, i);
+        if (!AppendWcs(inputListPtr, buffer, length)) {
+            return false;
+        }
+    }
+    return AppendWcs(inputListPtr, tail, WcsLengthR(tail));
+}
+
+struct PackMember {
+    wchar_t * path; // also the name
+    bool isText;
+    MkDynArray<wchar_t> text;
+    char * bytes; // binary members
+    size_t size; // bytes of data
+};
+
+int ComparePackMembers(const void * a, const void * b) {
+    return wcscmp(((const PackMember *)a)->path, ((const PackMember *)b)->path);
+}
+
+#define PACK_ALIGN(offset) (((offset) + 7) & ~(uint64_t)7)
+
+// Writes the files into one pack, see _MkConfGenPackHeader. Texts are decoded like definition files so they can be
+// loaded straight from the mapping, the file after each --binary is copied as it is.
+// 0 - ok
+// 1 - file not readable or packed twice
+// 2 - out of memory
+// 4 - file not writable
+int WritePack(const wchar_t * packPath, wchar_t ** args, size_t argCount) {
+    PackMember * members = (PackMember *)calloc(argCount + 1, sizeof(PackMember));
+    uint64_t * hashes = (uint64_t *)malloc((argCount + 1) * sizeof(uint64_t));
+    if (!members || !hashes) {
+        free(members);
+        free(hashes);
+        return 2;
+    }
+    auto FreeMembers = [members, hashes](size_t memberCount) {
+        for (size_t j = 0; j != memberCount; j++) {
+            free(members[j].isText ? (void *)members[j].text.elems : (void *)members[j].bytes);
+        }
+        free(members);
+        free(hashes);
+    };
+
+    size_t memberCount = 0;
+    for (size_t k = 0; k != argCount; k++) {
+        PackMember * memberPtr = &members[memberCount];
+        memberPtr->isText = wcscmp(args[k], L"--binary") != 0;
+        if (!memberPtr->isText && ++k == argCount) {
+            FreeMembers(memberCount);
+            return 1;
+        }
+        memberPtr->path = args[k];
+        int rc;
+        if (memberPtr->isText) {
+            rc = ReadInputFile(memberPtr->path, &memberPtr->text);
+            memberPtr->size = memberPtr->text.count * sizeof(wchar_t);
+        } else {
+            rc = ReadFileBytes(memberPtr->path, &memberPtr->bytes, &memberPtr->size);
+        }
+        if (rc != 0) {
+            fwprintf(stderr, L"%ls: error: file not readable\n", memberPtr->path);
+            FreeMembers(memberCount);
+            return rc;
+        }
+        memberCount++;
+    }
+
+    qsort(members, memberCount, sizeof(PackMember), ComparePackMembers);
+    for (size_t j = 0; j != memberCount; j++) {
+        if (j != 0 && wcscmp(members[j - 1].path, members[j].path) == 0) {
+            fwprintf(stderr, L"%ls: error: packed twice\n", members[j].path);
+            FreeMembers(memberCount);
+            return 1;
+        }
+        hashes[j] = HashWcs(KEY_HASH_BASIS, members[j].path, wcslen(members[j].path));
+    }
+    ItemHash hash;
+    if (!BuildKeyHash(hashes, memberCount, &hash)) {
+        FreeMembers(memberCount);
+        return 2;
+    }
+
+    _MkConfGenPackHeader header = {};
+    header.magic = _MKCONFGEN_PACK_MAGIC;
+    header.version = _MKCONFGEN_PACK_VERSION;
+    header.charSize = sizeof(wchar_t);
+    header.memberCount = memberCount;
+    header.bucketCount = hash.bucketCount;
+    header.slotCount = hash.slotCount;
+    header.seedsOffset = sizeof(_MkConfGenPackHeader);
+    header.slotsOffset = header.seedsOffset + hash.bucketCount * sizeof(uint32_t);
+    header.entriesOffset = PACK_ALIGN(header.slotsOffset + hash.slotCount * sizeof(uint32_t));
+    uint64_t offset = header.entriesOffset + memberCount * sizeof(_MkConfGenPackEntry);
+    for (size_t j = 0; j != memberCount; j++) {
+        offset += wcslen(members[j].path) * sizeof(wchar_t);
+    }
+    for (size_t j = 0; j != memberCount; j++) {
+        offset = PACK_ALIGN(offset) + members[j].size + (members[j].isText ? sizeof(wchar_t) : 0);
+    }
+    header.fileSize = offset;
+
+    MkDynArray<char> output;
+    output.Init((size_t)header.fileSize);
+    if (!output.elems) {
+        free(hash.seeds);
+        free(hash.slots);
+        FreeMembers(memberCount);
+        return 2;
+    }
+    char * base = output.Insert(SIZE_MAX, (size_t)header.fileSize);
+    memset(base, 0, (size_t)header.fileSize);
+    memcpy(base, &header, sizeof header);
+    memcpy(base + header.seedsOffset, hash.seeds, hash.bucketCount * sizeof(uint32_t));
+    memcpy(base + header.slotsOffset, hash.slots, hash.slotCount * sizeof(uint32_t));
+    free(hash.seeds);
+    free(hash.slots);
+
+    _MkConfGenPackEntry * entries = (_MkConfGenPackEntry *)(base + header.entriesOffset);
+    offset = header.entriesOffset + memberCount * sizeof(_MkConfGenPackEntry);
+    for (size_t j = 0; j != memberCount; j++) {
+        entries[j].nameOffset = offset;
+        entries[j].nameLength = wcslen(members[j].path);
+        memcpy(base + offset, members[j].path, entries[j].nameLength * sizeof(wchar_t));
+        offset += entries[j].nameLength * sizeof(wchar_t);
+    }
+    for (size_t j = 0; j != memberCount; j++) {
+        offset = PACK_ALIGN(offset);
+        entries[j].dataOffset = offset;
+        entries[j].dataSize = members[j].size;
+        entries[j].isText = members[j].isText;
+        memcpy(base + offset, members[j].isText ? (void *)members[j].text.elems : (void *)members[j].bytes, members[j].size);
+        offset += members[j].size + (members[j].isText ? sizeof(wchar_t) : 0);
+    }
+    FreeMembers(memberCount);
+
+    int rc = WriteOutputFile(packPath, &output);
+    free(output.elems);
+    return rc;
+}
+
+#define OutputWcs(s) if (!MkUtf8WriteWcs((s), SIZE_MAX, true, writeCallback, file, nullptr)) return 4
+#define OutputWcsN(s, n) if (!MkUtf8WriteWcs((s), (n), true, writeCallback, file, nullptr)) return 4
+#define OutputWstr(s) if (!MkUtf8WriteWcs((s)->wcs, (s)->length, true, writeCallback, file, nullptr)) return 4
+#define OutputDefaultName(configPtr, itemPtr) \
+    OutputWstr(&(configPtr)->name); \
+    OutputWcs(L"Default_"); \
+    if ((itemPtr)->table != SIZE_MAX) { OutputWstr(&(configPtr)->tables.elems[(itemPtr)->table].name); OutputWcs(L"_"); } \
+    OutputWstr(&(itemPtr)->name)
+#define OutputPatternName(configPtr, itemPtr) \
+    OutputWcs(L"_mkConfGen"); \
+    OutputWstr(&(configPtr)->name); \
+    OutputWcs(L"Pattern_"); \
+    if ((itemPtr)->table != SIZE_MAX) { OutputWstr(&(configPtr)->tables.elems[(itemPtr)->table].name); OutputWcs(L"_"); } \
+    OutputWstr(&(itemPtr)->name)
+#define OutputItemRef(configPtr, itemPtr) \
+    OutputWcs(L"configPtr->"); \
+    if ((itemPtr)->table != SIZE_MAX) { OutputWstr(&(configPtr)->tables.elems[(itemPtr)->table].name); OutputWcs(L"."); } \
+    OutputWstr(&(itemPtr)->name); \
+    if ((itemPtr)->table != SIZE_MAX) { OutputWcs(L"[row]"); }
+#define OutputRowCountUpdate(configPtr, itemPtr) \
+    if ((itemPtr)->table != SIZE_MAX) { \
+        OutputWcs(L"\n            if (configPtr->"); \
+        OutputWstr(&(configPtr)->tables.elems[(itemPtr)->table].name); \
+        OutputWcs(L"Count <= row) configPtr->"); \
+        OutputWstr(&(configPtr)->tables.elems[(itemPtr)->table].name); \
+        OutputWcs(L"Count = row + 1;"); \
+    }
+#define OutputAssignValue(configPtr, itemPtr) \
+    if ((itemPtr)->isMap) { \
+        OutputWcs(L"\n            "); \
+        OutputWcs(ItemTypeName((itemPtr)->type)); \
+        OutputWcs(L" * mapValue = ("); \
+        OutputWcs(ItemTypeName((itemPtr)->type)); \
+        OutputWcs(L" *)_MkConfGenMapInsert(&configPtr->"); \
+        OutputWstr(&(itemPtr)->name); \
+        OutputWcs(L", mapKey, mapKeyLength);"); \
+        OutputWcs(L"\n            if (!mapValue) {"); \
+        OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_MEMORY;"); \
+        OutputWcs(L"\n                return false;"); \
+        OutputWcs(L"\n            }"); \
+        OutputWcs(L"\n            *mapValue = value;"); \
+    } else { \
+        OutputWcs(L"\n            "); \
+        OutputItemRef(configPtr, itemPtr); \
+        OutputWcs(L" = value;"); \
+        OutputRowCountUpdate(configPtr, itemPtr); \
+    }
+#define OutputParseArray(itemPtr, isTemporary) \
+    switch ((itemPtr)->type) { \
+        case ITEM_INT_ARRAY: OutputWcs(L"\n            bool isValid = _MkConfGenParseIntArray(rawValue, rawValueLength, "); break; \
+        case ITEM_FLOAT_ARRAY: OutputWcs(L"\n            bool isValid = _MkConfGenParseFloatArray(rawValue, rawValueLength, "); break; \
+        default: OutputWcs(L"\n            bool isValid = _MkConfGenParseWstrArray(rawValue, rawValueLength, (wchar_t *)"); break; \
+    } \
+    if (isTemporary) { OutputWcs(L"*values"); } else { OutputWcs(L"configPtr->"); OutputWstr(&(itemPtr)->name); } \
+    OutputWcs(L", "); OutputWstr(&(itemPtr)->maxCount); \
+    if ((itemPtr)->type == ITEM_STR_ARRAY) { OutputWcs(L", "); OutputWstr(&(itemPtr)->length); } \
+    if (isTemporary) { OutputWcs(L", &count, errorType);"); } \
+    else { OutputWcs(L", &configPtr->"); OutputWstr(&(itemPtr)->name); OutputWcs(L"Count, errorType);"); } \
+    if ((itemPtr)->validateCallback.length != 0) { \
+        OutputWcs(L"\n            if (isValid && !"); OutputWstr(&(itemPtr)->validateCallback); \
+        if (isTemporary) { OutputWcs(L"(*values, count)) {"); } \
+        else { \
+            OutputWcs(L"(configPtr->"); OutputWstr(&(itemPtr)->name); \
+            OutputWcs(L", configPtr->"); OutputWstr(&(itemPtr)->name); OutputWcs(L"Count)) {"); \
+        } \
+        OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_INVALID;"); \
+        OutputWcs(L"\n                isValid = false;"); \
+        OutputWcs(L"\n            }"); \
+    }
+#define OutputConstraintChecks(itemPtr) \
+    if ((itemPtr)->rangeMin.length != 0) { \
+        OutputWcs(L"\n            if ("); \
+        if (HasLowerBound(itemPtr)) { OutputWcs(L"value < "); OutputWstr(&(itemPtr)->rangeMin); OutputWcs(L" || "); } \
+        OutputWcs(L"value > "); \
+        OutputWstr(&(itemPtr)->rangeMax); \
+        OutputWcs(L") {"); \
+        OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_INVALID;"); \
+        OutputWcs(L"\n                return false;"); \
+        OutputWcs(L"\n            }"); \
+    } \
+    if ((itemPtr)->hasOneOf) { \
+        OutputWcs(L"\n            switch (value) {"); \
+        for (size_t l = 0; l != (itemPtr)->oneOf.count; l++) { \
+            OutputWcs(L"\n                case "); \
+            OutputWstr(&(itemPtr)->oneOf.elems[l]); \
+            OutputWcs(L":"); \
+        } \
+        OutputWcs(L"\n                    break;"); \
+        OutputWcs(L"\n                default:"); \
+        OutputWcs(L"\n                    *errorType = MKCONFGEN_LOAD_ERROR_VALUE_INVALID;"); \
+        OutputWcs(L"\n                    return false;"); \
+        OutputWcs(L"\n            }"); \
+    }
+#define OutputWriteItemValue(configPtr, itemPtr, indent) \
+    if (IsArray((itemPtr)->type)) { \
+        OutputWcs(indent); OutputWcs(L"*pos++ = L'[';"); \
+        OutputWcs(indent); OutputWcs(L"for (size_t k = 0; k != "); OutputItemRef(configPtr, itemPtr); OutputWcs(L"Count; k++) {"); \
+        OutputWcs(indent); OutputWcs(L"    if (k != 0) {"); \
+        OutputWcs(indent); OutputWcs(L"        pos = _MkConfGenWriteWcs(pos, L\", \", 2);"); \
+        OutputWcs(indent); OutputWcs(L"    }"); \
+        OutputWcs(indent); OutputWcs(L"    pos = "); OutputWcs(ItemWriterName((itemPtr)->type)); OutputWcs(L"(pos, "); \
+        OutputItemRef(configPtr, itemPtr); OutputWcs((itemPtr)->type == ITEM_STR_ARRAY ? L"[k], &isWritable);" : L"[k]);"); \
+        OutputWcs(indent); OutputWcs(L"}"); \
+        OutputWcs(indent); OutputWcs(L"*pos++ = L']';"); \
+    } else if ((itemPtr)->type == ITEM_ENUM) { \
+        OutputWcs(indent); OutputWcs(L"switch ("); OutputItemRef(configPtr, itemPtr); OutputWcs(L") {"); \
+        for (size_t e = 0; e != (itemPtr)->values.count; e++) { \
+            wchar_t caseBuffer[32]; \
+            swprintf_s(caseBuffer, 32, L"\", %zu); break;", (itemPtr)->values.elems[e].length); \
+            OutputWcs(indent); OutputWcs(L"    case "); OutputWstr(&(itemPtr)->enumName); OutputWcs(L"::"); \
+            OutputWstr(&(itemPtr)->values.elems[e]); OutputWcs(L": pos = _MkConfGenWriteWcs(pos, L\""); \
+            OutputWstr(&(itemPtr)->values.elems[e]); OutputWcs(caseBuffer); \
+        } \
+        OutputWcs(indent); OutputWcs(L"}"); \
+    } else { \
+        OutputWcs(indent); OutputWcs(L"pos = "); OutputWcs(ItemWriterName((itemPtr)->type)); OutputWcs(L"(pos, "); \
+        OutputItemRef(configPtr, itemPtr); OutputWcs((itemPtr)->type == ITEM_WSTR ? L", &isWritable);" : L");"); \
+    }
+#define OutputBakedValue(bakePtr, itemPtr, j, row) \
+    if ((row) < (bakePtr)->texts[j].count && (bakePtr)->texts[j].elems[row].wcs) { \
+        OutputWstr(&(bakePtr)->texts[j].elems[row]); \
+    } else if ((itemPtr)->type == ITEM_WSTR) { \
+        OutputWcs(L"L\""); OutputWstr(&(itemPtr)->defaultValue); OutputWcs(L"\""); \
+    } else if ((itemPtr)->type == ITEM_ENUM) { \
+        OutputWstr(&(itemPtr)->enumName); OutputWcs(L"::"); OutputWstr(&(itemPtr)->defaultValue); \
+    } else if (IsArray((itemPtr)->type)) { \
+        OutputWcs(L"{"); \
+        for (size_t e = 0; e != (itemPtr)->values.count; e++) { \
+            OutputWcs(e == 0 ? L" " : L", "); \
+            if ((itemPtr)->type == ITEM_STR_ARRAY) { OutputWcs(L"L\""); } \
+            OutputWstr(&(itemPtr)->values.elems[e]); \
+            if ((itemPtr)->type == ITEM_STR_ARRAY) { OutputWcs(L"\""); } \
+        } \
+        wchar_t countBuffer[32]; \
+        swprintf_s(countBuffer, 32, (itemPtr)->values.count == 0 ? L"}, %zu" : L" }, %zu", (itemPtr)->values.count); \
+        OutputWcs(countBuffer); \
+    } else if ((itemPtr)->type == ITEM_DURATION || (itemPtr)->type == ITEM_SIZE) { \
+        uint64_t unitValue; \
+        ParseUnitValue(&(itemPtr)->defaultValue, (itemPtr)->type, &unitValue); \
+        wchar_t unitBuffer[32]; \
+        swprintf_s(unitBuffer, 32, L"%lluu", (unsigned long long)unitValue); \
+        OutputWcs(unitBuffer); \
+    } else { \
+        OutputWstr(&(itemPtr)->defaultValue); \
+    }
+#define OutputItemType(itemPtr) if ((itemPtr)->type == ITEM_ENUM) { OutputWstr(&(itemPtr)->enumName); } else { OutputWcs(ItemTypeName((itemPtr)->type)); }
+#define OutputItemDims(itemPtr) \
+    if (IsArray((itemPtr)->type)) { OutputWcs(L"["); OutputWstr(&(itemPtr)->maxCount); OutputWcs(L"]"); } \
+    if ((itemPtr)->type == ITEM_WSTR || (itemPtr)->type == ITEM_STR_ARRAY) { OutputWcs(L"["); OutputWstr(&(itemPtr)->length); OutputWcs(L"]"); }
+#define OutputGetterHead(configPtr, itemPtr, kind, qualifier, paramName) \
+    if (IsArray((itemPtr)->type) || (itemPtr)->type == ITEM_WSTR) { \
+        OutputWcs(L"\n\nconst "); OutputWcs(ItemTypeName((itemPtr)->type)); OutputWcs(L" * "); \
+    } else { \
+        OutputWcs(L"\n\n"); OutputItemType(itemPtr); OutputWcs(L" "); \
+    } \
+    OutputWstr(&(configPtr)->name); OutputWcs(kind); OutputWcs(L"Get_"); OutputWstr(&(itemPtr)->name); \
+    OutputWcs(L"("); OutputWcs(qualifier); OutputWstr(&(configPtr)->name); OutputWcs(kind); OutputWcs(L" * "); OutputWcs(paramName); \
+    OutputWcs(IsArray((itemPtr)->type) ? L", size_t * count)" : L")")
+#define OutputSharedGetterHead(configPtr, itemPtr) \
+    OutputWcs(L"\n\n"); OutputItemType(itemPtr); OutputWcs(L" "); \
+    OutputWstr(&(configPtr)->name); OutputWcs(L"SharedGet_"); OutputWstr(&(itemPtr)->name); \
+    OutputWcs(L"(const MkConfGenShared * sharedPtr)")
+#define OutputReplicaGetterHead(configPtr, itemPtr) \
+    OutputWcs(L"\n\n"); OutputItemType(itemPtr); OutputWcs(L" "); \
+    OutputWstr(&(configPtr)->name); OutputWcs(L"ReplicaGet_"); OutputWstr(&(itemPtr)->name); \
+    OutputWcs(L"(const MkConfGenReplicas * replicasPtr)")
+#define OutputReplicaMapArgs(configPtr, mapCount) \
+    if ((mapCount) != 0) { \
+        wchar_t mapCountBuffer[32]; \
+        swprintf_s(mapCountBuffer, 32, L"MapOffsets, %zu", (mapCount)); \
+        OutputWcs(L", _mkConfGen"); OutputWstr(&(configPtr)->name); OutputWcs(mapCountBuffer); \
+    } else { \
+        OutputWcs(L", NULL, 0"); \
+    }
+#define OutputHeadingArgs(configPtr) \
+    if ((configPtr)->headings.count != 0) { \
+        wchar_t headingCountBuffer[32]; \
+        swprintf_s(headingCountBuffer, 32, L"%zu, _mkConfGen", (configPtr)->headings.count); \
+        OutputWcs(headingCountBuffer); \
+        OutputWstr(&(configPtr)->name); \
+        OutputWcs(L"Headings"); \
+    } else { \
+        OutputWcs(L"0, NULL"); \
+    }
+#define OutputPrepareArg(configPtr) \
+    if (CountMaps(configPtr) != 0) { \
+        OutputWcs(L"_MkConfGen"); \
+        OutputWstr(&(configPtr)->name); \
+        OutputWcs(L"Prepare"); \
+    } else { \
+        OutputWcs(L"NULL"); \
+    }
+#define OutputConfigParamName(configPtr) \
+    { wchar_t firstChar = towlower((configPtr)->name.wcs[0]); OutputWcsN(&firstChar, 1); } \
+    OutputWcsN((configPtr)->name.wcs + 1, (configPtr)->name.length - 1); \
+    OutputWcs(L"Ptr")
+#define OutputLoadAllHead() \
+    OutputWcs(L"\n\nbool "); \
+    OutputWcsN(fileName, fileBaseNameLength); \
+    OutputWcs(L"LoadAll("); \
+    for (size_t i = 0; i != configs.count; i++) { \
+        OutputWstr(&configs.elems[i].name); \
+        OutputWcs(L" * "); \
+        OutputConfigParamName(&configs.elems[i]); \
+        OutputWcs(L", "); \
+    } \
+    OutputWcs(L"const wchar_t * configWcs, size_t configLength, MkConfGenLoadError ** errors, size_t * errorCount)")
+
+// Errors:
+// 1 - file not readable
+// 2 - out of memory
+// 3 - syntax error
+// 4 - write error
+// 5 - invalid baked config file
+int wmain(int argCount, wchar_t ** args) {
+    // MkConfGen [--split] [--bake <ConfigName>=<path>]... <definition file>
+    // MkConfGen --bench <item count>
+    // MkConfGen --pack <pack file> [[--binary] <file>]...
+    if (argCount < 2) {
+        return 1;
+    }
+    if (wcscmp(args[1], L"--pack") == 0) {
+        return argCount < 3 ? 1 : WritePack(args[2], args + 3, argCount - 3);
+    }
+    wchar_t * definitionPath = args[argCount - 1];
+
+    int rc;
+
+    // Generates Bench<item count>Gen.* from a synthetic definition and prints how long parsing and output took.
+    size_t benchItemCount = 0;
+    wchar_t benchPath[MAX_PATH];
+    if (argCount == 3 && wcscmp(args[1], L"--bench") == 0) {
+        benchItemCount = wcstoull(args[2], NULL, 10);
+        if (benchItemCount == 0) {
+            return 1;
+        }
+        swprintf_s(benchPath, MAX_PATH, L"Bench%zu.cpp", benchItemCount);
+        definitionPath = benchPath;
+    }
+
+    bool isSplit = false;
+    size_t bakeCount = 0;
+    Bake * bakes = (Bake *)calloc(argCount, sizeof(Bake));
+    if (!bakes) {
+        return 2;
+    }
+    for (int k = 1; benchItemCount == 0 && k != argCount - 1; k++) {
+        if (wcscmp(args[k], L"--split") == 0) {
+            isSplit = true;
+            continue;
+        }
+        if (wcscmp(args[k], L"--bake") != 0 || k + 1 == argCount - 1) {
+            return 1;
+        }
+        wchar_t * bakeArg = args[++k];
+        wchar_t * separator = wcschr(bakeArg, L'=');
+        if (!separator) {
+            return 1;
+        }
+        MkWstrSet(&bakes[bakeCount].configName, bakeArg, separator - bakeArg);
+        bakes[bakeCount].path = separator + 1;
+        bakeCount++;
+    }
+
+    MkDynArray<wchar_t> inputWcsList;
+    if (benchItemCount != 0) {
+        if (!MakeBenchDefinition(benchItemCount, &inputWcsList)) {
+            return 2;
+        }
+    } else {
+        rc = ReadInputFile(definitionPath, &inputWcsList);
+        if (rc != 0) return rc;
+    }
+
+    LARGE_INTEGER parseBeginTime;
+    QueryPerformanceCounter(&parseBeginTime);
+
+    MkDynArray<Config> configs;
+    configs.Init(4);
+    MkWstr includeLine;
+    MkWstr inputHead;
+    rc = Parse(&inputWcsList, &configs, &includeLine, &inputHead);
+    if (rc != 0) return rc;
+
+    LARGE_INTEGER parseEndTime;
+    QueryPerformanceCounter(&parseEndTime);
+
+    // All baked files are checked before anything is written, so a failing build leaves no half-updated output.
+    for (size_t k = 0; k != bakeCount; k++) {
+        Bake * bakePtr = &bakes[k];
+        for (size_t i = 0; i != configs.count; i++) {
+            if (MkWcsAreEqual(configs.elems[i].name.wcs, configs.elems[i].name.length, bakePtr->configName.wcs, bakePtr->configName.length)) {
+                bakePtr->configPtr = &configs.elems[i];
+            }
+        }
+        for (size_t l = 0; l != k && bakePtr->configPtr; l++) {
+            if (bakes[l].configPtr == bakePtr->configPtr) {
+                bakePtr->configPtr = NULL;
+            }
+        }
+        if (!bakePtr->configPtr) {
+            fwprintf(stderr, L"%ls: error: unknown or repeated config for --bake\n", bakePtr->path);
+            return 5;
+        }
+
+        int bakeRc = LoadBake(bakePtr);
+        if (bakeRc != 0) {
+            rc = bakeRc;
+        }
+    }
+    if (rc != 0) return rc;
+
+    const wchar_t * fileName;
+    size_t fileBaseNameLength;
+    {
+        fileName = wcsrchr(definitionPath, L'\\');
+        if (fileName) {
+            fileName++;
+        } else {
+            fileName = definitionPath;
+        }
+        const wchar_t * extBegin = wcsrchr(fileName, L'.');
+        if (extBegin) {
+            fileBaseNameLength = extBegin - fileName;
+        } else {
+            fileBaseNameLength = wcslen(fileName);
+        }
+    }
+
+    wchar_t fileBaseNameUpper[MAX_PATH];
+    for (size_t i = 0; i != fileBaseNameLength; i++) {
+        fileBaseNameUpper[i] = towupper(fileName[i]);
+    }
+    fileBaseNameUpper[fileBaseNameLength] = L'\0';
+
+    auto writeCallback = [](void * stream, const void * buffer, ulong count, void * status) {
+        MkDynArray<char> * output = (MkDynArray<char> *)stream;
+        char * newElems = output->Insert(SIZE_MAX, count);
+        if (!newElems) {
+            return false;
+        }
+        memcpy(newElems, buffer, count);
+        return true;
+    };
+
+    wchar_t headerFileName[MAX_PATH];
+    {
+        wcsncpy_s(headerFileName, MAX_PATH, fileName, fileBaseNameLength);
+        wcscat_s(headerFileName, MAX_PATH, L"Gen.h");
+
+        wchar_t headerFilePath[MAX_PATH];
+        wcsncpy_s(headerFilePath, MAX_PATH, definitionPath, fileName - definitionPath);
+        wcscat_s(headerFilePath, MAX_PATH, headerFileName);
+
+        MkDynArray<char> output;
+        output.Init(65536);
+        if (!output.elems) {
+            return 2;
+        }
+        void * file = &output;
+
+        OutputWcs(L"//---------------------//\n");
+        OutputWcs(L"// AUTO-GENERATED FILE //\n");
+        OutputWcs(L"//---------------------//\n\n");
+
+        OutputWcs(L"#ifndef _MKCONFGEN_");
+        OutputWcs(fileBaseNameUpper);
+        OutputWcs(L"_H\n");
+
+        OutputWcs(L"#define _MKCONFGEN_");
+        OutputWcs(fileBaseNameUpper);
+        OutputWcs(L"_H\n");
+
+        OutputWcs(L"\n#include <errno.h>");
+        OutputWcs(L"\n#include <limits.h>");
+        OutputWcs(L"\n#include <math.h>");
+        OutputWcs(L"\n#include <stddef.h>");
+        OutputWcs(L"\n#include <stdint.h>");
+        OutputWcs(L"\n#include <stdlib.h>");
+        OutputWcs(L"\n#include <string.h>");
+        OutputWcs(L"\n#include <wchar.h>\n");
+        OutputWstr(&includeLine);
+
+        // Enums
+
+        bool hasEnums = false;
+        for (size_t i = 0; i != configs.count; i++) {
+            Config * configPtr = &configs.elems[i];
+            for (size_t j = 0; j != configPtr->items.count; j++) {
+                Item * itemPtr = &configPtr->items.elems[j];
+                if (itemPtr->type != ITEM_ENUM) {
+                    continue;
+                }
+
+                // Items may share an enum type, emit each one only once.
+                bool isDuplicate = false;
+                for (size_t k = 0; k <= i && !isDuplicate; k++) {
+                    Config * prevConfigPtr = &configs.elems[k];
+                    size_t prevItemCount = k == i ? j : prevConfigPtr->items.count;
+                    for (size_t l = 0; l != prevItemCount; l++) {
+                        Item * prevItemPtr = &prevConfigPtr->items.elems[l];
+                        if (prevItemPtr->type == ITEM_ENUM
+                            && MkWcsAreEqual(prevItemPtr->enumName.wcs, prevItemPtr->enumName.length, itemPtr->enumName.wcs, itemPtr->enumName.length))
+                        {
+                            isDuplicate = true;
+                            break;
+                        }
+                    }
+                }
+                if (isDuplicate) {
+                    continue;
+                }
+
+                if (!hasEnums) {
+                    OutputWcs(L"\n");
+                    hasEnums = true;
+                }
+
+                OutputWcs(L"\nenum class ");
+                OutputWstr(&itemPtr->enumName);
+                OutputWcs(itemPtr->values.count <= 256 ? L" : uint8_t {" : L" : uint16_t {");
+                for (size_t k = 0; k != itemPtr->values.count; k++) {
+                    OutputWcs(L"\n    ");
+                    OutputWstr(&itemPtr->values.elems[k]);
+                    OutputWcs(L",");
+                }
+                OutputWcs(L"\n};");
+            }
+        }
+
+        for (size_t i = 0; i != configs.count; i++) {
+            Config * configPtr = &configs.elems[i];
+
+            OutputWcs(L"\n\nstruct ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" {");
+
+            size_t boolCount = 0;
+            size_t headingIndex = 0;
+            Heading * headingPtr;
+            if (headingIndex != configPtr->headings.count) {
+                headingPtr = &configPtr->headings.elems[headingIndex];
+            } else {
+                headingPtr = NULL;
+            }
+
+            for (size_t j = 0; j != configPtr->items.count; j++) {
+                if (headingPtr != NULL && j == headingPtr->index) {
+                    OutputWcs(L"\n\n    // ");
+                    OutputWstr(&headingPtr->name);
+
+                    if (++headingIndex != configPtr->headings.count) {
+                        headingPtr = &configPtr->headings.elems[headingIndex];
+                    } else {
+                        headingPtr = NULL;
+                    }
+                }
+
+                Item * itemPtr = &configPtr->items.elems[j];
+
+                // Tables are stored as one array per column.
+                if (itemPtr->table != SIZE_MAX) {
+                    Table * tablePtr = &configPtr->tables.elems[itemPtr->table];
+                    OutputWcs(L"\n    size_t ");
+                    OutputWstr(&tablePtr->name);
+                    OutputWcs(L"Count;");
+                    OutputWcs(L"\n    struct {");
+                    for (size_t k = 0; k != tablePtr->itemCount; k++) {
+                        Item * columnPtr = &configPtr->items.elems[tablePtr->firstItem + k];
+                        OutputWcs(L"\n        ");
+                        OutputItemType(columnPtr);
+                        OutputWcs(L" ");
+                        OutputWstr(&columnPtr->name);
+                        OutputWcs(L"[");
+                        OutputWstr(&tablePtr->maxRows);
+                        OutputWcs(L"]");
+                        OutputItemDims(columnPtr);
+                        OutputWcs(L";");
+                    }
+                    OutputWcs(L"\n    } ");
+                    OutputWstr(&tablePtr->name);
+                    OutputWcs(L";");
+
+                    j += tablePtr->itemCount - 1;
+                    continue;
+                }
+
+                if (itemPtr->isMap) {
+                    OutputWcs(L"\n    MkConfGenMap ");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L";");
+                    continue;
+                }
+
+                if (itemPtr->type == ITEM_BOOL) {
+                    boolCount++;
+                    continue;
+                }
+
+                OutputWcs(L"\n    ");
+                OutputItemType(itemPtr);
+                OutputWcs(L" ");
+                OutputWstr(&itemPtr->name);
+                OutputItemDims(itemPtr);
+                OutputWcs(L";");
+
+                if (IsArray(itemPtr->type)) {
+                    OutputWcs(L"\n    size_t ");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L"Count;");
+                }
+            }
+
+            // Booleans are packed into bitfield words at the end of the struct.
+            if (boolCount != 0) {
+                OutputWcs(L"\n\n    // Flags");
+                for (size_t j = 0; j != configPtr->items.count; j++) {
+                    Item * itemPtr = &configPtr->items.elems[j];
+                    if (itemPtr->type == ITEM_BOOL && itemPtr->table == SIZE_MAX && !itemPtr->isMap) {
+                        OutputWcs(L"\n    unsigned int ");
+                        OutputWstr(&itemPtr->name);
+                        OutputWcs(L" : 1;");
+                    }
+                }
+            }
+
+            OutputWcs(L"\n};");
+
+            OutputWcs(L"\n\n// Overrides of single items on top of a shared base config, read through the OverlayGet_ functions.");
+            OutputWcs(L"\nstruct ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Overlay {");
+            OutputWcs(L"\n    const ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * base;");
+            OutputWcs(L"\n    MkConfGenOverlay overlay;");
+            OutputWcs(L"\n};");
+
+            OutputWcs(L"\n\n// Values parsed on first access through the LazyGet_ functions, the source must outlive the struct.");
+            OutputWcs(L"\nstruct ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Lazy {");
+            OutputWcs(L"\n    ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" values;");
+            OutputWcs(L"\n    const wchar_t * source;");
+            wchar_t tmpBuffer[32];
+            swprintf_s(tmpBuffer, 32, L"items[%zu];", configPtr->items.count);
+            OutputWcs(L"\n    _MkConfGenLazyItem ");
+            OutputWcs(tmpBuffer);
+            OutputWcs(L"\n};");
+        }
+
+        OutputWcs(L"\n");
+        OutputWcs(L"\n//--------------");
+        OutputWcs(L"\n// Section Masks");
+
+        for (size_t i = 0; i != configs.count; i++) {
+            Config * configPtr = &configs.elems[i];
+
+            OutputWcs(L"\n\n// ");
+            OutputWstr(&configPtr->name);
+
+            for (size_t j = 0; j != configPtr->headings.count; j++) {
+                Heading * headingPtr = &configPtr->headings.elems[j];
+                OutputWcs(L"\n#define ");
+                for (size_t k = 0; k != configPtr->name.length; k++) {
+                    wchar_t upperChar = towupper(configPtr->name.wcs[k]);
+                    OutputWcsN(&upperChar, 1);
+                }
+                OutputWcs(L"_SECTION_");
+                for (size_t k = 0; k != headingPtr->name.length; k++) {
+                    wchar_t upperChar = towupper(headingPtr->name.wcs[k]);
+                    OutputWcsN(&upperChar, 1);
+                }
+                wchar_t tmpBuffer[32];
+                swprintf_s(tmpBuffer, 32, L" ((uint64_t)1 << %zu)", j);
+                OutputWcs(tmpBuffer);
+            }
+        }
+
+        OutputWcs(L"\n");
+        OutputWcs(L"\n//-------------");
+        OutputWcs(L"\n// Item Indices");
+
+        for (size_t i = 0; i != configs.count; i++) {
+            Config * configPtr = &configs.elems[i];
+
+            OutputWcs(L"\n\n// ");
+            OutputWstr(&configPtr->name);
+
+            for (size_t j = 0; j != configPtr->items.count; j++) {
+                Item * itemPtr = &configPtr->items.elems[j];
+                OutputWcs(L"\n#define ");
+                for (size_t k = 0; k != configPtr->name.length; k++) {
+                    wchar_t upperChar = towupper(configPtr->name.wcs[k]);
+                    OutputWcsN(&upperChar, 1);
+                }
+                OutputWcs(L"_ITEM_");
+                if (itemPtr->table != SIZE_MAX) {
+                    MkWstr * tableNamePtr = &configPtr->tables.elems[itemPtr->table].name;
+                    for (size_t k = 0; k != tableNamePtr->length; k++) {
+                        wchar_t upperChar = towupper(tableNamePtr->wcs[k]);
+                        OutputWcsN(&upperChar, 1);
+                    }
+                    OutputWcs(L"_");
+                }
+                for (size_t k = 0; k != itemPtr->name.length; k++) {
+                    wchar_t upperChar = towupper(itemPtr->name.wcs[k]);
+                    OutputWcsN(&upperChar, 1);
+                }
+                wchar_t tmpBuffer[32];
+                swprintf_s(tmpBuffer, 32, L" %zu", j);
+                OutputWcs(tmpBuffer);
+            }
+
+            wchar_t countBuffer[32];
+            swprintf_s(countBuffer, 32, L"ItemInfos[%zu];", configPtr->items.count);
+            OutputWcs(L"\n\nextern const MkConfGenItemInfo ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(countBuffer);
+        }
+
+        OutputWcs(L"\n");
+        OutputWcs(L"\n//-------");
+        OutputWcs(L"\n// Fields");
+        OutputWcs(L"\n\n#ifdef _MKCONFGEN_FIELDS");
+
+        for (size_t i = 0; i != configs.count; i++) {
+            Config * configPtr = &configs.elems[i];
+            // Without a specialization, uses of the fields hit the static_assert of the primary template.
+            if (configPtr->items.count > MAX_FIELDS_COUNT) {
+                continue;
+            }
+
+            OutputWcs(L"\n\ntemplate <>");
+            OutputWcs(L"\nstruct MkConfGenFieldsOf<");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"> {");
+            OutputWcs(L"\n    static constexpr auto fields = std::make_tuple(");
+
+            for (size_t j = 0; j != configPtr->items.count; j++) {
+                Item * itemPtr = &configPtr->items.elems[j];
+                wchar_t tmpBuffer[32];
+                swprintf_s(tmpBuffer, 32, L"\", %zu, ", j);
+
+                if (itemPtr->table != SIZE_MAX) {
+                    Table * tablePtr = &configPtr->tables.elems[itemPtr->table];
+                    OutputWcs(L"\n        MkConfGenColumnField<");
+                    OutputWstr(&configPtr->name);
+                    OutputWcs(L", decltype(");
+                    OutputWstr(&configPtr->name);
+                    OutputWcs(L"::");
+                    OutputWstr(&tablePtr->name);
+                    OutputWcs(L"), ");
+                    OutputItemType(itemPtr);
+                    OutputWcs(L"[");
+                    OutputWstr(&tablePtr->maxRows);
+                    OutputWcs(L"]");
+                    OutputItemDims(itemPtr);
+                    OutputWcs(L"> { \"");
+                    OutputWstr(&tablePtr->name);
+                    OutputWcs(L".");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(tmpBuffer);
+                    OutputWcs(ItemTypeConstant(itemPtr->type));
+                    OutputWcs(L", &");
+                    OutputWstr(&configPtr->name);
+                    OutputWcs(L"::");
+                    OutputWstr(&tablePtr->name);
+                    OutputWcs(L", &decltype(");
+                    OutputWstr(&configPtr->name);
+                    OutputWcs(L"::");
+                    OutputWstr(&tablePtr->name);
+                    OutputWcs(L")::");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L", &");
+                    OutputWstr(&configPtr->name);
+                    OutputWcs(L"::");
+                    OutputWstr(&tablePtr->name);
+                    OutputWcs(L"Count }");
+                } else if (itemPtr->type == ITEM_BOOL && !itemPtr->isMap) {
+                    OutputWcs(L"\n        MkConfGenBitField<");
+                    OutputWstr(&configPtr->name);
+                    OutputWcs(L"> { \"");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(tmpBuffer);
+                    OutputWcs(ItemTypeConstant(itemPtr->type));
+                    OutputWcs(L", [](const ");
+                    OutputWstr(&configPtr->name);
+                    OutputWcs(L" & config) { return (bool)config.");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L"; } }");
+                } else {
+                    OutputWcs(L"\n        MkConfGenMemberField<");
+                    OutputWstr(&configPtr->name);
+                    OutputWcs(L", ");
+                    if (itemPtr->isMap) {
+                        OutputWcs(L"MkConfGenMap");
+                    } else {
+                        OutputItemType(itemPtr);
+                        OutputItemDims(itemPtr);
+                    }
+                    OutputWcs(L"> { \"");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(tmpBuffer);
+                    OutputWcs(ItemTypeConstant(itemPtr->type));
+                    OutputWcs(L", &");
+                    OutputWstr(&configPtr->name);
+                    OutputWcs(L"::");
+                    OutputWstr(&itemPtr->name);
+                    if (IsArray(itemPtr->type) && !itemPtr->isMap) {
+                        OutputWcs(L", &");
+                        OutputWstr(&configPtr->name);
+                        OutputWcs(L"::");
+                        OutputWstr(&itemPtr->name);
+                        OutputWcs(L"Count }");
+                    } else {
+                        OutputWcs(L", NULL }");
+                    }
+                }
+                OutputWcs(j + 1 != configPtr->items.count ? L"," : L"");
+            }
+
+            OutputWcs(L"\n    );");
+            OutputWcs(L"\n};");
+            OutputWcs(L"\n\ninline constexpr const auto & ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Fields = MkConfGenFieldsOf<");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L">::fields;");
+        }
+
+        OutputWcs(L"\n\n#endif");
+
+        OutputWcs(L"\n");
+        OutputWcs(L"\n//---------------");
+        OutputWcs(L"\n// Default Values");
+
+        for (size_t i = 0; i != configs.count; i++) {
+            Config * configPtr = &configs.elems[i];
+
+            OutputWcs(L"\n\n// ");
+            OutputWstr(&configPtr->name);
+
+            Heading * headingPtr;
+            size_t headingIndex = 0;
+            if (headingIndex != configPtr->headings.count) {
+                headingPtr = &configPtr->headings.elems[headingIndex];
+            } else {
+                headingPtr = NULL;
+            }
+
+            for (size_t j = 0; j != configPtr->items.count; j++) {
+                if (headingPtr != NULL && j == headingPtr->index) {
+                    OutputWcs(L"\n\n// ");
+                    OutputWstr(&headingPtr->name);
+
+                    if (++headingIndex != configPtr->headings.count) {
+                        headingPtr = &configPtr->headings.elems[headingIndex];
+                    } else {
+                        headingPtr = NULL;
+                    }
+                }
+
+                Item * itemPtr = &configPtr->items.elems[j];
+                if (itemPtr->isMap) {
+                    continue;
+                }
+
+                OutputWcs(L"\nextern const ");
+                OutputItemType(itemPtr);
+                OutputWcs(L" ");
+
+                OutputDefaultName(configPtr, itemPtr);
+                OutputItemDims(itemPtr);
+                OutputWcs(L";");
+
+                if (IsArray(itemPtr->type)) {
+                    OutputWcs(L"\nextern const size_t ");
+                    OutputDefaultName(configPtr, itemPtr);
+                    OutputWcs(L"Count;");
+                }
+            }
+        }
+
+        if (bakeCount != 0) {
+            OutputWcs(L"\n");
+            OutputWcs(L"\n//--------------");
+            OutputWcs(L"\n// Baked Configs");
+
+            for (size_t k = 0; k != bakeCount; k++) {
+                OutputWcs(L"\n\n// Values of ");
+                OutputWcs(bakes[k].path);
+                OutputWcs(L", checked when generating. Don't pass to Free.");
+                OutputWcs(L"\nextern const ");
+                OutputWstr(&bakes[k].configPtr->name);
+                OutputWcs(L" ");
+                OutputWstr(&bakes[k].configPtr->name);
+                OutputWcs(L"Baked;");
+            }
+        }
+
+        OutputWcs(L"\n");
+        OutputWcs(L"\n//----------");
+        OutputWcs(L"\n// Functions");
+
+        for (size_t i = 0; i != configs.count; i++) {
+            Config * configPtr = &configs.elems[i];
+
+            // Takes uninitialized memory, maps of a loaded config must be released with Free first or use Reset.
+            OutputWcs(L"\n\nvoid ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Init(");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr);");
+
+            OutputWcs(L"\n\nbool ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Load(");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr, const wchar_t * configWcs, size_t configLength, MkConfGenLoadError ** errors, size_t * errorCount);");
+
+            // Includes are resolved relative to the file instead of the working directory.
+            OutputWcs(L"\n\n#ifdef _WIN32");
+            OutputWcs(L"\nbool ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"LoadFile(");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr, const wchar_t * path, MkConfGenLoadError ** errors, size_t * errorCount);");
+            OutputWcs(L"\n#endif");
+
+            // Loads the text member of that name in place, false without errors if the pack has none.
+            OutputWcs(L"\n\nbool ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"LoadPacked(");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr, const MkConfGenPack * pack, const wchar_t * name, MkConfGenLoadError ** errors, size_t * errorCount);");
+
+            // Only the headings selected by sectionMask are parsed, see the _SECTION_ masks.
+            OutputWcs(L"\n\nbool ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"LoadSections(");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr, uint64_t sectionMask, const wchar_t * configWcs, size_t configLength, MkConfGenLoadError ** errors, size_t * errorCount);");
+
+            // Tokenizes and parses on threadCount threads, 0 for one per processor.
+            OutputWcs(L"\n\n#ifdef _WIN32");
+            OutputWcs(L"\nbool ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"LoadParallel(");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr, size_t threadCount, const wchar_t * configWcs, size_t configLength, MkConfGenLoadError ** errors, size_t * errorCount);");
+
+            OutputWcs(L"\n#endif");
+
+            // Reads and loads the file in the background and calls the completion there.
+            OutputWcs(L"\n\nbool ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"LoadAsync(");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr, const wchar_t * path, MkConfGenLoadCompletion completion, void * context);");
+
+            // Reads the file in the background, the caller parses it with MkConfGenLoadStep in slices of lineBudget lines.
+            OutputWcs(L"\n\nbool ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"LoadSliced(");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr, const wchar_t * path, size_t lineBudget, MkConfGenLoadReady ready, void * context);");
+
+            OutputWcs(L"\n\n#ifdef __cpp_impl_coroutine");
+            OutputWcs(L"\nMkConfGenLoadAwaitable<");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"> ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"LoadAwait(");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr, const wchar_t * path);");
+            OutputWcs(L"\n\nMkConfGenLoadSlicedAwaitable<");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"> ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"LoadSlicedAwait(");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr, const wchar_t * path, size_t lineBudget);");
+            OutputWcs(L"\n#endif");
+
+            OutputWcs(L"\n\nvoid ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Free(");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr);");
+
+            // Releases the maps and sets the defaults again.
+            OutputWcs(L"\n\nvoid ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Reset(");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr);");
+
+            for (size_t j = 0; j != configPtr->items.count; j++) {
+                Item * itemPtr = &configPtr->items.elems[j];
+                if (itemPtr->isMap) {
+                    OutputWcs(L"\n\nconst ");
+                    OutputWcs(ItemTypeName(itemPtr->type));
+                    OutputWcs(L" * ");
+                    OutputWstr(&configPtr->name);
+                    OutputWcs(L"Find_");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L"(const ");
+                    OutputWstr(&configPtr->name);
+                    OutputWcs(L" * configPtr, const wchar_t * key, size_t keyLength);");
+                }
+            }
+
+            OutputWcs(L"\n\nbool ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"OverlayLoad(");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Overlay * overlayPtr, const ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * base, const wchar_t * configWcs, size_t configLength, MkConfGenLoadError ** errors, size_t * errorCount);");
+
+            OutputWcs(L"\n\nvoid ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"OverlayFree(");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Overlay * overlayPtr);");
+
+            for (size_t j = 0; j != configPtr->items.count; j++) {
+                Item * itemPtr = &configPtr->items.elems[j];
+                if (IsOverlayItem(itemPtr)) {
+                    OutputGetterHead(configPtr, itemPtr, L"Overlay", L"const ", L"overlayPtr");
+                    OutputWcs(L";");
+                }
+            }
+
+            OutputWcs(L"\n\nbool ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"LazyLoad(");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Lazy * lazyPtr, const wchar_t * configWcs, size_t configLength, MkConfGenLoadError ** errors, size_t * errorCount);");
+
+            OutputWcs(L"\n\nvoid ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"LazyFree(");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Lazy * lazyPtr);");
+
+            for (size_t j = 0; j != configPtr->items.count; j++) {
+                Item * itemPtr = &configPtr->items.elems[j];
+                if (IsOverlayItem(itemPtr)) {
+                    OutputGetterHead(configPtr, itemPtr, L"Lazy", L"", L"lazyPtr");
+                    OutputWcs(L";");
+                }
+            }
+
+            // Publishing into shared memory, see MkConfGenShared.
+            OutputWcs(L"\n\n#ifdef _WIN32");
+            OutputWcs(L"\nbool ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"SharedCreate(MkConfGenShared * sharedPtr, const wchar_t * name);");
+
+            OutputWcs(L"\n\nbool ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"SharedOpen(MkConfGenShared * sharedPtr, const wchar_t * name);");
+
+            OutputWcs(L"\n\nvoid ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"SharedPublish(MkConfGenShared * sharedPtr, const ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr);");
+
+            OutputWcs(L"\n\nvoid ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"SharedRead(const MkConfGenShared * sharedPtr, ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr);");
+
+            for (size_t j = 0; j != configPtr->items.count; j++) {
+                Item * itemPtr = &configPtr->items.elems[j];
+                if (IsSharedItem(itemPtr)) {
+                    OutputSharedGetterHead(configPtr, itemPtr);
+                    OutputWcs(L";");
+                }
+            }
+            OutputWcs(L"\n#endif");
+
+            // Per-node copies within the process, see MkConfGenReplicas.
+            OutputWcs(L"\n\nbool ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"ReplicasCreate(MkConfGenReplicas * replicasPtr);");
+
+            OutputWcs(L"\n\nbool ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"ReplicasPublish(MkConfGenReplicas * replicasPtr, const ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr);");
+
+            OutputWcs(L"\n\nconst ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"ReplicaAcquire(const MkConfGenReplicas * replicasPtr, MkConfGenReplicaLease * leasePtr);");
+
+            OutputWcs(L"\n\nbool ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"ReplicaRead(const MkConfGenReplicas * replicasPtr, ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr);");
+
+            for (size_t j = 0; j != configPtr->items.count; j++) {
+                Item * itemPtr = &configPtr->items.elems[j];
+                if (IsSharedItem(itemPtr)) {
+                    OutputReplicaGetterHead(configPtr, itemPtr);
+                    OutputWcs(L";");
+                }
+            }
+
+            OutputWcs(L"\n\nbool ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Write(const ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr, bool isMinimal, MkConfGenWriteCallback writeCallback, void * context);");
+
+            // Writes the current values of the listed _ITEM_ indices into an existing config file.
+            OutputWcs(L"\n\n#ifdef _WIN32");
+            OutputWcs(L"\nbool ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"PatchFile(const wchar_t * path, const ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr, const size_t * items, size_t itemCount);");
+            OutputWcs(L"\n#endif");
+
+            // Reflection by item key, SIZE_MAX if there is no such item.
+            OutputWcs(L"\n\nsize_t ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"FindItem(const wchar_t * name, size_t nameLength);");
+
+            // Table columns take a row, all other items SIZE_MAX.
+            OutputWcs(L"\n\nbool ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"GetByIndex(const ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr, size_t index, size_t row, MkConfGenValue * value);");
+
+            // Sets a value written like in config files, it is parsed and validated like a loaded value.
+            OutputWcs(L"\n\nbool ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"SetFromText(");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr, size_t index, size_t row, const wchar_t * mapKey, size_t mapKeyLength, const wchar_t * text, size_t textLength, MkConfGenLoadErrorType * errorType);");
+        }
+
+        // Multiple configs can also share one file with [ConfigName] sections.
+        OutputLoadAllHead();
+        OutputWcs(L";");
+
+        OutputWcs(L"\n\n#endif");
+
+        rc = WriteOutputFile(headerFilePath, &output);
+        free(output.elems);
+        if (rc != 0) return rc;
+    }
+
+    // With --split the copied head goes into a header shared by the implementation files, together with the
+    // internals that LoadAll uses across them.
+    wchar_t headFileName[MAX_PATH];
+    if (isSplit) {
+        wcsncpy_s(headFileName, MAX_PATH, fileName, fileBaseNameLength);
+        wcscat_s(headFileName, MAX_PATH, L"GenHead.h");
+
+        wchar_t headFilePath[MAX_PATH];
+        wcsncpy_s(headFilePath, MAX_PATH, definitionPath, fileName - definitionPath);
+        wcscat_s(headFilePath, MAX_PATH, headFileName);
+
+        MkDynArray<char> output;
+        output.Init(4096);
+        if (!output.elems) {
+            return 2;
+        }
+        void * file = &output;
+
+        OutputWcs(L"//---------------------//\n");
+        OutputWcs(L"// AUTO-GENERATED FILE //\n");
+        OutputWcs(L"//---------------------//\n\n");
+
+        OutputWcs(L"#ifndef _MKCONFGEN_");
+        OutputWcs(fileBaseNameUpper);
+        OutputWcs(L"_HEAD_H\n");
+
+        OutputWcs(L"#define _MKCONFGEN_");
+        OutputWcs(fileBaseNameUpper);
+        OutputWcs(L"_HEAD_H\n");
+
+        OutputWcs(L"\n#include \"");
+        OutputWcs(headerFileName);
+        OutputWcs(L"\"");
+
+        OutputWcs(L"\n");
+        OutputWcs(L"\n//-----------------------");
+        OutputWcs(L"\n// Copied Input File Head");
+
+        OutputWcs(L"\n\n");
+        OutputWstr(&inputHead);
+
+        OutputWcs(L"\n");
+        OutputWcs(L"\n//-----------------");
+        OutputWcs(L"\n// Shared Internals");
+
+        for (size_t i = 0; i != configs.count; i++) {
+            Config * configPtr = &configs.elems[i];
+
+            OutputWcs(L"\n\nextern const size_t _mkConfGen");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Indices[];");
+
+            OutputWcs(L"\nextern const wchar_t _mkConfGen");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Keys[];");
+
+            if (configPtr->headings.count != 0) {
+                OutputWcs(L"\nextern const wchar_t * const _mkConfGen");
+                OutputWstr(&configPtr->name);
+                OutputWcs(L"Headings[];");
+            }
+
+            OutputWcs(L"\nbool _MkConfGen");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"ParseValue(void * config, size_t index, size_t row, const wchar_t * mapKey, size_t mapKeyLength, wchar_t * rawValue, size_t rawValueLength, bool isStr, MkConfGenLoadErrorType * errorType);");
+
+            if (CountMaps(configPtr) != 0) {
+                OutputWcs(L"\nbool _MkConfGen");
+                OutputWstr(&configPtr->name);
+                OutputWcs(L"ReserveMaps(");
+                OutputWstr(&configPtr->name);
+                OutputWcs(L" * configPtr, const wchar_t * configWcs, size_t configLength);");
+
+                OutputWcs(L"\nbool _MkConfGen");
+                OutputWstr(&configPtr->name);
+                OutputWcs(L"Prepare(void * config, const wchar_t * configWcs, size_t configLength);");
+            }
+        }
+
+        OutputWcs(L"\n\n#endif");
+
+        rc = WriteOutputFile(headFilePath, &output);
+        free(output.elems);
+        if (rc != 0) return rc;
+    }
+
+    // Part 0 is the only file without --split, with it the shared one and each config follows in its own file.
+    size_t partCount = isSplit ? configs.count + 1 : 1;
+    for (size_t part = 0; part != partCount; part++) {
+        size_t configBegin = part == 0 ? 0 : part - 1;
+        size_t configEnd = isSplit ? part : configs.count;
+
+        wchar_t implFilePath[MAX_PATH];
+        wcsncpy_s(implFilePath, MAX_PATH, definitionPath, fileName - definitionPath);
+        wcsncat_s(implFilePath, MAX_PATH, fileName, fileBaseNameLength);
+        if (part == 0) {
+            wcscat_s(implFilePath, MAX_PATH, L"Gen.cpp");
+        } else {
+            wcscat_s(implFilePath, MAX_PATH, L"Gen_");
+            wcsncat_s(implFilePath, MAX_PATH, configs.elems[configBegin].name.wcs, configs.elems[configBegin].name.length);
+            wcscat_s(implFilePath, MAX_PATH, L".cpp");
+        }
+
+        MkDynArray<char> output;
+        output.Init(65536);
+        if (!output.elems) {
+            return 2;
+        }
+        void * file = &output;
+
+        OutputWcs(L"//---------------------//\n");
+        OutputWcs(L"// AUTO-GENERATED FILE //\n");
+        OutputWcs(L"//---------------------//\n\n");
+
+        OutputWcs(L"#include \"");
+        OutputWcs(isSplit ? headFileName : headerFileName);
+        OutputWcs(L"\"");
+
+        if (!isSplit) {
+            OutputWcs(L"\n");
+            OutputWcs(L"\n//-----------------------");
+            OutputWcs(L"\n// Copied Input File Head");
+
+            OutputWcs(L"\n\n");
+            OutputWstr(&inputHead);
+        }
+
+        if (configBegin != configEnd) {
+            OutputWcs(L"\n");
+            OutputWcs(L"\n//-----");
+            OutputWcs(L"\n// Keys");
+        }
+
+        for (size_t i = configBegin; i != configEnd; i++) {
+            Config * configPtr = &configs.elems[i];
+
+            OutputWcs(L"\n\nconst size_t _mkConfGen");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Indices[] = {");
+
+            size_t currentKeyIndex = 0;
+            wchar_t tmpBuffer[32];
+            for (size_t j = 0; j != configPtr->items.count; j++) {
+                swprintf_s(tmpBuffer, 32, L"\n    %zu,", currentKeyIndex);
+                OutputWcs(tmpBuffer);
+
+                Item * itemPtr = &configPtr->items.elems[j];
+                currentKeyIndex += itemPtr->name.length;
+                if (itemPtr->table != SIZE_MAX) {
+                    currentKeyIndex += configPtr->tables.elems[itemPtr->table].name.length + 1;
+                }
+            }
+            swprintf_s(tmpBuffer, 32, L"\n    %zu,", currentKeyIndex);
+            OutputWcs(tmpBuffer);
+            OutputWcs(L"\n};");
+
+            OutputWcs(L"\n\nconst wchar_t _mkConfGen");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Keys[] =");
+
+            for (size_t j = 0; j != configPtr->items.count; j++) {
+                Item * itemPtr = &configPtr->items.elems[j];
+                OutputWcs(L"\n    L\"");
+                if (itemPtr->table != SIZE_MAX) {
+                    OutputWstr(&configPtr->tables.elems[itemPtr->table].name);
+                    OutputWcs(L".");
+                }
+                OutputWstr(&itemPtr->name);
+                OutputWcs(L"\"");
+            }
+            OutputWcs(L";");
+
+            if (configPtr->headings.count != 0) {
+                OutputWcs(L"\n\nconst wchar_t * const _mkConfGen");
+                OutputWstr(&configPtr->name);
+                OutputWcs(L"Headings[] = {");
+                for (size_t j = 0; j != configPtr->headings.count; j++) {
+                    OutputWcs(L"\n    L\"");
+                    OutputWstr(&configPtr->headings.elems[j].name);
+                    OutputWcs(L"\",");
+                }
+                OutputWcs(L"\n};");
+            }
+
+            OutputWcs(L"\n\nconst MkConfGenItemInfo ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"ItemInfos[] = {");
+            size_t heading = SIZE_MAX;
+            for (size_t j = 0; j != configPtr->items.count; j++) {
+                Item * itemPtr = &configPtr->items.elems[j];
+                Table * tablePtr = itemPtr->table != SIZE_MAX ? &configPtr->tables.elems[itemPtr->table] : NULL;
+                while (heading + 1 != configPtr->headings.count && configPtr->headings.elems[heading + 1].index <= j) {
+                    heading++;
+                }
+
+                OutputWcs(L"\n    { L\"");
+                if (tablePtr) {
+                    OutputWstr(&tablePtr->name);
+                    OutputWcs(L".");
+                }
+                OutputWstr(&itemPtr->name);
+                swprintf_s(tmpBuffer, 32, L"\", %zu, ", (tablePtr ? tablePtr->name.length + 1 : 0) + itemPtr->name.length);
+                OutputWcs(tmpBuffer);
+                OutputWcs(ItemTypeConstant(itemPtr->type));
+
+                if (itemPtr->type == ITEM_BOOL && !tablePtr) {
+                    OutputWcs(L", SIZE_MAX, ");
+                } else {
+                    OutputWcs(L", offsetof(");
+                    OutputWstr(&configPtr->name);
+                    OutputWcs(L", ");
+                    if (tablePtr) {
+                        OutputWstr(&tablePtr->name);
+                        OutputWcs(L".");
+                    }
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L"), ");
+                }
+
+                OutputWcs(L"sizeof(");
+                if (itemPtr->isMap) {
+                    OutputWcs(ItemTypeName(itemPtr->type));
+                } else {
+                    OutputItemType(itemPtr);
+                    OutputItemDims(itemPtr);
+                }
+                OutputWcs(L"), ");
+
+                if (tablePtr) {
+                    OutputWstr(&tablePtr->maxRows);
+                } else if (IsArray(itemPtr->type)) {
+                    OutputWstr(&itemPtr->maxCount);
+                } else if (itemPtr->type == ITEM_WSTR) {
+                    OutputWstr(&itemPtr->length);
+                } else {
+                    OutputWcs(L"0");
+                }
+
+                if (tablePtr || IsArray(itemPtr->type)) {
+                    OutputWcs(L", offsetof(");
+                    OutputWstr(&configPtr->name);
+                    OutputWcs(L", ");
+                    OutputWstr(tablePtr ? &tablePtr->name : &itemPtr->name);
+                    OutputWcs(L"Count), ");
+                } else {
+                    OutputWcs(L", SIZE_MAX, ");
+                }
+
+                if (heading == SIZE_MAX) {
+                    OutputWcs(L"SIZE_MAX, ");
+                } else {
+                    swprintf_s(tmpBuffer, 32, L"%zu, ", heading);
+                    OutputWcs(tmpBuffer);
+                }
+
+                if (itemPtr->validateCallback.length != 0) {
+                    OutputWcs(L"L\"");
+                    OutputWstr(&itemPtr->validateCallback);
+                    OutputWcs(L"\", ");
+                } else {
+                    OutputWcs(L"NULL, ");
+                }
+                bool isConstrained = itemPtr->rangeMin.length != 0 || itemPtr->maxLength.length != 0 || itemPtr->hasOneOf || itemPtr->patternPtr;
+                OutputWcs(isConstrained ? L"true, " : L"false, ");
+                OutputWcs(itemPtr->isMap ? L"true, " : L"false, ");
+                OutputWcs(tablePtr ? L"true }," : L"false },");
+            }
+            OutputWcs(L"\n};");
+
+            ItemHash itemHash;
+            if (!BuildItemHash(configPtr, &itemHash)) {
+                free(output.elems);
+                return 2;
+            }
+
+            OutputWcs(L"\n\nconst uint32_t _mkConfGen");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"ItemSeeds[] = {");
+            for (size_t b = 0; b != itemHash.bucketCount; b++) {
+                swprintf_s(tmpBuffer, 32, L"\n    %u,", (unsigned)itemHash.seeds[b]);
+                OutputWcs(tmpBuffer);
+            }
+            OutputWcs(L"\n};");
+
+            OutputWcs(L"\n\nconst uint32_t _mkConfGen");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"ItemSlots[] = {");
+            for (size_t k = 0; k != itemHash.slotCount; k++) {
+                swprintf_s(tmpBuffer, 32, L"\n    %u,", (unsigned)itemHash.slots[k]);
+                OutputWcs(tmpBuffer);
+            }
+            OutputWcs(L"\n};");
+
+            OutputWcs(L"\n\nconst _MkConfGenItemHash _mkConfGen");
+            OutputWstr(&configPtr->name);
+            swprintf_s(tmpBuffer, 32, L"ItemHash = { %zu, _mkConfGen", itemHash.bucketCount - 1);
+            OutputWcs(tmpBuffer);
+            OutputWstr(&configPtr->name);
+            swprintf_s(tmpBuffer, 32, L"ItemSeeds, %zu, _mkConfGen", itemHash.slotCount - 1);
+            OutputWcs(tmpBuffer);
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"ItemSlots };");
+            free(itemHash.seeds);
+            free(itemHash.slots);
+        }
+
+        bool hasPatterns = false;
+        for (size_t i = configBegin; i != configEnd && !hasPatterns; i++) {
+            for (size_t j = 0; j != configs.elems[i].items.count; j++) {
+                if (configs.elems[i].items.elems[j].patternPtr) {
+                    hasPatterns = true;
+                    break;
+                }
+            }
+        }
+
+        // The DFA tables of the patterns, ASCII characters map to their class directly, all others through the
+        // sorted ranges above 127.
+        if (hasPatterns) {
+            OutputWcs(L"\n");
+            OutputWcs(L"\n//---------");
+            OutputWcs(L"\n// Patterns");
+        }
+
+        for (size_t i = configBegin; i != configEnd; i++) {
+            Config * configPtr = &configs.elems[i];
+
+            for (size_t j = 0; j != configPtr->items.count; j++) {
+                Item * itemPtr = &configPtr->items.elems[j];
+                Pattern * patternPtr = itemPtr->patternPtr;
+                if (!patternPtr) {
+                    continue;
+                }
+
+                wchar_t tmpBuffer[32];
+                OutputWcs(L"\n\nconst uint8_t ");
+                OutputPatternName(configPtr, itemPtr);
+                OutputWcs(L"AsciiClasses[128] = {");
+                for (uint32_t ch = 0; ch != 128; ch++) {
+                    OutputWcs(ch % 16 == 0 ? L"\n    " : L" ");
+                    swprintf_s(tmpBuffer, 32, L"%zu,", FindPatternClass(patternPtr, ch));
+                    OutputWcs(tmpBuffer);
+                }
+                OutputWcs(L"\n};");
+
+                size_t firstRange = 0;
+                while (patternPtr->rangeLasts[firstRange] < 128) {
+                    firstRange++;
+                }
+                OutputWcs(L"\n\nconst uint32_t ");
+                OutputPatternName(configPtr, itemPtr);
+                OutputWcs(L"RangeLasts[] = {");
+                for (size_t k = firstRange; k != patternPtr->rangeCount; k++) {
+                    swprintf_s(tmpBuffer, 32, L"\n    0x%X,", patternPtr->rangeLasts[k]);
+                    OutputWcs(tmpBuffer);
+                }
+                OutputWcs(L"\n};");
+
+                OutputWcs(L"\n\nconst uint8_t ");
+                OutputPatternName(configPtr, itemPtr);
+                OutputWcs(L"RangeClasses[] = {");
+                for (size_t k = firstRange; k != patternPtr->rangeCount; k++) {
+                    swprintf_s(tmpBuffer, 32, L"\n    %u,", patternPtr->rangeClasses[k]);
+                    OutputWcs(tmpBuffer);
+                }
+                OutputWcs(L"\n};");
+
+                OutputWcs(L"\n\nconst uint16_t ");
+                OutputPatternName(configPtr, itemPtr);
+                OutputWcs(L"Transitions[] = {");
+                for (size_t state = 0; state != patternPtr->stateCount; state++) {
+                    OutputWcs(L"\n   ");
+                    for (size_t k = 0; k != patternPtr->classCount; k++) {
+                        swprintf_s(tmpBuffer, 32, L" %u,", patternPtr->transitions[state * patternPtr->classCount + k]);
+                        OutputWcs(tmpBuffer);
+                    }
+                }
+                OutputWcs(L"\n};");
+
+                OutputWcs(L"\n\nconst bool ");
+                OutputPatternName(configPtr, itemPtr);
+                OutputWcs(L"Accepting[] = {");
+                for (size_t state = 0; state != patternPtr->stateCount; state++) {
+                    OutputWcs(patternPtr->isAccepting[state] ? L"\n    true," : L"\n    false,");
+                }
+                OutputWcs(L"\n};");
+
+                OutputWcs(L"\n\nconst _MkConfGenPattern ");
+                OutputPatternName(configPtr, itemPtr);
+                OutputWcs(L" = {\n    ");
+                OutputPatternName(configPtr, itemPtr);
+                swprintf_s(tmpBuffer, 32, L"AsciiClasses,\n    %zu,\n    ", patternPtr->rangeCount - firstRange);
+                OutputWcs(tmpBuffer);
+                OutputPatternName(configPtr, itemPtr);
+                OutputWcs(L"RangeLasts,\n    ");
+                OutputPatternName(configPtr, itemPtr);
+                swprintf_s(tmpBuffer, 32, L"RangeClasses,\n    %zu,\n    ", patternPtr->classCount);
+                OutputWcs(tmpBuffer);
+                OutputPatternName(configPtr, itemPtr);
+                OutputWcs(L"Transitions,\n    ");
+                OutputPatternName(configPtr, itemPtr);
+                OutputWcs(L"Accepting,");
+                if (patternPtr->deadState == SIZE_MAX) {
+                    OutputWcs(L"\n    SIZE_MAX,");
+                } else {
+                    swprintf_s(tmpBuffer, 32, L"\n    %zu,", patternPtr->deadState);
+                    OutputWcs(tmpBuffer);
+                }
+                OutputWcs(L"\n};");
+            }
+        }
+
+        if (configBegin != configEnd) {
+            OutputWcs(L"\n");
+            OutputWcs(L"\n//---------------");
+            OutputWcs(L"\n// Default Values");
+        }
+
+        for (size_t i = configBegin; i != configEnd; i++) {
+            Config * configPtr = &configs.elems[i];
+
+            OutputWcs(L"\n\n// ");
+            OutputWstr(&configPtr->name);
+
+            Heading * headingPtr;
+            size_t headingIndex = 0;
+            if (headingIndex != configPtr->headings.count) {
+                headingPtr = &configPtr->headings.elems[headingIndex];
+            } else {
+                headingPtr = NULL;
+            }
+
+            for (size_t j = 0; j != configPtr->items.count; j++) {
+                if (headingPtr != NULL && j == headingPtr->index) {
+                    OutputWcs(L"\n\n// ");
+                    OutputWstr(&headingPtr->name);
+
+                    if (++headingIndex != configPtr->headings.count) {
+                        headingPtr = &configPtr->headings.elems[headingIndex];
+                    } else {
+                        headingPtr = NULL;
+                    }
+                }
+
+                Item * itemPtr = &configPtr->items.elems[j];
+                if (itemPtr->isMap) {
+                    continue;
+                }
+
+                OutputWcs(L"\nconst ");
+                OutputItemType(itemPtr);
+                OutputWcs(L" ");
+
+                OutputDefaultName(configPtr, itemPtr);
+
+                if (itemPtr->type == ITEM_WSTR) {
+                    OutputWcs(L"[");
+                    OutputWstr(&itemPtr->length);
+                    OutputWcs(L"] = L\"");
+                    OutputWstr(&itemPtr->defaultValue);
+                    OutputWcs(L"\";");
+                } else if (itemPtr->type == ITEM_ENUM) {
+                    OutputWcs(L" = ");
+                    OutputWstr(&itemPtr->enumName);
+                    OutputWcs(L"::");
+                    OutputWstr(&itemPtr->defaultValue);
+                    OutputWcs(L";");
+                } else if (IsArray(itemPtr->type)) {
+                    OutputItemDims(itemPtr);
+                    OutputWcs(L" = {");
+                    for (size_t k = 0; k != itemPtr->values.count; k++) {
+                        OutputWcs(k == 0 ? L" " : L", ");
+                        if (itemPtr->type == ITEM_STR_ARRAY) {
+                            OutputWcs(L"L\"");
+                        }
+                        OutputWstr(&itemPtr->values.elems[k]);
+                        if (itemPtr->type == ITEM_STR_ARRAY) {
+                            OutputWcs(L"\"");
+                        }
+                    }
+                    OutputWcs(itemPtr->values.count == 0 ? L"};" : L" };");
+
+                    wchar_t tmpBuffer[32];
+                    swprintf_s(tmpBuffer, 32, L"Count = %zu;", itemPtr->values.count);
+                    OutputWcs(L"\nconst size_t ");
+                    OutputDefaultName(configPtr, itemPtr);
+                    OutputWcs(tmpBuffer);
+                } else if (itemPtr->type == ITEM_DURATION || itemPtr->type == ITEM_SIZE) {
+                    // Converted to the base unit here, the config file keeps the unit.
+                    uint64_t unitValue;
+                    ParseUnitValue(&itemPtr->defaultValue, itemPtr->type, &unitValue);
+                    wchar_t tmpBuffer[32];
+                    swprintf_s(tmpBuffer, 32, L" = %llu; // ", (unsigned long long)unitValue);
+                    OutputWcs(tmpBuffer);
+                    OutputWstr(&itemPtr->defaultValue);
+                } else {
+                    OutputWcs(L" = ");
+                    OutputWstr(&itemPtr->defaultValue);
+                    OutputWcs(L";");
+                }
+            }
+        }
+
+        // The initializers follow the member order of the struct: tables as count and columns, booleans last.
+        bool hasBakes = false;
+        for (size_t k = 0; k != bakeCount; k++) {
+            size_t configIndex = bakes[k].configPtr - configs.elems;
+            if (configIndex >= configBegin && configIndex < configEnd) {
+                hasBakes = true;
+            }
+        }
+        if (hasBakes) {
+            OutputWcs(L"\n");
+            OutputWcs(L"\n//--------------");
+            OutputWcs(L"\n// Baked Configs");
+        }
+
+        for (size_t k = 0; k != bakeCount; k++) {
+            Bake * bakePtr = &bakes[k];
+            Config * configPtr = bakePtr->configPtr;
+            wchar_t tmpBuffer[64];
+            size_t configIndex = configPtr - configs.elems;
+            if (configIndex < configBegin || configIndex >= configEnd) {
+                continue;
+            }
+
+            OutputWcs(L"\n\n// ");
+            OutputWcs(bakePtr->path);
+
+            // Maps point to constant arrays holding the layout built by the runtime while baking.
+            for (size_t j = 0; j != configPtr->items.count; j++) {
+                Item * itemPtr = &configPtr->items.elems[j];
+                MkConfGenMap * mapPtr = &bakePtr->maps[j];
+                if (!itemPtr->isMap || mapPtr->count == 0) {
+                    continue;
+                }
+
+                OutputWcs(L"\n\nstatic const MkConfGenMapSlot _mkConfGen");
+                OutputWstr(&configPtr->name);
+                OutputWcs(L"Baked_");
+                OutputWstr(&itemPtr->name);
+                OutputWcs(L"Slots[] = {");
+                for (size_t l = 0; l <= mapPtr->slotMask; l++) {
+                    swprintf_s(tmpBuffer, 64, L"\n    { 0x%08xu, %u },", (unsigned)mapPtr->slots[l].hash, (unsigned)mapPtr->slots[l].entry);
+                    OutputWcs(tmpBuffer);
+                }
+                OutputWcs(L"\n};");
+
+                OutputWcs(L"\n\nalignas(8) static const unsigned char _mkConfGen");
+                OutputWstr(&configPtr->name);
+                OutputWcs(L"Baked_");
+                OutputWstr(&itemPtr->name);
+                OutputWcs(L"Values[] = {");
+                for (size_t l = 0; l != mapPtr->count * mapPtr->valueSize; l++) {
+                    swprintf_s(tmpBuffer, 64, l % 16 == 0 ? L"\n    0x%02x," : L" 0x%02x,", mapPtr->values[l]);
+                    OutputWcs(tmpBuffer);
+                }
+                OutputWcs(L"\n};");
+
+                OutputWcs(L"\n\nstatic const size_t _mkConfGen");
+                OutputWstr(&configPtr->name);
+                OutputWcs(L"Baked_");
+                OutputWstr(&itemPtr->name);
+                OutputWcs(L"KeyOffsets[] = {");
+                for (size_t l = 0; l <= mapPtr->count; l++) {
+                    swprintf_s(tmpBuffer, 64, L"\n    %zu,", mapPtr->keyOffsets[l]);
+                    OutputWcs(tmpBuffer);
+                }
+                OutputWcs(L"\n};");
+
+                MkDynArray<wchar_t> keyArena;
+                keyArena.Init(mapPtr->keyArenaLength + 16);
+                if (!keyArena.elems || !AppendWstrLiteral(&keyArena, mapPtr->keyArena, mapPtr->keyArenaLength)) {
+                    return 2;
+                }
+                OutputWcs(L"\n\nstatic const wchar_t _mkConfGen");
+                OutputWstr(&configPtr->name);
+                OutputWcs(L"Baked_");
+                OutputWstr(&itemPtr->name);
+                OutputWcs(L"KeyArena[] = ");
+                OutputWcsN(keyArena.elems, keyArena.count);
+                OutputWcs(L";");
+                free(keyArena.elems);
+            }
+
+            OutputWcs(L"\n\nconstexpr ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Baked = {");
+
+            for (size_t j = 0; j != configPtr->items.count; j++) {
+                Item * itemPtr = &configPtr->items.elems[j];
+
+                if (itemPtr->table != SIZE_MAX) {
+                    Table * tablePtr = &configPtr->tables.elems[itemPtr->table];
+                    size_t rowCount = 0;
+                    for (size_t l = 0; l != tablePtr->itemCount; l++) {
+                        MkDynArray<MkWstr> * textsPtr = &bakePtr->texts[tablePtr->firstItem + l];
+                        for (size_t row = 0; row != textsPtr->count; row++) {
+                            if (textsPtr->elems[row].wcs && rowCount <= row) {
+                                rowCount = row + 1;
+                            }
+                        }
+                    }
+
+                    // Unused rows hold the defaults like after Init, which needs the row count as a literal.
+                    Literal maxRowsLiteral;
+                    size_t initRowCount = ParseLiteral(&tablePtr->maxRows, ITEM_U64, &maxRowsLiteral) ? (size_t)maxRowsLiteral.magnitude : rowCount;
+
+                    swprintf_s(tmpBuffer, 64, L"\n    %zu,", rowCount);
+                    OutputWcs(tmpBuffer);
+                    OutputWcs(L"\n    {");
+                    for (size_t l = 0; l != tablePtr->itemCount; l++) {
+                        Item * columnPtr = &configPtr->items.elems[tablePtr->firstItem + l];
+                        OutputWcs(L"\n        {");
+                        for (size_t row = 0; row != initRowCount; row++) {
+                            OutputWcs(row == 0 ? L" " : L", ");
+                            OutputBakedValue(bakePtr, columnPtr, tablePtr->firstItem + l, row);
+                        }
+                        OutputWcs(initRowCount == 0 ? L"}," : L" },");
+                    }
+                    OutputWcs(L"\n    },");
+
+                    j += tablePtr->itemCount - 1;
+                    continue;
+                }
+
+                if (itemPtr->isMap) {
+                    MkConfGenMap * mapPtr = &bakePtr->maps[j];
+                    if (mapPtr->count == 0) {
+                        OutputWcs(L"\n    {},");
+                        continue;
+                    }
+
+                    swprintf_s(tmpBuffer, 64, L"\n    { %zu, %zu, %zu, ", mapPtr->count, mapPtr->count, mapPtr->slotMask);
+                    OutputWcs(tmpBuffer);
+                    swprintf_s(tmpBuffer, 64, L"%zu, %zu, %zu,", mapPtr->keyArenaLength, mapPtr->keyArenaLength, mapPtr->valueSize);
+                    OutputWcs(tmpBuffer);
+                    const wchar_t * arrayTypes[] = { L"MkConfGenMapSlot", L"unsigned char", L"size_t", L"wchar_t" };
+                    const wchar_t * arrayNames[] = { L"Slots", L"Values", L"KeyOffsets", L"KeyArena" };
+                    for (size_t l = 0; l != 4; l++) {
+                        OutputWcs(l == 0 ? L" (" : L", (");
+                        OutputWcs(arrayTypes[l]);
+                        OutputWcs(L" *)_mkConfGen");
+                        OutputWstr(&configPtr->name);
+                        OutputWcs(L"Baked_");
+                        OutputWstr(&itemPtr->name);
+                        OutputWcs(arrayNames[l]);
+                    }
+                    OutputWcs(L" },");
+                    continue;
+                }
+
+                if (itemPtr->type == ITEM_BOOL) {
+                    continue;
+                }
+
+                OutputWcs(L"\n    ");
+                OutputBakedValue(bakePtr, itemPtr, j, 0);
+                OutputWcs(L",");
+            }
+
+            for (size_t j = 0; j != configPtr->items.count; j++) {
+                Item * itemPtr = &configPtr->items.elems[j];
+                if (itemPtr->type == ITEM_BOOL && itemPtr->table == SIZE_MAX && !itemPtr->isMap) {
+                    OutputWcs(L"\n    ");
+                    OutputBakedValue(bakePtr, itemPtr, j, 0);
+                    OutputWcs(L",");
+                }
+            }
+
+            OutputWcs(L"\n};");
+
+            // Values of constraints that are no literals, checked like the generated parser does.
+            if (bakePtr->checks.count != 0) {
+                OutputWcs(L"\n");
+            }
+            for (size_t l = 0; l != bakePtr->checks.count; l++) {
+                BakeCheck * checkPtr = &bakePtr->checks.elems[l];
+                Item * itemPtr = &configPtr->items.elems[checkPtr->index];
+                for (unsigned type = BAKE_CHECK_RANGE; type <= BAKE_CHECK_MAX_LEN; type <<= 1) {
+                    if (!(checkPtr->types & type)) {
+                        continue;
+                    }
+                    OutputWcs(L"\nstatic_assert(");
+                    if (type == BAKE_CHECK_RANGE) {
+                        OutputWcs(L"!((");
+                        OutputWcs(ItemTypeName(itemPtr->type));
+                        OutputWcs(L")(");
+                        OutputWstr(&checkPtr->text);
+                        OutputWcs(L") < (");
+                        OutputWstr(&itemPtr->rangeMin);
+                        OutputWcs(L") || (");
+                        OutputWcs(ItemTypeName(itemPtr->type));
+                        OutputWcs(L")(");
+                        OutputWstr(&checkPtr->text);
+                        OutputWcs(L") > (");
+                        OutputWstr(&itemPtr->rangeMax);
+                        OutputWcs(L"))");
+                    } else if (type == BAKE_CHECK_ONE_OF) {
+                        for (size_t e = 0; e != itemPtr->oneOf.count; e++) {
+                            OutputWcs(e == 0 ? L"(" : L" || (");
+                            OutputWcs(ItemTypeName(itemPtr->type));
+                            OutputWcs(L")(");
+                            OutputWstr(&checkPtr->text);
+                            OutputWcs(L") == (");
+                            OutputWstr(&itemPtr->oneOf.elems[e]);
+                            OutputWcs(L")");
+                        }
+                    } else {
+                        swprintf_s(tmpBuffer, 64, L"%zu <= (", checkPtr->length);
+                        OutputWcs(tmpBuffer);
+                        OutputWstr(&itemPtr->maxLength);
+                        OutputWcs(L")");
+                    }
+                    OutputWcs(L", \"baked ");
+                    if (itemPtr->table != SIZE_MAX) {
+                        OutputWstr(&configPtr->tables.elems[itemPtr->table].name);
+                        OutputWcs(L".");
+                    }
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(type == BAKE_CHECK_RANGE ? L" out of RANGE\");" : type == BAKE_CHECK_ONE_OF ? L" not in ONE_OF\");" : L" longer than MAX_LEN\");");
+                }
+            }
+        }
+
+        if (configBegin != configEnd) {
+            OutputWcs(L"\n");
+            OutputWcs(L"\n//----------");
+            OutputWcs(L"\n// Functions");
+        }
+
+        for (size_t i = configBegin; i != configEnd; i++) {
+            Config * configPtr = &configs.elems[i];
+
+            OutputWcs(L"\n\nvoid ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Init(");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr) {");
+            OutputWcs(L"\n    _MKCONFGEN_ASSERT(configPtr);");
+
+            size_t headingIndex = 0;
+            Heading * headingPtr;
+            if (headingIndex != configPtr->headings.count) {
+                headingPtr = &configPtr->headings.elems[headingIndex];
+            } else {
+                headingPtr = NULL;
+            }
+
+            for (size_t j = 0; j != configPtr->items.count; j++) {
+                if (headingPtr != NULL && j == headingPtr->index) {
+                    OutputWcs(L"\n\n    // ");
+                    OutputWstr(&headingPtr->name);
+
+                    if (++headingIndex != configPtr->headings.count) {
+                        headingPtr = &configPtr->headings.elems[headingIndex];
+                    } else {
+                        headingPtr = NULL;
+                    }
+                }
+
+                Item * itemPtr = &configPtr->items.elems[j];
+
+                // Every row of a table starts out with the column defaults.
+                const wchar_t * indent = L"\n    ";
+                if (itemPtr->table != SIZE_MAX) {
+                    Table * tablePtr = &configPtr->tables.elems[itemPtr->table];
+                    indent = L"\n        ";
+
+                    if (j == tablePtr->firstItem) {
+                        OutputWcs(L"\n    configPtr->");
+                        OutputWstr(&tablePtr->name);
+                        OutputWcs(L"Count = 0;");
+                        OutputWcs(L"\n    for (size_t row = 0; row != ");
+                        OutputWstr(&tablePtr->maxRows);
+                        OutputWcs(L"; row++) {");
+                    }
+                }
+
+                if (itemPtr->isMap) {
+                    OutputWcs(L"\n    memset(&configPtr->");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L", 0, sizeof(MkConfGenMap));");
+                } else if (itemPtr->type == ITEM_WSTR) {
+                    OutputWcs(indent);
+                    OutputWcs(L"wmemcpy(");
+                    OutputItemRef(configPtr, itemPtr);
+                    OutputWcs(L", ");
+                    OutputDefaultName(configPtr, itemPtr);
+                    OutputWcs(L", ");
+                    OutputWstr(&itemPtr->length);
+                    OutputWcs(L");");
+                } else if (IsArray(itemPtr->type)) {
+                    OutputWcs(L"\n    memcpy(configPtr->");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L", ");
+                    OutputDefaultName(configPtr, itemPtr);
+                    OutputWcs(L", sizeof ");
+                    OutputDefaultName(configPtr, itemPtr);
+                    OutputWcs(L");");
+                    OutputWcs(L"\n    configPtr->");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L"Count = ");
+                    OutputDefaultName(configPtr, itemPtr);
+                    OutputWcs(L"Count;");
+                } else {
+                    OutputWcs(indent);
+                    OutputItemRef(configPtr, itemPtr);
+                    OutputWcs(L" = ");
+                    OutputDefaultName(configPtr, itemPtr);
+                    OutputWcs(L";");
+                }
+
+                if (itemPtr->table != SIZE_MAX) {
+                    Table * tablePtr = &configPtr->tables.elems[itemPtr->table];
+                    if (j == tablePtr->firstItem + tablePtr->itemCount - 1) {
+                        OutputWcs(L"\n    }");
+                    }
+                }
+            }
+
+            OutputWcs(L"\n}");
+
+            OutputWcs(isSplit ? L"\n\nbool _MkConfGen" : L"\n\nstatic bool _MkConfGen");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"ParseValue(");
+            OutputWcs(L"\n    void * config,");
+            OutputWcs(L"\n    size_t index,");
+            OutputWcs(L"\n    size_t row,");
+            OutputWcs(L"\n    const wchar_t * mapKey,");
+            OutputWcs(CountMaps(configPtr) != 0 ? L"\n    size_t mapKeyLength," : L"\n    size_t,");
+            OutputWcs(L"\n    wchar_t * rawValue,");
+            OutputWcs(L"\n    size_t rawValueLength,");
+            OutputWcs(L"\n    bool isStr,");
+            OutputWcs(L"\n    MkConfGenLoadErrorType * errorType)");
+            OutputWcs(L"\n{");
+
+            OutputWcs(L"\n    ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr = (");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" *)config;");
+
+            OutputWcs(L"\n    switch (index) {");
+
+            for (size_t j = 0; j != configPtr->items.count; j++) {
+                Item * itemPtr = &configPtr->items.elems[j];
+
+                wchar_t tmpBuffer[64];
+                swprintf_s(tmpBuffer, 64, L"\n\n        case %zu:", j);
+                OutputWcs(tmpBuffer);
+                OutputWcs(L"\n        {");
+
+                if (itemPtr->table != SIZE_MAX) {
+                    OutputWcs(L"\n            if (row >= ");
+                    OutputWstr(&configPtr->tables.elems[itemPtr->table].maxRows);
+                    OutputWcs(L") {");
+                    OutputWcs(L"\n                *errorType = row == SIZE_MAX ? MKCONFGEN_LOAD_ERROR_KEY_FORMAT : MKCONFGEN_LOAD_ERROR_KEY_INDEX;");
+                    OutputWcs(L"\n                return false;");
+                    OutputWcs(L"\n            }");
+                } else if (itemPtr->isMap) {
+                    OutputWcs(L"\n            if (row != SIZE_MAX || !mapKey) {");
+                    OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_KEY_FORMAT;");
+                    OutputWcs(L"\n                return false;");
+                    OutputWcs(L"\n            }");
+                } else {
+                    OutputWcs(L"\n            if (row != SIZE_MAX || mapKey) {");
+                    OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_KEY_FORMAT;");
+                    OutputWcs(L"\n                return false;");
+                    OutputWcs(L"\n            }");
+                }
+
+                switch (itemPtr->type) {
+                    case ITEM_INT:
+                    {
+                        OutputWcs(L"\n            if (isStr) {");
+                        OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_TYPE;");
+                        OutputWcs(L"\n                return false;");
+                        OutputWcs(L"\n            }");
+                        OutputWcs(L"\n");
+                        OutputWcs(L"\n            wchar_t * end;");
+                        OutputWcs(L"\n            long value = wcstol(rawValue, &end, 0);");
+                        OutputWcs(L"\n            if (end != rawValue + rawValueLength) {");
+                        OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_TYPE;");
+                        OutputWcs(L"\n                return false;");
+                        OutputWcs(L"\n            }");
+                        OutputWcs(L"\n            if (value == LONG_MIN || value == LONG_MAX) {");
+                        OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_OVERFLOW;");
+                        OutputWcs(L"\n                return false;");
+                        OutputWcs(L"\n            }");
+
+                        OutputConstraintChecks(itemPtr);
+
+                        if (itemPtr->validateCallback.length != 0) {
+                            OutputWcs(L"\n            if (!");
+                            OutputWstr(&itemPtr->validateCallback);
+                            OutputWcs(L"(value)) {");
+                            OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_INVALID;");
+                            OutputWcs(L"\n                return false;");
+                            OutputWcs(L"\n            }");
+                        }
+
+                        OutputAssignValue(configPtr, itemPtr);
+
+                        OutputWcs(L"\n            return true;");
+                        OutputWcs(L"\n        }");
+                        break;
+                    }
+
+                    case ITEM_UINT:
+                    {
+                        OutputWcs(L"\n            if (isStr) {");
+                        OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_TYPE;");
+                        OutputWcs(L"\n                return false;");
+                        OutputWcs(L"\n            }");
+                        OutputWcs(L"\n");
+                        OutputWcs(L"\n            wchar_t * end;");
+                        OutputWcs(L"\n            unsigned long value = wcstoul(rawValue, &end, 0);");
+                        OutputWcs(L"\n            if (end != rawValue + rawValueLength) {");
+                        OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_TYPE;");
+                        OutputWcs(L"\n                return false;");
+                        OutputWcs(L"\n            }");
+                        OutputWcs(L"\n            if (value == ULONG_MAX) {");
+                        OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_OVERFLOW;");
+                        OutputWcs(L"\n                return false;");
+                        OutputWcs(L"\n            }");
+
+                        OutputConstraintChecks(itemPtr);
+
+                        if (itemPtr->validateCallback.length != 0) {
+                            OutputWcs(L"\n            if (!");
+                            OutputWstr(&itemPtr->validateCallback);
+                            OutputWcs(L"(value)) {");
+                            OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_INVALID;");
+                            OutputWcs(L"\n                return false;");
+                            OutputWcs(L"\n            }");
+                        }
+
+                        OutputAssignValue(configPtr, itemPtr);
+
+                        OutputWcs(L"\n            return true;");
+                        OutputWcs(L"\n        }");
+                        break;
+                    }
+
+                    case ITEM_FLOAT:
+                    {
+                        OutputWcs(L"\n            if (isStr) {");
+                        OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_TYPE;");
+                        OutputWcs(L"\n                return false;");
+                        OutputWcs(L"\n            }");
+                        OutputWcs(L"\n            ");
+                        OutputWcs(L"\n            wchar_t * end;");
+                        OutputWcs(L"\n            double value = wcstod(rawValue, &end);");
+                        OutputWcs(L"\n            if (end != rawValue + rawValueLength) {");
+                        OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_TYPE;");
+                        OutputWcs(L"\n                return false;");
+                        OutputWcs(L"\n            }");
+                        OutputWcs(L"\n            if (value == HUGE_VAL || value == -HUGE_VAL) {");
+                        OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_OVERFLOW;");
+                        OutputWcs(L"\n                return false;");
+                        OutputWcs(L"\n            }");
+
+                        OutputConstraintChecks(itemPtr);
+
+                        if (itemPtr->validateCallback.length != 0) {
+                            OutputWcs(L"\n            if (!");
+                            OutputWstr(&itemPtr->validateCallback);
+                            OutputWcs(L"(value)) {");
+                            OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_INVALID;");
+                            OutputWcs(L"\n                return false;");
+                            OutputWcs(L"\n            }");
+                        }
+
+                        OutputAssignValue(configPtr, itemPtr);
 
-    wchar_t headerFileName[MAX_PATH];
-    {
-        wcsncpy_s(headerFileName, MAX_PATH, fileName, fileBaseNameLength);
-        wcscat_s(headerFileName, MAX_PATH, L"Gen.h");
+                        OutputWcs(L"\n            return true;");
+                        OutputWcs(L"\n        }");
+                        break;
+                    }
 
-        wchar_t headerFilePath[MAX_PATH];
-        wcsncpy_s(headerFilePath, MAX_PATH, args[1], fileName - args[1]);
-        wcscat_s(headerFilePath, MAX_PATH, headerFileName);
+                    case ITEM_BOOL:
+                    {
+                        OutputWcs(L"\n            bool value;");
+                        OutputWcs(L"\n            if (isStr || !_MkConfGenParseBool(rawValue, rawValueLength, &value)) {");
+                        OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_TYPE;");
+                        OutputWcs(L"\n                return false;");
+                        OutputWcs(L"\n            }");
 
-        HANDLE file = CreateFileW(
-            headerFilePath,
-            GENERIC_WRITE,
-            0,
-            NULL,
-            CREATE_ALWAYS,
-            FILE_ATTRIBUTE_NORMAL,
-            NULL);
-        if (file == INVALID_HANDLE_VALUE) {
-            return 4;
-        }
+                        if (itemPtr->validateCallback.length != 0) {
+                            OutputWcs(L"\n            if (!");
+                            OutputWstr(&itemPtr->validateCallback);
+                            OutputWcs(L"(value)) {");
+                            OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_INVALID;");
+                            OutputWcs(L"\n                return false;");
+                            OutputWcs(L"\n            }");
+                        }
 
-        OutputWcs(L"//---------------------//\n");
-        OutputWcs(L"// AUTO-GENERATED FILE //\n");
-        OutputWcs(L"//---------------------//\n\n");
+                        OutputAssignValue(configPtr, itemPtr);
 
-        wchar_t fileBaseNameUpper[MAX_PATH];
-        for (size_t i = 0; i != fileBaseNameLength; i++) {
-            fileBaseNameUpper[i] = towupper(fileName[i]);
-        }
-        fileBaseNameUpper[fileBaseNameLength] = L'\0';
+                        OutputWcs(L"\n            return true;");
+                        OutputWcs(L"\n        }");
+                        break;
+                    }
 
-        OutputWcs(L"#ifndef _MKCONFGEN_");
-        OutputWcs(fileBaseNameUpper);
-        OutputWcs(L"_H\n");
+                    case ITEM_I8:
+                    case ITEM_I16:
+                    case ITEM_I32:
+                    case ITEM_I64:
+                    case ITEM_U8:
+                    case ITEM_U16:
+                    case ITEM_U32:
+                    case ITEM_U64:
+                    {
+                        bool isSigned = itemPtr->type <= ITEM_I64;
 
-        OutputWcs(L"#define _MKCONFGEN_");
-        OutputWcs(fileBaseNameUpper);
-        OutputWcs(L"_H\n");
+                        OutputWcs(L"\n            if (isStr) {");
+                        OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_TYPE;");
+                        OutputWcs(L"\n                return false;");
+                        OutputWcs(L"\n            }");
+                        OutputWcs(L"\n");
+                        OutputWcs(L"\n            wchar_t * end;");
+                        OutputWcs(L"\n            errno = 0;");
+                        if (isSigned) {
+                            OutputWcs(L"\n            long long parsedValue = wcstoll(rawValue, &end, 0);");
+                        } else {
+                            OutputWcs(L"\n            unsigned long long parsedValue = wcstoull(rawValue, &end, 0);");
+                        }
+                        OutputWcs(L"\n            if (end != rawValue + rawValueLength");
+                        if (!isSigned) {
+                            OutputWcs(L" || rawValue[0] == L'-'");
+                        }
+                        OutputWcs(L") {");
+                        OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_TYPE;");
+                        OutputWcs(L"\n                return false;");
+                        OutputWcs(L"\n            }");
 
-        OutputWcs(L"\n#include <math.h>");
-        OutputWcs(L"\n#include <stddef.h>");
-        OutputWcs(L"\n#include <wchar.h>\n");
-        OutputWstr(&includeLine);
+                        // The range check is inlined against the target width, 64 bit values can only overflow the
+                        // conversion itself.
+                        OutputWcs(L"\n            if (errno == ERANGE");
+                        switch (itemPtr->type) {
+                            case ITEM_I8:
+                                OutputWcs(L" || parsedValue < INT8_MIN || parsedValue > INT8_MAX");
+                                break;
+                            case ITEM_I16:
+                                OutputWcs(L" || parsedValue < INT16_MIN || parsedValue > INT16_MAX");
+                                break;
+                            case ITEM_I32:
+                                OutputWcs(L" || parsedValue < INT32_MIN || parsedValue > INT32_MAX");
+                                break;
+                            case ITEM_U8:
+                                OutputWcs(L" || parsedValue > UINT8_MAX");
+                                break;
+                            case ITEM_U16:
+                                OutputWcs(L" || parsedValue > UINT16_MAX");
+                                break;
+                            case ITEM_U32:
+                                OutputWcs(L" || parsedValue > UINT32_MAX");
+                                break;
+                            default:
+                                break;
+                        }
+                        OutputWcs(L") {");
+                        OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_OVERFLOW;");
+                        OutputWcs(L"\n                return false;");
+                        OutputWcs(L"\n            }");
 
-        for (size_t i = 0; i != configs.count; i++) {
-            Config * configPtr = &configs.elems[i];
+                        OutputWcs(L"\n            ");
+                        OutputWcs(ItemTypeName(itemPtr->type));
+                        OutputWcs(L" value = (");
+                        OutputWcs(ItemTypeName(itemPtr->type));
+                        OutputWcs(L")parsedValue;");
 
-            OutputWcs(L"\n\nstruct ");
-            OutputWstr(&configPtr->name);
-            OutputWcs(L" {");
+                        OutputConstraintChecks(itemPtr);
 
-            size_t headingIndex = 0;
-            Heading * headingPtr;
-            if (headingIndex != configPtr->headings.count) {
-                headingPtr = &configPtr->headings.elems[headingIndex];
-            } else {
-                headingPtr = NULL;
-            }
+                        if (itemPtr->validateCallback.length != 0) {
+                            OutputWcs(L"\n            if (!");
+                            OutputWstr(&itemPtr->validateCallback);
+                            OutputWcs(L"(value)) {");
+                            OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_INVALID;");
+                            OutputWcs(L"\n                return false;");
+                            OutputWcs(L"\n            }");
+                        }
 
-            for (size_t j = 0; j != configPtr->items.count; j++) {
-                if (headingPtr != NULL && j == headingPtr->index) {
-                    OutputWcs(L"\n\n    // ");
-                    OutputWstr(&headingPtr->name);
+                        OutputAssignValue(configPtr, itemPtr);
 
-                    if (++headingIndex != configPtr->headings.count) {
-                        headingPtr = &configPtr->headings.elems[headingIndex];
-                    } else {
-                        headingPtr = NULL;
+                        OutputWcs(L"\n            return true;");
+                        OutputWcs(L"\n        }");
+                        break;
                     }
-                }
-
-                Item * itemPtr = &configPtr->items.elems[j];
-                OutputWcs(L"\n    ");
 
-                switch (itemPtr->type) {
-                    case ITEM_INT:
+                    case ITEM_DURATION:
+                    case ITEM_SIZE:
                     {
-                        OutputWcs(L"long ");
-                        OutputWstr(&itemPtr->name);
+                        OutputWcs(L"\n            if (isStr) {");
+                        OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_TYPE;");
+                        OutputWcs(L"\n                return false;");
+                        OutputWcs(L"\n            }");
+                        OutputWcs(L"\n");
+                        OutputWcs(L"\n            uint64_t value;");
+                        OutputWcs(itemPtr->type == ITEM_DURATION
+                            ? L"\n            if (!_MkConfGenParseDuration(rawValue, rawValueLength, &value, errorType)) {"
+                            : L"\n            if (!_MkConfGenParseSize(rawValue, rawValueLength, &value, errorType)) {");
+                        OutputWcs(L"\n                return false;");
+                        OutputWcs(L"\n            }");
+
+                        if (itemPtr->validateCallback.length != 0) {
+                            OutputWcs(L"\n            if (!");
+                            OutputWstr(&itemPtr->validateCallback);
+                            OutputWcs(L"(value)) {");
+                            OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_INVALID;");
+                            OutputWcs(L"\n                return false;");
+                            OutputWcs(L"\n            }");
+                        }
+
+                        OutputAssignValue(configPtr, itemPtr);
+
+                        OutputWcs(L"\n            return true;");
+                        OutputWcs(L"\n        }");
                         break;
                     }
 
-                    case ITEM_UINT:
+                    case ITEM_ENUM:
                     {
-                        OutputWcs(L"unsigned long ");
-                        OutputWstr(&itemPtr->name);
+                        // Bare and quoted names are both accepted. The names are matched by switching on the length
+                        // first so that at most a few candidates have to be compared.
+                        OutputWcs(L"\n            ");
+                        OutputWstr(&itemPtr->enumName);
+                        OutputWcs(L" value = ");
+                        OutputDefaultName(configPtr, itemPtr);
+                        OutputWcs(L";");
+                        OutputWcs(L"\n            bool isMatch = false;");
+                        OutputWcs(L"\n            switch (rawValueLength) {");
+
+                        for (size_t k = 0; k != itemPtr->values.count; k++) {
+                            size_t valueLength = itemPtr->values.elems[k].length;
+
+                            bool isLengthDone = false;
+                            for (size_t l = 0; l != k; l++) {
+                                if (itemPtr->values.elems[l].length == valueLength) {
+                                    isLengthDone = true;
+                                    break;
+                                }
+                            }
+                            if (isLengthDone) {
+                                continue;
+                            }
+
+                            swprintf_s(tmpBuffer, 64, L"\n                case %zu:", valueLength);
+                            OutputWcs(tmpBuffer);
+
+                            bool isFirst = true;
+                            for (size_t l = k; l != itemPtr->values.count; l++) {
+                                MkWstr * valuePtr = &itemPtr->values.elems[l];
+                                if (valuePtr->length != valueLength) {
+                                    continue;
+                                }
+
+                                OutputWcs(isFirst ? L"\n                    if (wmemcmp(rawValue, L\"" : L" else if (wmemcmp(rawValue, L\"");
+                                OutputWstr(valuePtr);
+                                swprintf_s(tmpBuffer, 64, L"\", %zu) == 0) {", valueLength);
+                                OutputWcs(tmpBuffer);
+                                OutputWcs(L"\n                        value = ");
+                                OutputWstr(&itemPtr->enumName);
+                                OutputWcs(L"::");
+                                OutputWstr(valuePtr);
+                                OutputWcs(L";");
+                                OutputWcs(L"\n                        isMatch = true;");
+                                OutputWcs(L"\n                    }");
+                                isFirst = false;
+                            }
+                            OutputWcs(L"\n                    break;");
+                        }
+
+                        OutputWcs(L"\n            }");
+                        OutputWcs(L"\n            if (!isMatch) {");
+                        OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_INVALID;");
+                        OutputWcs(L"\n                return false;");
+                        OutputWcs(L"\n            }");
+
+                        if (itemPtr->validateCallback.length != 0) {
+                            OutputWcs(L"\n            if (!");
+                            OutputWstr(&itemPtr->validateCallback);
+                            OutputWcs(L"(value)) {");
+                            OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_INVALID;");
+                            OutputWcs(L"\n                return false;");
+                            OutputWcs(L"\n            }");
+                        }
+
+                        OutputAssignValue(configPtr, itemPtr);
+
+                        OutputWcs(L"\n            return true;");
+                        OutputWcs(L"\n        }");
                         break;
                     }
 
-                    case ITEM_FLOAT:
+                    case ITEM_INT_ARRAY:
+                    case ITEM_FLOAT_ARRAY:
+                    case ITEM_STR_ARRAY:
                     {
-                        OutputWcs(L"double ");
+                        // Loading parses the elements straight into the struct, a failed list falls back to the
+                        // defaults instead of leaving a partially overwritten array behind. SetFromText goes through
+                        // _MkConfGen<Config>SetValue instead, which leaves the array alone.
+                        OutputWcs(L"\n            if (isStr) {");
+                        OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_TYPE;");
+                        OutputWcs(L"\n                return false;");
+                        OutputWcs(L"\n            }");
+                        OutputParseArray(itemPtr, false);
+
+                        OutputWcs(L"\n            if (!isValid) {");
+                        OutputWcs(L"\n                memcpy(configPtr->");
+                        OutputWstr(&itemPtr->name);
+                        OutputWcs(L", ");
+                        OutputDefaultName(configPtr, itemPtr);
+                        OutputWcs(L", sizeof ");
+                        OutputDefaultName(configPtr, itemPtr);
+                        OutputWcs(L");");
+                        OutputWcs(L"\n                configPtr->");
                         OutputWstr(&itemPtr->name);
+                        OutputWcs(L"Count = ");
+                        OutputDefaultName(configPtr, itemPtr);
+                        OutputWcs(L"Count;");
+                        OutputWcs(L"\n            }");
+                        OutputWcs(L"\n            return isValid;");
+                        OutputWcs(L"\n        }");
                         break;
                     }
 
                     case ITEM_WSTR:
                     {
-                        OutputWcs(L"wchar_t ");
-                        OutputWstr(&itemPtr->name);
-                        OutputWcs(L"[");
-                        OutputWstr(&itemPtr->length);
-                        OutputWcs(L"]");
-                        break;
-                    }
-                }
-                OutputWcs(L";");
-            }
+                        OutputWcs(L"\n            if (!isStr) {");
+                        OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_TYPE;");
+                        OutputWcs(L"\n                return false;");
+                        OutputWcs(L"\n            }");
 
-            OutputWcs(L"\n};");
-        }
+                        OutputWcs(L"\n            if (rawValueLength >= ");
+                        OutputWstr(&itemPtr->length);
+                        OutputWcs(L") { ");
 
-        OutputWcs(L"\n");
-        OutputWcs(L"\n//---------------");
-        OutputWcs(L"\n// Default Values");
+                        OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_OVERFLOW;");
+                        OutputWcs(L"\n                return false;");
+                        OutputWcs(L"\n            }");
 
-        for (size_t i = 0; i != configs.count; i++) {
-            Config * configPtr = &configs.elems[i];
+                        if (itemPtr->maxLength.length != 0) {
+                            OutputWcs(L"\n            if (rawValueLength > ");
+                            OutputWstr(&itemPtr->maxLength);
+                            OutputWcs(L") {");
+                            OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_INVALID;");
+                            OutputWcs(L"\n                return false;");
+                            OutputWcs(L"\n            }");
+                        }
 
-            OutputWcs(L"\n\n// ");
-            OutputWstr(&configPtr->name);
+                        // Allowed strings are matched like enum names, by length first.
+                        if (itemPtr->hasOneOf) {
+                            OutputWcs(L"\n            bool isMatch = false;");
+                            OutputWcs(L"\n            switch (rawValueLength) {");
+                            for (size_t k = 0; k != itemPtr->oneOf.count; k++) {
+                                size_t valueLength = UnescapedLength(&itemPtr->oneOf.elems[k]);
+
+                                bool isLengthDone = false;
+                                for (size_t l = 0; l != k; l++) {
+                                    if (UnescapedLength(&itemPtr->oneOf.elems[l]) == valueLength) {
+                                        isLengthDone = true;
+                                        break;
+                                    }
+                                }
+                                if (isLengthDone) {
+                                    continue;
+                                }
+
+                                swprintf_s(tmpBuffer, 64, L"\n                case %zu:", valueLength);
+                                OutputWcs(tmpBuffer);
+                                OutputWcs(L"\n                    isMatch = ");
+                                bool isFirst = true;
+                                for (size_t l = k; l != itemPtr->oneOf.count; l++) {
+                                    if (UnescapedLength(&itemPtr->oneOf.elems[l]) != valueLength) {
+                                        continue;
+                                    }
+                                    OutputWcs(isFirst ? L"wmemcmp(rawValue, L\"" : L" || wmemcmp(rawValue, L\"");
+                                    OutputWstr(&itemPtr->oneOf.elems[l]);
+                                    swprintf_s(tmpBuffer, 64, L"\", %zu) == 0", valueLength);
+                                    OutputWcs(tmpBuffer);
+                                    isFirst = false;
+                                }
+                                OutputWcs(L";");
+                                OutputWcs(L"\n                    break;");
+                            }
+                            OutputWcs(L"\n            }");
+                            OutputWcs(L"\n            if (!isMatch) {");
+                            OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_INVALID;");
+                            OutputWcs(L"\n                return false;");
+                            OutputWcs(L"\n            }");
+                        }
 
-            Heading * headingPtr;
-            size_t headingIndex = 0;
-            if (headingIndex != configPtr->headings.count) {
-                headingPtr = &configPtr->headings.elems[headingIndex];
-            } else {
-                headingPtr = NULL;
-            }
+                        if (itemPtr->patternPtr) {
+                            OutputWcs(L"\n            if (!_MkConfGenMatchPattern(&");
+                            OutputPatternName(configPtr, itemPtr);
+                            OutputWcs(L", rawValue, rawValueLength)) {");
+                            OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_INVALID;");
+                            OutputWcs(L"\n                return false;");
+                            OutputWcs(L"\n            }");
+                        }
 
-            for (size_t j = 0; j != configPtr->items.count; j++) {
-                if (headingPtr != NULL && j == headingPtr->index) {
-                    OutputWcs(L"\n\n// ");
-                    OutputWstr(&headingPtr->name);
+                        OutputWcs(L"\n            wmemcpy(");
+                        OutputItemRef(configPtr, itemPtr);
+                        OutputWcs(L", rawValue, rawValueLength + 1);");
+                        OutputRowCountUpdate(configPtr, itemPtr);
 
-                    if (++headingIndex != configPtr->headings.count) {
-                        headingPtr = &configPtr->headings.elems[headingIndex];
-                    } else {
-                        headingPtr = NULL;
+                        OutputWcs(L"\n            return true;");
+                        OutputWcs(L"\n        }");
+                        break;
                     }
                 }
+            }
 
-                Item * itemPtr = &configPtr->items.elems[j];
-
-                OutputWcs(L"\nextern const ");
-                switch (itemPtr->type) {
-                    case ITEM_INT:
-                        OutputWcs(L"long ");
-                        break;
-
-                    case ITEM_UINT:
-                        OutputWcs(L"unsigned long ");
-                        break;
-
-                    case ITEM_FLOAT:
-                        OutputWcs(L"double ");
-                        break;
+            OutputWcs(L"\n");
+            OutputWcs(L"\n        default:");
+            OutputWcs(L"\n        {");
+            OutputWcs(L"\n            *errorType = MKCONFGEN_LOAD_ERROR_UNDEFINED;");
+            OutputWcs(L"\n            return false;");
+            OutputWcs(L"\n        }");
 
-                    case ITEM_WSTR:
-                        OutputWcs(L"wchar_t ");
-                        break;
-                }
+            OutputWcs(L"\n    }");
+            OutputWcs(L"\n}");
 
+            // Maps are sized by a counting pre-pass so that parsing never has to grow them.
+            wchar_t tmpBuffer[32];
+            size_t mapCount = CountMaps(configPtr);
+            if (mapCount != 0) {
+                OutputWcs(isSplit ? L"\n\nbool _MkConfGen" : L"\n\nstatic bool _MkConfGen");
                 OutputWstr(&configPtr->name);
-                OutputWcs(L"Default_");
-                OutputWstr(&itemPtr->name);
-
-                if (itemPtr->type == ITEM_WSTR) {
-                    OutputWcs(L"[");
-                    OutputWstr(&itemPtr->length);
-                    OutputWcs(L"]");
+                OutputWcs(L"ReserveMaps(");
+                OutputWstr(&configPtr->name);
+                OutputWcs(L" * configPtr, const wchar_t * configWcs, size_t configLength) {");
+                OutputWcs(L"\n    static const wchar_t * const mapNames[] = {");
+                bool isFirstMap = true;
+                for (size_t j = 0; j != configPtr->items.count; j++) {
+                    Item * itemPtr = &configPtr->items.elems[j];
+                    if (itemPtr->isMap) {
+                        OutputWcs(isFirstMap ? L" L\"" : L", L\"");
+                        OutputWstr(&itemPtr->name);
+                        OutputWcs(L"\"");
+                        isFirstMap = false;
+                    }
                 }
+                OutputWcs(L" };");
+                swprintf_s(tmpBuffer, 32, L"%zu];", mapCount);
+                OutputWcs(L"\n    size_t keyCounts[");
+                OutputWcs(tmpBuffer);
+                OutputWcs(L"\n    size_t keyLengths[");
+                OutputWcs(tmpBuffer);
+                swprintf_s(tmpBuffer, 32, L"%zu", mapCount);
+                OutputWcs(L"\n    _MkConfGenCountMapKeys(configWcs, configLength, ");
+                OutputWcs(tmpBuffer);
+                OutputWcs(L", mapNames, keyCounts, keyLengths);");
 
+                size_t mapIndex = 0;
+                for (size_t j = 0; j != configPtr->items.count; j++) {
+                    Item * itemPtr = &configPtr->items.elems[j];
+                    if (!itemPtr->isMap) {
+                        continue;
+                    }
+                    OutputWcs(mapIndex == 0 ? L"\n    return " : L" &&\n        ");
+                    swprintf_s(tmpBuffer, 32, L"%zu", mapIndex);
+                    OutputWcs(L"_MkConfGenMapReserve(&configPtr->");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L", keyCounts[");
+                    OutputWcs(tmpBuffer);
+                    OutputWcs(L"], keyLengths[");
+                    OutputWcs(tmpBuffer);
+                    OutputWcs(L"], sizeof(");
+                    OutputWcs(ItemTypeName(itemPtr->type));
+                    OutputWcs(L"))");
+                    mapIndex++;
+                }
                 OutputWcs(L";");
+                OutputWcs(L"\n}");
+
+                // Reserves map space for included files as well.
+                OutputWcs(isSplit ? L"\n\nbool _MkConfGen" : L"\n\nstatic bool _MkConfGen");
+                OutputWstr(&configPtr->name);
+                OutputWcs(L"Prepare(void * config, const wchar_t * configWcs, size_t configLength) {");
+                OutputWcs(L"\n    return _MkConfGen");
+                OutputWstr(&configPtr->name);
+                OutputWcs(L"ReserveMaps((");
+                OutputWstr(&configPtr->name);
+                OutputWcs(L" *)config, configWcs, configLength);");
+                OutputWcs(L"\n}");
             }
-        }
 
-        OutputWcs(L"\n");
-        OutputWcs(L"\n//----------");
-        OutputWcs(L"\n// Functions");
+            OutputWcs(L"\n\nbool ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"LoadSections(");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr, uint64_t sectionMask, const wchar_t * configWcs, size_t configLength, MkConfGenLoadError ** errors, size_t * errorCount) {");
 
-        for (size_t i = 0; i != configs.count; i++) {
-            Config * configPtr = &configs.elems[i];
+            if (mapCount != 0) {
+                OutputWcs(L"\n    if (!_MkConfGen");
+                OutputWstr(&configPtr->name);
+                OutputWcs(L"ReserveMaps(configPtr, configWcs, configLength)) {");
+                OutputWcs(L"\n        *errors = NULL;");
+                OutputWcs(L"\n        *errorCount = 0;");
+                OutputWcs(L"\n        return false;");
+                OutputWcs(L"\n    }");
+                OutputWcs(L"\n");
+            }
 
-            OutputWcs(L"\n\nvoid ");
+            swprintf_s(tmpBuffer, 32, L"%zu, _mkConfGen", configPtr->items.count);
+            OutputWcs(L"\n    const _MkConfGenSection section = { NULL, ");
+            OutputWcs(tmpBuffer);
             OutputWstr(&configPtr->name);
-            OutputWcs(L"Init(");
+            OutputWcs(L"Indices, _mkConfGen");
             OutputWstr(&configPtr->name);
-            OutputWcs(L" * configPtr);");
+            OutputWcs(L"Keys, ");
+            OutputHeadingArgs(configPtr);
+            OutputWcs(L", sectionMask, _MkConfGen");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"ParseValue, configPtr, false, ");
+            OutputPrepareArg(configPtr);
+            OutputWcs(L" };");
+            OutputWcs(L"\n    return _MkConfGenLoadSections(configWcs, configLength, 1, &section, errors, errorCount);");
+            OutputWcs(L"\n}");
 
             OutputWcs(L"\n\nbool ");
             OutputWstr(&configPtr->name);
             OutputWcs(L"Load(");
             OutputWstr(&configPtr->name);
-            OutputWcs(L" * configPtr, const wchar_t * configWcs, size_t configLength, MkConfGenLoadError ** errors, size_t * errorCount);");
-        }
-
-        OutputWcs(L"\n\n#endif");
-
-        CloseHandle(file);
-    }
-
-    {
-        wchar_t implFilePath[MAX_PATH];
-        wcsncpy_s(implFilePath, MAX_PATH, args[1], fileName - args[1]);
-        wcsncat_s(implFilePath, MAX_PATH, fileName, fileBaseNameLength);
-        wcscat_s(implFilePath, MAX_PATH, L"Gen.cpp");
+            OutputWcs(L" * configPtr, const wchar_t * configWcs, size_t configLength, MkConfGenLoadError ** errors, size_t * errorCount) {");
+            OutputWcs(L"\n    return ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"LoadSections(configPtr, UINT64_MAX, configWcs, configLength, errors, errorCount);");
+            OutputWcs(L"\n}");
 
-        HANDLE file = CreateFileW(
-            implFilePath,
-            GENERIC_WRITE,
-            0,
-            NULL,
-            CREATE_ALWAYS,
-            FILE_ATTRIBUTE_NORMAL,
-            NULL);
-        if (file == INVALID_HANDLE_VALUE) {
-            return 4;
-        }
+            OutputWcs(L"\n\n#ifdef _WIN32");
+            OutputWcs(L"\nbool ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"LoadFile(");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr, const wchar_t * path, MkConfGenLoadError ** errors, size_t * errorCount) {");
+            swprintf_s(tmpBuffer, 32, L"%zu, _mkConfGen", configPtr->items.count);
+            OutputWcs(L"\n    const _MkConfGenSection section = { NULL, ");
+            OutputWcs(tmpBuffer);
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Indices, _mkConfGen");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Keys, ");
+            OutputHeadingArgs(configPtr);
+            OutputWcs(L", UINT64_MAX, _MkConfGen");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"ParseValue, configPtr, false, ");
+            OutputPrepareArg(configPtr);
+            OutputWcs(L" };");
+            OutputWcs(L"\n    return _MkConfGenLoadFile(path, 1, &section, errors, errorCount);");
+            OutputWcs(L"\n}");
+            OutputWcs(L"\n#endif");
 
-        OutputWcs(L"//---------------------//\n");
-        OutputWcs(L"// AUTO-GENERATED FILE //\n");
-        OutputWcs(L"//---------------------//\n\n");
+            OutputWcs(L"\n\nbool ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"LoadPacked(");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr, const MkConfGenPack * pack, const wchar_t * name, MkConfGenLoadError ** errors, size_t * errorCount) {");
+            OutputWcs(L"\n    MkConfGenPackMember member;");
+            OutputWcs(L"\n    if (!MkConfGenPackFind(pack, name, wcslen(name), &member) || !member.isText) {");
+            OutputWcs(L"\n        *errors = NULL;");
+            OutputWcs(L"\n        *errorCount = 0;");
+            OutputWcs(L"\n        return false;");
+            OutputWcs(L"\n    }");
+            OutputWcs(L"\n    return ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Load(configPtr, (const wchar_t *)member.data, member.size / sizeof(wchar_t), errors, errorCount);");
+            OutputWcs(L"\n}");
 
-        OutputWcs(L"#include \"");
-        OutputWcs(headerFileName);
-        OutputWcs(L"\"");
+            // Bitfield booleans and the columns of a table share memory, so each of them is parsed by one thread.
+            OutputWcs(L"\n\n#ifdef _WIN32");
+            OutputWcs(L"\nstatic const uint32_t _mkConfGen");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"ParseGroups[] = {");
+            size_t boolGroup = SIZE_MAX;
+            for (size_t j = 0; j != configPtr->items.count; j++) {
+                Item * itemPtr = &configPtr->items.elems[j];
+                size_t group = j;
+                if (itemPtr->table != SIZE_MAX) {
+                    group = configPtr->tables.elems[itemPtr->table].firstItem;
+                } else if (itemPtr->type == ITEM_BOOL && !itemPtr->isMap) {
+                    if (boolGroup == SIZE_MAX) {
+                        boolGroup = j;
+                    }
+                    group = boolGroup;
+                }
+                swprintf_s(tmpBuffer, 32, L"\n    %zu,", group);
+                OutputWcs(tmpBuffer);
+            }
+            OutputWcs(L"\n};");
 
-        OutputWcs(L"\n");
-        OutputWcs(L"\n//-----------------------");
-        OutputWcs(L"\n// Copied Input File Head");
-        
-        OutputWcs(L"\n\n");
-        OutputWstr(&inputHead);
+            OutputWcs(L"\n\nbool ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"LoadParallel(");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr, size_t threadCount, const wchar_t * configWcs, size_t configLength, MkConfGenLoadError ** errors, size_t * errorCount) {");
+            if (mapCount != 0) {
+                OutputWcs(L"\n    if (!_MkConfGen");
+                OutputWstr(&configPtr->name);
+                OutputWcs(L"ReserveMaps(configPtr, configWcs, configLength)) {");
+                OutputWcs(L"\n        *errors = NULL;");
+                OutputWcs(L"\n        *errorCount = 0;");
+                OutputWcs(L"\n        return false;");
+                OutputWcs(L"\n    }");
+            }
+            swprintf_s(tmpBuffer, 32, L"%zu, _mkConfGen", configPtr->items.count);
+            OutputWcs(L"\n    const _MkConfGenSection section = { NULL, ");
+            OutputWcs(tmpBuffer);
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Indices, _mkConfGen");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Keys, ");
+            OutputHeadingArgs(configPtr);
+            OutputWcs(L", UINT64_MAX, _MkConfGen");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"ParseValue, configPtr, false, ");
+            OutputPrepareArg(configPtr);
+            OutputWcs(L" };");
+            OutputWcs(L"\n    return _MkConfGenLoadParallel(configWcs, configLength, &section, _mkConfGen");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"ParseGroups, threadCount, errors, errorCount);");
+            OutputWcs(L"\n}");
 
-        OutputWcs(L"\n");
-        OutputWcs(L"\n//-----");
-        OutputWcs(L"\n// Keys");
+            OutputWcs(L"\n#endif");
 
-        for (size_t i = 0; i != configs.count; i++) {
-            Config * configPtr = &configs.elems[i];
+            // Both only differ in the callback the file is handed to once it is read.
+            const wchar_t * asyncKinds[2] = { L"LoadAsync", L"LoadSliced" };
+            for (size_t k = 0; k != 2; k++) {
+                OutputWcs(L"\n\nbool ");
+                OutputWstr(&configPtr->name);
+                OutputWcs(asyncKinds[k]);
+                OutputWcs(L"(");
+                OutputWstr(&configPtr->name);
+                OutputWcs(k == 0
+                    ? L" * configPtr, const wchar_t * path, MkConfGenLoadCompletion completion, void * context) {"
+                    : L" * configPtr, const wchar_t * path, size_t lineBudget, MkConfGenLoadReady ready, void * context) {");
+                OutputWcs(L"\n    const _MkConfGenSection section = { NULL, ");
+                OutputWcs(tmpBuffer);
+                OutputWstr(&configPtr->name);
+                OutputWcs(L"Indices, _mkConfGen");
+                OutputWstr(&configPtr->name);
+                OutputWcs(L"Keys, ");
+                OutputHeadingArgs(configPtr);
+                OutputWcs(L", UINT64_MAX, _MkConfGen");
+                OutputWstr(&configPtr->name);
+                OutputWcs(L"ParseValue, configPtr, false, ");
+                OutputPrepareArg(configPtr);
+                OutputWcs(L" };");
+                if (mapCount != 0) {
+                    OutputWcs(L"\n    return _MkConfGenLoadAsync(path, &section, _MkConfGen");
+                    OutputWstr(&configPtr->name);
+                    OutputWcs(L"Prepare, ");
+                } else {
+                    OutputWcs(L"\n    return _MkConfGenLoadAsync(path, &section, NULL, ");
+                }
+                OutputWcs(k == 0 ? L"0, NULL, completion, context);" : L"lineBudget, ready, NULL, context);");
+                OutputWcs(L"\n}");
+            }
 
-            OutputWcs(L"\n\nconst size_t _mkConfGen");
+            OutputWcs(L"\n\n#ifdef __cpp_impl_coroutine");
+            OutputWcs(L"\nMkConfGenLoadAwaitable<");
             OutputWstr(&configPtr->name);
-            OutputWcs(L"Indices[] = {");
+            OutputWcs(L"> ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"LoadAwait(");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr, const wchar_t * path) {");
+            OutputWcs(L"\n    return { ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"LoadAsync, configPtr, path, { false, NULL, 0 }, std::coroutine_handle<>() };");
+            OutputWcs(L"\n}");
+            OutputWcs(L"\n\nMkConfGenLoadSlicedAwaitable<");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"> ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"LoadSlicedAwait(");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr, const wchar_t * path, size_t lineBudget) {");
+            OutputWcs(L"\n    return { ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"LoadSliced, configPtr, path, lineBudget, NULL, std::coroutine_handle<>() };");
+            OutputWcs(L"\n}");
+            OutputWcs(L"\n#endif");
 
-            size_t currentKeyIndex = 0;
-            wchar_t tmpBuffer[32];
+            OutputWcs(L"\n\nvoid ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Free(");
+            OutputWstr(&configPtr->name);
+            // Without maps there is nothing to free, the parameter is left unnamed.
+            if (mapCount != 0) {
+                OutputWcs(L" * configPtr) {");
+                OutputWcs(L"\n    _MKCONFGEN_ASSERT(configPtr);");
+            } else {
+                OutputWcs(L" *) {");
+            }
             for (size_t j = 0; j != configPtr->items.count; j++) {
-                swprintf_s(tmpBuffer, 32, L"\n    %zu,", currentKeyIndex);
-                OutputWcs(tmpBuffer);
-
                 Item * itemPtr = &configPtr->items.elems[j];
-                currentKeyIndex += itemPtr->name.length;
+                if (itemPtr->isMap) {
+                    OutputWcs(L"\n    _MkConfGenMapFree(&configPtr->");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L");");
+                }
             }
-            swprintf_s(tmpBuffer, 32, L"\n    %zu,", currentKeyIndex);
-            OutputWcs(tmpBuffer);
-            OutputWcs(L"\n};");
+            OutputWcs(L"\n}");
 
-            OutputWcs(L"\n\nconst wchar_t _mkConfGen");
+            OutputWcs(L"\n\nvoid ");
             OutputWstr(&configPtr->name);
-            OutputWcs(L"Keys[] =");
+            OutputWcs(L"Reset(");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr) {");
+            OutputWcs(L"\n    ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Free(configPtr);");
+            OutputWcs(L"\n    ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Init(configPtr);");
+            OutputWcs(L"\n}");
 
             for (size_t j = 0; j != configPtr->items.count; j++) {
                 Item * itemPtr = &configPtr->items.elems[j];
-                OutputWcs(L"\n    L\"");
+                if (!itemPtr->isMap) {
+                    continue;
+                }
+                OutputWcs(L"\n\nconst ");
+                OutputWcs(ItemTypeName(itemPtr->type));
+                OutputWcs(L" * ");
+                OutputWstr(&configPtr->name);
+                OutputWcs(L"Find_");
                 OutputWstr(&itemPtr->name);
-                OutputWcs(L"\"");
+                OutputWcs(L"(const ");
+                OutputWstr(&configPtr->name);
+                OutputWcs(L" * configPtr, const wchar_t * key, size_t keyLength) {");
+                OutputWcs(L"\n    _MKCONFGEN_ASSERT(configPtr);");
+                OutputWcs(L"\n    return (const ");
+                OutputWcs(ItemTypeName(itemPtr->type));
+                OutputWcs(L" *)MkConfGenMapFind(&configPtr->");
+                OutputWstr(&itemPtr->name);
+                OutputWcs(L", key, keyLength);");
+                OutputWcs(L"\n}");
             }
-            OutputWcs(L";");
-        }
 
-        OutputWcs(L"\n");
-        OutputWcs(L"\n//---------------");
-        OutputWcs(L"\n// Default Values");
-
-        for (size_t i = 0; i != configs.count; i++) {
-            Config * configPtr = &configs.elems[i];
+            // Overlays parse into a scratch copy of the base and keep only the values that were set.
+            OutputWcs(L"\n\nconst size_t _mkConfGen");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"OverlayValueSizes[] = {");
+            for (size_t j = 0; j != configPtr->items.count; j++) {
+                Item * itemPtr = &configPtr->items.elems[j];
+                if (!IsOverlayItem(itemPtr)) {
+                    OutputWcs(L"\n    0,");
+                } else if (itemPtr->type == ITEM_BOOL) {
+                    OutputWcs(L"\n    sizeof(bool),");
+                } else {
+                    OutputWcs(IsArray(itemPtr->type) ? L"\n    sizeof(size_t) + sizeof " : L"\n    sizeof ");
+                    OutputDefaultName(configPtr, itemPtr);
+                    OutputWcs(L",");
+                }
+            }
+            OutputWcs(L"\n};");
 
-            OutputWcs(L"\n\n// ");
+            swprintf_s(tmpBuffer, 32, L"%zu];", (configPtr->items.count + 63) / 64);
+            OutputWcs(L"\n\nstruct _MkConfGen");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"OverlayScratch {");
+            OutputWcs(L"\n    ");
             OutputWstr(&configPtr->name);
+            OutputWcs(L" config;");
+            OutputWcs(L"\n    uint64_t presence[");
+            OutputWcs(tmpBuffer);
+            OutputWcs(L"\n};");
 
-            Heading * headingPtr;
-            size_t headingIndex = 0;
-            if (headingIndex != configPtr->headings.count) {
-                headingPtr = &configPtr->headings.elems[headingIndex];
-            } else {
-                headingPtr = NULL;
+            OutputWcs(L"\n\nstatic bool _MkConfGen");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"OverlayParseValue(");
+            OutputWcs(L"\n    void * config,");
+            OutputWcs(L"\n    size_t index,");
+            OutputWcs(L"\n    size_t row,");
+            OutputWcs(L"\n    const wchar_t * mapKey,");
+            OutputWcs(L"\n    size_t mapKeyLength,");
+            OutputWcs(L"\n    wchar_t * rawValue,");
+            OutputWcs(L"\n    size_t rawValueLength,");
+            OutputWcs(L"\n    bool isStr,");
+            OutputWcs(L"\n    MkConfGenLoadErrorType * errorType)");
+            OutputWcs(L"\n{");
+            OutputWcs(L"\n    _MkConfGen");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"OverlayScratch * scratchPtr = (_MkConfGen");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"OverlayScratch *)config;");
+            OutputWcs(L"\n    uint64_t bit = (uint64_t)1 << (index % 64);");
+            OutputWcs(L"\n    switch (index) {");
+            bool hasCases = false;
+            for (size_t j = 0; j != configPtr->items.count; j++) {
+                if (!IsOverlayItem(&configPtr->items.elems[j])) {
+                    swprintf_s(tmpBuffer, 32, L"\n        case %zu:", j);
+                    OutputWcs(tmpBuffer);
+                    hasCases = true;
+                }
             }
-
+            if (hasCases) {
+                OutputWcs(L"\n            *errorType = MKCONFGEN_LOAD_ERROR_KEY_OVERLAY;");
+                OutputWcs(L"\n            return false;");
+            }
+            OutputWcs(L"\n    }");
+            OutputWcs(L"\n    if (!_MkConfGen");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"ParseValue(&scratchPtr->config, index, row, mapKey, mapKeyLength, rawValue, rawValueLength, isStr, errorType)) {");
+            OutputWcs(L"\n        // Arrays fall back to their defaults on errors, the overlay falls back to the base instead.");
+            OutputWcs(L"\n        switch (index) {");
+            hasCases = false;
             for (size_t j = 0; j != configPtr->items.count; j++) {
-                if (headingPtr != NULL && j == headingPtr->index) {
-                    OutputWcs(L"\n\n// ");
-                    OutputWstr(&headingPtr->name);
-
-                    if (++headingIndex != configPtr->headings.count) {
-                        headingPtr = &configPtr->headings.elems[headingIndex];
-                    } else {
-                        headingPtr = NULL;
-                    }
+                if (IsArray(configPtr->items.elems[j].type)) {
+                    swprintf_s(tmpBuffer, 32, L"\n            case %zu:", j);
+                    OutputWcs(tmpBuffer);
+                    hasCases = true;
                 }
+            }
+            if (hasCases) {
+                OutputWcs(L"\n                scratchPtr->presence[index / 64] &= ~bit;");
+            }
+            OutputWcs(L"\n        }");
+            OutputWcs(L"\n        return false;");
+            OutputWcs(L"\n    }");
+            OutputWcs(L"\n    scratchPtr->presence[index / 64] |= bit;");
+            OutputWcs(L"\n    return true;");
+            OutputWcs(L"\n}");
 
+            OutputWcs(L"\n\nbool ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"OverlayLoad(");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Overlay * overlayPtr, const ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * base, const wchar_t * configWcs, size_t configLength, MkConfGenLoadError ** errors, size_t * errorCount) {");
+            OutputWcs(L"\n    _MKCONFGEN_ASSERT(overlayPtr);");
+            OutputWcs(L"\n    _MKCONFGEN_ASSERT(base);");
+            OutputWcs(L"\n    _MkConfGen");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"OverlayScratch * scratchPtr = (_MkConfGen");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"OverlayScratch *)malloc(sizeof(_MkConfGen");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"OverlayScratch));");
+            OutputWcs(L"\n    if (!scratchPtr) {");
+            OutputWcs(L"\n        *errors = NULL;");
+            OutputWcs(L"\n        *errorCount = 0;");
+            OutputWcs(L"\n        return false;");
+            OutputWcs(L"\n    }");
+            OutputWcs(L"\n    memcpy(&scratchPtr->config, base, sizeof(");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"));");
+            OutputWcs(L"\n    memset(scratchPtr->presence, 0, sizeof scratchPtr->presence);");
+            OutputWcs(L"\n    overlayPtr->base = base;");
+            OutputWcs(L"\n");
+            OutputWcs(L"\n    bool isLoaded = _MkConfGenLoad(");
+            OutputWcs(L"\n        configWcs,");
+            OutputWcs(L"\n        configLength,");
+            swprintf_s(tmpBuffer, 32, L"\n        %zu,", configPtr->items.count);
+            OutputWcs(tmpBuffer);
+            OutputWcs(L"\n        _mkConfGen");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Indices,");
+            OutputWcs(L"\n        _mkConfGen");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Keys,");
+            OutputWcs(L"\n        ");
+            OutputHeadingArgs(configPtr);
+            OutputWcs(L",");
+            OutputWcs(L"\n        UINT64_MAX,");
+            OutputWcs(L"\n        _MkConfGen");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"OverlayParseValue,");
+            OutputWcs(L"\n        scratchPtr,");
+            OutputWcs(L"\n        errors,");
+            OutputWcs(L"\n        errorCount);");
+            OutputWcs(L"\n");
+            swprintf_s(tmpBuffer, 32, L"%zu", configPtr->items.count);
+            OutputWcs(L"\n    if (!_MkConfGenOverlayAlloc(&overlayPtr->overlay, ");
+            OutputWcs(tmpBuffer);
+            OutputWcs(L", scratchPtr->presence, _mkConfGen");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"OverlayValueSizes)) {");
+            OutputWcs(L"\n        free(scratchPtr);");
+            OutputWcs(L"\n        free(*errors);");
+            OutputWcs(L"\n        *errors = NULL;");
+            OutputWcs(L"\n        *errorCount = 0;");
+            OutputWcs(L"\n        return false;");
+            OutputWcs(L"\n    }");
+            OutputWcs(L"\n");
+            OutputWcs(L"\n    for (size_t index = 0; index != ");
+            OutputWcs(tmpBuffer);
+            OutputWcs(L"; index++) {");
+            OutputWcs(L"\n        void * slot = (void *)MkConfGenOverlayFind(&overlayPtr->overlay, index);");
+            OutputWcs(L"\n        if (!slot) {");
+            OutputWcs(L"\n            continue;");
+            OutputWcs(L"\n        }");
+            OutputWcs(L"\n        switch (index) {");
+            for (size_t j = 0; j != configPtr->items.count; j++) {
                 Item * itemPtr = &configPtr->items.elems[j];
-
-                OutputWcs(L"\nconst ");
-                switch (itemPtr->type) {
-                    case ITEM_INT:
-                        OutputWcs(L"long ");
-                        break;
-
-                    case ITEM_UINT:
-                        OutputWcs(L"unsigned long ");
-                        break;
-
-                    case ITEM_FLOAT:
-                        OutputWcs(L"double ");
-                        break;
-
-                    case ITEM_WSTR:
-                        OutputWcs(L"wchar_t ");
-                        break;
+                if (!IsOverlayItem(itemPtr)) {
+                    continue;
                 }
-
-                OutputWstr(&configPtr->name);
-                OutputWcs(L"Default_");
-                OutputWstr(&itemPtr->name);
-
-                if (itemPtr->type == ITEM_WSTR) {
-                    OutputWcs(L"[");
-                    OutputWstr(&itemPtr->length);
-                    OutputWcs(L"] = L\"");
-                    OutputWstr(&itemPtr->defaultValue);
-                    OutputWcs(L"\";");
+                swprintf_s(tmpBuffer, 32, L"\n            case %zu:", j);
+                OutputWcs(tmpBuffer);
+                if (itemPtr->type == ITEM_BOOL) {
+                    OutputWcs(L"\n                *(bool *)slot = scratchPtr->config.");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L";");
+                } else if (IsArray(itemPtr->type)) {
+                    OutputWcs(L"\n                *(size_t *)slot = scratchPtr->config.");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L"Count;");
+                    OutputWcs(L"\n                memcpy((size_t *)slot + 1, scratchPtr->config.");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L", sizeof scratchPtr->config.");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L");");
                 } else {
-                    OutputWcs(L" = ");
-                    OutputWstr(&itemPtr->defaultValue);
-                    OutputWcs(L";");
+                    OutputWcs(L"\n                memcpy(slot, &scratchPtr->config.");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L", sizeof scratchPtr->config.");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L");");
                 }
+                OutputWcs(L"\n                break;");
             }
-        }
-
-        OutputWcs(L"\n");
-        OutputWcs(L"\n//----------");
-        OutputWcs(L"\n// Functions");
-
-        for (size_t i = 0; i != configs.count; i++) {
-            Config * configPtr = &configs.elems[i];
+            OutputWcs(L"\n        }");
+            OutputWcs(L"\n    }");
+            OutputWcs(L"\n");
+            OutputWcs(L"\n    free(scratchPtr);");
+            OutputWcs(L"\n    return isLoaded;");
+            OutputWcs(L"\n}");
 
             OutputWcs(L"\n\nvoid ");
             OutputWstr(&configPtr->name);
-            OutputWcs(L"Init(");
+            OutputWcs(L"OverlayFree(");
             OutputWstr(&configPtr->name);
-            OutputWcs(L" * configPtr) {");
-            OutputWcs(L"\n    _MKCONFGEN_ASSERT(configPtr);");
-
-            size_t headingIndex = 0;
-            Heading * headingPtr;
-            if (headingIndex != configPtr->headings.count) {
-                headingPtr = &configPtr->headings.elems[headingIndex];
-            } else {
-                headingPtr = NULL;
-            }
+            OutputWcs(L"Overlay * overlayPtr) {");
+            OutputWcs(L"\n    _MKCONFGEN_ASSERT(overlayPtr);");
+            OutputWcs(L"\n    _MkConfGenOverlayFree(&overlayPtr->overlay);");
+            OutputWcs(L"\n}");
 
             for (size_t j = 0; j != configPtr->items.count; j++) {
-                if (headingPtr != NULL && j == headingPtr->index) {
-                    OutputWcs(L"\n\n    // ");
-                    OutputWstr(&headingPtr->name);
-
-                    if (++headingIndex != configPtr->headings.count) {
-                        headingPtr = &configPtr->headings.elems[headingIndex];
-                    } else {
-                        headingPtr = NULL;
-                    }
-                }
-
                 Item * itemPtr = &configPtr->items.elems[j];
+                if (!IsOverlayItem(itemPtr)) {
+                    continue;
+                }
 
-                if (itemPtr->type == ITEM_WSTR) {
-                    OutputWcs(L"\n    wcscpy_s(configPtr->");
+                OutputGetterHead(configPtr, itemPtr, L"Overlay", L"const ", L"overlayPtr");
+                OutputWcs(L" {");
+                OutputWcs(L"\n    _MKCONFGEN_ASSERT(overlayPtr);");
+                swprintf_s(tmpBuffer, 32, L"%zu);", j);
+                OutputWcs(L"\n    const void * value = MkConfGenOverlayFind(&overlayPtr->overlay, ");
+                OutputWcs(tmpBuffer);
+                if (IsArray(itemPtr->type)) {
+                    OutputWcs(L"\n    if (value) {");
+                    OutputWcs(L"\n        *count = *(const size_t *)value;");
+                    OutputWcs(L"\n        return (const ");
+                    OutputWcs(ItemTypeName(itemPtr->type));
+                    OutputWcs(L" *)((const size_t *)value + 1);");
+                    OutputWcs(L"\n    }");
+                    OutputWcs(L"\n    *count = overlayPtr->base->");
                     OutputWstr(&itemPtr->name);
-                    OutputWcs(L", ");
-                    OutputWstr(&itemPtr->length);
-                    OutputWcs(L", ");
-                    OutputWstr(&configPtr->name);
-                    OutputWcs(L"Default_");
+                    OutputWcs(L"Count;");
+                    OutputWcs(L"\n    return (const ");
+                    OutputWcs(ItemTypeName(itemPtr->type));
+                    OutputWcs(L" *)overlayPtr->base->");
                     OutputWstr(&itemPtr->name);
-                    OutputWcs(L");");
-                } else {
-                    OutputWcs(L"\n    configPtr->");
+                    OutputWcs(L";");
+                } else if (itemPtr->type == ITEM_WSTR) {
+                    OutputWcs(L"\n    return value ? (const wchar_t *)value : overlayPtr->base->");
                     OutputWstr(&itemPtr->name);
-                    OutputWcs(L" = ");
-                    OutputWstr(&configPtr->name);
-                    OutputWcs(L"Default_");
+                    OutputWcs(L";");
+                } else {
+                    OutputWcs(L"\n    return value ? *(const ");
+                    OutputItemType(itemPtr);
+                    OutputWcs(L" *)value : overlayPtr->base->");
                     OutputWstr(&itemPtr->name);
                     OutputWcs(L";");
                 }
+                OutputWcs(L"\n}");
             }
 
-            OutputWcs(L"\n}");
-
+            // Lazy loading only records where the values are, they are parsed by the first LazyGet_ call.
             OutputWcs(L"\n\nstatic bool _MkConfGen");
             OutputWstr(&configPtr->name);
-            OutputWcs(L"ParseValue(");
+            OutputWcs(L"LazyRecord(");
             OutputWcs(L"\n    void * config,");
             OutputWcs(L"\n    size_t index,");
+            OutputWcs(L"\n    size_t row,");
+            OutputWcs(L"\n    const wchar_t * mapKey,");
+            OutputWcs(L"\n    size_t mapKeyLength,");
             OutputWcs(L"\n    wchar_t * rawValue,");
             OutputWcs(L"\n    size_t rawValueLength,");
             OutputWcs(L"\n    bool isStr,");
             OutputWcs(L"\n    MkConfGenLoadErrorType * errorType)");
             OutputWcs(L"\n{");
+            OutputWcs(L"\n    ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Lazy * lazyPtr = (");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Lazy *)config;");
+            OutputWcs(L"\n    switch (index) {");
+            bool hasEagerItems = false;
+            for (size_t j = 0; j != configPtr->items.count; j++) {
+                if (!IsLazyItem(&configPtr->items.elems[j])) {
+                    swprintf_s(tmpBuffer, 32, L"\n        case %zu:", j);
+                    OutputWcs(tmpBuffer);
+                    hasEagerItems = true;
+                }
+            }
+            if (hasEagerItems) {
+                OutputWcs(L"\n        {");
+                OutputWcs(L"\n            wchar_t buffer[MK_CONF_MAX_VALUE_COUNT];");
+                OutputWcs(L"\n            size_t valueLength;");
+                OutputWcs(L"\n            wchar_t * value = _MkConfGenRawValue(rawValue, rawValueLength, isStr, buffer, &valueLength);");
+                OutputWcs(L"\n            return _MkConfGen");
+                OutputWstr(&configPtr->name);
+                OutputWcs(L"ParseValue(&lazyPtr->values, index, row, mapKey, mapKeyLength, value, valueLength, isStr, errorType);");
+                OutputWcs(L"\n        }");
+            }
+            OutputWcs(L"\n    }");
+            OutputWcs(L"\n    if (row != SIZE_MAX || mapKey) {");
+            OutputWcs(L"\n        *errorType = MKCONFGEN_LOAD_ERROR_KEY_FORMAT;");
+            OutputWcs(L"\n        return false;");
+            OutputWcs(L"\n    }");
+            OutputWcs(L"\n    lazyPtr->items[index].offset = rawValue - lazyPtr->source;");
+            OutputWcs(L"\n    lazyPtr->items[index].length = rawValueLength;");
+            OutputWcs(L"\n    lazyPtr->items[index].isStr = isStr;");
+            OutputWcs(L"\n    return true;");
+            OutputWcs(L"\n}");
 
+            OutputWcs(L"\n\nbool ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"LazyLoad(");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Lazy * lazyPtr, const wchar_t * configWcs, size_t configLength, MkConfGenLoadError ** errors, size_t * errorCount) {");
+            OutputWcs(L"\n    _MKCONFGEN_ASSERT(lazyPtr);");
             OutputWcs(L"\n    ");
             OutputWstr(&configPtr->name);
-            OutputWcs(L" * configPtr = (");
+            OutputWcs(L"Init(&lazyPtr->values);");
+            OutputWcs(L"\n    lazyPtr->source = configWcs;");
+            swprintf_s(tmpBuffer, 32, L"%zu; index++) {", configPtr->items.count);
+            OutputWcs(L"\n    for (size_t index = 0; index != ");
+            OutputWcs(tmpBuffer);
+            OutputWcs(L"\n        lazyPtr->items[index].offset = SIZE_MAX;");
+            OutputWcs(L"\n        lazyPtr->items[index].state.store(0, std::memory_order_relaxed);");
+            OutputWcs(L"\n    }");
+            if (CountMaps(configPtr) != 0) {
+                OutputWcs(L"\n    if (!_MkConfGen");
+                OutputWstr(&configPtr->name);
+                OutputWcs(L"ReserveMaps(&lazyPtr->values, configWcs, configLength)) {");
+                OutputWcs(L"\n        *errors = NULL;");
+                OutputWcs(L"\n        *errorCount = 0;");
+                OutputWcs(L"\n        return false;");
+                OutputWcs(L"\n    }");
+            }
+            swprintf_s(tmpBuffer, 32, L"%zu, _mkConfGen", configPtr->items.count);
+            OutputWcs(L"\n    const _MkConfGenSection section = { NULL, ");
+            OutputWcs(tmpBuffer);
             OutputWstr(&configPtr->name);
-            OutputWcs(L" *)config;");
+            OutputWcs(L"Indices, _mkConfGen");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Keys, ");
+            OutputHeadingArgs(configPtr);
+            OutputWcs(L", UINT64_MAX, _MkConfGen");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"LazyRecord, lazyPtr, true, NULL };");
+            OutputWcs(L"\n    return _MkConfGenLoadSections(configWcs, configLength, 1, &section, errors, errorCount);");
+            OutputWcs(L"\n}");
 
-            OutputWcs(L"\n    switch (index) {");
+            OutputWcs(L"\n\nvoid ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"LazyFree(");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Lazy * lazyPtr) {");
+            OutputWcs(L"\n    _MKCONFGEN_ASSERT(lazyPtr);");
+            OutputWcs(L"\n    ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Free(&lazyPtr->values);");
+            OutputWcs(L"\n}");
 
             for (size_t j = 0; j != configPtr->items.count; j++) {
                 Item * itemPtr = &configPtr->items.elems[j];
+                if (!IsOverlayItem(itemPtr)) {
+                    continue;
+                }
 
-                wchar_t tmpBuffer[64];
-                swprintf_s(tmpBuffer, 64, L"\n\n        case %zu:", j);
-                OutputWcs(tmpBuffer);
-                OutputWcs(L"\n        {");
+                OutputGetterHead(configPtr, itemPtr, L"Lazy", L"", L"lazyPtr");
+                OutputWcs(L" {");
+                OutputWcs(L"\n    _MKCONFGEN_ASSERT(lazyPtr);");
+                if (IsLazyItem(itemPtr)) {
+                    swprintf_s(tmpBuffer, 32, L"[%zu], lazyPtr->source, %zu, ", j, j);
+                    OutputWcs(L"\n    _MkConfGenLazyParse(&lazyPtr->items");
+                    OutputWcs(tmpBuffer);
+                    OutputWcs(L"_MkConfGen");
+                    OutputWstr(&configPtr->name);
+                    OutputWcs(L"ParseValue, &lazyPtr->values);");
+                }
+                if (IsArray(itemPtr->type)) {
+                    OutputWcs(L"\n    *count = lazyPtr->values.");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L"Count;");
+                    OutputWcs(L"\n    return (const ");
+                    OutputWcs(ItemTypeName(itemPtr->type));
+                    OutputWcs(L" *)lazyPtr->values.");
+                } else {
+                    OutputWcs(L"\n    return lazyPtr->values.");
+                }
+                OutputWstr(&itemPtr->name);
+                OutputWcs(L";");
+                OutputWcs(L"\n}");
+            }
 
-                switch (itemPtr->type) {
-                    case ITEM_INT:
-                    {
-                        OutputWcs(L"\n            if (isStr) {");
-                        OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_TYPE;");
-                        OutputWcs(L"\n                return false;");
-                        OutputWcs(L"\n            }");
-                        OutputWcs(L"\n");
-                        OutputWcs(L"\n            wchar_t * end;");
-                        OutputWcs(L"\n            long value = wcstol(rawValue, &end, 0);");
-                        OutputWcs(L"\n            if (end != rawValue + rawValueLength) {");
-                        OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_TYPE;");
-                        OutputWcs(L"\n                return false;");
-                        OutputWcs(L"\n            }");
-                        OutputWcs(L"\n            if (value == LONG_MIN || value == LONG_MAX) {");
-                        OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_OVERFLOW;");
-                        OutputWcs(L"\n                return false;");
-                        OutputWcs(L"\n            }");
+            // A new mapping gets the defaults as its first image, so readers never see a zeroed config.
+            OutputWcs(L"\n\n#ifdef _WIN32");
+            OutputWcs(L"\nbool ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"SharedCreate(MkConfGenShared * sharedPtr, const wchar_t * name) {");
+            OutputWcs(L"\n    if (!_MkConfGenSharedCreate(sharedPtr, name, sizeof(");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"))) {");
+            OutputWcs(L"\n        return false;");
+            OutputWcs(L"\n    }");
+            OutputWcs(L"\n    if (MkConfGenSharedSequence(sharedPtr) == 0) {");
+            OutputWcs(L"\n        ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Init((");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" *)_MkConfGenSharedBeginWrite(sharedPtr));");
+            OutputWcs(L"\n        _MkConfGenSharedEndWrite(sharedPtr);");
+            OutputWcs(L"\n    }");
+            OutputWcs(L"\n    return true;");
+            OutputWcs(L"\n}");
 
-                        if (itemPtr->validateCallback.length != 0) {
-                            OutputWcs(L"\n            if (!");
-                            OutputWstr(&itemPtr->validateCallback);
-                            OutputWcs(L"(value)) {");
-                            OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_INVALID;");
-                            OutputWcs(L"\n                return false;");
-                            OutputWcs(L"\n            }");
-                        }
+            OutputWcs(L"\n\nbool ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"SharedOpen(MkConfGenShared * sharedPtr, const wchar_t * name) {");
+            OutputWcs(L"\n    return _MkConfGenSharedOpen(sharedPtr, name, sizeof(");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"));");
+            OutputWcs(L"\n}");
 
-                        OutputWcs(L"\n            configPtr->");
-                        OutputWstr(&itemPtr->name);
-                        OutputWcs(L" = value;");
+            // Maps point into the memory of the publisher, readers get them empty.
+            OutputWcs(L"\n\nvoid ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"SharedPublish(MkConfGenShared * sharedPtr, const ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr) {");
+            OutputWcs(L"\n    _MKCONFGEN_ASSERT(sharedPtr);");
+            OutputWcs(L"\n    _MKCONFGEN_ASSERT(configPtr);");
+            OutputWcs(L"\n    ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * imagePtr = (");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" *)_MkConfGenSharedBeginWrite(sharedPtr);");
+            OutputWcs(L"\n    memcpy(imagePtr, configPtr, sizeof(");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"));");
+            for (size_t j = 0; j != configPtr->items.count; j++) {
+                Item * itemPtr = &configPtr->items.elems[j];
+                if (itemPtr->isMap) {
+                    OutputWcs(L"\n    memset(&imagePtr->");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L", 0, sizeof(MkConfGenMap));");
+                }
+            }
+            OutputWcs(L"\n    _MkConfGenSharedEndWrite(sharedPtr);");
+            OutputWcs(L"\n}");
 
-                        OutputWcs(L"\n            return true;");
-                        OutputWcs(L"\n        }");
-                        break;
+            OutputWcs(L"\n\nvoid ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"SharedRead(const MkConfGenShared * sharedPtr, ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr) {");
+            OutputWcs(L"\n    _MKCONFGEN_ASSERT(sharedPtr);");
+            OutputWcs(L"\n    _MKCONFGEN_ASSERT(configPtr);");
+            if (mapCount != 0) {
+                OutputWcs(L"\n    ");
+                OutputWstr(&configPtr->name);
+                OutputWcs(L"Free(configPtr);");
+            }
+            OutputWcs(L"\n    uint64_t sequence;");
+            OutputWcs(L"\n    do {");
+            OutputWcs(L"\n        sequence = _MkConfGenSharedBeginRead(sharedPtr);");
+            OutputWcs(L"\n        memcpy(configPtr, sharedPtr->image, sizeof(");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"));");
+            OutputWcs(L"\n    } while (_MkConfGenSharedRetryRead(sharedPtr, sequence));");
+            OutputWcs(L"\n}");
+
+            for (size_t j = 0; j != configPtr->items.count; j++) {
+                Item * itemPtr = &configPtr->items.elems[j];
+                if (!IsSharedItem(itemPtr)) {
+                    continue;
+                }
+
+                OutputSharedGetterHead(configPtr, itemPtr);
+                OutputWcs(L" {");
+                OutputWcs(L"\n    _MKCONFGEN_ASSERT(sharedPtr);");
+                OutputWcs(L"\n    const ");
+                OutputWstr(&configPtr->name);
+                OutputWcs(L" * imagePtr = (const ");
+                OutputWstr(&configPtr->name);
+                OutputWcs(L" *)sharedPtr->image;");
+                OutputWcs(L"\n    ");
+                OutputItemType(itemPtr);
+                OutputWcs(L" value;");
+                OutputWcs(L"\n    uint64_t sequence;");
+                OutputWcs(L"\n    do {");
+                OutputWcs(L"\n        sequence = _MkConfGenSharedBeginRead(sharedPtr);");
+                OutputWcs(L"\n        value = imagePtr->");
+                OutputWstr(&itemPtr->name);
+                OutputWcs(L";");
+                OutputWcs(L"\n    } while (_MkConfGenSharedRetryRead(sharedPtr, sequence));");
+                OutputWcs(L"\n    return value;");
+                OutputWcs(L"\n}");
+            }
+            OutputWcs(L"\n#endif");
+
+            // Replicas copy the entries of the maps along with the config.
+            if (mapCount != 0) {
+                OutputWcs(L"\n\nstatic const size_t _mkConfGen");
+                OutputWstr(&configPtr->name);
+                OutputWcs(L"MapOffsets[] = {");
+                for (size_t j = 0; j != configPtr->items.count; j++) {
+                    Item * itemPtr = &configPtr->items.elems[j];
+                    if (itemPtr->isMap) {
+                        OutputWcs(L"\n    offsetof(");
+                        OutputWstr(&configPtr->name);
+                        OutputWcs(L", ");
+                        OutputWstr(&itemPtr->name);
+                        OutputWcs(L"),");
                     }
+                }
+                OutputWcs(L"\n};");
+            }
 
-                    case ITEM_UINT:
-                    {
-                        OutputWcs(L"\n            if (isStr) {");
-                        OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_TYPE;");
-                        OutputWcs(L"\n                return false;");
-                        OutputWcs(L"\n            }");
-                        OutputWcs(L"\n");
-                        OutputWcs(L"\n            wchar_t * end;");
-                        OutputWcs(L"\n            unsigned long value = wcstoul(rawValue, &end, 0);");
-                        OutputWcs(L"\n            if (end != rawValue + rawValueLength) {");
-                        OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_TYPE;");
-                        OutputWcs(L"\n                return false;");
-                        OutputWcs(L"\n            }");
-                        OutputWcs(L"\n            if (value == ULONG_MAX) {");
-                        OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_OVERFLOW;");
-                        OutputWcs(L"\n                return false;");
-                        OutputWcs(L"\n            }");
+            // The replicas start with the defaults like a new shared mapping.
+            OutputWcs(L"\n\nbool ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"ReplicasCreate(MkConfGenReplicas * replicasPtr) {");
+            OutputWcs(L"\n    ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr = (");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" *)malloc(sizeof(");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"));");
+            OutputWcs(L"\n    if (!configPtr) {");
+            OutputWcs(L"\n        return false;");
+            OutputWcs(L"\n    }");
+            OutputWcs(L"\n    ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Init(configPtr);");
+            OutputWcs(L"\n    bool isCreated = _MkConfGenReplicasCreate(replicasPtr, configPtr, sizeof(");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L")");
+            OutputReplicaMapArgs(configPtr, mapCount);
+            OutputWcs(L");");
+            OutputWcs(L"\n    ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Free(configPtr);");
+            OutputWcs(L"\n    free(configPtr);");
+            OutputWcs(L"\n    return isCreated;");
+            OutputWcs(L"\n}");
 
-                        if (itemPtr->validateCallback.length != 0) {
-                            OutputWcs(L"\n            if (!");
-                            OutputWstr(&itemPtr->validateCallback);
-                            OutputWcs(L"(value)) {");
-                            OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_INVALID;");
-                            OutputWcs(L"\n                return false;");
-                            OutputWcs(L"\n            }");
-                        }
+            OutputWcs(L"\n\nbool ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"ReplicasPublish(MkConfGenReplicas * replicasPtr, const ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr) {");
+            OutputWcs(L"\n    return _MkConfGenReplicasPublish(replicasPtr, configPtr");
+            OutputReplicaMapArgs(configPtr, mapCount);
+            OutputWcs(L");");
+            OutputWcs(L"\n}");
+
+            OutputWcs(L"\n\nconst ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"ReplicaAcquire(const MkConfGenReplicas * replicasPtr, MkConfGenReplicaLease * leasePtr) {");
+            OutputWcs(L"\n    return (const ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" *)_MkConfGenReplicaAcquire(replicasPtr, leasePtr);");
+            OutputWcs(L"\n}");
+
+            // The maps the target held are freed, the copy owns new ones. Maps that could not be copied are left empty.
+            OutputWcs(L"\n\nbool ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"ReplicaRead(const MkConfGenReplicas * replicasPtr, ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr) {");
+            OutputWcs(L"\n    _MKCONFGEN_ASSERT(configPtr);");
+            if (mapCount != 0) {
+                OutputWcs(L"\n    ");
+                OutputWstr(&configPtr->name);
+                OutputWcs(L"Free(configPtr);");
+            }
+            OutputWcs(L"\n    MkConfGenReplicaLease lease;");
+            OutputWcs(L"\n    const ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * imagePtr = ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"ReplicaAcquire(replicasPtr, &lease);");
+            OutputWcs(L"\n    memcpy(configPtr, imagePtr, sizeof(");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"));");
+            OutputWcs(L"\n    bool isRead = true;");
+            for (size_t j = 0; j != configPtr->items.count; j++) {
+                Item * itemPtr = &configPtr->items.elems[j];
+                if (itemPtr->isMap) {
+                    OutputWcs(L"\n    isRead = _MkConfGenMapCopy(&configPtr->");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L", &imagePtr->");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L") && isRead;");
+                }
+            }
+            OutputWcs(L"\n    MkConfGenReplicaRelease(&lease);");
+            OutputWcs(L"\n    return isRead;");
+            OutputWcs(L"\n}");
 
-                        OutputWcs(L"\n            configPtr->");
-                        OutputWstr(&itemPtr->name);
-                        OutputWcs(L" = value;");
+            for (size_t j = 0; j != configPtr->items.count; j++) {
+                Item * itemPtr = &configPtr->items.elems[j];
+                if (!IsSharedItem(itemPtr)) {
+                    continue;
+                }
 
-                        OutputWcs(L"\n            return true;");
-                        OutputWcs(L"\n        }");
-                        break;
-                    }
+                OutputReplicaGetterHead(configPtr, itemPtr);
+                OutputWcs(L" {");
+                OutputWcs(L"\n    MkConfGenReplicaLease lease;");
+                OutputWcs(L"\n    ");
+                OutputItemType(itemPtr);
+                OutputWcs(L" value = ");
+                OutputWstr(&configPtr->name);
+                OutputWcs(L"ReplicaAcquire(replicasPtr, &lease)->");
+                OutputWstr(&itemPtr->name);
+                OutputWcs(L";");
+                OutputWcs(L"\n    MkConfGenReplicaRelease(&lease);");
+                OutputWcs(L"\n    return value;");
+                OutputWcs(L"\n}");
+            }
 
-                    case ITEM_FLOAT:
-                    {
-                        OutputWcs(L"\n            if (isStr) {");
-                        OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_TYPE;");
-                        OutputWcs(L"\n                return false;");
-                        OutputWcs(L"\n            }");
-                        OutputWcs(L"\n            ");
-                        OutputWcs(L"\n            wchar_t * end;");
-                        OutputWcs(L"\n            double value = wcstod(rawValue, &end);");
-                        OutputWcs(L"\n            if (end != rawValue + rawValueLength) {");
-                        OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_TYPE;");
-                        OutputWcs(L"\n                return false;");
-                        OutputWcs(L"\n            }");
-                        OutputWcs(L"\n            if (value == HUGE_VAL || value == -HUGE_VAL) {");
-                        OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_OVERFLOW;");
-                        OutputWcs(L"\n                return false;");
-                        OutputWcs(L"\n            }");
+            // Upper bound of the text length of Write, also used for the values of PatchFile.
+            OutputWcs(L"\n\nstatic size_t _MkConfGen");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"WriteCapacity(const ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr) {");
 
-                        if (itemPtr->validateCallback.length != 0) {
-                            OutputWcs(L"\n            if (!");
-                            OutputWstr(&itemPtr->validateCallback);
-                            OutputWcs(L"(value)) {");
-                            OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_INVALID;");
-                            OutputWcs(L"\n                return false;");
-                            OutputWcs(L"\n            }");
+            size_t fixedLength = 0;
+            size_t numberCount = 0;
+            for (size_t j = 0; j != configPtr->headings.count; j++) {
+                fixedLength += configPtr->headings.elems[j].name.length + 4;
+            }
+            for (size_t j = 0; j != configPtr->items.count; j++) {
+                Item * itemPtr = &configPtr->items.elems[j];
+                if (itemPtr->table != SIZE_MAX || itemPtr->isMap) {
+                    continue;
+                }
+                fixedLength += itemPtr->name.length + 6;
+                if (itemPtr->type == ITEM_ENUM) {
+                    for (size_t k = 0; k != itemPtr->values.count; k++) {
+                        fixedLength += itemPtr->values.elems[k].length;
+                    }
+                } else if (itemPtr->type != ITEM_WSTR && !IsArray(itemPtr->type)) {
+                    numberCount++;
+                }
+            }
+            wchar_t lengthBuffer[128];
+            swprintf_s(lengthBuffer, 128, L"\n    return %zu + %zu * _MKCONFGEN_MAX_NUMBER_LENGTH", fixedLength, numberCount);
+            OutputWcs(lengthBuffer);
+            for (size_t j = 0; j != configPtr->items.count; j++) {
+                Item * itemPtr = &configPtr->items.elems[j];
+                if (itemPtr->isMap) {
+                    swprintf_s(lengthBuffer, 128, L" * (%zu + _MKCONFGEN_MAX_NUMBER_LENGTH)", itemPtr->name.length + 5);
+                    OutputWcs(L"\n        + configPtr->");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L".keyArenaLength + configPtr->");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L".count");
+                    OutputWcs(lengthBuffer);
+                } else if (itemPtr->type == ITEM_WSTR && itemPtr->table == SIZE_MAX) {
+                    OutputWcs(L"\n        + 2 * sizeof configPtr->");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L" / sizeof(wchar_t)");
+                } else if (IsArray(itemPtr->type)) {
+                    OutputWcs(L"\n        + sizeof configPtr->");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L" / sizeof configPtr->");
+                    OutputWstr(&itemPtr->name);
+                    if (itemPtr->type == ITEM_STR_ARRAY) {
+                        OutputWcs(L"[0] * (2 * sizeof configPtr->");
+                        OutputWstr(&itemPtr->name);
+                        OutputWcs(L"[0] / sizeof(wchar_t) + 4)");
+                    } else {
+                        OutputWcs(L"[0] * (_MKCONFGEN_MAX_NUMBER_LENGTH + 2)");
+                    }
+                }
+            }
+            for (size_t t = 0; t != configPtr->tables.count; t++) {
+                Table * tablePtr = &configPtr->tables.elems[t];
+                size_t rowLength = 0;
+                size_t rowNumberCount = 0;
+                for (size_t j = tablePtr->firstItem; j != tablePtr->firstItem + tablePtr->itemCount; j++) {
+                    Item * itemPtr = &configPtr->items.elems[j];
+                    rowLength += tablePtr->name.length + itemPtr->name.length + 27;
+                    if (itemPtr->type == ITEM_ENUM) {
+                        for (size_t k = 0; k != itemPtr->values.count; k++) {
+                            rowLength += itemPtr->values.elems[k].length;
                         }
-
-                        OutputWcs(L"\n            configPtr->");
+                    } else if (itemPtr->type != ITEM_WSTR) {
+                        rowNumberCount++;
+                    }
+                }
+                OutputWcs(L"\n        + configPtr->");
+                OutputWstr(&tablePtr->name);
+                swprintf_s(lengthBuffer, 128, L"Count * (%zu + %zu * _MKCONFGEN_MAX_NUMBER_LENGTH", rowLength, rowNumberCount);
+                OutputWcs(lengthBuffer);
+                for (size_t j = tablePtr->firstItem; j != tablePtr->firstItem + tablePtr->itemCount; j++) {
+                    Item * itemPtr = &configPtr->items.elems[j];
+                    if (itemPtr->type == ITEM_WSTR) {
+                        OutputWcs(L" + 2 * sizeof configPtr->");
+                        OutputWstr(&tablePtr->name);
+                        OutputWcs(L".");
                         OutputWstr(&itemPtr->name);
-                        OutputWcs(L" = value;");
-
-                        OutputWcs(L"\n            return true;");
-                        OutputWcs(L"\n        }");
-                        break;
+                        OutputWcs(L"[0] / sizeof(wchar_t)");
                     }
+                }
+                OutputWcs(L")");
+            }
+            OutputWcs(L";");
+            OutputWcs(L"\n}");
 
-                    case ITEM_WSTR:
-                    {
-                        OutputWcs(L"\n            if (!isStr) {");
-                        OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_TYPE;");
-                        OutputWcs(L"\n                return false;");
-                        OutputWcs(L"\n            }");
+            // The text is written into one buffer sized for the longest possible output and handed over at once.
+            OutputWcs(L"\n\nbool ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Write(const ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr, bool isMinimal, MkConfGenWriteCallback writeCallback, void * context) {");
+            OutputWcs(L"\n    _MKCONFGEN_ASSERT(configPtr);");
+            OutputWcs(L"\n    _MKCONFGEN_ASSERT(writeCallback);");
+            OutputWcs(L"\n    size_t capacity = _MkConfGen");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"WriteCapacity(configPtr);");
+            OutputWcs(L"\n    wchar_t * buffer = (wchar_t *)malloc(capacity * sizeof(wchar_t));");
+            OutputWcs(L"\n    if (!buffer) {");
+            OutputWcs(L"\n        return false;");
+            OutputWcs(L"\n    }");
+            OutputWcs(L"\n    wchar_t * pos = buffer;");
+            OutputWcs(L"\n    bool isWritable = true;");
 
-                        OutputWcs(L"\n            if (rawValueLength >= ");
-                        OutputWstr(&itemPtr->length);
-                        OutputWcs(L") { ");
+            size_t nextHeading = 0;
+            for (size_t j = 0; j != configPtr->items.count; j++) {
+                Item * itemPtr = &configPtr->items.elems[j];
+                while (nextHeading != configPtr->headings.count && configPtr->headings.elems[nextHeading].index == j) {
+                    Heading * headingPtr = &configPtr->headings.elems[nextHeading++];
+                    OutputWcs(j == 0 ? L"\n\n    pos = _MkConfGenWriteWcs(pos, L\"[" : L"\n\n    pos = _MkConfGenWriteWcs(pos, L\"\\n[");
+                    OutputWstr(&headingPtr->name);
+                    swprintf_s(lengthBuffer, 128, L"]\\n\", %zu);", headingPtr->name.length + (j == 0 ? 3 : 4));
+                    OutputWcs(lengthBuffer);
+                }
 
-                        OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_OVERFLOW;");
-                        OutputWcs(L"\n                return false;");
-                        OutputWcs(L"\n            }");
+                // Tables and maps are empty by default, so whatever they hold is written in either mode.
+                if (itemPtr->table != SIZE_MAX) {
+                    Table * tablePtr = &configPtr->tables.elems[itemPtr->table];
+                    if (tablePtr->firstItem != j) {
+                        continue;
+                    }
+                    OutputWcs(L"\n    for (size_t row = 0; row != configPtr->");
+                    OutputWstr(&tablePtr->name);
+                    OutputWcs(L"Count; row++) {");
+                    for (size_t k = j; k != j + tablePtr->itemCount; k++) {
+                        Item * columnPtr = &configPtr->items.elems[k];
+                        swprintf_s(lengthBuffer, 128, L"[\", %zu);", tablePtr->name.length + 1);
+                        OutputWcs(L"\n        pos = _MkConfGenWriteWcs(pos, L\"");
+                        OutputWstr(&tablePtr->name);
+                        OutputWcs(lengthBuffer);
+                        OutputWcs(L"\n        pos = _MkConfGenWriteUint(pos, row);");
+                        OutputWcs(L"\n        pos = _MkConfGenWriteWcs(pos, L\"].");
+                        OutputWstr(&columnPtr->name);
+                        swprintf_s(lengthBuffer, 128, L" = \", %zu);", columnPtr->name.length + 5);
+                        OutputWcs(lengthBuffer);
+                        OutputWriteItemValue(configPtr, columnPtr, L"\n        ");
+                        OutputWcs(L"\n        *pos++ = L'\\n';");
+                    }
+                    OutputWcs(L"\n    }");
+                    continue;
+                }
+
+                if (itemPtr->isMap) {
+                    OutputWcs(L"\n    for (size_t k = 0; k != configPtr->");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L".count; k++) {");
+                    OutputWcs(L"\n        size_t keyLength;");
+                    OutputWcs(L"\n        const wchar_t * key = MkConfGenMapKey(&configPtr->");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L", k, &keyLength);");
+                    OutputWcs(L"\n        pos = _MkConfGenWriteWcs(pos, L\"");
+                    OutputWstr(&itemPtr->name);
+                    swprintf_s(lengthBuffer, 128, L".\", %zu);", itemPtr->name.length + 1);
+                    OutputWcs(lengthBuffer);
+                    OutputWcs(L"\n        pos = _MkConfGenWriteWcs(pos, key, keyLength);");
+                    OutputWcs(L"\n        pos = _MkConfGenWriteWcs(pos, L\" = \", 3);");
+                    OutputWcs(L"\n        pos = ");
+                    OutputWcs(ItemWriterName(itemPtr->type));
+                    OutputWcs(L"(pos, *(const ");
+                    OutputWcs(ItemTypeName(itemPtr->type));
+                    OutputWcs(L" *)MkConfGenMapValue(&configPtr->");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L", k));");
+                    OutputWcs(L"\n        *pos++ = L'\\n';");
+                    OutputWcs(L"\n    }");
+                    continue;
+                }
 
-                        OutputWcs(L"\n            wcscpy_s(configPtr->");
+                OutputWcs(L"\n    if (!isMinimal || ");
+                if (itemPtr->type == ITEM_WSTR) {
+                    OutputWcs(L"wcscmp(configPtr->");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L", ");
+                    OutputDefaultName(configPtr, itemPtr);
+                    OutputWcs(L") != 0");
+                } else if (IsArray(itemPtr->type)) {
+                    OutputWcs(L"configPtr->");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L"Count != ");
+                    OutputDefaultName(configPtr, itemPtr);
+                    OutputWcs(L"Count || ");
+                    if (itemPtr->type == ITEM_STR_ARRAY) {
+                        OutputWcs(L"!_MkConfGenAreWstrArraysEqual(configPtr->");
+                        OutputWstr(&itemPtr->name);
+                        OutputWcs(L"[0], ");
+                        OutputDefaultName(configPtr, itemPtr);
+                        OutputWcs(L"[0], configPtr->");
+                        OutputWstr(&itemPtr->name);
+                        OutputWcs(L"Count, sizeof configPtr->");
+                        OutputWstr(&itemPtr->name);
+                        OutputWcs(L"[0] / sizeof(wchar_t))");
+                    } else {
+                        OutputWcs(L"memcmp(configPtr->");
                         OutputWstr(&itemPtr->name);
                         OutputWcs(L", ");
-                        OutputWstr(&itemPtr->length);
-                        OutputWcs(L", rawValue);");
-
-                        OutputWcs(L"\n            return true;");
-                        OutputWcs(L"\n        }");
-                        break;
+                        OutputDefaultName(configPtr, itemPtr);
+                        OutputWcs(L", configPtr->");
+                        OutputWstr(&itemPtr->name);
+                        OutputWcs(L"Count * sizeof configPtr->");
+                        OutputWstr(&itemPtr->name);
+                        OutputWcs(L"[0]) != 0");
                     }
+                } else {
+                    OutputWcs(L"configPtr->");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L" != ");
+                    OutputDefaultName(configPtr, itemPtr);
                 }
+                OutputWcs(L") {");
+                OutputWcs(L"\n        pos = _MkConfGenWriteWcs(pos, L\"");
+                OutputWstr(&itemPtr->name);
+                swprintf_s(lengthBuffer, 128, L" = \", %zu);", itemPtr->name.length + 3);
+                OutputWcs(lengthBuffer);
+                OutputWriteItemValue(configPtr, itemPtr, L"\n        ");
+                OutputWcs(L"\n        *pos++ = L'\\n';");
+                OutputWcs(L"\n    }");
             }
 
-            OutputWcs(L"\n");
-            OutputWcs(L"\n        default:");
-            OutputWcs(L"\n        {");
-            OutputWcs(L"\n            *errorType = MKCONFGEN_LOAD_ERROR_UNDEFINED;");
-            OutputWcs(L"\n            return false;");
+            OutputWcs(L"\n\n    _MKCONFGEN_ASSERT((size_t)(pos - buffer) <= capacity);");
+            OutputWcs(L"\n    bool isWritten = isWritable && writeCallback(context, buffer, pos - buffer);");
+            OutputWcs(L"\n    free(buffer);");
+            OutputWcs(L"\n    return isWritten;");
+            OutputWcs(L"\n}");
+
+            // Only the values are formatted here, every table row and map entry is a patch of its own.
+            OutputWcs(L"\n\n#ifdef _WIN32");
+            OutputWcs(L"\nbool ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"PatchFile(const wchar_t * path, const ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr, const size_t * items, size_t itemCount) {");
+            OutputWcs(L"\n    _MKCONFGEN_ASSERT(path);");
+            OutputWcs(L"\n    _MKCONFGEN_ASSERT(configPtr);");
+            OutputWcs(L"\n    _MKCONFGEN_ASSERT(items || itemCount == 0);");
+            swprintf_s(lengthBuffer, 128, L"\n    bool isListed[%zu] = {};", configPtr->items.count);
+            OutputWcs(lengthBuffer);
+            OutputWcs(L"\n    size_t patchCount = 0;");
+            OutputWcs(L"\n    for (size_t i = 0; i != itemCount; i++) {");
+            swprintf_s(lengthBuffer, 128, L"\n        _MKCONFGEN_ASSERT(items[i] < %zu);", configPtr->items.count);
+            OutputWcs(lengthBuffer);
+            OutputWcs(L"\n        if (isListed[items[i]]) {");
+            OutputWcs(L"\n            continue;");
+            OutputWcs(L"\n        }");
+            OutputWcs(L"\n        isListed[items[i]] = true;");
+            OutputWcs(L"\n        switch (items[i]) {");
+            for (size_t j = 0; j != configPtr->items.count; j++) {
+                Item * itemPtr = &configPtr->items.elems[j];
+                if (itemPtr->isMap) {
+                    swprintf_s(lengthBuffer, 128, L"\n            case %zu: patchCount += configPtr->", j);
+                    OutputWcs(lengthBuffer);
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L".count; break;");
+                } else if (itemPtr->table != SIZE_MAX) {
+                    swprintf_s(lengthBuffer, 128, L"\n            case %zu:", j);
+                    OutputWcs(lengthBuffer);
+                    Table * tablePtr = &configPtr->tables.elems[itemPtr->table];
+                    if (j == tablePtr->firstItem + tablePtr->itemCount - 1) {
+                        OutputWcs(L" patchCount += configPtr->");
+                        OutputWstr(&tablePtr->name);
+                        OutputWcs(L"Count; break;");
+                    }
+                }
+            }
+            OutputWcs(L"\n            default: patchCount++; break;");
             OutputWcs(L"\n        }");
+            OutputWcs(L"\n    }");
+            OutputWcs(L"\n    size_t capacity = _MkConfGen");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"WriteCapacity(configPtr);");
+            OutputWcs(L"\n    _MkConfGenPatch * patches = (_MkConfGenPatch *)malloc(patchCount * sizeof(_MkConfGenPatch) + capacity * sizeof(wchar_t));");
+            OutputWcs(L"\n    if (!patches) {");
+            OutputWcs(L"\n        return false;");
+            OutputWcs(L"\n    }");
+            OutputWcs(L"\n    wchar_t * text = (wchar_t *)(patches + patchCount);");
+            OutputWcs(L"\n    wchar_t * pos = text;");
+            OutputWcs(L"\n    _MkConfGenPatch * patchPtr = patches;");
+            OutputWcs(L"\n    bool isWritable = true;");
+            swprintf_s(lengthBuffer, 128, L"\n    for (size_t index = 0; index != %zu; index++) {", configPtr->items.count);
+            OutputWcs(lengthBuffer);
+            OutputWcs(L"\n        if (!isListed[index]) {");
+            OutputWcs(L"\n            continue;");
+            OutputWcs(L"\n        }");
+            OutputWcs(L"\n        switch (index) {");
+            size_t heading = SIZE_MAX;
+            for (size_t j = 0; j != configPtr->items.count; j++) {
+                Item * itemPtr = &configPtr->items.elems[j];
+                while (heading + 1 != configPtr->headings.count && configPtr->headings.elems[heading + 1].index <= j) {
+                    heading++;
+                }
+                wchar_t headingBuffer[32];
+                if (heading == SIZE_MAX) {
+                    wcscpy_s(headingBuffer, 32, L"SIZE_MAX");
+                } else {
+                    swprintf_s(headingBuffer, 32, L"%zu", heading);
+                }
 
+                swprintf_s(lengthBuffer, 128, L"\n            case %zu:", j);
+                OutputWcs(lengthBuffer);
+                if (itemPtr->isMap) {
+                    OutputWcs(L"\n                for (size_t k = 0; k != configPtr->");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L".count; k++) {");
+                    OutputWcs(L"\n                    size_t keyLength;");
+                    OutputWcs(L"\n                    const wchar_t * key = MkConfGenMapKey(&configPtr->");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L", k, &keyLength);");
+                    swprintf_s(lengthBuffer, 128, L"\n                    *patchPtr++ = { %zu, SIZE_MAX, ", j);
+                    OutputWcs(lengthBuffer);
+                    OutputWcs(L"key, keyLength, ");
+                    OutputWcs(headingBuffer);
+                    OutputWcs(L", (size_t)(pos - text), 0, 0, 0 };");
+                    OutputWcs(L"\n                    pos = ");
+                    OutputWcs(ItemWriterName(itemPtr->type));
+                    OutputWcs(L"(pos, *(const ");
+                    OutputWcs(ItemTypeName(itemPtr->type));
+                    OutputWcs(L" *)MkConfGenMapValue(&configPtr->");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L", k));");
+                    OutputWcs(L"\n                }");
+                } else if (itemPtr->table != SIZE_MAX) {
+                    OutputWcs(L"\n                for (size_t row = 0; row != configPtr->");
+                    OutputWstr(&configPtr->tables.elems[itemPtr->table].name);
+                    OutputWcs(L"Count; row++) {");
+                    swprintf_s(lengthBuffer, 128, L"\n                    *patchPtr++ = { %zu, row, NULL, 0, ", j);
+                    OutputWcs(lengthBuffer);
+                    OutputWcs(headingBuffer);
+                    OutputWcs(L", (size_t)(pos - text), 0, 0, 0 };");
+                    OutputWriteItemValue(configPtr, itemPtr, L"\n                    ");
+                    OutputWcs(L"\n                }");
+                } else {
+                    swprintf_s(lengthBuffer, 128, L"\n                *patchPtr++ = { %zu, SIZE_MAX, NULL, 0, ", j);
+                    OutputWcs(lengthBuffer);
+                    OutputWcs(headingBuffer);
+                    OutputWcs(L", (size_t)(pos - text), 0, 0, 0 };");
+                    OutputWriteItemValue(configPtr, itemPtr, L"\n                ");
+                }
+                OutputWcs(L"\n                break;");
+            }
+            OutputWcs(L"\n        }");
             OutputWcs(L"\n    }");
+            OutputWcs(L"\n    _MKCONFGEN_ASSERT((size_t)(pos - text) <= capacity);");
+            swprintf_s(lengthBuffer, 128, L"%zu, _mkConfGen", configPtr->items.count);
+            OutputWcs(L"\n    const _MkConfGenSection section = { NULL, ");
+            OutputWcs(lengthBuffer);
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Indices, _mkConfGen");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"Keys, ");
+            OutputHeadingArgs(configPtr);
+            OutputWcs(L", UINT64_MAX, NULL, NULL, true, NULL };");
+            OutputWcs(L"\n    bool isPatched = isWritable && _MkConfGenPatchFile(path, &section, patches, patchPtr - patches, text, pos - text);");
+            OutputWcs(L"\n    free(patches);");
+            OutputWcs(L"\n    return isPatched;");
             OutputWcs(L"\n}");
+            OutputWcs(L"\n#endif");
 
-            OutputWcs(L"\n\nbool ");
+            OutputWcs(L"\n\nsize_t ");
             OutputWstr(&configPtr->name);
-            OutputWcs(L"Load(");
+            OutputWcs(L"FindItem(const wchar_t * name, size_t nameLength) {");
+            OutputWcs(L"\n    return _MkConfGenFindItem(&_mkConfGen");
             OutputWstr(&configPtr->name);
-            OutputWcs(L" * configPtr, const wchar_t * configWcs, size_t configLength, MkConfGenLoadError ** errors, size_t * errorCount) {");
-            OutputWcs(L"\n    return _MkConfGenLoad(");
-            OutputWcs(L"\n        configWcs,");
-            OutputWcs(L"\n        configLength,");
-
-            wchar_t tmpBuffer[32];
-            swprintf_s(tmpBuffer, 32, L"\n        %zu,", configPtr->items.count);
-            OutputWcs(tmpBuffer);
-
-            OutputWcs(L"\n        _mkConfGen");
+            OutputWcs(L"ItemHash, ");
             OutputWstr(&configPtr->name);
-            OutputWcs(L"Indices,");
+            OutputWcs(L"ItemInfos, name, nameLength);");
+            OutputWcs(L"\n}");
 
-            OutputWcs(L"\n        _mkConfGen");
+            OutputWcs(L"\n\nbool ");
             OutputWstr(&configPtr->name);
-            OutputWcs(L"Keys,");
-
-            OutputWcs(L"\n        _MkConfGen");
+            OutputWcs(L"GetByIndex(const ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr, size_t index, size_t row, MkConfGenValue * value) {");
+            OutputWcs(L"\n    _MKCONFGEN_ASSERT(configPtr);");
+            OutputWcs(L"\n    _MKCONFGEN_ASSERT(value);");
+            swprintf_s(lengthBuffer, 128, L"\n    if (index >= %zu || ", configPtr->items.count);
+            OutputWcs(lengthBuffer);
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"ItemInfos[index].isTableColumn != (row != SIZE_MAX)) {");
+            OutputWcs(L"\n        return false;");
+            OutputWcs(L"\n    }");
+            OutputWcs(L"\n    value->type = ");
             OutputWstr(&configPtr->name);
-            OutputWcs(L"ParseValue,");
+            OutputWcs(L"ItemInfos[index].type;");
+            OutputWcs(L"\n    value->count = 0;");
+            OutputWcs(L"\n    switch (index) {");
+            for (size_t j = 0; j != configPtr->items.count; j++) {
+                Item * itemPtr = &configPtr->items.elems[j];
+                swprintf_s(lengthBuffer, 128, L"\n        case %zu:", j);
+                OutputWcs(lengthBuffer);
+                if (itemPtr->table != SIZE_MAX) {
+                    OutputWcs(L"\n            if (row >= configPtr->");
+                    OutputWstr(&configPtr->tables.elems[itemPtr->table].name);
+                    OutputWcs(L"Count) {");
+                    OutputWcs(L"\n                return false;");
+                    OutputWcs(L"\n            }");
+                }
+                if (itemPtr->isMap) {
+                    OutputWcs(L"\n            value->map = &configPtr->");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L";");
+                } else if (IsArray(itemPtr->type)) {
+                    OutputWcs(L"\n            value->elems = ");
+                    OutputItemRef(configPtr, itemPtr);
+                    OutputWcs(L";");
+                    OutputWcs(L"\n            value->count = ");
+                    OutputItemRef(configPtr, itemPtr);
+                    OutputWcs(L"Count;");
+                } else {
+                    switch (itemPtr->type) {
+                        case ITEM_FLOAT: OutputWcs(L"\n            value->f = "); break;
+                        case ITEM_BOOL: OutputWcs(L"\n            value->b = "); break;
+                        case ITEM_WSTR: OutputWcs(L"\n            value->wcs = "); break;
+                        case ITEM_ENUM: OutputWcs(L"\n            value->u = (uint64_t)"); break;
+                        default: OutputWcs(IsSignedType(itemPtr->type) ? L"\n            value->i = " : L"\n            value->u = "); break;
+                    }
+                    OutputItemRef(configPtr, itemPtr);
+                    OutputWcs(L";");
+                }
+                OutputWcs(L"\n            return true;");
+            }
+            OutputWcs(L"\n        default:");
+            OutputWcs(L"\n            return false;");
+            OutputWcs(L"\n    }");
+            OutputWcs(L"\n}");
 
+            // Rejected lists must not reset an array here, so they are parsed into a copy that replaces the array
+            // only once it is valid. Everything else is set by ParseValue as when loading.
+            size_t arrayCount = 0;
+            for (size_t j = 0; j != configPtr->items.count; j++) {
+                arrayCount += IsArray(configPtr->items.elems[j].type);
+            }
+            if (arrayCount != 0) {
+                OutputWcs(L"\n\nstatic bool _MkConfGen");
+                OutputWstr(&configPtr->name);
+                OutputWcs(L"SetValue(");
+                OutputWcs(L"\n    void * config,");
+                OutputWcs(L"\n    size_t index,");
+                OutputWcs(L"\n    size_t row,");
+                OutputWcs(L"\n    const wchar_t * mapKey,");
+                OutputWcs(L"\n    size_t mapKeyLength,");
+                OutputWcs(L"\n    wchar_t * rawValue,");
+                OutputWcs(L"\n    size_t rawValueLength,");
+                OutputWcs(L"\n    bool isStr,");
+                OutputWcs(L"\n    MkConfGenLoadErrorType * errorType)");
+                OutputWcs(L"\n{");
+                OutputWcs(L"\n    ");
+                OutputWstr(&configPtr->name);
+                OutputWcs(L" * configPtr = (");
+                OutputWstr(&configPtr->name);
+                OutputWcs(L" *)config;");
+                OutputWcs(L"\n    switch (index) {");
+                for (size_t j = 0; j != configPtr->items.count; j++) {
+                    Item * itemPtr = &configPtr->items.elems[j];
+                    if (!IsArray(itemPtr->type)) {
+                        continue;
+                    }
+                    swprintf_s(lengthBuffer, 128, L"\n        case %zu:", j);
+                    OutputWcs(lengthBuffer);
+                    OutputWcs(L"\n        {");
+                    OutputWcs(L"\n            if (isStr) {");
+                    OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_VALUE_TYPE;");
+                    OutputWcs(L"\n                return false;");
+                    OutputWcs(L"\n            }");
+                    OutputWcs(L"\n            auto * values = (decltype(configPtr->");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L") *)malloc(sizeof configPtr->");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L");");
+                    OutputWcs(L"\n            if (!values) {");
+                    OutputWcs(L"\n                *errorType = MKCONFGEN_LOAD_ERROR_MEMORY;");
+                    OutputWcs(L"\n                return false;");
+                    OutputWcs(L"\n            }");
+                    OutputWcs(L"\n            size_t count;");
+                    OutputParseArray(itemPtr, true);
+                    OutputWcs(L"\n            if (isValid) {");
+                    OutputWcs(L"\n                memcpy(configPtr->");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L", *values, count * sizeof (*values)[0]);");
+                    OutputWcs(L"\n                configPtr->");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L"Count = count;");
+                    OutputWcs(L"\n            }");
+                    OutputWcs(L"\n            free(values);");
+                    OutputWcs(L"\n            return isValid;");
+                    OutputWcs(L"\n        }");
+                }
+                OutputWcs(L"\n        default:");
+                OutputWcs(L"\n            return _MkConfGen");
+                OutputWstr(&configPtr->name);
+                OutputWcs(L"ParseValue(config, index, row, mapKey, mapKeyLength, rawValue, rawValueLength, isStr, errorType);");
+                OutputWcs(L"\n    }");
+                OutputWcs(L"\n}");
+            }
 
-            OutputWcs(L"\n        configPtr,");
-            OutputWcs(L"\n        errors,");
-            OutputWcs(L"\n        errorCount);");
+            // New map entries need room, Load sizes maps up front.
+            OutputWcs(L"\n\nbool ");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L"SetFromText(");
+            OutputWstr(&configPtr->name);
+            OutputWcs(L" * configPtr, size_t index, size_t row, const wchar_t * mapKey, size_t mapKeyLength, const wchar_t * text, size_t textLength, MkConfGenLoadErrorType * errorType) {");
+            OutputWcs(L"\n    _MKCONFGEN_ASSERT(configPtr);");
+            if (mapCount != 0) {
+                OutputWcs(L"\n    bool isReserved = true;");
+                OutputWcs(L"\n    switch (mapKey ? index : SIZE_MAX) {");
+                for (size_t j = 0; j != configPtr->items.count; j++) {
+                    Item * itemPtr = &configPtr->items.elems[j];
+                    if (!itemPtr->isMap) {
+                        continue;
+                    }
+                    swprintf_s(lengthBuffer, 128, L"\n        case %zu:", j);
+                    OutputWcs(lengthBuffer);
+                    OutputWcs(L"\n            if (!MkConfGenMapFind(&configPtr->");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L", mapKey, mapKeyLength)) {");
+                    OutputWcs(L"\n                isReserved = _MkConfGenMapReserve(&configPtr->");
+                    OutputWstr(&itemPtr->name);
+                    OutputWcs(L", 1, mapKeyLength, sizeof(");
+                    OutputWcs(ItemTypeName(itemPtr->type));
+                    OutputWcs(L"));");
+                    OutputWcs(L"\n            }");
+                    OutputWcs(L"\n            break;");
+                }
+                OutputWcs(L"\n    }");
+                OutputWcs(L"\n    if (!isReserved) {");
+                OutputWcs(L"\n        *errorType = MKCONFGEN_LOAD_ERROR_MEMORY;");
+                OutputWcs(L"\n        return false;");
+                OutputWcs(L"\n    }");
+            }
+            OutputWcs(L"\n    return _MkConfGenSetFromText(_MkConfGen");
+            OutputWstr(&configPtr->name);
+            OutputWcs(arrayCount != 0 ? L"SetValue" : L"ParseValue");
+            OutputWcs(L", configPtr, index, row, mapKey, mapKeyLength, text, textLength, errorType);");
+            OutputWcs(L"\n}");
+        }
 
+        // LoadAll needs every config and stays in the shared file.
+        if (part == 0) {
+            OutputLoadAllHead();
+            OutputWcs(L" {");
+            for (size_t i = 0; i != configs.count; i++) {
+                Config * configPtr = &configs.elems[i];
+                if (CountMaps(configPtr) != 0) {
+                    OutputWcs(L"\n    if (!_MkConfGen");
+                    OutputWstr(&configPtr->name);
+                    OutputWcs(L"ReserveMaps(");
+                    OutputConfigParamName(configPtr);
+                    OutputWcs(L", configWcs, configLength)) {");
+                    OutputWcs(L"\n        *errors = NULL;");
+                    OutputWcs(L"\n        *errorCount = 0;");
+                    OutputWcs(L"\n        return false;");
+                    OutputWcs(L"\n    }");
+                }
+            }
+            OutputWcs(L"\n    const _MkConfGenSection sections[] = {");
+            for (size_t i = 0; i != configs.count; i++) {
+                Config * configPtr = &configs.elems[i];
+                wchar_t tmpBuffer[32];
+                swprintf_s(tmpBuffer, 32, L"\", %zu, _mkConfGen", configPtr->items.count);
+                OutputWcs(L"\n        { L\"");
+                OutputWstr(&configPtr->name);
+                OutputWcs(tmpBuffer);
+                OutputWstr(&configPtr->name);
+                OutputWcs(L"Indices, _mkConfGen");
+                OutputWstr(&configPtr->name);
+                OutputWcs(L"Keys, ");
+                OutputHeadingArgs(configPtr);
+                OutputWcs(L", UINT64_MAX, _MkConfGen");
+                OutputWstr(&configPtr->name);
+                OutputWcs(L"ParseValue, ");
+                OutputConfigParamName(configPtr);
+                OutputWcs(L", false, ");
+                OutputPrepareArg(configPtr);
+                OutputWcs(L" },");
+            }
+            OutputWcs(L"\n    };");
+            wchar_t tmpBuffer[32];
+            swprintf_s(tmpBuffer, 32, L"%zu, sections, ", configs.count);
+            OutputWcs(L"\n    return _MkConfGenLoadSections(configWcs, configLength, ");
+            OutputWcs(tmpBuffer);
+            OutputWcs(L"errors, errorCount);");
             OutputWcs(L"\n}");
         }
 
-        CloseHandle(file);
+        rc = WriteOutputFile(implFilePath, &output);
+        free(output.elems);
+        if (rc != 0) return rc;
     }
 
     for (size_t i = 0; i != configs.count; i++) {
         Config * configPtr = &configs.elems[i];
 
         wchar_t filePath[MAX_PATH];
-        wcsncpy_s(filePath, MAX_PATH, args[1], fileName - args[1]);
+        wcsncpy_s(filePath, MAX_PATH, definitionPath, fileName - definitionPath);
         wcsncat_s(filePath, MAX_PATH, configPtr->name.wcs, configPtr->name.length);
         wcscat_s(filePath, MAX_PATH, L"_example.cfg");
 
-        HANDLE file = CreateFileW(
-            filePath,
-            GENERIC_WRITE,
-            0,
-            NULL,
-            CREATE_ALWAYS,
-            FILE_ATTRIBUTE_NORMAL,
-            NULL);
-        if (file == INVALID_HANDLE_VALUE) {
-            return 4;
+        MkDynArray<char> output;
+        output.Init(4096);
+        if (!output.elems) {
+            return 2;
         }
+        void * file = &output;
 
         size_t headingIndex = 0;
         Heading * headingPtr;
         if (headingIndex != configPtr->headings.count) {
             headingPtr = &configPtr->headings.elems[headingIndex];
             if (headingPtr->index == 0) {
-                OutputWcs(L"# ");
+                OutputWcs(L"[");
                 OutputWstr(&headingPtr->name);
+                OutputWcs(L"]");
 
                 if (++headingIndex != configPtr->headings.count) {
                     headingPtr = &configPtr->headings.elems[headingIndex];
@@ -1392,8 +7834,9 @@ int wmain(int argCount, wchar_t ** args) {
 
         for (size_t j = 0; j != configPtr->items.count; j++) {
             if (headingPtr != NULL && headingPtr->index == j) {
-                OutputWcs(L"\n\n# ");
+                OutputWcs(L"\n\n[");
                 OutputWstr(&headingPtr->name);
+                OutputWcs(L"]");
 
                 if (++headingIndex != configPtr->headings.count) {
                     headingPtr = &configPtr->headings.elems[headingIndex];
@@ -1404,8 +7847,51 @@ int wmain(int argCount, wchar_t ** args) {
 
             Item * itemPtr = &configPtr->items.elems[j];
             OutputWcs(L"\n");
+
+            // Maps start out empty, so only a commented-out entry is shown.
+            if (itemPtr->isMap) {
+                OutputWcs(L"# ");
+                OutputWstr(&itemPtr->name);
+                if (itemPtr->type == ITEM_BOOL) {
+                    OutputWcs(L".<key> = false");
+                } else {
+                    const MkWstr * valuePtr = MapExampleValue(itemPtr);
+                    OutputWcs(L".<key> = ");
+                    if (valuePtr) {
+                        OutputWstr(valuePtr);
+                    } else {
+                        OutputWcs(L"0");
+                    }
+                }
+                continue;
+            }
+
+            // Tables have no rows by default, so only a commented-out first row is shown.
+            if (itemPtr->table != SIZE_MAX) {
+                OutputWcs(L"# ");
+                OutputWstr(&configPtr->tables.elems[itemPtr->table].name);
+                OutputWcs(L"[0].");
+            }
+
             OutputWstr(&itemPtr->name);
             OutputWcs(L" = ");
+            if (IsArray(itemPtr->type)) {
+                OutputWcs(L"[");
+                for (size_t k = 0; k != itemPtr->values.count; k++) {
+                    if (k != 0) {
+                        OutputWcs(L", ");
+                    }
+                    if (itemPtr->type == ITEM_STR_ARRAY) {
+                        OutputWcs(L"\"");
+                    }
+                    OutputWstr(&itemPtr->values.elems[k]);
+                    if (itemPtr->type == ITEM_STR_ARRAY) {
+                        OutputWcs(L"\"");
+                    }
+                }
+                OutputWcs(L"]");
+                continue;
+            }
             if (itemPtr->type == ITEM_WSTR) {
                 OutputWcs(L"\"");
             }
@@ -1415,7 +7901,22 @@ int wmain(int argCount, wchar_t ** args) {
             }
         }
 
-        CloseHandle(file);
+        rc = WriteOutputFile(filePath, &output);
+        free(output.elems);
+        if (rc != 0) return rc;
+    }
+
+    if (benchItemCount != 0) {
+        LARGE_INTEGER outputEndTime;
+        LARGE_INTEGER frequency;
+        QueryPerformanceCounter(&outputEndTime);
+        QueryPerformanceFrequency(&frequency);
+        wprintf(
+            L"items: %zu, input: %zu chars, parse: %.1f ms, output: %.1f ms\n",
+            benchItemCount,
+            inputWcsList.count,
+            (parseEndTime.QuadPart - parseBeginTime.QuadPart) * 1000.0 / frequency.QuadPart,
+            (outputEndTime.QuadPart - parseEndTime.QuadPart) * 1000.0 / frequency.QuadPart);
     }
 
     return 0;
@@ -1,10 +1,6 @@
 #include "Import/MkConfGen.h"
 
-static bool ValidateFontSize(int value) {
-    return value > 0;
-}
-
-static bool ValidateColor(unsigned long value) {
+inline bool ValidateColor(unsigned long value) {
     return value <= 0xffffff;
 }
 
@@ -15,11 +11,24 @@ MKCONFGEN_DEF_BEGIN(Config)
 MKCONFGEN_HEADING(General)
 MKCONFGEN_ITEM_WSTR(fontName, 32, L"Consolas")
 MKCONFGEN_ITEM_INT(fontSize, 10)
-MKCONFGEN_ITEM_UINT(tabWidth, 4)
-MKCONFGEN_ITEM_INT(expandTabs, 0)
-MKCONFGEN_ITEM_INT(useVimMode, 0)
+MKCONFGEN_ITEM_U8(tabWidth, 4)
+MKCONFGEN_ITEM_BOOL(expandTabs, false)
+MKCONFGEN_ITEM_BOOL(useVimMode, false)
+MKCONFGEN_ITEM_ENUM(lineEnding, LineEnding, crlf, {crlf, lf, cr})
+
+MKCONFGEN_RANGE(fontSize, 1, 200)
+MKCONFGEN_ONE_OF(tabWidth, {2, 4, 8})
+MKCONFGEN_ONE_OF(fontName, {L"Consolas", L"Cascadia Mono", L"Courier New"})
 
-MKCONFGEN_VALIDATE(fontSize, ValidateFontSize)
+MKCONFGEN_HEADING(Files)
+MKCONFGEN_ITEM_STR_ARRAY(recentFiles, 8, 260, {})
+MKCONFGEN_ITEM_STR_ARRAY(fallbackFonts, 4, 32, {L"Cascadia Mono", L"Courier New"})
+MKCONFGEN_ITEM_INT_ARRAY(rulers, 4, {80, 120})
+MKCONFGEN_ITEM_MAP(extensionTabWidths, U8)
+MKCONFGEN_ITEM_DURATION(autoSaveInterval, 30s)
+MKCONFGEN_ITEM_SIZE(maxFileSize, 64MiB)
+
+MKCONFGEN_RANGE(extensionTabWidths, 1, 16)
 
 MKCONFGEN_HEADING(Colors)
 MKCONFGEN_ITEM_UINT(textColor, 0xdcdcdc)
@@ -30,13 +39,35 @@ MKCONFGEN_ITEM_UINT(docTitleBackgroundColor, 0x3d3d3d)
 MKCONFGEN_ITEM_UINT(promptTextColor, 0xffffff)
 MKCONFGEN_ITEM_UINT(promptBackgroundColor, 0x861b2d)
 
-MKCONFGEN_VALIDATE(textColor, ValidateColor)
-MKCONFGEN_VALIDATE(backgroundColor, ValidateColor)
-MKCONFGEN_VALIDATE(cursorColor, ValidateColor)
-MKCONFGEN_VALIDATE(statusBackgroundColor, ValidateColor)
-MKCONFGEN_VALIDATE(docTitleBackgroundColor, ValidateColor)
-MKCONFGEN_VALIDATE(promptTextColor, ValidateColor)
-MKCONFGEN_VALIDATE(promptBackgroundColor, ValidateColor)
+MKCONFGEN_RANGE(textColor, 0, 0xffffff)
+MKCONFGEN_RANGE(backgroundColor, 0, 0xffffff)
+MKCONFGEN_RANGE(cursorColor, 0, 0xffffff)
+MKCONFGEN_RANGE(statusBackgroundColor, 0, 0xffffff)
+MKCONFGEN_RANGE(docTitleBackgroundColor, 0, 0xffffff)
+MKCONFGEN_RANGE(promptTextColor, 0, 0xffffff)
+MKCONFGEN_RANGE(promptBackgroundColor, 0, 0xffffff)
+
+MKCONFGEN_HEADING(Highlighting)
+MKCONFGEN_TABLE_BEGIN(keywords, 32)
+MKCONFGEN_ITEM_WSTR(word, 32, L"")
+MKCONFGEN_ITEM_UINT(color, 0xffffff)
+MKCONFGEN_ITEM_BOOL(bold, false)
+MKCONFGEN_VALIDATE(color, ValidateColor)
+MKCONFGEN_MAX_LEN(word, 24)
+MKCONFGEN_PATTERN(word, "([A-Za-z_#]\\w*)?")
+MKCONFGEN_TABLE_END
+
+MKCONFGEN_DEF_END
+
+MKCONFGEN_DEF_BEGIN(Session)
+
+MKCONFGEN_ITEM_WSTR(lastProject, 260, L"")
+MKCONFGEN_ITEM_INT(windowWidth, 1280)
+MKCONFGEN_ITEM_INT(windowHeight, 720)
+MKCONFGEN_ITEM_BOOL(maximized, false)
+
+MKCONFGEN_RANGE(windowWidth, 320, 16384)
+MKCONFGEN_RANGE(windowHeight, 240, 16384)
 
 MKCONFGEN_DEF_END
 